@@ -0,0 +1,111 @@
+#ifndef BAD_EXTENTS_H
+#define BAD_EXTENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Índice compacto de setores ilegíveis. O espaço de LBAs é dividido em
+// chunks de 64 Ki setores; cada chunk guarda suas sequências ruins como runs
+// de 16 bits e vira um bitmap de 8 KiB quando os runs passariam desse
+// tamanho. Assim um disco com milhões de setores ruins espalhados ainda cabe
+// em poucos MiB, e áreas inteiras mortas custam um run por chunk.
+
+/**
+ * @brief A run of consecutive unreadable logical sectors.
+ */
+typedef struct {
+    uint64_t lba;       // primeiro setor lógico
+    uint64_t count;     // número de setores
+} bad_extent_t;
+
+typedef struct bad_extent_index_s bad_extent_index_t;
+
+typedef void (*bad_extent_visit_t)(const bad_extent_t* extent, void* user_data);
+
+/**
+ * @brief Creates an empty index.
+ *
+ * @param sector_size Logical sector size in bytes, or 0 to let the first scan fill it in.
+ * @return The new index, or NULL if out of memory.
+ */
+bad_extent_index_t* bad_extent_index_create(uint32_t sector_size);
+void bad_extent_index_destroy(bad_extent_index_t* index);
+
+uint32_t bad_extent_index_sector_size(const bad_extent_index_t* index);
+void bad_extent_index_set_sector_size(bad_extent_index_t* index, uint32_t sector_size);
+
+/**
+ * @brief Marks [lba, lba + count) as unreadable, merging with neighbouring runs.
+ *
+ * O(log n) in the number of chunks plus a bounded move inside one chunk;
+ * ascending inserts (the common case during a scan) hit a cached chunk.
+ *
+ * @param added Receives the number of sectors that were not marked before (may be NULL).
+ * @return 0 on success, 1 if out of memory (the index is then flagged incomplete).
+ */
+int bad_extent_index_add(bad_extent_index_t* index, uint64_t lba, uint64_t count, uint64_t* added);
+
+/**
+ * @brief Returns true if the sector is marked unreadable.
+ */
+bool bad_extent_index_contains(const bad_extent_index_t* index, uint64_t lba);
+
+/**
+ * @brief Total number of unreadable sectors in the index.
+ */
+uint64_t bad_extent_index_sectors(const bad_extent_index_t* index);
+
+/**
+ * @brief True if an insertion into the index (or into one merged into it)
+ *        ran out of memory, so some unreadable sectors are missing from it.
+ */
+bool bad_extent_index_incomplete(const bad_extent_index_t* index);
+
+/**
+ * @brief Number of maximal extents (runs merged across chunk boundaries).
+ */
+uint64_t bad_extent_index_extents(const bad_extent_index_t* index);
+
+/**
+ * @brief Visits every maximal extent in ascending LBA order.
+ */
+void bad_extent_index_foreach(const bad_extent_index_t* index, bad_extent_visit_t visit, void* user_data);
+
+/**
+ * @brief Adds every sector of src to dst.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int bad_extent_index_merge(bad_extent_index_t* dst, const bad_extent_index_t* src);
+
+/**
+ * @brief Serializes the index at the current position of an open binary stream.
+ *
+ * @return 0 on success, 1 on a write error.
+ */
+int bad_extent_index_write(const bad_extent_index_t* index, FILE* fp);
+
+/**
+ * @brief Reads an index written by bad_extent_index_write().
+ *
+ * @return The index, or NULL if the data is truncated or invalid.
+ */
+bad_extent_index_t* bad_extent_index_read(FILE* fp);
+
+/**
+ * @brief Writes the index to a binary file (little-endian, chunked layout).
+ *
+ * @return 0 on success, 1 on failure.
+ */
+int bad_extent_index_save(const bad_extent_index_t* index, const char* path);
+
+/**
+ * @brief Reads an index written by bad_extent_index_save().
+ *
+ * @return The loaded index, or NULL if the file is missing or invalid.
+ */
+bad_extent_index_t* bad_extent_index_load(const char* path);
+
+#endif // BAD_EXTENTS_H
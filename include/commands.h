@@ -35,17 +35,25 @@ int execute_smart_command(const char* device_path);
  * @param device_path The platform-specific path to the target device.
  * @param output_file The path to the output JSON file. If NULL, output is
  *                    printed to the standard output.
+ * @param bad_index_path A bad sector index saved by a surface scan, or NULL.
+ * @param map_files_path Mount point whose files the bad sectors are resolved to
+ *                       (the "affectedFiles" section); ignored without bad_index_path.
  * @return int Returns EXIT_SUCCESS (0) on success, or EXIT_FAILURE (1) on error.
  */
-int execute_json_export_command(const char* device_path, const char* output_file);
+int execute_json_export_command(const char* device_path, const char* output_file, const char* bad_index_path, const char* map_files_path);
 
 
 int handle_list_drives(int argc, char* argv[]);
 int handle_surface_scan(int argc, char* argv[]);
+int handle_surface_scan_all(int argc, char* argv[]);
 int handle_smart(int argc, char* argv[]);
 int handle_smart_json(int argc, char* argv[]);
 int handle_error_log(int argc, char* argv[]);
 int handle_help(int argc, char* argv[]);
+int handle_latency_map(int argc, char* argv[]);
+int handle_patrol(int argc, char* argv[]);
+int handle_profile(int argc, char* argv[]);
+int handle_benchmark(int argc, char* argv[]);
 int start_interactive_mode(void);
 
 void handle_error_log_command(const char* device_path);
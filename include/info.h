@@ -8,7 +8,7 @@
 
 #include "smart.h" // Include smart.h to define 'struct smart_data'
 
-#define MAX_DRIVES 16
+#define MAX_DRIVES 64    // nós de storage chegam a 60 discos
 #define MAX_ATTRIBUTES 30
 
 
@@ -88,6 +88,8 @@ void run_smart_analysis(FILE* output_stream, const struct smart_data* data);
  */
 void run_nvme_analysis(FILE* output_stream, const struct smart_data* data);
 
+struct scan_options_s;
+
 /**
  * @brief Orchestrates the command-line surface scan operation for a device.
  * 
@@ -95,7 +97,66 @@ void run_nvme_analysis(FILE* output_stream, const struct smart_data* data);
  * initializes the UI, runs the scan, cleans up the UI, and displays the final report.
  * 
  * @param device_path The system path to the device (e.g., \\.\PhysicalDrive0).
+ * @param opts Scan options parsed from the command line, or NULL for a default quick scan.
+ */
+void run_surface_scan_command(const char *device_path, const struct scan_options_s *opts);
+
+/**
+ * @brief Scans several devices at once from this process (--surface with many
+ *        paths, or --surface-all), with a dashboard, a per-device summary, each
+ *        device's own reports and one combined JSON summary.
+ *
+ * @param device_paths The devices to scan.
+ * @param count Number of devices.
+ * @param opts Scan options applied to every device, or NULL for a default quick scan.
+ * @param max_concurrent Upper bound on simultaneous scans (0 = all at once).
+ */
+void run_surface_scan_fleet(const char *const *device_paths, size_t count, const struct scan_options_s *opts, unsigned max_concurrent);
+
+struct scan_patrol_budget_s;
+
+/**
+ * @brief Runs one incremental patrol step on a device (--patrol): loads the
+ *        drive's patrol state, deep scans from its cursor within the budget,
+ *        saves the state and shows the coverage age of each disk region.
+ *
+ * @param device_path The device to patrol.
+ * @param opts Scan options (engine, block size, throttle), or NULL for the defaults.
+ * @param budget How much this run may read.
+ * @param state_path Patrol state file, or NULL for the per-serial default under reports/.
+ * @return 0 on success, 1 if the run failed or was interrupted.
+ */
+int run_patrol_command(const char *device_path, const struct scan_options_s *opts, const struct scan_patrol_budget_s *budget, const char *state_path);
+
+/**
+ * @brief Profiles the transfer rate of a device (--profile): sustained
+ *        sequential reads at evenly spaced zones, drawn as a curve, compared
+ *        against the stored baseline of the drive model and exported as JSON
+ *        and CSV.
+ *
+ * @param device_path The device to profile.
+ * @param opts Scan options (engine, block size, queue depth, direct I/O), or NULL for the defaults.
+ * @param zones Number of zones (0 = SCAN_PROFILE_DEFAULT_ZONES).
+ * @param zone_bytes Bytes read per zone (0 = SCAN_PROFILE_DEFAULT_ZONE_BYTES).
+ * @param baseline_path Baseline to compare against, or NULL for the per-model default under reports/.
+ * @param save_baseline Store this run as the baseline (the first complete run of a model always is).
+ * @return 0 on success, 1 if the run failed or was interrupted.
+ */
+int run_profile_command(const char *device_path, const struct scan_options_s *opts, unsigned zones, uint64_t zone_bytes,
+                        const char *baseline_path, bool save_baseline);
+
+/**
+ * @brief Benchmarks the reads of a device (--benchmark): random 4K and 64K
+ *        reads at queue depths 1 to max_queue_depth and sequential 128K and
+ *        1M reads, each for seconds seconds, with a table of IOPS, MB/s and
+ *        p50/p99/p99.9 latency and a JSON report. Never writes to the device.
+ *
+ * @param device_path The device to benchmark.
+ * @param opts Scan options (engine, direct I/O), or NULL for the defaults.
+ * @param seconds Duration of each configuration (0 = SCAN_BENCH_DEFAULT_SECONDS).
+ * @param max_queue_depth Deepest queue tried (0 = SCAN_BENCH_MAX_QUEUE_DEPTH).
+ * @return 0 on success, 1 if a configuration failed or the run was interrupted.
  */
-void run_surface_scan_command(const char *device_path);
+int run_benchmark_command(const char *device_path, const struct scan_options_s *opts, double seconds, uint32_t max_queue_depth);
 
 #endif // INFO_H
@@ -0,0 +1,137 @@
+#ifndef LATENCY_MAP_H
+#define LATENCY_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Mapa de latência do disco inteiro com memória fixa. O nível 0 divide o
+// dispositivo em no máximo max_buckets faixas de 2^k bytes; cada nível acima
+// junta pares do nível de baixo até restar uma única faixa. Cada faixa guarda
+// min/média/máx e erros, então um heatmap de qualquer largura, de qualquer
+// trecho do disco, lê só algumas centenas de células do nível adequado, seja
+// na memória ou direto do arquivo.
+
+#define LATENCY_MAP_DEFAULT_BUCKETS (1u << 16)
+#define LATENCY_MAP_MIN_BUCKET_BYTES 4096u
+#define LATENCY_MAP_MAX_LEVELS 64
+
+/**
+ * @brief Latency summary of one region of the device.
+ */
+typedef struct {
+    uint32_t min_us;    // UINT32_MAX enquanto a faixa não tiver leituras
+    uint32_t max_us;
+    uint64_t count;     // leituras bem-sucedidas
+    uint64_t sum_us;
+    uint64_t errors;    // leituras que falharam
+} latency_cell_t;
+
+typedef struct latency_map_s latency_map_t;
+
+/**
+ * @brief Creates an empty map; the geometry is set on first use.
+ *
+ * @param max_buckets Upper bound on level-0 buckets, or 0 for LATENCY_MAP_DEFAULT_BUCKETS.
+ *        Memory use is about 2 * max_buckets * sizeof(latency_cell_t).
+ * @return The new map, or NULL if out of memory.
+ */
+latency_map_t* latency_map_create(uint32_t max_buckets);
+void latency_map_destroy(latency_map_t* map);
+
+/**
+ * @brief Sizes the map for a device. Keeps the samples if the geometry is unchanged.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int latency_map_set_geometry(latency_map_t* map, uint64_t device_size, uint32_t sector_size);
+
+uint64_t latency_map_device_size(const latency_map_t* map);
+uint32_t latency_map_sector_size(const latency_map_t* map);
+
+/**
+ * @brief Bytes covered by one level-0 bucket (0 before the geometry is set).
+ */
+uint64_t latency_map_bucket_bytes(const latency_map_t* map);
+
+/**
+ * @brief Adds pre-aggregated samples to the bucket holding offset, on every level.
+ *
+ * Lock-free: several scan workers may add to the same map concurrently.
+ */
+void latency_map_add(latency_map_t* map, uint64_t offset, const latency_cell_t* cell);
+
+/**
+ * @brief Records a single read at offset (a failed read when ok is false).
+ */
+void latency_map_record(latency_map_t* map, uint64_t offset, uint64_t latency_us, bool ok);
+
+/**
+ * @brief Adds every sample of src to dst (both must have the same geometry).
+ *
+ * @return 0 on success, 1 if the geometries differ.
+ */
+int latency_map_merge(latency_map_t* dst, const latency_map_t* src);
+
+/**
+ * @brief Resets a cell to the empty state.
+ */
+void latency_cell_clear(latency_cell_t* cell);
+
+/**
+ * @brief Adds one sample (or one error) to a cell.
+ */
+void latency_cell_sample(latency_cell_t* cell, uint64_t latency_us, bool ok);
+
+/**
+ * @brief Adds src to dst.
+ */
+void latency_cell_merge(latency_cell_t* dst, const latency_cell_t* src);
+
+/**
+ * @brief Splits [start, end) into cell_count equal columns and summarizes each
+ *        from the coarsest level that still resolves them.
+ *
+ * Cost is proportional to cell_count, not to the size of the range. When the
+ * range is narrower than cell_count level-0 buckets, a bucket is repeated in
+ * every column it overlaps. end is clamped to the device size.
+ *
+ * @return 0 on success, 1 on invalid arguments.
+ */
+int latency_map_render(const latency_map_t* map, uint64_t start, uint64_t end, latency_cell_t* cells, unsigned cell_count);
+
+/**
+ * @brief Serializes the map (all levels plus a directory of level offsets).
+ *
+ * @return 0 on success, 1 on a write error.
+ */
+int latency_map_write(const latency_map_t* map, FILE* fp);
+
+/**
+ * @brief Reads a map written by latency_map_write().
+ *
+ * @return The map, or NULL if the data is truncated or invalid.
+ */
+latency_map_t* latency_map_read(FILE* fp);
+
+/**
+ * @brief Writes the map to a binary file.
+ *
+ * @return 0 on success, 1 on failure.
+ */
+int latency_map_save(const latency_map_t* map, const char* path);
+
+/**
+ * @brief Same as latency_map_render() on a saved file, reading only the
+ *        header and the slice of the selected level.
+ *
+ * @param end End of the range; clamped to the device size (UINT64_MAX = whole device).
+ * @param device_size Receives the size of the mapped device (may be NULL).
+ * @param sector_size Receives its logical sector size (may be NULL).
+ * @return 0 on success, 1 if the file is missing or invalid.
+ */
+int latency_map_file_query(const char* path, uint64_t start, uint64_t end, latency_cell_t* cells, unsigned cell_count,
+                           uint64_t* device_size, uint32_t* sector_size);
+
+#endif // LATENCY_MAP_H
@@ -3,6 +3,7 @@
 
 #include "pal.h"          
 #include "nvme_hybrid.h"  
+#include "scan_filemap.h"
 #include <stdio.h>       
 
 typedef enum {
@@ -19,6 +20,7 @@ int nvme_export_to_json(
     const struct smart_data* sdata,           
     const nvme_health_alerts_t* alerts,       
     const nvme_hybrid_context_t* hybrid_ctx,  // Contexto híbrido, para resultados de benchmark
+    const scan_file_damage_t* file_damage,    // Arquivos atingidos por setores ruins. Se NULL, a seção é omitida.
     const char* output_file_path              // Caminho do arquivo de saída. Se NULL, imprime para stdout.
 );
 
@@ -37,6 +37,169 @@ pal_status_t pal_list_drives(DriveInfo* drives, int max_drives, int* drive_count
 pal_status_t pal_get_basic_drive_info(const char* device_path, BasicDriveInfo* drive_info);
 int64_t pal_get_device_size(const char *device_path);
 
+/**
+ * @brief Retrieves the logical and physical sector sizes of a device.
+ *
+ * Unbuffered (O_DIRECT / FILE_FLAG_NO_BUFFERING) reads must be aligned to the
+ * logical sector size, both in offset/length and in buffer address.
+ *
+ * @param device_path The platform-specific path to the device.
+ * @param logical_size Receives the logical sector size in bytes.
+ * @param physical_size Receives the physical sector size in bytes (may be NULL).
+ * @return pal_status_t PAL_STATUS_SUCCESS on success, or an error code on failure.
+ */
+pal_status_t pal_get_sector_sizes(const char *device_path, uint32_t *logical_size, uint32_t *physical_size);
+
+/**
+ * @brief Retrieves the number of hardware submission queues of a block device.
+ *
+ * On Linux this is the number of blk-mq hardware contexts exposed under
+ * /sys/block/<dev>/mq. Used to size parallel surface scans.
+ *
+ * @param device_path The platform-specific path to the device.
+ * @param queue_count Receives the number of hardware queues.
+ * @return pal_status_t PAL_STATUS_SUCCESS on success, PAL_STATUS_UNSUPPORTED where unknown.
+ */
+pal_status_t pal_get_queue_count(const char *device_path, int *queue_count);
+
+/**
+ * @brief Request-queue limits of the disk that holds a device.
+ *
+ * Zero means unknown. max_transfer_bytes already includes the NVMe MDTS
+ * limit when the controller reports one.
+ */
+typedef struct {
+    uint32_t max_transfer_bytes;    // maior leitura enviada sem ser dividida pelo kernel
+    uint32_t logical_block_size;
+    uint32_t physical_block_size;
+    uint32_t nr_requests;           // requisições que a fila do SO aceita
+    uint32_t nvme_mdts_bytes;       // MDTS do controlador NVMe (0 = sem limite ou não é NVMe)
+    int rotational;                 // 1 = disco giratório, 0 = SSD, -1 = desconhecido
+} pal_queue_limits_t;
+
+/**
+ * @brief Reads the request-queue limits of the disk containing device_path.
+ *
+ * On Linux these come from /sys/block/<dev>/queue/{max_sectors_kb,
+ * logical_block_size,physical_block_size,nr_requests,rotational} and, for
+ * NVMe, from the MDTS field of Identify Controller. Other platforms fill what
+ * they know (at least the sector sizes) and leave the rest unknown.
+ *
+ * @param device_path The platform-specific path to the device.
+ * @param limits Receives the limits.
+ * @return pal_status_t PAL_STATUS_SUCCESS on success (possibly partial), or an error code.
+ */
+pal_status_t pal_get_queue_limits(const char *device_path, pal_queue_limits_t *limits);
+
+/**
+ * @brief Command used to have a drive check its own media without sending
+ *        the data to the host.
+ */
+typedef enum {
+    PAL_VERIFY_NONE,
+    PAL_VERIFY_SCSI,    // VERIFY(16) sem BYTCHK (SAS; SATA atrás do libata vira READ VERIFY)
+    PAL_VERIFY_ATA,     // READ VERIFY SECTORS EXT dentro de ATA PASS-THROUGH(16)
+    PAL_VERIFY_NVME     // comando Verify (0x0C) do NVM command set
+} pal_verify_method_t;
+
+/**
+ * @brief An open device that accepts verify commands.
+ */
+typedef struct {
+    pal_verify_method_t method;
+    uint32_t sector_size;       // setor lógico: unidade dos LBAs
+    uint32_t max_sectors;       // maior faixa de um comando
+    uint64_t lba_offset;        // partição: LBA do disco onde ela começa
+    uint32_t nsid;              // NVMe: namespace dos comandos
+    int fd;
+} pal_verifier_t;
+
+/**
+ * @brief Opens device_path for verify commands and picks the first method the
+ *        drive accepts (a one-sector verify of LBA 0 is issued to find out).
+ *
+ * On Linux the SCSI and ATA commands go through SG_IO (the ATA PASS-THROUGH
+ * method usually needs root, CAP_SYS_RAWIO) and NVMe Verify through
+ * NVME_IOCTL_IO_CMD, only when the ONCS field of Identify Controller says the
+ * controller supports it. A partition is verified through its whole disk,
+ * with LBAs still relative to the partition.
+ *
+ * @return PAL_STATUS_SUCCESS, PAL_STATUS_UNSUPPORTED when the device (or the
+ *         platform) has no usable verify command, or an open error.
+ */
+pal_status_t pal_verify_open(const char *device_path, pal_verifier_t *verifier);
+
+/**
+ * @brief Asks the drive to read and check count sectors from lba (count at
+ *        most verifier->max_sectors). No data is transferred.
+ *
+ * @param error_lba On PAL_STATUS_DEVICE_ERROR receives the first LBA the drive
+ *        could not read, from the sense data (UINT64_MAX when it gave none).
+ * @return PAL_STATUS_SUCCESS when the whole range is readable (recovered
+ *         errors included), PAL_STATUS_DEVICE_ERROR on a medium error, or
+ *         PAL_STATUS_IO_ERROR when the command itself failed.
+ */
+pal_status_t pal_verify_sectors(pal_verifier_t *verifier, uint64_t lba, uint32_t count, uint64_t *error_lba);
+
+void pal_verify_close(pal_verifier_t *verifier);
+
+/**
+ * @brief Printable name of a verify method.
+ */
+const char* pal_verify_method_name(pal_verify_method_t method);
+
+/**
+ * @brief Cumulative I/O counters of the disk that holds a device.
+ *
+ * Counts every request the disk completed, from any process. Sectors are
+ * always 512-byte units, whatever the logical sector size.
+ */
+typedef struct {
+    uint64_t reads_completed;
+    uint64_t sectors_read;
+    uint64_t writes_completed;
+    uint64_t sectors_written;
+} pal_io_counters_t;
+
+/**
+ * @brief Reads the I/O counters of the whole disk containing device_path.
+ *
+ * On Linux these come from /sys/block/<dev>/stat (a partition reports the
+ * counters of its parent disk); on Windows from IOCTL_DISK_PERFORMANCE.
+ *
+ * @param device_path The platform-specific path to the device.
+ * @param counters Receives the counters.
+ * @return pal_status_t PAL_STATUS_SUCCESS on success, PAL_STATUS_UNSUPPORTED for
+ *         disk images and platforms without per-disk statistics.
+ */
+pal_status_t pal_get_io_counters(const char *device_path, pal_io_counters_t *counters);
+
+/**
+ * @brief Receives one extent of a file as a byte range of the scanned device.
+ *
+ * @param file_path Path of the file or directory that owns the extent.
+ * @param file_offset Byte offset of the extent inside the file.
+ * @param device_offset Byte offset of the extent on the device passed to pal_map_fs_extents().
+ * @param length Length of the extent in bytes.
+ */
+typedef void (*pal_fs_extent_callback)(const char *file_path, uint64_t file_offset, uint64_t device_offset, uint64_t length, void *user_data);
+
+/**
+ * @brief Walks the filesystem mounted at fs_path (without crossing into other
+ *        mounts) and reports the on-disk extents of every file and directory.
+ *
+ * Offsets are translated to device_path, which may be the filesystem's own
+ * block device/volume or the whole disk holding it (the partition offset is
+ * added). On Linux the extents come from FIEMAP; on Windows from
+ * FSCTL_GET_RETRIEVAL_POINTERS. Filesystem metadata (inode tables, journal,
+ * MFT) is not reported, nor are extents not yet allocated (delayed allocation).
+ *
+ * @return pal_status_t PAL_STATUS_SUCCESS on success, PAL_STATUS_INVALID_PARAMETER
+ *         if the filesystem is not on device_path, PAL_STATUS_UNSUPPORTED when the
+ *         platform or filesystem cannot map files to disk blocks.
+ */
+pal_status_t pal_map_fs_extents(const char *fs_path, const char *device_path, pal_fs_extent_callback callback, void *user_data);
+
 // S.M.A.R.T.
 struct smart_data; 
 pal_status_t pal_get_smart_data(const char* device_path, struct smart_data* data);
@@ -0,0 +1,145 @@
+#ifndef PAL_SIM_H
+#define PAL_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pal.h"
+#include "smart.h"
+
+// Backend simulado da PAL, compilado no lugar da PAL da plataforma com
+// DISKORACLE_PAL_SIM (biblioteca diskoracle_sim). Cada dispositivo é um
+// arquivo de configuração (ou uma entrada registrada por pal_sim_register())
+// que descreve um disco ATA ou NVMe: tamanho, setores, arquivo de imagem com
+// os dados (opcional; sem ele o disco lê zeros), custo de leitura por região,
+// faixas de LBAs com falhas injetadas e as respostas SMART/health log. O
+// caminho do arquivo é o caminho do dispositivo para o resto do programa:
+// pal_get_device_size(), pal_get_smart_data() e surface_scan() funcionam
+// sobre ele sem saber que não há hardware. Só POSIX.
+
+#define PAL_SIM_MAX_REGIONS 16
+#define PAL_SIM_MAX_FAULTS 64
+#define PAL_SIM_MAX_DEVICES 64
+
+/**
+ * @brief Interface a simulated device reports.
+ */
+typedef enum {
+    PAL_SIM_BUS_ATA,
+    PAL_SIM_BUS_NVME
+} pal_sim_bus_t;
+
+/**
+ * @brief How reads touching a faulty LBA range behave.
+ */
+typedef enum {
+    PAL_SIM_FAULT_EIO,      // toda leitura que toca a faixa falha com EIO
+    PAL_SIM_FAULT_FLAKY,    // leituras alternadas falham: uma nova tentativa passa
+    PAL_SIM_FAULT_FLIP      // leituras alternadas devolvem um bit trocado (detectado por --verify)
+} pal_sim_fault_kind_t;
+
+typedef struct {
+    uint64_t lba;
+    uint64_t count;
+    pal_sim_fault_kind_t kind;
+} pal_sim_fault_t;
+
+/**
+ * @brief Cost of each read that starts in [start, end) (bytes): a fixed
+ *        latency plus the transfer at mbps MiB/s (0 = instantaneous).
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint32_t latency_us;
+    double mbps;
+} pal_sim_region_t;
+
+/**
+ * @brief Canned NVMe SMART / Health Information log values.
+ */
+typedef struct {
+    uint8_t critical_warning;
+    uint16_t temperature_kelvin;
+    uint8_t available_spare;
+    uint8_t spare_threshold;
+    uint8_t percentage_used;
+    uint64_t data_units_read;
+    uint64_t data_units_written;
+    uint64_t power_cycles;
+    uint64_t power_on_hours;
+    uint64_t unsafe_shutdowns;
+    uint64_t media_errors;
+    uint64_t error_log_entries;
+} pal_sim_nvme_health_t;
+
+/**
+ * @brief Description of a simulated device. Initialize with pal_sim_config_init().
+ */
+typedef struct {
+    pal_sim_bus_t bus;
+    char model[64];
+    char serial[32];
+    char firmware[16];
+    uint64_t size;                  // bytes; 0 = tamanho do arquivo de imagem
+    uint32_t sector_size;
+    uint32_t physical_sector_size;
+    int queues;                     // filas de hardware informadas (scan paralelo automático)
+    bool rotational;                // HDD: uma leitura por vez, como uma cabeça só
+    char image[512];                // arquivo com os dados ("" = zeros); além do fim dele também lê zeros
+
+    pal_sim_region_t regions[PAL_SIM_MAX_REGIONS];
+    unsigned region_count;
+    pal_sim_fault_t faults[PAL_SIM_MAX_FAULTS];
+    unsigned fault_count;
+
+    struct smart_attr attrs[MAX_SMART_ATTRIBUTES];  // ATA
+    int attr_count;
+    pal_sim_nvme_health_t health;                   // NVMe
+    uint8_t mdts;                   // Identify Controller: tamanho máximo de transferência (2^mdts páginas, 0 = sem limite)
+    uint16_t oncs;                  // Identify Controller: comandos opcionais suportados (bit 7: Verify)
+} pal_sim_config_t;
+
+/**
+ * @brief Fills a config with the defaults: a healthy 512-byte-sector ATA SSD
+ *        with one queue, sized by its image file.
+ */
+void pal_sim_config_init(pal_sim_config_t* config);
+
+/**
+ * @brief Reads a device description from a text file of "key = value" lines
+ *        (see README). Relative image paths are taken from the file's directory.
+ *
+ * @return PAL_STATUS_SUCCESS, PAL_STATUS_DEVICE_NOT_FOUND if the file is
+ *         missing, PAL_STATUS_INVALID_PARAMETER on a malformed line (reported on stderr).
+ */
+pal_status_t pal_sim_load_config(const char* config_path, pal_sim_config_t* config);
+
+/**
+ * @brief Makes device_path a simulated device described by config, replacing
+ *        any earlier one with the same path. Unregistered paths are loaded
+ *        with pal_sim_load_config() on first use.
+ */
+pal_status_t pal_sim_register(const char* device_path, const pal_sim_config_t* config);
+
+/**
+ * @brief Forgets every simulated device (open handles must be closed first).
+ */
+void pal_sim_reset(void);
+
+/**
+ * @brief Opens a simulated device for reading; used by the scan engines in
+ *        place of open(). direct_io opens the image with O_DIRECT.
+ *
+ * @return A file descriptor, or -1 with errno set.
+ */
+int pal_sim_open(const char* device_path, bool direct_io);
+
+/**
+ * @brief Positional read with the device's latency and faults applied; reads
+ *        of descriptors not opened by pal_sim_open() go straight to pread().
+ */
+int64_t pal_sim_read(int fd, void* buf, uint32_t len, uint64_t offset);
+
+void pal_sim_close(int fd);
+
+#endif // PAL_SIM_H
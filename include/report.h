@@ -3,6 +3,13 @@
 
 #include <stdio.h>
 #include "smart.h"
+#include "bad_extents.h"
+#include "surface.h"
+#include "scan_scheduler.h"
+#include "scan_journal.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
+#include "scan_tune.h"
 #include "nvme_hybrid.h"
 
 /**
@@ -23,4 +30,93 @@ int report_smart_data(FILE* output_stream, const char *device_path, struct smart
 int report_generate(const char *device_path_in, const struct smart_data *data, const char *format, const char *output_filepath);
 void display_nvme_alerts(const nvme_health_alerts_t* health_alerts);
 
+/**
+ * @brief Saves a bad sector index next to the reports, as
+ *        reports/diskoracle_badlba_<device>_<timestamp>.bin.
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_bad_extents(const char *device_path, const bad_extent_index_t *index, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes the results of a surface scan, including the read latency
+ *        tiers, histogram and (if the scan kept one) a whole-disk latency heatmap, as reports/diskoracle_scan_<device>_<timestamp>.json.
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_scan_json(const char *device_path, const scan_state_t *state, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Saves a latency map as reports/diskoracle_latmap_<device>_<timestamp>.bin
+ *        (view it later with --latency-map).
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_latency_map(const char *device_path, const latency_map_t *map, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes one summary of a multi-device scan (status, counters and the
+ *        path of each device's own report) as reports/diskoracle_scan_all_<timestamp>.json.
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_scan_summary_json(const scan_job_t *jobs, size_t count, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes the state of a patrol after a run (cursor, passes, the run's
+ *        counters and the coverage age of each LBA region) as
+ *        reports/diskoracle_patrol_<device>_<timestamp>.json.
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_patrol_json(const char *device_path, const scan_patrol_t *patrol, const scan_state_t *state, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes a transfer-rate profile (MB/s and latency per zone) as
+ *        reports/diskoracle_profile_<device>_<timestamp>.json, with the
+ *        baseline rate and the difference from it per zone when a baseline
+ *        is given.
+ *
+ * @param baseline Baseline of the same model (may be NULL).
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_profile_json(const char *device_path, const scan_profile_t *profile, const scan_profile_t *baseline, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Exports a transfer-rate profile as
+ *        reports/diskoracle_profile_<device>_<timestamp>.csv (the format
+ *        --baseline reads back).
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_profile_csv(const char *device_path, const scan_profile_t *profile, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes the results of a read benchmark (IOPS, MB/s and latency
+ *        percentiles per configuration) as
+ *        reports/diskoracle_benchmark_<device>_<timestamp>.json.
+ *
+ * @param drive_info Identity of the benchmarked drive (may be NULL).
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_benchmark_json(const char *device_path, const BasicDriveInfo *drive_info, const scan_bench_result_t *results, size_t count, char *saved_path, size_t saved_path_size);
+
+/**
+ * @brief Writes an --auto-tune calibration (queue limits, every probe and the
+ *        chosen block size and queue depth) as
+ *        reports/diskoracle_tune_<device>_<timestamp>.json.
+ *
+ * @param saved_path Receives the path of the written file (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int report_save_tune_json(const char *device_path, const scan_tune_result_t *result, char *saved_path, size_t saved_path_size);
+
 #endif
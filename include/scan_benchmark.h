@@ -0,0 +1,88 @@
+#ifndef SCAN_BENCHMARK_H
+#define SCAN_BENCHMARK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "surface.h"
+
+// Benchmark de leitura de um dispositivo real (--benchmark): leituras
+// aleatórias de 4K e 64K com profundidades de fila de 1 a 256 e leituras
+// sequenciais de 128K e 1M, cada configuração por alguns segundos, com IOPS,
+// MB/s e percentis de latência. Roda sobre o núcleo do scan (io_uring quando
+// disponível), que só lê: é seguro num disco montado.
+
+#define SCAN_BENCH_MAX_CONFIGS 32
+#define SCAN_BENCH_MAX_QUEUE_DEPTH 256
+#define SCAN_BENCH_DEFAULT_SECONDS 5.0
+#define SCAN_BENCH_SEQUENTIAL_QUEUE_DEPTH 32
+
+/**
+ * @brief Access pattern of a benchmark configuration.
+ */
+typedef enum {
+    SCAN_BENCH_RANDOM,      // permutação aleatória dos blocos do disco inteiro
+    SCAN_BENCH_SEQUENTIAL
+} scan_bench_pattern_t;
+
+/**
+ * @brief One benchmark configuration.
+ */
+typedef struct {
+    scan_bench_pattern_t pattern;
+    uint32_t block_size;
+    uint32_t queue_depth;
+} scan_bench_config_t;
+
+/**
+ * @brief Measurement of one configuration.
+ */
+typedef struct {
+    scan_bench_config_t config;
+    unsigned threads;           // workers usados para chegar à fila sem io_uring (1 com io_uring)
+    scan_engine_t engine;       // engine que de fato leu
+    double seconds;
+    uint64_t reads;
+    uint64_t bytes;
+    uint64_t errors;
+    double iops;
+    double mbps;                // MiB/s
+    double mean_us;
+    uint64_t p50_us;
+    uint64_t p99_us;
+    uint64_t p999_us;
+    uint64_t max_us;
+} scan_bench_result_t;
+
+/**
+ * @brief Fills the default plan: random 4K and 64K reads at queue depths
+ *        1, 2, 4 ... max_queue_depth, then sequential 128K and 1M reads at
+ *        SCAN_BENCH_SEQUENTIAL_QUEUE_DEPTH (capped at max_queue_depth).
+ *
+ * @param max_queue_depth Deepest queue tried (0 = SCAN_BENCH_MAX_QUEUE_DEPTH).
+ * @return Number of configurations written (at most max_configs).
+ */
+unsigned scan_bench_default_plan(scan_bench_config_t* configs, unsigned max_configs, uint32_t max_queue_depth);
+
+/**
+ * @brief Runs one configuration for seconds seconds (or until the device has
+ *        been read once) and fills result.
+ *
+ * opts supplies the engine and direct I/O; mode, order, block size, queue
+ * depth, threads, range, throttle, verify and journal are overridden. When
+ * the run shows the reads were not queued asynchronously (the engine that
+ * actually read was not io_uring) a random configuration is measured again
+ * with as many synchronous workers as its queue depth, up to
+ * SCAN_MAX_THREADS, and a sequential one is reported at QD 1. result->engine
+ * is the engine that read.
+ *
+ * @return 0 on success, 1 if the device could not be read or the run was interrupted.
+ */
+int scan_bench_run(const char* device_path, const scan_options_t* opts, const scan_bench_config_t* config, double seconds,
+                   scan_callback_t callback, void* user_data, scan_bench_result_t* result);
+
+/**
+ * @brief Printable name of a pattern ("random" or "sequential").
+ */
+const char* scan_bench_pattern_name(scan_bench_pattern_t pattern);
+
+#endif // SCAN_BENCHMARK_H
@@ -0,0 +1,73 @@
+#ifndef SCAN_CONTENT_H
+#define SCAN_CONTENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Classificação do conteúdo dos blocos lidos pelo scan: zerado, todo 0xFF,
+// padrão repetido (p.ex. o preenchimento de uma ferramenta de wipe) ou dados.
+// Mostra quanto do disco está de fato ocupado (thin provisioning) e confirma
+// que um wipe antes do descarte cobriu o disco inteiro. Os kernels são SIMD
+// e param no primeiro vetor que descarta a classe, então um bloco de dados
+// custa só algumas centenas de bytes de leitura da memória.
+
+#define SCAN_CONTENT_REGIONS 64
+
+// Período testado para padrões: múltiplo de 1, 2, 3, 4, 6, 8, 12, 16, 24, 32,
+// 48 e 64, cobrindo os padrões de 1 a 3 bytes dos métodos de wipe clássicos.
+#define SCAN_CONTENT_PATTERN_PERIOD 192
+
+/**
+ * @brief What a block holds.
+ */
+typedef enum {
+    SCAN_CONTENT_ZERO,
+    SCAN_CONTENT_ONES,      // todos os bytes 0xFF (flash apagada)
+    SCAN_CONTENT_PATTERN,   // um trecho de até 192 bytes repetido do início ao fim
+    SCAN_CONTENT_DATA,
+    SCAN_CONTENT_CLASSES
+} scan_content_class_t;
+
+/**
+ * @brief Bytes of each class per region of the device (SCAN_CONTENT_REGIONS
+ *        equal regions), filled by a scan run with scan_options_t::content_map.
+ *
+ * Owned by the caller. Parallel workers add to it with atomic increments.
+ */
+typedef struct {
+    uint64_t device_size;
+    uint32_t sector_size;
+    uint64_t bytes[SCAN_CONTENT_REGIONS][SCAN_CONTENT_CLASSES];
+} scan_content_map_t;
+
+/**
+ * @brief Classifies one block.
+ */
+scan_content_class_t scan_content_classify(const uint8_t* buf, size_t len);
+
+/**
+ * @brief Short printable name of a class ("zero", "ones", "pattern", "data").
+ */
+const char* scan_content_class_name(scan_content_class_t content);
+
+/**
+ * @brief Sizes the map for a device; the counts are kept if the geometry is unchanged.
+ */
+void scan_content_map_set_geometry(scan_content_map_t* map, uint64_t device_size, uint32_t sector_size);
+
+/**
+ * @brief First byte of a region (region == SCAN_CONTENT_REGIONS gives the device size).
+ */
+uint64_t scan_content_region_start(const scan_content_map_t* map, unsigned region);
+
+/**
+ * @brief Region holding offset.
+ */
+unsigned scan_content_region_of(const scan_content_map_t* map, uint64_t offset);
+
+/**
+ * @brief Sums the bytes of each class over the whole map.
+ */
+void scan_content_totals(const scan_content_map_t* map, uint64_t totals[SCAN_CONTENT_CLASSES]);
+
+#endif // SCAN_CONTENT_H
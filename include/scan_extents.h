@@ -0,0 +1,84 @@
+#ifndef SCAN_EXTENTS_H
+#define SCAN_EXTENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Lista das faixas alocadas de um sistema de arquivos, em bytes do disco
+// escaneado. Num volume quase vazio o scan profundo lê só estas faixas em vez
+// do disco inteiro. A lista é ordenada e os buracos pequenos entre faixas
+// vizinhas são absorvidos, para que o engine continue fazendo leituras
+// sequenciais longas em vez de saltar a cada arquivo.
+
+// Buracos até este tamanho são lidos junto: num HDD, ler 1 MiB custa menos
+// que o seek para pulá-lo.
+#define SCAN_EXTENT_MERGE_GAP (1024u * 1024u)
+
+/**
+ * @brief Half-open byte range [start, end) of the device.
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} scan_extent_t;
+
+/**
+ * @brief Growable list of extents; sorted and disjoint after scan_extent_list_coalesce().
+ */
+typedef struct {
+    scan_extent_t* items;
+    size_t count;
+    size_t capacity;
+    uint64_t bytes;     // soma dos tamanhos (válida depois de coalesce)
+} scan_extent_list_t;
+
+void scan_extent_list_init(scan_extent_list_t* list);
+void scan_extent_list_free(scan_extent_list_t* list);
+
+/**
+ * @brief Appends [start, start + length), in any order.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int scan_extent_list_add(scan_extent_list_t* list, uint64_t start, uint64_t length);
+
+/**
+ * @brief Sorts the list, widens every extent to whole sectors, clips it to
+ *        [0, limit) and merges extents that overlap or are at most max_gap apart.
+ */
+void scan_extent_list_coalesce(scan_extent_list_t* list, uint32_t sector_size, uint64_t max_gap, uint64_t limit);
+
+/**
+ * @brief Index of the first extent that ends after offset (count if none).
+ */
+size_t scan_extent_list_find(const scan_extent_list_t* list, uint64_t offset);
+
+/**
+ * @brief Bytes of the list inside [start, end).
+ */
+uint64_t scan_extent_list_bytes_in(const scan_extent_list_t* list, uint64_t start, uint64_t end);
+
+/**
+ * @brief Reads of block_size bytes needed to cover the list inside [start, end)
+ *        (one short read at the end of each extent).
+ */
+uint64_t scan_extent_list_blocks_in(const scan_extent_list_t* list, uint64_t start, uint64_t end, uint32_t block_size);
+
+/**
+ * @brief Offset at which bytes bytes of the list inside [start, end) have been
+ *        passed, aligned down to align; used to split a scan in equal shares.
+ */
+uint64_t scan_extent_list_offset_after(const scan_extent_list_t* list, uint64_t start, uint64_t end, uint64_t bytes, uint32_t align);
+
+/**
+ * @brief Collects the allocated extents of the filesystem mounted at fs_path,
+ *        as byte ranges of device_path, and coalesces them.
+ *
+ * @return A pal_status_t: PAL_STATUS_SUCCESS, PAL_STATUS_INVALID_PARAMETER if the
+ *         filesystem is not on device_path, PAL_STATUS_UNSUPPORTED where the
+ *         platform or filesystem cannot report file extents.
+ */
+int scan_extent_list_collect_fs(scan_extent_list_t* list, const char* fs_path, const char* device_path,
+                                uint32_t sector_size, uint64_t device_size);
+
+#endif // SCAN_EXTENTS_H
@@ -0,0 +1,149 @@
+#ifndef SCAN_FILEMAP_H
+#define SCAN_FILEMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bad_extents.h"
+
+// Mapeamento reverso de setores ruins para arquivos. O índice guarda as
+// extensões de todos os arquivos de um sistema de arquivos montado, em bytes
+// do disco escaneado, ordenadas pelo início; max_end[i] é o maior fim entre
+// items[0..i], o que transforma o array num interval tree implícito: uma
+// consulta acha por busca binária a última extensão que começa antes do fim
+// da faixa e volta enquanto max_end ainda alcança o início dela. Extensões
+// compartilhadas (reflink, snapshots) aparecem uma vez por arquivo.
+
+#define SCAN_FILEMAP_MAX_HITS 4096      // trechos guardados para os relatórios; acima disso só os totais
+
+/**
+ * @brief Why a sector of a file was reported.
+ */
+typedef enum {
+    SCAN_DAMAGE_UNREADABLE,     // leitura falhou
+    SCAN_DAMAGE_MISMATCH        // duas leituras devolveram dados diferentes (--verify)
+} scan_damage_kind_t;
+
+/**
+ * @brief One extent of a file: bytes [start, end) of the device hold bytes
+ *        [file_offset, file_offset + end - start) of file number file.
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint64_t file_offset;
+    uint32_t file;
+} scan_file_extent_t;
+
+/**
+ * @brief Interval index of the file extents of one filesystem.
+ */
+typedef struct {
+    scan_file_extent_t* items;
+    uint64_t* max_end;          // preenchido por scan_file_index_sort()
+    size_t count;
+    size_t capacity;
+    size_t* file_paths;         // offset do caminho de cada arquivo em paths
+    uint32_t files;
+    uint32_t files_capacity;
+    char* paths;                // caminhos terminados em '\0', um após o outro
+    size_t paths_size;
+    size_t paths_capacity;
+} scan_file_index_t;
+
+/**
+ * @brief A run of damaged sectors inside one file.
+ */
+typedef struct {
+    uint64_t lba;               // primeiro setor lógico atingido
+    uint64_t sectors;
+    uint64_t file_offset;       // byte do arquivo guardado em lba
+    size_t path;                // offset do caminho em scan_file_damage_t::paths
+    scan_damage_kind_t kind;
+} scan_file_hit_t;
+
+/**
+ * @brief Files hit by the bad (and mismatched) sectors of a scan.
+ */
+typedef struct {
+    int status;                 // pal_status_t do mapeamento (PAL_STATUS_SUCCESS se feito)
+    char fs_path[512];          // ponto de montagem mapeado
+    uint32_t sector_size;
+    scan_file_hit_t* hits;      // em ordem de LBA, no máximo SCAN_FILEMAP_MAX_HITS
+    size_t hit_count;
+    size_t hit_capacity;
+    uint64_t total_hits;        // trechos encontrados, inclusive os não guardados
+    uint64_t files;             // arquivos distintos atingidos
+    uint64_t bytes;             // bytes de arquivo atingidos
+    uint64_t unmapped_sectors;  // setores ruins fora de qualquer arquivo (espaço livre ou metadados)
+    char* paths;
+    size_t paths_size;
+    size_t paths_capacity;
+    size_t* file_slots;         // durante o mapeamento: o que já foi contado/copiado de cada arquivo do índice
+    uint32_t file_slot_count;
+} scan_file_damage_t;
+
+void scan_file_index_init(scan_file_index_t* index);
+void scan_file_index_free(scan_file_index_t* index);
+
+/**
+ * @brief Appends an extent of file_path. Extents of the same file should be
+ *        added one after the other, so that its path is stored once.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int scan_file_index_add(scan_file_index_t* index, const char* file_path, uint64_t file_offset, uint64_t device_offset, uint64_t length);
+
+/**
+ * @brief Sorts the extents and builds max_end; call once after the last add.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int scan_file_index_sort(scan_file_index_t* index);
+
+/**
+ * @brief Fills the index with every file extent of the filesystem mounted at
+ *        fs_path, as byte offsets of device_path (partition offset included).
+ *
+ * @return A pal_status_t, as pal_map_fs_extents().
+ */
+int scan_file_index_build(scan_file_index_t* index, const char* fs_path, const char* device_path);
+
+/**
+ * @brief Path of file number file.
+ */
+const char* scan_file_index_path(const scan_file_index_t* index, uint32_t file);
+
+void scan_file_damage_init(scan_file_damage_t* damage);
+void scan_file_damage_free(scan_file_damage_t* damage);
+
+/**
+ * @brief Resolves every sector of bad to the files that hold it, in one pass
+ *        over the index, adding the hits to damage.
+ *
+ * @return 0 on success, 1 if out of memory.
+ */
+int scan_file_damage_resolve(scan_file_damage_t* damage, const scan_file_index_t* index,
+                             const bad_extent_index_t* bad, scan_damage_kind_t kind);
+
+/**
+ * @brief Builds the index of the filesystem mounted at fs_path and resolves
+ *        the unreadable and (optional) mismatched sectors of a scan of
+ *        device_path. The index is freed before returning; damage keeps only
+ *        the paths of the files that were hit.
+ *
+ * @return A pal_status_t, also stored in damage->status.
+ */
+int scan_file_damage_map(scan_file_damage_t* damage, const char* fs_path, const char* device_path,
+                         const bad_extent_index_t* bad, const bad_extent_index_t* mismatch);
+
+/**
+ * @brief Path of the file of a hit.
+ */
+const char* scan_file_damage_path(const scan_file_damage_t* damage, const scan_file_hit_t* hit);
+
+/**
+ * @brief Printable name of a damage kind ("unreadable", "mismatch").
+ */
+const char* scan_damage_kind_name(scan_damage_kind_t kind);
+
+#endif // SCAN_FILEMAP_H
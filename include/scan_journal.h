@@ -0,0 +1,149 @@
+#ifndef SCAN_JOURNAL_H
+#define SCAN_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "surface.h"
+#include "bad_extents.h"
+#include "latency_map.h"
+
+// Journal de checkpoint do scan profundo. Guarda a identidade do disco, a
+// configuração e os modos do scan, o cursor de cada faixa, os setores ruins e
+// inconsistentes achados até ali e o mapa de latência, para que um scan interrompido (SIGINT, queda da sessão SSH,
+// reboot) possa continuar com --resume.
+
+#define SCAN_JOURNAL_INTERVAL_SECONDS 15
+
+/**
+ * @brief A contiguous byte range of the device assigned to one scan worker.
+ *
+ * Everything in [start, cursor) has already been read and accounted for.
+ * Outside the sequential order the range holds positions in the order.
+ */
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+    uint64_t cursor;
+} scan_segment_t;
+
+/**
+ * @brief Contents of a scan checkpoint (the bad and mismatched sector indexes
+ *        and the latency map are stored alongside).
+ *
+ * The progress counters only cover what lies before the segment cursors,
+ * which is exactly what a resumed scan does not read again.
+ */
+typedef struct {
+    // Identidade do dispositivo
+    char device_path[256];
+    char serial[64];
+    uint64_t device_size;
+    uint32_t sector_size;
+
+    // Configuração
+    uint32_t block_size;
+    uint32_t queue_depth;
+    uint32_t engine;
+    bool direct_io;
+    uint32_t order;         // scan_order_kind_t
+    uint64_t stride;
+    uint64_t order_seed;    // semente da ordem aleatória
+
+    // Modos: um resume continua com eles, seja qual for a linha de comando.
+    bool verify;
+    bool classify;
+    char allocated_path[256];   // vazio = faixa inteira
+
+    // Progresso
+    uint64_t scanned_blocks;
+    uint64_t bad_blocks;
+    uint64_t read_errors;
+    uint64_t mismatch_blocks;
+    double elapsed_seconds;
+    scan_latency_t latency;
+    unsigned segment_count;
+    scan_segment_t segments[SCAN_MAX_THREADS];
+    scan_content_map_t content;     // só com classify
+} scan_journal_t;
+
+/**
+ * @brief Builds the default journal path for a device: reports/diskoracle_scan_<device>.journal.
+ */
+void scan_journal_default_path(const char* device_path, char* out, size_t out_size);
+
+/**
+ * @brief Writes a checkpoint atomically: the data goes to <path>.tmp, is
+ *        flushed to stable storage and then renamed over path.
+ *
+ * @param mismatch_index Mismatched sectors of a verify scan (may be NULL).
+ * @param latency_map Latency map to store with the checkpoint (may be NULL).
+ * @return 0 on success, 1 on failure (the previous checkpoint is left intact).
+ */
+int scan_journal_save(const char* path, const scan_journal_t* journal, const bad_extent_index_t* bad_index,
+                      const bad_extent_index_t* mismatch_index, const latency_map_t* latency_map);
+
+/**
+ * @brief Reads a checkpoint written by scan_journal_save().
+ *
+ * @param bad_index Receives the saved bad sector index (caller frees it).
+ * @param mismatch_index Receives the saved mismatch index, or NULL if there was none (caller frees it; may be NULL).
+ * @param latency_map Receives the saved latency map, or NULL if there was none (caller frees it; may be NULL).
+ * @return 0 on success, 1 if the file is missing or invalid.
+ */
+int scan_journal_load(const char* path, scan_journal_t* journal, bad_extent_index_t** bad_index,
+                      bad_extent_index_t** mismatch_index, latency_map_t** latency_map);
+
+/**
+ * @brief Returns true if a checkpoint exists at path.
+ */
+bool scan_journal_exists(const char* path);
+
+/**
+ * @brief Deletes the checkpoint once the scan it describes has completed.
+ */
+void scan_journal_remove(const char* path);
+
+// Estado da patrulha incremental (--patrol): uma volta pelo disco dividida em
+// muitas execuções curtas. Guarda onde a volta atual parou e quando cada
+// região do disco foi lida por inteiro pela última vez. Um arquivo por disco.
+
+#define SCAN_PATROL_REGIONS 64
+
+/**
+ * @brief Persistent state of an incremental patrol of one device.
+ */
+typedef struct {
+    char device_path[256];
+    char serial[64];
+    uint64_t device_size;
+
+    uint64_t cursor;                // próximo byte a ler na volta atual
+    uint64_t passes;                // voltas completas
+    int64_t pass_started;           // início da volta atual (time_t)
+    int64_t last_full_coverage;     // fim da última volta completa (0 = nunca)
+    int64_t last_run;               // fim da execução anterior (0 = nunca)
+    int64_t region_scanned[SCAN_PATROL_REGIONS];   // última leitura completa de cada região (0 = nunca)
+} scan_patrol_t;
+
+/**
+ * @brief Builds the default patrol state path: reports/diskoracle_patrol_<serial>.state,
+ *        or the device path when the serial is unknown.
+ */
+void scan_patrol_default_path(const char* serial, const char* device_path, char* out, size_t out_size);
+
+/**
+ * @brief Writes the patrol state atomically (same scheme as scan_journal_save()).
+ *
+ * @return 0 on success, 1 on failure (the previous state is left intact).
+ */
+int scan_patrol_save(const char* path, const scan_patrol_t* patrol);
+
+/**
+ * @brief Reads a patrol state written by scan_patrol_save().
+ *
+ * @return 0 on success, 1 if the file is missing or invalid.
+ */
+int scan_patrol_load(const char* path, scan_patrol_t* patrol);
+
+#endif // SCAN_JOURNAL_H
@@ -0,0 +1,83 @@
+#ifndef SCAN_LATENCY_H
+#define SCAN_LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Histograma de latência por leitura, no estilo HDR: faixas em potências de
+// dois divididas em 2^SCAN_LATENCY_SUB_BITS sub-faixas lineares, o que dá um
+// erro relativo de ~6% de 1 µs até horas com memória fixa. Ao lado dele vêm
+// as faixas clássicas do Victoria/MHDD, que apontam setores que ainda leem,
+// mas devagar (o primeiro sinal de um HDD degradando).
+
+#define SCAN_LATENCY_SUB_BITS 4
+#define SCAN_LATENCY_SUB_BUCKETS (1u << SCAN_LATENCY_SUB_BITS)
+#define SCAN_LATENCY_MAX_EXPONENT 36    // 2^36 µs ~ 19 h; acima disso satura
+#define SCAN_LATENCY_BUCKETS ((SCAN_LATENCY_MAX_EXPONENT - SCAN_LATENCY_SUB_BITS + 2) * SCAN_LATENCY_SUB_BUCKETS)
+
+/**
+ * @brief Victoria/MHDD style latency tiers for a block read.
+ */
+typedef enum {
+    SCAN_TIER_5MS,      // < 5 ms
+    SCAN_TIER_20MS,     // < 20 ms
+    SCAN_TIER_50MS,     // < 50 ms
+    SCAN_TIER_150MS,    // < 150 ms
+    SCAN_TIER_500MS,    // < 500 ms
+    SCAN_TIER_SLOW,     // >= 500 ms
+    SCAN_TIER_ERROR,    // leitura falhou ou voltou curta
+    SCAN_TIER_COUNT
+} scan_latency_tier_t;
+
+/**
+ * @brief Latency histogram and tier counters of one scan.
+ *
+ * Plain counters with no allocation, so it can live inside scan_state_t and
+ * be copied or merged freely. Failed reads only count in SCAN_TIER_ERROR.
+ */
+typedef struct {
+    uint64_t tiers[SCAN_TIER_COUNT];
+    uint64_t buckets[SCAN_LATENCY_BUCKETS];
+    uint64_t count;         // leituras bem-sucedidas no histograma
+    uint64_t sum_us;
+    uint64_t min_us;
+    uint64_t max_us;
+} scan_latency_t;
+
+/**
+ * @brief Records one completed read.
+ *
+ * @param latency_ns Time from submission to completion, in nanoseconds.
+ * @param ok false if the read failed or came back short.
+ */
+void scan_latency_record(scan_latency_t* latency, uint64_t latency_ns, bool ok);
+
+/**
+ * @brief Adds every sample of src to dst.
+ */
+void scan_latency_merge(scan_latency_t* dst, const scan_latency_t* src);
+
+/**
+ * @brief Returns the tier a successful read of the given latency falls in.
+ */
+scan_latency_tier_t scan_latency_tier_of(uint64_t latency_us);
+
+/**
+ * @brief Printable label of a tier ("<5 ms", ..., "error").
+ */
+const char* scan_latency_tier_label(scan_latency_tier_t tier);
+
+/**
+ * @brief Value at the given percentile (0-100), in microseconds (0 when empty).
+ *
+ * The result is the upper edge of the bucket holding the sample, clamped to
+ * the largest latency seen.
+ */
+uint64_t scan_latency_percentile_us(const scan_latency_t* latency, double percentile);
+
+/**
+ * @brief Lower and upper edges (in microseconds) of a histogram bucket.
+ */
+void scan_latency_bucket_range(unsigned bucket, uint64_t* low_us, uint64_t* high_us);
+
+#endif // SCAN_LATENCY_H
@@ -0,0 +1,81 @@
+#ifndef SCAN_ORDER_H
+#define SCAN_ORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scan_sampling.h"
+
+// Ordem em que um scan visita os blocos de uma faixa. Cada ordem é uma
+// bijeção entre a posição da leitura (0, 1, 2...) e o bloco lido, calculada
+// em O(1) sem memória extra, então todos os engines (síncrono, io_uring,
+// verificação, workers paralelos) andam pela mesma sequência de posições e
+// só traduzem cada uma para um offset. Ordens diferentes expõem falhas
+// diferentes: a sequencial é a mais rápida e mede a taxa por zona, a reversa
+// e a borboleta forçam seeks longos e desligam a leitura antecipada, a
+// espaçada pula trilhas e a aleatória mede IOPS e acha setores fracos que
+// só falham sem o cache do drive aquecido.
+
+#define SCAN_ORDER_DEFAULT_STRIDE 64    // blocos entre duas leituras da ordem espaçada
+
+/**
+ * @brief Block visiting order of a scan.
+ */
+typedef enum {
+    SCAN_ORDER_SEQUENTIAL,  // do início ao fim
+    SCAN_ORDER_REVERSE,     // do fim ao início
+    SCAN_ORDER_STRIDED,     // um bloco a cada stride, em passadas deslocadas de um bloco
+    SCAN_ORDER_RANDOM,      // permutação uniforme de todos os blocos
+    SCAN_ORDER_BUTTERFLY,   // alterna as pontas, do disco para o meio
+    SCAN_ORDER_SAMPLED      // amostra estratificada do scan rápido (scan_sampling.h)
+} scan_order_kind_t;
+
+/**
+ * @brief A visiting order over blocks [0, blocks) of a range.
+ */
+typedef struct {
+    scan_order_kind_t kind;
+    uint64_t blocks;        // blocos da faixa
+    uint64_t count;         // leituras da ordem: blocks, ou o tamanho da amostra
+    uint64_t stride;
+    uint64_t seed;
+    // Ordem aleatória: rede de Feistel de 4 rodadas sobre 2^(2*half_bits)
+    // valores; os que caem fora da faixa são cifrados de novo (cycle walking).
+    unsigned half_bits;
+    uint64_t keys[4];
+    scan_sampler_t sampler;
+} scan_order_t;
+
+/**
+ * @brief Prepares an order over blocks blocks.
+ *
+ * @param stride Blocks between reads of SCAN_ORDER_STRIDED (0 = SCAN_ORDER_DEFAULT_STRIDE).
+ * @param seed Seed of SCAN_ORDER_RANDOM; 0 picks one from the clock (stored in order->seed).
+ */
+void scan_order_init(scan_order_t* order, scan_order_kind_t kind, uint64_t blocks, uint64_t stride, uint64_t seed);
+
+/**
+ * @brief Prepares a SCAN_ORDER_SAMPLED order: samples blocks out of blocks,
+ *        one per stratum (see scan_sampler_init()).
+ */
+void scan_order_init_sampled(scan_order_t* order, uint64_t blocks, uint64_t samples, uint64_t seed);
+
+/**
+ * @brief Block read at position (0 <= position < order->count). Distinct
+ *        positions always map to distinct blocks.
+ */
+uint64_t scan_order_block(const scan_order_t* order, uint64_t position);
+
+/**
+ * @brief Printable name of an order ("sequential", "reverse", ...).
+ */
+const char* scan_order_name(scan_order_kind_t kind);
+
+/**
+ * @brief Parses an order name as accepted by --order (the sampled order is
+ *        only reached through the quick scan).
+ *
+ * @return true if name is a known order.
+ */
+bool scan_order_parse(const char* name, scan_order_kind_t* kind);
+
+#endif // SCAN_ORDER_H
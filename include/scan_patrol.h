@@ -0,0 +1,73 @@
+#ifndef SCAN_PATROL_H
+#define SCAN_PATROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "surface.h"
+#include "scan_journal.h"
+
+// Patrulha incremental: cada execução (tipicamente pelo cron) lê um trecho do
+// disco limitado por tempo ou por bytes, a partir de onde a anterior parou, e
+// volta ao início ao chegar ao fim. O estado fica num scan_patrol_t gravado
+// por número de série, então o disco inteiro é coberto a cada poucos dias sem
+// nenhum scan longo.
+
+#define SCAN_PATROL_DEFAULT_BUDGET_SECONDS (30.0 * 60.0)
+
+/**
+ * @brief How much a single patrol run may read.
+ *
+ * When several limits are set the run stops at the first one reached. With
+ * cycle_days the byte budget is derived from the time since the previous run,
+ * so that a run every N hours covers the device every cycle_days days.
+ */
+typedef struct scan_patrol_budget_s {
+    uint64_t bytes;             // 0 = sem limite
+    double seconds;             // 0 = sem limite
+    double cycle_days;          // 0 = desligado
+} scan_patrol_budget_t;
+
+/**
+ * @brief Starts a new patrol of a device (cursor at 0, no region covered yet).
+ */
+void scan_patrol_init(scan_patrol_t* patrol, const char* device_path, const char* serial, uint64_t device_size, int64_t now);
+
+/**
+ * @brief Records that everything from the cursor up to end has been read at time
+ *        now. Regions whose last byte was reached are stamped; reaching the end
+ *        of the device completes a pass and wraps the cursor to 0.
+ */
+void scan_patrol_advance(scan_patrol_t* patrol, uint64_t end, int64_t now);
+
+/**
+ * @brief First byte of a region (region == SCAN_PATROL_REGIONS gives the device size).
+ */
+uint64_t scan_patrol_region_start(const scan_patrol_t* patrol, unsigned region);
+
+/**
+ * @brief Seconds since a region was last read completely, or -1 if never.
+ */
+int64_t scan_patrol_region_age(const scan_patrol_t* patrol, unsigned region, int64_t now);
+
+/**
+ * @brief Bytes a run must read now to keep a full pass every cycle_days days,
+ *        given the time since the previous run (one day is assumed for the first).
+ */
+uint64_t scan_patrol_cycle_budget(const scan_patrol_t* patrol, double cycle_days, int64_t now);
+
+/**
+ * @brief Runs one patrol step: deep scans from the cursor within the budget,
+ *        wrapping around at most once, and advances patrol.
+ *
+ * opts supplies the engine, block size, throttle and the optional bad sector
+ * index and latency map; mode, range, journal and resume are overridden.
+ * The caller saves patrol afterwards, also when the run was interrupted.
+ *
+ * @param out_state Receives the totals of the run (may be NULL).
+ * @return 0 on success, 1 if a scan failed or was interrupted (the progress up
+ *         to that point is still recorded in patrol).
+ */
+int scan_patrol_run(const char* device_path, scan_patrol_t* patrol, const scan_options_t* opts, const scan_patrol_budget_t* budget,
+                    scan_callback_t callback, void* user_data, scan_state_t* out_state);
+
+#endif // SCAN_PATROL_H
@@ -0,0 +1,127 @@
+#ifndef SCAN_PROFILE_H
+#define SCAN_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "surface.h"
+
+// Perfil de taxa de transferência: leituras sequenciais sustentadas em N
+// zonas espaçadas igualmente do início ao fim do disco. Num HDD a taxa cai
+// das trilhas externas para as internas (a curva descendente clássica); uma
+// zona bem abaixo da vizinha ou da linha de base do mesmo modelo aponta
+// cabeça fraca, superfície degradada ou setores sendo relidos.
+
+#define SCAN_PROFILE_DEFAULT_ZONES 32
+#define SCAN_PROFILE_MAX_ZONES 256
+#define SCAN_PROFILE_DEFAULT_ZONE_BYTES (256ULL * 1024 * 1024)
+#define SCAN_PROFILE_DEFAULT_BLOCK_SIZE (1024u * 1024u)
+#define SCAN_PROFILE_SLOW_PERCENT 15.0  // abaixo da linha de base além disso, a zona é lenta
+
+/**
+ * @brief Measurement of one zone.
+ */
+typedef struct {
+    uint64_t offset;            // primeiro byte da zona
+    uint64_t bytes;             // bytes lidos
+    double seconds;
+    double mbps;                // MiB/s sustentados
+    uint64_t mean_us;           // latência por leitura
+    uint64_t p50_us;
+    uint64_t p99_us;
+    uint64_t max_us;
+    uint64_t bad_sectors;
+} scan_profile_zone_t;
+
+/**
+ * @brief A transfer-rate profile of a device (or a stored baseline).
+ */
+typedef struct {
+    char device_path[256];
+    char model[64];
+    char serial[64];
+    uint64_t device_size;
+    uint32_t block_size;
+    uint64_t zone_bytes;
+    unsigned zone_count;
+    unsigned measured;          // zonas já medidas, em ordem (as demais ainda não)
+    int64_t created;            // início da medição (time_t)
+    scan_profile_zone_t zones[SCAN_PROFILE_MAX_ZONES];
+} scan_profile_t;
+
+/**
+ * @brief Result of comparing a profile against a baseline.
+ */
+typedef struct {
+    unsigned compared;          // zonas medidas nos dois perfis
+    unsigned slower;            // zonas mais de SCAN_PROFILE_SLOW_PERCENT abaixo da linha de base
+    unsigned worst_zone;
+    double worst_percent;       // diferença da pior zona (negativo = mais lenta)
+    double mean_percent;        // diferença média de todas as zonas
+} scan_profile_comparison_t;
+
+/**
+ * @brief Lays out zones evenly spaced zones over a device, the first at the
+ *        start and the last ending at the end. Each zone reads zone_bytes
+ *        (0 = SCAN_PROFILE_DEFAULT_ZONE_BYTES), shrunk so the zones do not
+ *        overlap, in multiples of block_size.
+ *
+ * @return 0 on success, 1 if the device is too small for the zones.
+ */
+int scan_profile_init(scan_profile_t* profile, const char* device_path, const char* model, const char* serial,
+                      uint64_t device_size, unsigned zones, uint64_t zone_bytes, uint32_t block_size);
+
+/**
+ * @brief Measures every zone in order with a sequential single-threaded deep
+ *        scan of its range, filling profile->zones and profile->measured.
+ *
+ * opts supplies the engine, block size, queue depth, direct I/O and the
+ * optional bad sector index and latency map; mode, range, order, threads,
+ * verify, throttle and journal are overridden. The callback is the scan's
+ * own, called for the zone being read.
+ *
+ * @return 0 on success, 1 if a zone failed or the run was interrupted (the
+ *         zones measured up to that point are kept).
+ */
+int scan_profile_run(const char* device_path, scan_profile_t* profile, const scan_options_t* opts,
+                     scan_callback_t callback, void* user_data);
+
+/**
+ * @brief Transfer rate of a profile at a relative position of the disk
+ *        (0.0 = start, 1.0 = end), interpolated between the centers of the
+ *        measured zones. Returns 0 if no zone was measured.
+ */
+double scan_profile_rate_at(const scan_profile_t* profile, double position);
+
+/**
+ * @brief Relative position (0.0-1.0) of the center of a zone.
+ */
+double scan_profile_zone_position(const scan_profile_t* profile, unsigned zone);
+
+/**
+ * @brief Compares the measured zones of profile against baseline at the same
+ *        relative positions, so baselines with another zone count still apply.
+ */
+void scan_profile_compare(const scan_profile_t* profile, const scan_profile_t* baseline, scan_profile_comparison_t* out);
+
+/**
+ * @brief Builds the default baseline path of a drive model:
+ *        reports/diskoracle_profile_<model>.csv.
+ */
+void scan_profile_baseline_path(const char* model, char* out, size_t out_size);
+
+/**
+ * @brief Writes a profile as CSV: '#' header lines with the drive and the
+ *        geometry, then one row per measured zone.
+ *
+ * @return 0 on success, 1 on failure.
+ */
+int scan_profile_save_csv(const char* path, const scan_profile_t* profile);
+
+/**
+ * @brief Reads a profile written by scan_profile_save_csv().
+ *
+ * @return 0 on success, 1 if the file is missing or not a profile.
+ */
+int scan_profile_load_csv(const char* path, scan_profile_t* profile);
+
+#endif // SCAN_PROFILE_H
@@ -0,0 +1,68 @@
+#ifndef SCAN_SAMPLING_H
+#define SCAN_SAMPLING_H
+
+#include <stdint.h>
+
+// Amostragem do scan rápido. O disco é dividido em tantos estratos iguais
+// quantas forem as leituras, e cada estrato contribui com um bloco sorteado
+// dentro dele (amostragem estratificada, nunca pior que a aleatória simples).
+// Os estratos são visitados numa ordem de baixa discrepância (passo próximo
+// de n/φ), então qualquer prefixo do scan já cobre o disco por igual e a
+// leitura antecipada do drive não ajuda. A taxa de blocos ruins vem com um
+// intervalo de Wilson, que continua válido com zero falhas.
+
+#define SCAN_SAMPLE_DEFAULT_CONFIDENCE 0.95
+#define SCAN_SAMPLE_DEFAULT_TOLERANCE 0.001    // taxa de blocos ruins que a amostra deve poder descartar
+#define SCAN_SAMPLE_MAX_BLOCKS (1ULL << 24)
+
+/**
+ * @brief Visiting order and positions of a stratified sample.
+ */
+typedef struct {
+    uint64_t population;    // blocos do dispositivo
+    uint64_t count;         // blocos amostrados (um por estrato)
+    uint64_t step;          // passo entre estratos, primo com count
+    uint64_t seed;
+} scan_sampler_t;
+
+/**
+ * @brief Start of part i when total is split into parts nearly equal parts:
+ *        floor(i * total / parts), computed without overflowing 64 bits.
+ *        Used for the sampling strata and the patrol and content regions.
+ *
+ * @param parts Number of parts, at most 2^32; i runs from 0 to parts.
+ */
+uint64_t scan_split_point(uint64_t total, uint64_t parts, uint64_t i);
+
+/**
+ * @brief Number of samples needed so that, if none of them fails, the upper
+ *        bound of the bad-block rate at the given confidence is at most tolerance.
+ *
+ * @param confidence Two-sided confidence level, in (0, 1).
+ * @param tolerance Bad-block rate to rule out, in (0, 1).
+ */
+uint64_t scan_sampling_size(double confidence, double tolerance);
+
+/**
+ * @brief Wilson score interval of a bad-block rate.
+ *
+ * @param bad Failed samples.
+ * @param samples Samples taken (low = high = 0 when none).
+ * @param confidence Two-sided confidence level, in (0, 1).
+ */
+void scan_sampling_interval(uint64_t bad, uint64_t samples, double confidence, double* low, double* high);
+
+/**
+ * @brief Prepares a sample of count blocks out of population.
+ *
+ * count is clamped to population and SCAN_SAMPLE_MAX_BLOCKS; seed 0 picks one from the clock.
+ */
+void scan_sampler_init(scan_sampler_t* sampler, uint64_t population, uint64_t count, uint64_t seed);
+
+/**
+ * @brief Block visited at position index (0 <= index < count). Every block
+ *        is distinct and each stratum is visited exactly once.
+ */
+uint64_t scan_sampler_block(const scan_sampler_t* sampler, uint64_t index);
+
+#endif // SCAN_SAMPLING_H
@@ -0,0 +1,111 @@
+#ifndef SCAN_SCHEDULER_H
+#define SCAN_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "info.h"
+#include "surface.h"
+
+// Vários scans de superfície no mesmo processo. Cada job carrega todo o
+// estado do seu scan (opções, progresso, índice de setores ruins, mapa de
+// latência, journal), então nada fica em globais. Um pool de até
+// max_concurrent threads tira jobs da fila; a thread chamadora só lê cópias
+// do progresso para desenhar o painel.
+
+#define SCAN_JOB_MAX_EXTENTS 16             // extensões ruins guardadas para o relatório do terminal
+#define SCAN_SCHEDULER_MAX_JOBS 64
+#define SCAN_SCHEDULER_DEFAULT_CONCURRENCY 8
+
+/**
+ * @brief Lifecycle of a scan job.
+ */
+typedef enum {
+    SCAN_JOB_PENDING,
+    SCAN_JOB_RUNNING,
+    SCAN_JOB_DONE,
+    SCAN_JOB_FAILED
+} scan_job_status_t;
+
+typedef struct scan_job_s scan_job_t;
+
+typedef void (*scan_job_progress_t)(const scan_job_t* job, const scan_state_t* state, void* user_data);
+
+/**
+ * @brief One device to scan, with everything its scan owns.
+ */
+struct scan_job_s {
+    char device_path[256];
+    BasicDriveInfo drive_info;
+    scan_options_t opts;            // bad_index, latency_map, mismatch_index, content_map, journal_path e controls apontam para dados do job
+    scan_controls_t controls;       // limites próprios do job, ajustáveis durante o scan
+    scan_content_map_t content;     // classificação do conteúdo (com opts.classify)
+    scan_file_damage_t damage;      // arquivos atingidos (com opts.map_files_path)
+    char journal_path[512];
+    char allocated_path[256];       // faixas alocadas adotadas do checkpoint num resume
+    char report_path[1024];         // relatório JSON gravado ao fim (vazio se nenhum)
+
+    scan_job_status_t status;
+    int rc;
+    scan_state_t state;             // último progresso; de outra thread, leia com scan_job_snapshot()
+
+    bad_extent_t extents[SCAN_JOB_MAX_EXTENTS];
+    size_t extent_count;
+    uint32_t sector_size;
+
+    // Chamado na thread do scan a cada atualização de progresso (opcional).
+    scan_job_progress_t on_progress;
+    void* progress_user_data;
+
+    struct scan_scheduler_s* scheduler; // preenchido enquanto o job roda num pool
+};
+
+/**
+ * @brief Prepares a job: copies opts, reads the drive identity and creates the
+ *        job's own bad sector index, latency map, (verify) mismatch index,
+ *        (classify) content map and (deep scans) journal path. With
+ *        opts.resume, the verify, classify and allocated-space modes of the
+ *        checkpoint replace the ones in opts.
+ *
+ * @param opts Scan options, or NULL for the defaults. An explicit journal_path
+ *        is kept as is, so it only makes sense for a single device.
+ * @return 0 on success, 1 if out of memory.
+ */
+int scan_job_init(scan_job_t* job, const char* device_path, const scan_options_t* opts);
+
+/**
+ * @brief Frees what scan_job_init() created.
+ */
+void scan_job_release(scan_job_t* job);
+
+/**
+ * @brief Runs the job's scan on the calling thread. With opts.map_files_path,
+ *        the bad and mismatched sectors found are then resolved to the files
+ *        that hold them (job->damage, also reachable from job->state).
+ *
+ * @return The result of surface_scan_ex().
+ */
+int scan_job_run(scan_job_t* job);
+
+/**
+ * @brief Copies the latest progress and status of a job, safe while it runs.
+ */
+void scan_job_snapshot(const scan_job_t* job, scan_state_t* state, scan_job_status_t* status);
+
+typedef void (*scan_scheduler_tick_t)(scan_job_t* jobs, size_t count, void* user_data);
+
+/**
+ * @brief Scans every job, at most max_concurrent at a time, in array order.
+ *
+ * @param max_concurrent Upper bound on simultaneous scans (0 = all at once).
+ * @param tick Called on the calling thread about five times per second and
+ *        once at the end, e.g. to draw a dashboard (may be NULL).
+ * @return 0 if every scan succeeded, 1 otherwise.
+ */
+int scan_scheduler_run(scan_job_t* jobs, size_t count, unsigned max_concurrent, scan_scheduler_tick_t tick, void* user_data);
+
+/**
+ * @brief Printable name of a job status.
+ */
+const char* scan_job_status_name(scan_job_status_t status);
+
+#endif // SCAN_SCHEDULER_H
@@ -0,0 +1,82 @@
+#ifndef SCAN_TUNE_H
+#define SCAN_TUNE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "surface.h"
+#include "pal.h"
+
+// Calibração antes do scan (--auto-tune): lê os limites da fila do
+// dispositivo, mede algumas combinações de tamanho de bloco e profundidade de
+// fila por cerca de um segundo cada e fica com a mais rápida. Primeiro escolhe
+// o bloco com uma fila fixa, depois a fila com esse bloco. Só lê.
+
+#define SCAN_TUNE_MAX_PROBES 16
+#define SCAN_TUNE_PROBE_SECONDS 1.0
+#define SCAN_TUNE_MAX_BLOCK_SIZE (4u * 1024u * 1024u)
+#define SCAN_TUNE_MIN_GAIN_PERCENT 5.0
+
+/**
+ * @brief One measured block size / queue depth combination.
+ */
+typedef struct {
+    uint32_t block_size;
+    uint32_t queue_depth;
+    double mbps;                // MiB/s
+    double iops;
+} scan_tune_probe_t;
+
+/**
+ * @brief Outcome of a calibration: the limits read from the device, every
+ *        probe, and the chosen settings.
+ */
+typedef struct {
+    pal_queue_limits_t limits;
+    bool have_limits;
+    bool async;                 // a engine que leu foi o io_uring; sem ele a fila não é calibrada
+    bool tuned_block_size;      // falso no scan rápido, onde o bloco define a amostra
+    bool interrupted;           // parada pedida (Ctrl+C) durante a calibração
+    unsigned probe_count;
+    scan_tune_probe_t probes[SCAN_TUNE_MAX_PROBES];
+    unsigned chosen;            // índice em probes da combinação escolhida
+    uint32_t block_size;
+    uint32_t queue_depth;
+    double mbps;
+    double iops;
+} scan_tune_result_t;
+
+/**
+ * @brief Block sizes worth trying on a device: 64K, 256K and 1M plus the
+ *        largest transfer the device accepts, up to SCAN_TUNE_MAX_BLOCK_SIZE
+ *        and never below the physical sector, in increasing order.
+ *
+ * @return Number of sizes written (at most max_sizes).
+ */
+unsigned scan_tune_block_sizes(const pal_queue_limits_t* limits, uint32_t* sizes, unsigned max_sizes);
+
+/**
+ * @brief Queue depths worth trying, in increasing order: 1, 2 and 4 on a
+ *        rotational disk, 1 to 64 otherwise, capped at nr_requests.
+ *
+ * @return Number of depths written (at most max_depths).
+ */
+unsigned scan_tune_queue_depths(const pal_queue_limits_t* limits, uint32_t* depths, unsigned max_depths);
+
+/**
+ * @brief Calibrates the block size and queue depth of a scan of device_path.
+ *
+ * opts is the scan about to run: its mode, order, engine, threads and direct
+ * I/O are kept. A deep scan is tuned for MB/s, a quick scan (fixed block
+ * size) for IOPS. A larger setting only wins when it is at least
+ * SCAN_TUNE_MIN_GAIN_PERCENT faster. Sequential probes read consecutive
+ * stretches of the disk so that none is served from the page cache. The
+ * queue depth is only tuned when the probes were actually read by io_uring
+ * (result->async); otherwise opts->queue_depth is kept.
+ *
+ * @param probe_seconds Length of each probe (0 = SCAN_TUNE_PROBE_SECONDS).
+ * @return 0 on success, 1 if no probe could read the device or the run was interrupted.
+ */
+int scan_tune_run(const char* device_path, const scan_options_t* opts, double probe_seconds,
+                  scan_callback_t callback, void* user_data, scan_tune_result_t* result);
+
+#endif // SCAN_TUNE_H
@@ -0,0 +1,30 @@
+#ifndef SCAN_VERIFY_H
+#define SCAN_VERIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Comparação das duas leituras de um bloco no modo de verificação. Setores
+// marginais (cabeça fraca, read-disturb em SSD) podem devolver dados diferentes
+// em leituras seguidas sem nenhum erro de I/O; a comparação é vetorizada
+// (AVX2 quando a CPU tem, SSE2 em qualquer x86-64, palavras de 64 bits nas
+// outras arquiteturas) para não virar o gargalo de um disco rápido.
+
+/**
+ * @brief Offset of the first byte that differs between a and b, or len if
+ *        both buffers are equal.
+ */
+size_t scan_verify_diff(const uint8_t* a, const uint8_t* b, size_t len);
+
+/**
+ * @brief Non-zero when both the CPU and the OS support AVX2 (shared by the
+ *        SIMD kernels of the scan).
+ */
+int scan_cpu_has_avx2(void);
+
+/**
+ * @brief Name of the compare routine picked for this CPU ("avx2", "sse2" or "scalar").
+ */
+const char* scan_verify_isa(void);
+
+#endif // SCAN_VERIFY_H
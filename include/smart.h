@@ -7,6 +7,41 @@
 #if defined(_WIN32) || defined(__MINGW32__)
     #include <windows.h>
     #include <nvme.h>
+#else
+// SMART / Health Information log do NVMe (512 bytes), com os nomes de campo do
+// nvme.h do Windows para o mesmo código servir às outras plataformas.
+typedef struct {
+    union {
+        struct {
+            uint8_t AvailableSpaceLow : 1;
+            uint8_t TemperatureThreshold : 1;
+            uint8_t ReliabilityDegraded : 1;
+            uint8_t ReadOnly : 1;
+            uint8_t VolatileMemoryBackupDeviceFailed : 1;
+            uint8_t Reserved : 3;
+        };
+        uint8_t AsUchar;
+    } CriticalWarning;
+    uint8_t Temperature[2];
+    uint8_t AvailableSpare;
+    uint8_t AvailableSpareThreshold;
+    uint8_t PercentageUsed;
+    uint8_t Reserved0[26];
+    uint8_t DataUnitRead[16];
+    uint8_t DataUnitWritten[16];
+    uint8_t HostReadCommands[16];
+    uint8_t HostWrittenCommands[16];
+    uint8_t ControllerBusyTime[16];
+    uint8_t PowerCycle[16];
+    uint8_t PowerOnHours[16];
+    uint8_t UnsafeShutdowns[16];
+    uint8_t MediaErrors[16];
+    uint8_t ErrorInfoLogEntryCount[16];
+    uint32_t WarningCompositeTemperatureTime;
+    uint32_t CriticalCompositeTemperatureTime;
+    uint16_t TemperatureSensor[8];
+    uint8_t Reserved1[296];
+} NVME_HEALTH_INFO_LOG;
 #endif
 
 #define MAX_SMART_ATTRIBUTES 30
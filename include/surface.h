@@ -4,7 +4,54 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
-#include "info.h" 
+#include "info.h"
+#include "bad_extents.h"
+#include "scan_latency.h"
+#include "latency_map.h"
+#include "scan_sampling.h"
+#include "scan_content.h"
+#include "scan_filemap.h"
+#include "scan_order.h"
+
+// Tamanho de leitura padrão (e mínimo) de um scan.
+#define SCAN_DEFAULT_BLOCK_SIZE 4096
+#define SCAN_DEFAULT_QUEUE_DEPTH 32
+#define SCAN_MAX_QUEUE_DEPTH 1024
+#define SCAN_MAX_BLOCK_SIZE (64u * 1024u * 1024u)
+#define SCAN_MEDIA_VERIFY_BLOCK_SIZE (8u * 1024u * 1024u)  // padrão do engine media-verify: nada trafega, então blocos grandes
+#define SCAN_MAX_THREADS 64
+#define SCAN_THREADS_AUTO 0     // um worker por fila de hardware (sysfs)
+#define SCAN_SECTOR_RETRIES 1   // novas tentativas de um setor isolado antes de marcá-lo ruim
+
+/**
+ * @brief Live limits of a throttled (background) scan.
+ *
+ * Owned by the caller and shared with the running scan, which rereads it
+ * before every read: change it at any time (e.g. from the progress callback,
+ * through scan_state_t::controls) with scan_controls_set_limits() and
+ * scan_controls_set_latency_target().
+ *
+ * With idle_aware the scan watches the disk's own I/O counters and yields to
+ * foreground traffic: it shrinks its queue depth, then pauses, and speeds up
+ * again once the disk goes idle.
+ */
+typedef struct scan_controls_s {
+    uint64_t max_bytes_per_sec;     // 0 = sem limite
+    uint64_t max_iops;              // 0 = sem limite
+    uint64_t latency_target_us;     // acima disso o scan reduz o ritmo; 0 = desligado
+    bool idle_priority;             // classe de I/O idle do SO (lida só no início)
+    bool idle_aware;                // cede o disco a I/O de outros processos (lido só no início)
+} scan_controls_t;
+
+/**
+ * @brief I/O engine used to issue the reads of a surface scan.
+ */
+typedef enum {
+    SCAN_ENGINE_AUTO,   // io_uring quando disponível, senão leitura síncrona
+    SCAN_ENGINE_SYNC,   // um pread()/ReadFile() por vez
+    SCAN_ENGINE_URING,  // Linux io_uring com várias leituras em voo
+    SCAN_ENGINE_MEDIA_VERIFY    // o disco verifica a própria mídia (VERIFY/READ VERIFY/Verify do NVMe), sem transferir dados
+} scan_engine_t;
 
 // Estrutura para manter o estado de um scan de superfície.
 typedef struct {
@@ -12,23 +59,192 @@ typedef struct {
     uint64_t scanned_blocks;
     uint64_t bad_blocks;
     uint64_t read_errors;
+    uint64_t bad_sectors;       // setores lógicos ilegíveis, localizados por bisseção
+    uint64_t bad_extents;       // sequências contíguas de setores ruins
+    uint32_t block_size;        // bytes por bloco lido
     double current_speed_mbps;
     time_t start_time;
     time_t last_update_time;
+    scan_latency_t latency;     // histograma e faixas de latência das leituras
+    const latency_map_t* latency_map;   // mapa de latência ao vivo (NULL se desativado)
+    uint64_t population_blocks; // blocos do disco que a amostra representa (0 = scan completo)
+    double confidence;          // nível do intervalo da taxa de blocos ruins
+    scan_controls_t* controls;  // limites ao vivo do scan (NULL = sem throttle)
+    uint64_t throttle_bytes_per_sec;    // teto efetivo no momento, já com o recuo por latência (0 = nenhum)
+    bool foreground_io;         // modo idle-aware: outro processo está usando o disco
+    bool paused;                // modo idle-aware: scan parado até o disco ficar ocioso
+    uint32_t depth_limit;       // modo idle-aware: leituras em voo permitidas agora (0 = sem restrição)
+    uint64_t resume_offset;     // scan profundo: tudo antes disto (desde o início da faixa, na ordem de leitura) foi lido
+    bool verify;                // cada bloco foi lido duas vezes e as leituras comparadas
+    uint64_t mismatch_blocks;   // blocos cujas duas leituras devolveram dados diferentes
+    uint64_t mismatch_sectors;  // setores lógicos que mudaram entre as leituras
+    uint64_t mismatch_extents;
+    const bad_extent_index_t* mismatch_index;   // LBAs inconsistentes (NULL se o chamador não passou índice)
+    const scan_content_map_t* content_map;      // classificação do conteúdo por região (NULL se desativada)
+    uint64_t allocated_bytes;   // scan só do espaço alocado: bytes alocados na faixa (0 = faixa inteira)
+    const scan_file_damage_t* file_damage;      // arquivos atingidos pelos setores ruins (NULL se não mapeados)
+    scan_order_kind_t order;    // ordem em que os blocos foram lidos
+    bool index_incomplete;      // faltou memória: os índices de setores não têm todos os que foram contados
+    scan_engine_t engine;       // engine que de fato leu, já com os recuos (nunca SCAN_ENGINE_AUTO depois do scan)
 } scan_state_t;
 
 typedef void (*scan_callback_t)(const scan_state_t* state, void* user_data);
 
+typedef void (*scan_bad_extent_callback_t)(const bad_extent_t* extent, uint32_t sector_size, void* user_data);
+
 // pode ser mesclada em scan_state_t no futuro
 typedef struct {
     bool scan_performed;
     uint64_t total_sectors_scanned;
     uint64_t bad_sectors_found;
+    uint64_t bad_extents;
     uint64_t read_errors;
     double scan_time_seconds;
     char status_message[256];
 } SurfaceScanResult;
 
+/**
+ * @brief Tunables for a surface scan.
+ *
+ * Always initialize with surface_scan_options_init() so that fields added
+ * in the future keep sane defaults.
+ */
+typedef struct scan_options_s {
+    const char* mode;       // "quick" ou "deep"
+    scan_engine_t engine;
+    uint32_t block_size;    // bytes por leitura, arredondado ao setor lógico
+    uint32_t queue_depth;   // leituras simultâneas no engine assíncrono
+    bool direct_io;         // ignora o page cache (O_DIRECT); sempre ativo no Windows
+    unsigned threads;       // workers do scan profundo; SCAN_THREADS_AUTO = pelas filas do dispositivo
+
+    // Scan rápido: samples blocos sorteados (0 = quantos forem precisos para
+    // descartar uma taxa de blocos ruins acima de tolerance com esse nível de
+    // confiança). sample_seed 0 sorteia uma semente nova; ela também embaralha
+    // a ordem SCAN_ORDER_RANDOM.
+    uint64_t samples;
+    double confidence;
+    double tolerance;
+    uint64_t sample_seed;
+
+    // Faixa do scan profundo em bytes (range_length 0 = até o fim do disco) e
+    // orçamento de tempo em segundos (0 = sem limite). Esgotado o tempo, o
+    // scan termina com sucesso e scan_state_t::resume_offset diz onde parou.
+    uint64_t range_offset;
+    uint64_t range_length;
+    double time_budget_seconds;
+
+    // Ordem de leitura do scan profundo (o rápido sempre usa a amostra) e,
+    // na ordem espaçada, os blocos entre duas leituras (0 = SCAN_ORDER_DEFAULT_STRIDE).
+    scan_order_kind_t order;
+    uint64_t stride;
+
+    // Verificação do scan profundo: cada bloco é lido duas vezes, a segunda sem
+    // passar pelo cache do SO, e as leituras são comparadas. Setores que mudam
+    // entre as leituras vão para mismatch_index (opcional, do chamador).
+    bool verify;
+    bad_extent_index_t* mismatch_index;
+
+    // Classificação do conteúdo: cada bloco lido é contado como zerado, 0xFF,
+    // padrão repetido ou dados, por região do disco, em content_map (do
+    // chamador). Com classify, scan_job_init() usa o mapa do próprio job.
+    bool classify;
+    scan_content_map_t* content_map;
+
+    // Scan profundo só das faixas alocadas do sistema de arquivos montado em
+    // allocated_path, que precisa estar no dispositivo escaneado (NULL = faixa inteira).
+    const char* allocated_path;
+
+    // Ao fim do scan, scan_job_run() resolve os setores ilegíveis e
+    // inconsistentes para os arquivos do sistema de arquivos montado em
+    // map_files_path (NULL = não resolve). Não é usado por surface_scan_ex().
+    const char* map_files_path;
+
+    // Antes do scan, block_size e queue_depth são calibrados no próprio
+    // dispositivo (scan_tune.h). Também não é usado por surface_scan_ex().
+    bool auto_tune;
+
+    // Throttle do scan profundo, para rodar em hosts em produção (NULL = leitura
+    // tão rápida quanto o dispositivo permitir). Também do chamador.
+    scan_controls_t* controls;
+
+    // Chamado ao fim do scan profundo, na thread chamadora, para cada
+    // extensão de setores ilegíveis em ordem crescente de LBA.
+    scan_bad_extent_callback_t on_bad_extent;
+    void* bad_extent_user_data;
+
+    // Índice opcional, criado e liberado pelo chamador, que recebe todos os
+    // setores ruins do scan profundo (somados aos que já estiverem nele).
+    bad_extent_index_t* bad_index;
+
+    // Mapa de latência opcional do disco inteiro, também do chamador. O scan
+    // ajusta a geometria dele ao dispositivo.
+    latency_map_t* latency_map;
+
+    // Journal de checkpoint do scan profundo (NULL desativa). Com resume o
+    // scan continua do último checkpoint gravado nesse arquivo.
+    const char* journal_path;
+    const char* device_serial;  // gravado no journal e conferido no resume
+    bool resume;
+} scan_options_t;
+
+/**
+ * @brief Fills a scan_options_t with the default values (sampled quick scan at 95%
+ *        confidence, 4 KiB reads, auto engine).
+ */
+void surface_scan_options_init(scan_options_t* opts);
+
+/**
+ * @brief Copies opts into run for a measurement pass (benchmark, auto-tune,
+ *        speed profile): a plain deep read of the whole device, without time
+ *        budget, verify, classification, allocated ranges, throttle, journal or
+ *        any caller-owned output (bad/mismatch indexes, latency and content maps,
+ *        bad-extent callback). Engine, block size, queue depth, threads and order
+ *        are kept; the caller adjusts them afterwards.
+ */
+void scan_options_for_measurement(scan_options_t* run, const scan_options_t* opts);
+
+/**
+ * @brief Picks a worker count for a parallel deep scan from the number of
+ *        hardware queues of the device (1 when unknown).
+ */
+unsigned surface_scan_auto_threads(const char* device_path);
+
+/**
+ * @brief Asks a running scan to stop after its in-flight reads (safe to call
+ *        from a signal handler). A deep scan with a journal saves a final
+ *        checkpoint so it can be resumed.
+ */
+void surface_scan_request_stop(void);
+
+/**
+ * @brief Changes the bandwidth and IOPS caps of a running (or future) scan.
+ *
+ * Safe to call from any thread while the scan runs; 0 removes a cap.
+ */
+void scan_controls_set_limits(scan_controls_t* controls, uint64_t max_bytes_per_sec, uint64_t max_iops);
+
+/**
+ * @brief Changes the per-read latency target (0 disables the automatic back-off).
+ */
+void scan_controls_set_latency_target(scan_controls_t* controls, uint64_t latency_target_us);
+
+/**
+ * @brief Returns a printable name for a scan engine.
+ */
+const char* surface_scan_engine_name(scan_engine_t engine);
+
 int surface_scan(const char* device_path, const char* mode, scan_callback_t callback, void* user_data, scan_state_t* out_final_state);
 
+/**
+ * @brief Runs a surface scan with explicit options.
+ *
+ * @param device_path The platform-specific path to the device.
+ * @param opts Scan options, or NULL for the defaults.
+ * @param callback Progress callback (may be NULL).
+ * @param user_data Opaque pointer forwarded to the callback.
+ * @param out_final_state Receives the final scan state (may be NULL).
+ * @return 0 on success, non-zero on failure.
+ */
+int surface_scan_ex(const char* device_path, const scan_options_t* opts, scan_callback_t callback, void* user_data, scan_state_t* out_final_state);
+
 #endif
@@ -0,0 +1,548 @@
+#ifndef SURFACE_ENGINE_H
+#define SURFACE_ENGINE_H
+
+// Interface interna entre surface.c e os engines de I/O do scan.
+// Não deve ser incluída fora dos módulos de scan.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "surface.h"
+#include "scan_journal.h"
+#include "scan_extents.h"
+#include "scan_order.h"
+#include "pal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE scan_dev_t;
+#define SCAN_DEV_INVALID INVALID_HANDLE_VALUE
+typedef CRITICAL_SECTION scan_mutex_t;
+typedef CONDITION_VARIABLE scan_cond_t;
+#else
+#include <pthread.h>
+typedef int scan_dev_t;
+#define SCAN_DEV_INVALID (-1)
+typedef pthread_mutex_t scan_mutex_t;
+typedef pthread_cond_t scan_cond_t;
+#endif
+
+static inline void scan_mutex_init(scan_mutex_t* m) {
+#ifdef _WIN32
+    InitializeCriticalSection(m);
+#else
+    pthread_mutex_init(m, NULL);
+#endif
+}
+
+static inline void scan_mutex_destroy(scan_mutex_t* m) {
+#ifdef _WIN32
+    DeleteCriticalSection(m);
+#else
+    pthread_mutex_destroy(m);
+#endif
+}
+
+static inline void scan_mutex_lock(scan_mutex_t* m) {
+#ifdef _WIN32
+    EnterCriticalSection(m);
+#else
+    pthread_mutex_lock(m);
+#endif
+}
+
+static inline void scan_mutex_unlock(scan_mutex_t* m) {
+#ifdef _WIN32
+    LeaveCriticalSection(m);
+#else
+    pthread_mutex_unlock(m);
+#endif
+}
+
+static inline void scan_cond_init(scan_cond_t* c) {
+#ifdef _WIN32
+    InitializeConditionVariable(c);
+#else
+    pthread_cond_init(c, NULL);
+#endif
+}
+
+static inline void scan_cond_destroy(scan_cond_t* c) {
+#ifdef _WIN32
+    (void)c;
+#else
+    pthread_cond_destroy(c);
+#endif
+}
+
+// Espera com o mutex travado; sempre dentro de um laço que confere a condição.
+static inline void scan_cond_wait(scan_cond_t* c, scan_mutex_t* m) {
+#ifdef _WIN32
+    SleepConditionVariableCS(c, m, INFINITE);
+#else
+    pthread_cond_wait(c, m);
+#endif
+}
+
+static inline void scan_cond_broadcast(scan_cond_t* c) {
+#ifdef _WIN32
+    WakeAllConditionVariable(c);
+#else
+    pthread_cond_broadcast(c);
+#endif
+}
+
+// Acesso atômico relaxado aos contadores compartilhados entre threads.
+#if defined(_MSC_VER)
+#define SCAN_ATOMIC_STORE(ptr, val) InterlockedExchange64((volatile LONG64*)(ptr), (LONG64)(val))
+#define SCAN_ATOMIC_ADD(ptr, val) InterlockedExchangeAdd64((volatile LONG64*)(ptr), (LONG64)(val))
+#define SCAN_ATOMIC_LOAD(ptr) ((uint64_t)InterlockedCompareExchange64((volatile LONG64*)(ptr), 0, 0))
+#define SCAN_ATOMIC_STORE_RELEASE(ptr, val) SCAN_ATOMIC_STORE(ptr, val)
+#define SCAN_ATOMIC_LOAD_ACQUIRE(ptr) SCAN_ATOMIC_LOAD(ptr)
+#define SCAN_ATOMIC_FENCE_RELEASE() MemoryBarrier()
+#define SCAN_ATOMIC_FENCE_ACQUIRE() MemoryBarrier()
+#else
+#define SCAN_ATOMIC_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+#define SCAN_ATOMIC_ADD(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#define SCAN_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define SCAN_ATOMIC_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define SCAN_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define SCAN_ATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define SCAN_ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+/**
+ * @brief Counters published by a parallel scan worker.
+ *
+ * Written only by the owning worker (relaxed atomic stores, once per progress
+ * interval) and read by the coordinating thread, so the read path never takes
+ * a lock. sequence is odd while the worker writes: the reader retries until it
+ * sees the same even value before and after, so the counters it sums always
+ * match the cursor it checkpoints. The trailing pad keeps neighbouring workers
+ * off each other's cache lines.
+ */
+typedef struct {
+    uint64_t sequence;
+    uint64_t scanned_blocks;
+    uint64_t bad_blocks;
+    uint64_t read_errors;
+    uint64_t bytes_read;
+    uint64_t bad_sectors;
+    uint64_t bad_extents;
+    uint64_t mismatch_blocks;
+    uint64_t mismatch_sectors;
+    uint64_t cursor;
+    scan_latency_t latency;
+    uint8_t pad[64];
+} scan_worker_slot_t;
+
+// scan_latency_t só tem contadores de 64 bits: copia palavra a palavra, atomicamente.
+static inline void scan_latency_publish(scan_latency_t* dst, const scan_latency_t* src) {
+    uint64_t* d = (uint64_t*)dst;
+    const uint64_t* s = (const uint64_t*)src;
+    for (size_t i = 0; i < sizeof(scan_latency_t) / sizeof(uint64_t); ++i) {
+        SCAN_ATOMIC_STORE(&d[i], s[i]);
+    }
+}
+
+static inline void scan_latency_snapshot(scan_latency_t* dst, scan_latency_t* src) {
+    uint64_t* d = (uint64_t*)dst;
+    uint64_t* s = (uint64_t*)src;
+    for (size_t i = 0; i < sizeof(scan_latency_t) / sizeof(uint64_t); ++i) {
+        d[i] = SCAN_ATOMIC_LOAD(&s[i]);
+    }
+}
+
+/**
+ * @brief Token buckets (bytes and reads) plus an AIMD latency controller,
+ *        shared by every worker of a throttled scan.
+ *
+ * The buckets may go into debt: each read takes its tokens up front and the
+ * caller sleeps until the debt is repaid, so concurrent workers are paced
+ * fairly without a queue. When the mean read latency of a 100 ms window
+ * exceeds the target, the allowed rate is halved; while it stays below, the
+ * rate grows back linearly.
+ *
+ * In idle-aware mode the disk counters are sampled too: whatever the disk
+ * did beyond the scan's own reads is foreground I/O. Each busy sample halves
+ * the allowed queue depth and, once it is down to one read, pauses the scan;
+ * each idle sample resumes it and doubles the depth again.
+ */
+typedef struct {
+    scan_controls_t* controls;
+    scan_mutex_t lock;
+    uint64_t last_refill_ns;
+    double byte_tokens;
+    double op_tokens;
+
+    uint64_t adaptive_bps;      // teto imposto pelo alvo de latência (0 = nenhum)
+    uint64_t window_start_ns;
+    uint64_t window_reads;
+    uint64_t window_latency_ns;
+    uint64_t window_bytes;
+
+    // Modo idle-aware: contadores do disco amostrados a cada 250 ms.
+    const char* device_path;
+    bool idle_aware;                // false se o disco não expõe contadores
+    uint64_t sample_ns;
+    pal_io_counters_t counters;     // última amostra
+    uint64_t own_sectors;           // setores de 512 bytes pedidos pelo próprio scan
+    uint64_t sampled_own_sectors;   // own_sectors na última amostra
+    uint32_t depth_limit;           // leituras em voo permitidas (0 = sem restrição)
+    uint32_t engine_depth;          // maior fila pedida por um engine
+    bool foreground;
+    bool paused;
+} scan_throttle_t;
+
+/**
+ * @brief Shared state of a running scan, handed to every I/O engine.
+ *
+ * Engines only issue reads; all accounting and progress reporting goes
+ * through scan_ctx_record_read() and scan_ctx_update_progress() so that
+ * every engine feeds scan_state_t the same way.
+ */
+typedef struct {
+    const scan_options_t* opts;
+    const char* device_path;
+    scan_dev_t dev;
+    uint64_t device_size;
+    uint32_t block_size;           // múltiplo de logical_sector_size
+    uint32_t logical_sector_size;
+    uint32_t alignment;            // alinhamento dos buffers de leitura
+    bool direct_io;
+
+    // Faixa [range_start, range_end) de posições lidas por este contexto. Na
+    // ordem sequencial posição e offset coincidem; nas outras o engine traduz
+    // cada posição com scan_ctx_read_offset() e avança com scan_ctx_advance().
+    uint64_t range_start;
+    uint64_t range_end;
+    uint64_t cursor;                // tudo antes disto já foi lido e contabilizado
+
+    // Ordem de leitura, a mesma em todos os workers: o bloco 0 da ordem fica
+    // em order_base e a faixa ordenada termina em order_end (último bloco pode ser parcial).
+    scan_order_t order;
+    uint64_t order_base;
+    uint64_t order_end;
+    uint64_t deadline_ns;           // fim do orçamento de tempo (0 = sem limite)
+
+    scan_state_t state;
+    SurfaceScanResult* result;
+    scan_callback_t callback;
+    void* user_data;
+
+    uint64_t last_update_ns;
+    uint64_t bytes_since_update;
+    uint64_t bytes_total;
+
+    // Em um worker paralelo o progresso é publicado aqui em vez do callback.
+    scan_worker_slot_t* publish;
+
+    // Localização de erros: buffer das releituras e índice dos setores ruins.
+    // Em scans paralelos o índice é compartilhado e protegido por bad_lock.
+    uint8_t* retry_buf;
+    bad_extent_index_t* bad_index;
+    bool owns_bad_index;
+    scan_mutex_t* bad_lock;
+    uint64_t last_bad_end;          // LBA seguinte ao último setor ruim marcado
+
+    // Verificação: setores cujas duas leituras diferiram (também sob bad_lock).
+    bad_extent_index_t* mismatch_index;
+    bool owns_mismatch_index;
+    uint64_t last_mismatch_end;
+
+    // Classificação do conteúdo (NULL = desativada); compartilhada pelos workers.
+    scan_content_map_t* content_map;
+
+    // Scan só do espaço alocado (NULL = a faixa inteira): os engines leem só
+    // estas faixas. extent_next é a faixa do último offset pedido.
+    scan_extent_list_t* extents;
+    bool owns_extents;
+    size_t extent_next;
+
+    // Mapa de latência: as leituras de uma mesma faixa do mapa são somadas
+    // aqui e entregues de uma vez quando o scan passa para a faixa seguinte.
+    latency_map_t* latency_map;
+    latency_cell_t map_pending;
+    uint64_t map_pending_bucket;
+
+    // Throttle compartilhado (NULL quando o scan roda sem limites).
+    scan_throttle_t* throttle;
+    bool idle_io;                   // leituras na classe de I/O idle
+
+    // Checkpoint: faixas do scan e journal (NULL quando desativado).
+    scan_segment_t* segments;
+    unsigned segment_count;
+    scan_journal_t* journal;
+    uint64_t last_checkpoint_ns;
+    bool checkpoint_saved;          // o último checkpoint foi gravado
+    bool checkpoint_warned;         // a falha ao gravar já foi avisada
+} scan_ctx_t;
+
+/**
+ * @brief Monotonic clock in nanoseconds.
+ */
+uint64_t scan_now_ns(void);
+
+/**
+ * @brief Allocates a read buffer aligned for unbuffered I/O.
+ */
+void* scan_buffer_alloc(size_t size, size_t alignment);
+void scan_buffer_free(void* ptr);
+
+/**
+ * @brief Accounts for one completed read.
+ *
+ * A failed or short read is bisected with smaller synchronous reads down to
+ * the logical sector, so every unreadable LBA is recorded exactly while the
+ * scan itself keeps using large blocks.
+ *
+ * @param ctx The scan context.
+ * @param offset Byte offset of the read.
+ * @param requested Number of bytes requested.
+ * @param bytes_read Bytes returned by the device, or a negative value on error.
+ * @param latency_ns Time the read took, from submission to completion.
+ */
+void scan_ctx_record_read(scan_ctx_t* ctx, uint64_t offset, uint32_t requested, int64_t bytes_read, uint64_t latency_ns);
+
+/**
+ * @brief Accounts for a range checked with a verify command (no data read):
+ *        the same counters, latency and throttle as scan_ctx_record_read(),
+ *        but a failed range is not localized; the caller does that with
+ *        further verifies and scan_ctx_mark_bad().
+ */
+void scan_ctx_record_verified(scan_ctx_t* ctx, uint64_t offset, uint32_t len, bool failed, uint64_t latency_ns);
+
+/**
+ * @brief Records count unreadable logical sectors starting at lba in the bad
+ *        sector index and the live counters.
+ */
+void scan_ctx_mark_bad(scan_ctx_t* ctx, uint64_t lba, uint64_t count);
+
+/**
+ * @brief Compares the two reads of a verified block and records every logical
+ *        sector whose contents differ (call after scan_ctx_record_read()).
+ */
+void scan_ctx_record_mismatch(scan_ctx_t* ctx, uint64_t offset, const uint8_t* first, const uint8_t* second, uint32_t len);
+
+/**
+ * @brief Classifies a block that was read completely and adds it to the
+ *        content map of ctx (no-op when classification is off).
+ */
+void scan_ctx_classify(scan_ctx_t* ctx, uint64_t offset, const uint8_t* buf, uint32_t len);
+
+/**
+ * @brief Adds a block classified earlier with scan_content_classify() to the
+ *        content map of ctx (no-op when classification is off).
+ */
+void scan_ctx_add_content(scan_ctx_t* ctx, uint64_t offset, uint32_t len, scan_content_class_t content);
+
+/**
+ * @brief Refreshes the speed estimate and invokes the progress callback every 50 ms.
+ *
+ * @param force Invoke the callback even if the interval has not elapsed.
+ */
+void scan_ctx_update_progress(scan_ctx_t* ctx, bool force);
+
+/**
+ * @brief Writes a checkpoint of ctx to its journal every SCAN_JOURNAL_INTERVAL_SECONDS.
+ *
+ * @param force Write even if the interval has not elapsed.
+ */
+void scan_ctx_checkpoint(scan_ctx_t* ctx, bool force);
+
+/**
+ * @brief Returns true once surface_scan_request_stop() has been called.
+ */
+bool scan_stop_requested(void);
+
+/**
+ * @brief Returns true when ctx must stop issuing reads: a stop was requested
+ *        or its time budget ran out.
+ */
+bool scan_ctx_stop(const scan_ctx_t* ctx);
+
+/**
+ * @brief Prepares a throttle driven by controls (see scan_throttle_t).
+ */
+void scan_throttle_init(scan_throttle_t* throttle, scan_controls_t* controls, const char* device_path);
+void scan_throttle_destroy(scan_throttle_t* throttle);
+
+/**
+ * @brief Waits until ctx may issue a read of the given size.
+ *
+ * Returns immediately when ctx has no throttle. Long waits are sliced so
+ * that progress callbacks keep running and a stop request is honoured.
+ */
+void scan_throttle_acquire(scan_ctx_t* ctx, uint32_t bytes);
+
+/**
+ * @brief Whether scan_throttle_acquire() would let a read of bytes through
+ *        right now, without waiting (always true without a throttle).
+ *
+ * Engines with reads in flight check this first: a wait inside
+ * scan_throttle_acquire() would otherwise be counted in their latency.
+ */
+bool scan_throttle_ready(scan_throttle_t* throttle, uint32_t bytes);
+
+/**
+ * @brief Feeds one completed read to the latency controller.
+ */
+void scan_throttle_observe(scan_throttle_t* throttle, uint32_t bytes, uint64_t latency_ns);
+
+/**
+ * @brief Reads an engine may keep in flight right now, at most depth (and at least 1).
+ */
+unsigned scan_throttle_depth(scan_throttle_t* throttle, unsigned depth);
+
+/**
+ * @brief Copies the live throttle status into state: effective bandwidth cap
+ *        and, in idle-aware mode, foreground I/O, pause and depth limit.
+ *        A NULL throttle clears those fields.
+ */
+void scan_throttle_report(scan_throttle_t* throttle, scan_state_t* state);
+
+/**
+ * @brief Moves the calling thread to the idle I/O class (Linux ioprio, Windows
+ *        background mode, macOS throttled I/O policy).
+ *
+ * @return A token for scan_io_idle_end(), or -1 if unsupported.
+ */
+int scan_io_idle_begin(void);
+void scan_io_idle_end(int previous);
+
+/**
+ * @brief Hands the latency samples accumulated by ctx over to its latency map.
+ */
+void scan_ctx_flush_latency_map(scan_ctx_t* ctx);
+
+/**
+ * @brief Updates the extent counters of ctx from its index once the scan is over.
+ */
+void scan_ctx_finish_bad_extents(scan_ctx_t* ctx);
+
+/**
+ * @brief Frees the error-localisation buffers (and the index, if owned) of ctx.
+ */
+void scan_ctx_release(scan_ctx_t* ctx);
+
+/**
+ * @brief Byte offset read at a position of the context's range.
+ */
+static inline uint64_t scan_ctx_read_offset(const scan_ctx_t* ctx, uint64_t position) {
+    if (ctx->order.kind == SCAN_ORDER_SEQUENTIAL) return position;
+    return ctx->order_base + scan_order_block(&ctx->order, (position - ctx->order_base) / ctx->block_size) * ctx->block_size;
+}
+
+/**
+ * @brief Length of the read starting at offset (as returned by
+ *        scan_ctx_read_offset()), clamped to the end of the range.
+ */
+static inline uint32_t scan_ctx_read_len(const scan_ctx_t* ctx, uint64_t offset) {
+    if (ctx->order.kind != SCAN_ORDER_SEQUENTIAL) {
+        uint64_t left = ctx->order_end - offset;
+        return left < ctx->block_size ? (uint32_t)left : ctx->block_size;
+    }
+    uint64_t end = ctx->range_end;
+    // No scan do espaço alocado a leitura para no fim da faixa alocada.
+    if (ctx->extents && ctx->extent_next < ctx->extents->count && ctx->extents->items[ctx->extent_next].end < end) {
+        end = ctx->extents->items[ctx->extent_next].end;
+    }
+    uint64_t remaining = end - offset;
+    return remaining < ctx->block_size ? (uint32_t)remaining : ctx->block_size;
+}
+
+/**
+ * @brief First offset at or after offset that the engine has to read: offset
+ *        itself, the start of the next allocated extent, or range_end when
+ *        nothing is left. Call before scan_ctx_read_len() for that offset.
+ */
+static inline uint64_t scan_ctx_next_offset(scan_ctx_t* ctx, uint64_t offset) {
+    if (!ctx->extents || offset >= ctx->range_end) return offset;
+    ctx->extent_next = scan_extent_list_find(ctx->extents, offset);
+    if (ctx->extent_next >= ctx->extents->count) return ctx->range_end;
+    uint64_t start = ctx->extents->items[ctx->extent_next].start;
+    if (start <= offset) return offset;
+    return start < ctx->range_end ? start : ctx->range_end;
+}
+
+/**
+ * @brief Position after the read of len bytes at position: the next block of
+ *        the order, the next allocated extent, or range_end when nothing is left.
+ */
+static inline uint64_t scan_ctx_advance(scan_ctx_t* ctx, uint64_t position, uint32_t len) {
+    if (ctx->order.kind != SCAN_ORDER_SEQUENTIAL) {
+        // Cada posição vale um bloco inteiro, mesmo a que cai no bloco parcial do fim.
+        uint64_t next = position + ctx->block_size;
+        return next < ctx->range_end ? next : ctx->range_end;
+    }
+    return scan_ctx_next_offset(ctx, position + len);
+}
+
+/**
+ * @brief Reads the context's range with the engine selected in ctx->opts
+ *        (io_uring when requested/available, synchronous reads otherwise).
+ */
+int scan_ctx_run_engine(scan_ctx_t* ctx);
+
+/**
+ * @brief Opens the scanned device again (same flags as the parent scan).
+ */
+scan_dev_t scan_ctx_reopen(const scan_ctx_t* ctx, const char* device);
+void scan_ctx_close(scan_dev_t dev);
+
+/**
+ * @brief Opens the scanned device so that reads skip the OS cache (O_DIRECT,
+ *        F_NOCACHE, unbuffered on Windows).
+ *
+ * @param drop_cache Set when the device refused unbuffered reads and the
+ *        cached pages must be dropped with scan_ctx_drop_cache() before each read.
+ */
+scan_dev_t scan_ctx_open_uncached(const scan_ctx_t* ctx, bool* drop_cache);
+void scan_ctx_drop_cache(scan_dev_t dev, uint64_t offset, uint32_t len);
+
+/**
+ * @brief Positional read (bytes read, or -1 on error).
+ */
+int64_t scan_ctx_pread(scan_dev_t dev, void* buf, uint32_t len, uint64_t offset);
+
+/**
+ * @brief Verify engine: reads every block twice (the second time bypassing
+ *        the OS cache) on a helper thread, double-buffered, while the calling
+ *        thread accounts for and compares the previous pair.
+ */
+int surface_verify_scan(scan_ctx_t* ctx);
+
+/**
+ * @brief Media verify engine: the drive checks each block itself (SCSI
+ *        VERIFY(16), ATA READ VERIFY SECTORS EXT or NVMe Verify) and only
+ *        failures come back; unreadable sectors are pinned with further verifies.
+ *
+ * @return 0 on success, -1 if the device accepts no verify command (the
+ *         caller falls back to reads), or 1 on a fatal error.
+ */
+int surface_media_scan(scan_ctx_t* ctx);
+
+/**
+ * @brief Scans ctx->segments with one worker thread per segment, aggregating
+ *        their counters into ctx->state and driving ctx->callback (and the
+ *        checkpoints) from the calling thread.
+ *
+ * Each worker reads [cursor, end) of its segment; the cursors are updated
+ * in ctx->segments as the workers progress.
+ *
+ * @param ctx The parent scan context (device already opened, segment_count >= 2).
+ * @param device_path Path of the device, reopened by each worker.
+ */
+int surface_parallel_scan(scan_ctx_t* ctx, const char* device_path);
+
+#if defined(__linux__)
+/**
+ * @brief Deep scan through io_uring, keeping opts->queue_depth reads in flight.
+ *
+ * @return 0 on success, -1 if io_uring is unavailable (the caller falls back
+ *         to the synchronous engine), or 1 on a fatal error.
+ */
+int surface_uring_scan(scan_ctx_t* ctx);
+#endif
+
+#endif // SURFACE_ENGINE_H
@@ -4,6 +4,11 @@
 #include "pal.h"
 #include "info.h" 
 #include "surface.h"
+#include "scan_scheduler.h"
+#include "scan_journal.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
+#include "scan_tune.h"
 
 
 /**
@@ -38,6 +43,91 @@ void ui_draw_drive_info(const BasicDriveInfo* drive_info);
 
 void ui_draw_scan_progress(const scan_state_t* state, const BasicDriveInfo* drive_info);
 void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* drive_info);
+
+/**
+ * @brief Exibe as faixas de latência (estilo Victoria/MHDD) e os percentis de um scan.
+ *
+ * @param latency O histograma acumulado pelo scan.
+ */
+void ui_display_scan_latency(const scan_latency_t* latency);
+
+/**
+ * @brief Desenha um heatmap de latência em linhas de 64 células, cada uma
+ *        colorida pela pior latência (ou 'x' se houve erro de leitura).
+ *
+ * @param cells Células em ordem de LBA.
+ * @param count Número de células.
+ * @param first_lba LBA inicial da primeira célula.
+ * @param lbas_per_cell Quantos LBAs cada célula cobre (para os rótulos das linhas).
+ */
+void ui_display_latency_heatmap(const latency_cell_t* cells, unsigned count, uint64_t first_lba, uint64_t lbas_per_cell);
+
+/**
+ * @brief Lista as extensões de setores ilegíveis localizadas por um scan profundo.
+ *
+ * @param extents As primeiras extensões encontradas, em ordem de LBA.
+ * @param shown Quantas extensões há em extents.
+ * @param total Total de extensões encontradas pelo scan.
+ * @param sector_size Tamanho do setor lógico, em bytes.
+ */
+void ui_display_bad_extents(const bad_extent_t* extents, size_t shown, uint64_t total, uint32_t sector_size);
+
+/**
+ * @brief Lista os arquivos atingidos por setores ruins ou inconsistentes.
+ *
+ * @param damage Resultado do mapeamento reverso (NULL se não foi feito).
+ */
+void ui_display_file_damage(const scan_file_damage_t* damage);
+
+/**
+ * @brief Desenha o painel de um scan de vários dispositivos: uma linha por
+ *        job (progresso, velocidade, blocos ruins, estado) e os totais.
+ *
+ * Pode ser chamada enquanto os jobs rodam; lê cópias do progresso.
+ */
+void ui_draw_scan_dashboard(const scan_job_t* jobs, size_t count);
+
+/**
+ * @brief Exibe a tabela final de um scan de vários dispositivos.
+ *
+ * @param jobs Jobs já terminados.
+ * @param count Número de jobs.
+ */
+void ui_display_scan_summary(const scan_job_t* jobs, size_t count);
+
+/**
+ * @brief Mostra há quantos dias cada região do disco foi lida pela patrulha:
+ *        uma célula por região, '.' para as que ainda não foram lidas.
+ *
+ * @param patrol Estado da patrulha.
+ * @param now Hora atual (segundos desde a época).
+ */
+void ui_display_patrol_coverage(const scan_patrol_t* patrol, int64_t now);
+
+/**
+ * @brief Desenha a curva de taxa de transferência por zona: uma coluna por
+ *        zona, do início ao fim do disco, com a linha de base do modelo ('-')
+ *        quando houver. Zonas ainda não medidas ficam vazias.
+ *
+ * @param profile Perfil em medição ou já medido.
+ * @param baseline Linha de base para comparação (NULL se não houver).
+ */
+void ui_draw_transfer_curve(const scan_profile_t* profile, const scan_profile_t* baseline);
+
+/**
+ * @brief Exibe a tabela do benchmark de leitura: IOPS, MB/s e latências
+ *        p50/p99/p99.9 por padrão de acesso, tamanho de bloco e fila.
+ *
+ * @param results Resultados na ordem em que as configurações rodaram.
+ * @param count Número de resultados.
+ */
+void ui_display_benchmark(const scan_bench_result_t* results, size_t count);
+
+/**
+ * @brief Exibe a calibração do --auto-tune: os limites da fila lidos do
+ *        dispositivo, cada combinação medida e a escolhida.
+ */
+void ui_display_tune_result(const scan_tune_result_t* result);
 void ui_display_error_log_entry(const NVMeErrorLogEntry* log_entry, int entry_number);
 
 void ui_init(void);
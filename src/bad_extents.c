@@ -0,0 +1,457 @@
+#include "bad_extents.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAD_CHUNK_SHIFT 16
+#define BAD_CHUNK_SECTORS (1u << BAD_CHUNK_SHIFT)
+#define BAD_CHUNK_BITMAP_BYTES (BAD_CHUNK_SECTORS / 8)
+
+#define BAD_INDEX_MAGIC "DOBX"
+#define BAD_INDEX_VERSION 1
+
+// Sequência ruim dentro de um chunk, com limites inclusivos (0..65535).
+typedef struct {
+    uint16_t first;
+    uint16_t last;
+} bad_run_t;
+
+// Acima disso o bitmap ocupa menos memória que a lista de runs.
+#define BAD_CHUNK_MAX_RUNS (BAD_CHUNK_BITMAP_BYTES / sizeof(bad_run_t))
+
+enum {
+    BAD_CHUNK_RUNS = 0,
+    BAD_CHUNK_BITMAP = 1
+};
+
+typedef struct {
+    uint64_t index;             // lba >> BAD_CHUNK_SHIFT
+    uint32_t sectors;           // setores ruins no chunk
+    uint32_t run_count;
+    uint32_t run_capacity;
+    uint8_t kind;
+    union {
+        bad_run_t* runs;
+        uint8_t* bitmap;
+    } data;
+} bad_chunk_t;
+
+struct bad_extent_index_s {
+    uint32_t sector_size;
+    bad_chunk_t* chunks;        // ordenados por index
+    size_t chunk_count;
+    size_t chunk_capacity;
+    size_t last_chunk;          // cache para inserções em ordem crescente
+    uint64_t sectors;
+    bool incomplete;            // uma inserção ficou sem memória
+};
+
+bad_extent_index_t* bad_extent_index_create(uint32_t sector_size) {
+    bad_extent_index_t* index = (bad_extent_index_t*)calloc(1, sizeof(bad_extent_index_t));
+    if (index) {
+        index->sector_size = sector_size;
+    }
+    return index;
+}
+
+void bad_extent_index_destroy(bad_extent_index_t* index) {
+    if (!index) return;
+    for (size_t i = 0; i < index->chunk_count; ++i) {
+        free(index->chunks[i].kind == BAD_CHUNK_BITMAP ? (void*)index->chunks[i].data.bitmap : (void*)index->chunks[i].data.runs);
+    }
+    free(index->chunks);
+    free(index);
+}
+
+uint32_t bad_extent_index_sector_size(const bad_extent_index_t* index) {
+    return index ? index->sector_size : 0;
+}
+
+void bad_extent_index_set_sector_size(bad_extent_index_t* index, uint32_t sector_size) {
+    if (index) index->sector_size = sector_size;
+}
+
+uint64_t bad_extent_index_sectors(const bad_extent_index_t* index) {
+    return index ? index->sectors : 0;
+}
+
+bool bad_extent_index_incomplete(const bad_extent_index_t* index) {
+    return index ? index->incomplete : false;
+}
+
+// Posição do chunk (ou onde ele seria inserido) por busca binária.
+static size_t chunk_lower_bound(const bad_extent_index_t* index, uint64_t chunk_index) {
+    size_t lo = 0, hi = index->chunk_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->chunks[mid].index < chunk_index) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static const bad_chunk_t* chunk_find(const bad_extent_index_t* index, uint64_t chunk_index) {
+    size_t pos = chunk_lower_bound(index, chunk_index);
+    if (pos < index->chunk_count && index->chunks[pos].index == chunk_index) {
+        return &index->chunks[pos];
+    }
+    return NULL;
+}
+
+static bad_chunk_t* chunk_get_or_create(bad_extent_index_t* index, uint64_t chunk_index) {
+    if (index->last_chunk < index->chunk_count && index->chunks[index->last_chunk].index == chunk_index) {
+        return &index->chunks[index->last_chunk];
+    }
+
+    size_t pos;
+    if (index->chunk_count > 0 && index->chunks[index->chunk_count - 1].index < chunk_index) {
+        pos = index->chunk_count;
+    } else {
+        pos = chunk_lower_bound(index, chunk_index);
+        if (pos < index->chunk_count && index->chunks[pos].index == chunk_index) {
+            index->last_chunk = pos;
+            return &index->chunks[pos];
+        }
+    }
+
+    if (index->chunk_count == index->chunk_capacity) {
+        size_t capacity = index->chunk_capacity ? index->chunk_capacity * 2 : 16;
+        bad_chunk_t* chunks = (bad_chunk_t*)realloc(index->chunks, capacity * sizeof(bad_chunk_t));
+        if (chunks == NULL) return NULL;
+        index->chunks = chunks;
+        index->chunk_capacity = capacity;
+    }
+    memmove(&index->chunks[pos + 1], &index->chunks[pos], (index->chunk_count - pos) * sizeof(bad_chunk_t));
+    memset(&index->chunks[pos], 0, sizeof(bad_chunk_t));
+    index->chunks[pos].index = chunk_index;
+    index->chunks[pos].kind = BAD_CHUNK_RUNS;
+    index->chunk_count++;
+    index->last_chunk = pos;
+    return &index->chunks[pos];
+}
+
+static inline bool bitmap_test(const uint8_t* bitmap, uint32_t bit) {
+    return (bitmap[bit >> 3] >> (bit & 7)) & 1;
+}
+
+// Converte os runs de um chunk denso em bitmap.
+static int chunk_to_bitmap(bad_chunk_t* chunk) {
+    uint8_t* bitmap = (uint8_t*)calloc(1, BAD_CHUNK_BITMAP_BYTES);
+    if (bitmap == NULL) return 1;
+    for (uint32_t r = 0; r < chunk->run_count; ++r) {
+        for (uint32_t bit = chunk->data.runs[r].first; bit <= chunk->data.runs[r].last; ++bit) {
+            bitmap[bit >> 3] |= (uint8_t)(1u << (bit & 7));
+        }
+    }
+    free(chunk->data.runs);
+    chunk->data.bitmap = bitmap;
+    chunk->kind = BAD_CHUNK_BITMAP;
+    chunk->run_count = chunk->run_capacity = 0;
+    return 0;
+}
+
+// Marca [first, last] dentro do chunk. Devolve os setores novos ou -1 sem memória.
+static int64_t chunk_add(bad_chunk_t* chunk, uint32_t first, uint32_t last) {
+    if (chunk->kind == BAD_CHUNK_BITMAP) {
+        int64_t added = 0;
+        for (uint32_t bit = first; bit <= last; ++bit) {
+            if (!bitmap_test(chunk->data.bitmap, bit)) {
+                chunk->data.bitmap[bit >> 3] |= (uint8_t)(1u << (bit & 7));
+                added++;
+            }
+        }
+        return added;
+    }
+
+    // Primeiro run que encosta em [first, last] ou vem depois dele.
+    bad_run_t* runs = chunk->data.runs;
+    uint32_t lo = 0, hi = chunk->run_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((uint32_t)runs[mid].last + 1 < first) lo = mid + 1;
+        else hi = mid;
+    }
+
+    uint32_t i = lo, j = lo;
+    uint32_t merged_first = first, merged_last = last;
+    int64_t covered = 0;
+    while (j < chunk->run_count && runs[j].first <= last + 1) {
+        uint32_t overlap_first = runs[j].first > first ? runs[j].first : first;
+        uint32_t overlap_last = runs[j].last < last ? runs[j].last : last;
+        if (overlap_first <= overlap_last) covered += overlap_last - overlap_first + 1;
+        if (runs[j].first < merged_first) merged_first = runs[j].first;
+        if (runs[j].last > merged_last) merged_last = runs[j].last;
+        j++;
+    }
+
+    if (i == j) {
+        if (chunk->run_count == chunk->run_capacity) {
+            uint32_t capacity = chunk->run_capacity ? chunk->run_capacity * 2 : 4;
+            bad_run_t* grown = (bad_run_t*)realloc(chunk->data.runs, capacity * sizeof(bad_run_t));
+            if (grown == NULL) return -1;
+            chunk->data.runs = runs = grown;
+            chunk->run_capacity = capacity;
+        }
+        memmove(&runs[i + 1], &runs[i], (chunk->run_count - i) * sizeof(bad_run_t));
+        chunk->run_count++;
+    } else if (j > i + 1) {
+        memmove(&runs[i + 1], &runs[j], (chunk->run_count - j) * sizeof(bad_run_t));
+        chunk->run_count -= j - i - 1;
+    }
+    runs[i].first = (uint16_t)merged_first;
+    runs[i].last = (uint16_t)merged_last;
+
+    int64_t added = (int64_t)(last - first + 1) - covered;
+    if (chunk->run_count > BAD_CHUNK_MAX_RUNS && chunk_to_bitmap(chunk) != 0) {
+        return -1;
+    }
+    return added;
+}
+
+int bad_extent_index_add(bad_extent_index_t* index, uint64_t lba, uint64_t count, uint64_t* added) {
+    uint64_t total_added = 0;
+    int rc = 0;
+    while (count > 0) {
+        uint32_t offset = (uint32_t)(lba & (BAD_CHUNK_SECTORS - 1));
+        uint64_t n = BAD_CHUNK_SECTORS - offset;
+        if (n > count) n = count;
+
+        bad_chunk_t* chunk = chunk_get_or_create(index, lba >> BAD_CHUNK_SHIFT);
+        int64_t chunk_added = chunk ? chunk_add(chunk, offset, offset + (uint32_t)n - 1) : -1;
+        if (chunk_added < 0) {
+            rc = 1;
+            break;
+        }
+        chunk->sectors += (uint32_t)chunk_added;
+        total_added += (uint64_t)chunk_added;
+
+        lba += n;
+        count -= n;
+    }
+    index->sectors += total_added;
+    if (rc != 0) index->incomplete = true;
+    if (added) *added = total_added;
+    return rc;
+}
+
+bool bad_extent_index_contains(const bad_extent_index_t* index, uint64_t lba) {
+    const bad_chunk_t* chunk = chunk_find(index, lba >> BAD_CHUNK_SHIFT);
+    if (chunk == NULL) return false;
+
+    uint32_t offset = (uint32_t)(lba & (BAD_CHUNK_SECTORS - 1));
+    if (chunk->kind == BAD_CHUNK_BITMAP) {
+        return bitmap_test(chunk->data.bitmap, offset);
+    }
+    uint32_t lo = 0, hi = chunk->run_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (chunk->data.runs[mid].last < offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < chunk->run_count && chunk->data.runs[lo].first <= offset;
+}
+
+// Junta os runs de chunks vizinhos antes de entregá-los ao visitante.
+typedef struct {
+    bad_extent_t pending;
+    bool has_pending;
+    bad_extent_visit_t visit;
+    void* user_data;
+} extent_walk_t;
+
+static void walk_emit(extent_walk_t* walk, uint64_t lba, uint64_t count) {
+    if (walk->has_pending && walk->pending.lba + walk->pending.count == lba) {
+        walk->pending.count += count;
+        return;
+    }
+    if (walk->has_pending) {
+        walk->visit(&walk->pending, walk->user_data);
+    }
+    walk->pending.lba = lba;
+    walk->pending.count = count;
+    walk->has_pending = true;
+}
+
+void bad_extent_index_foreach(const bad_extent_index_t* index, bad_extent_visit_t visit, void* user_data) {
+    if (!index || !visit) return;
+    extent_walk_t walk;
+    memset(&walk, 0, sizeof(walk));
+    walk.visit = visit;
+    walk.user_data = user_data;
+
+    for (size_t c = 0; c < index->chunk_count; ++c) {
+        const bad_chunk_t* chunk = &index->chunks[c];
+        uint64_t base = chunk->index << BAD_CHUNK_SHIFT;
+        if (chunk->kind == BAD_CHUNK_RUNS) {
+            for (uint32_t r = 0; r < chunk->run_count; ++r) {
+                walk_emit(&walk, base + chunk->data.runs[r].first, (uint64_t)chunk->data.runs[r].last - chunk->data.runs[r].first + 1);
+            }
+            continue;
+        }
+        uint32_t bit = 0;
+        while (bit < BAD_CHUNK_SECTORS) {
+            if (chunk->data.bitmap[bit >> 3] == 0 && (bit & 7) == 0) {
+                bit += 8;
+                continue;
+            }
+            if (!bitmap_test(chunk->data.bitmap, bit)) {
+                bit++;
+                continue;
+            }
+            uint32_t start = bit;
+            while (bit < BAD_CHUNK_SECTORS && bitmap_test(chunk->data.bitmap, bit)) bit++;
+            walk_emit(&walk, base + start, bit - start);
+        }
+    }
+    if (walk.has_pending) {
+        visit(&walk.pending, user_data);
+    }
+}
+
+static void count_extent(const bad_extent_t* extent, void* user_data) {
+    (void)extent;
+    (*(uint64_t*)user_data)++;
+}
+
+uint64_t bad_extent_index_extents(const bad_extent_index_t* index) {
+    uint64_t count = 0;
+    bad_extent_index_foreach(index, count_extent, &count);
+    return count;
+}
+
+typedef struct {
+    bad_extent_index_t* dst;
+    int rc;
+} merge_ctx_t;
+
+static void merge_extent(const bad_extent_t* extent, void* user_data) {
+    merge_ctx_t* merge = (merge_ctx_t*)user_data;
+    if (bad_extent_index_add(merge->dst, extent->lba, extent->count, NULL) != 0) {
+        merge->rc = 1;
+    }
+}
+
+int bad_extent_index_merge(bad_extent_index_t* dst, const bad_extent_index_t* src) {
+    if (!dst || !src) return 1;
+    if (dst->sector_size == 0) dst->sector_size = src->sector_size;
+    merge_ctx_t merge = { dst, 0 };
+    bad_extent_index_foreach(src, merge_extent, &merge);
+    if (src->incomplete) dst->incomplete = true;
+    return merge.rc;
+}
+
+// Formato do arquivo (little-endian):
+//   "DOBX" | u32 versão | u32 tamanho do setor | u64 setores | u64 chunks
+//   por chunk: u64 index | u8 tipo | u32 runs | runs (u16 first, u16 last) ou bitmap de 8 KiB
+static void put_le(FILE* fp, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        fputc((int)((value >> (8 * i)) & 0xFF), fp);
+    }
+}
+
+static bool get_le(FILE* fp, uint64_t* value, int bytes) {
+    *value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        int c = fgetc(fp);
+        if (c == EOF) return false;
+        *value |= (uint64_t)(uint8_t)c << (8 * i);
+    }
+    return true;
+}
+
+int bad_extent_index_write(const bad_extent_index_t* index, FILE* fp) {
+    if (!index || !fp) return 1;
+
+    fwrite(BAD_INDEX_MAGIC, 1, 4, fp);
+    put_le(fp, BAD_INDEX_VERSION, 4);
+    put_le(fp, index->sector_size, 4);
+    put_le(fp, index->sectors, 8);
+    put_le(fp, index->chunk_count, 8);
+
+    for (size_t c = 0; c < index->chunk_count; ++c) {
+        const bad_chunk_t* chunk = &index->chunks[c];
+        put_le(fp, chunk->index, 8);
+        put_le(fp, chunk->kind, 1);
+        put_le(fp, chunk->run_count, 4);
+        if (chunk->kind == BAD_CHUNK_BITMAP) {
+            fwrite(chunk->data.bitmap, 1, BAD_CHUNK_BITMAP_BYTES, fp);
+        } else {
+            for (uint32_t r = 0; r < chunk->run_count; ++r) {
+                put_le(fp, chunk->data.runs[r].first, 2);
+                put_le(fp, chunk->data.runs[r].last, 2);
+            }
+        }
+    }
+    return ferror(fp) ? 1 : 0;
+}
+
+bad_extent_index_t* bad_extent_index_read(FILE* fp) {
+    if (!fp) return NULL;
+
+    char magic[4];
+    uint64_t version, sector_size, sectors, chunk_count;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, BAD_INDEX_MAGIC, 4) != 0 ||
+        !get_le(fp, &version, 4) || version != BAD_INDEX_VERSION ||
+        !get_le(fp, &sector_size, 4) || !get_le(fp, &sectors, 8) || !get_le(fp, &chunk_count, 8)) {
+        return NULL;
+    }
+
+    bad_extent_index_t* index = bad_extent_index_create((uint32_t)sector_size);
+    bool ok = index != NULL;
+    uint8_t* bitmap = ok ? (uint8_t*)malloc(BAD_CHUNK_BITMAP_BYTES) : NULL;
+    ok = ok && bitmap != NULL;
+
+    // Reconstrói pelo caminho normal de inserção, que valida e reordena os dados.
+    for (uint64_t c = 0; ok && c < chunk_count; ++c) {
+        uint64_t chunk_index, kind, run_count;
+        if (!get_le(fp, &chunk_index, 8) || !get_le(fp, &kind, 1) || !get_le(fp, &run_count, 4)) {
+            ok = false;
+            break;
+        }
+        uint64_t base = chunk_index << BAD_CHUNK_SHIFT;
+        if (kind == BAD_CHUNK_BITMAP) {
+            if (fread(bitmap, 1, BAD_CHUNK_BITMAP_BYTES, fp) != BAD_CHUNK_BITMAP_BYTES) {
+                ok = false;
+                break;
+            }
+            for (uint32_t bit = 0; ok && bit < BAD_CHUNK_SECTORS; ++bit) {
+                if (bitmap_test(bitmap, bit)) ok = bad_extent_index_add(index, base + bit, 1, NULL) == 0;
+            }
+        } else if (kind == BAD_CHUNK_RUNS && run_count <= BAD_CHUNK_MAX_RUNS) {
+            for (uint64_t r = 0; ok && r < run_count; ++r) {
+                uint64_t first, last;
+                ok = get_le(fp, &first, 2) && get_le(fp, &last, 2) && first <= last &&
+                     bad_extent_index_add(index, base + first, last - first + 1, NULL) == 0;
+            }
+        } else {
+            ok = false;
+        }
+    }
+
+    free(bitmap);
+    if (!ok || index->sectors != sectors) {
+        bad_extent_index_destroy(index);
+        return NULL;
+    }
+    return index;
+}
+
+int bad_extent_index_save(const bad_extent_index_t* index, const char* path) {
+    if (!index || !path) return 1;
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return 1;
+
+    int rc = bad_extent_index_write(index, fp);
+    if (fclose(fp) != 0) rc = 1;
+    return rc;
+}
+
+bad_extent_index_t* bad_extent_index_load(const char* path) {
+    if (!path) return NULL;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    bad_extent_index_t* index = bad_extent_index_read(fp);
+    fclose(fp);
+    return index;
+}
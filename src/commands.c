@@ -12,6 +12,10 @@
 #include "style.h"
 #include "ui.h"
 #include "info.h"
+#include "surface.h"
+#include "scan_patrol.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
 
 int execute_smart_command(const char* device_path) {
     if (!device_path) {
@@ -124,7 +128,7 @@ int execute_smart_command(const char* device_path) {
     }
 }
 
-int execute_json_export_command(const char* device_path, const char* output_file) {
+int execute_json_export_command(const char* device_path, const char* output_file, const char* bad_index_path, const char* map_files_path) {
     BasicDriveInfo basic_info;
     memset(&basic_info, 0, sizeof(BasicDriveInfo));
     pal_status_t basic_info_status = pal_get_basic_drive_info(device_path, &basic_info);
@@ -165,14 +169,34 @@ int execute_json_export_command(const char* device_path, const char* output_file
         nvme_analyze_health_alerts(&s_data.data.nvme, &alerts, s_data.data.nvme.spare_thresh);
     }
     
+    // Setores ruins de um scan anterior, resolvidos para os arquivos que os contêm.
+    scan_file_damage_t damage;
+    scan_file_damage_init(&damage);
+    bool mapped = false;
+    if (bad_index_path && map_files_path) {
+        bad_extent_index_t* bad_index = bad_extent_index_load(bad_index_path);
+        if (bad_index == NULL) {
+            fprintf(stderr, "Error: Could not read the bad sector index %s.\n", bad_index_path);
+            return EXIT_FAILURE;
+        }
+        if (scan_file_damage_map(&damage, map_files_path, device_path, bad_index, NULL) != PAL_STATUS_SUCCESS) {
+            fprintf(stderr, "Warning: Could not map the bad sectors to the files under %s: %s\n",
+                    map_files_path, pal_get_error_string(damage.status));
+        }
+        bad_extent_index_destroy(bad_index);
+        mapped = true;
+    }
+
     int export_result = nvme_export_to_json(
         device_path,
         &basic_info,
         &s_data,
         &alerts,
         &hybrid_ctx,
+        mapped ? &damage : NULL,
         output_file
     );
+    scan_file_damage_free(&damage);
 
     if (export_result == PAL_STATUS_SUCCESS) {
         if (output_file) {
@@ -203,15 +227,550 @@ int handle_list_drives(int argc, char* argv[]) {
     return 0;
 }
 
+// Aceita valores como "4096", "64K", "1M".
+static bool parse_size_arg(const char* text, uint32_t* out) {
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text) return false;
+    if (*end == 'k' || *end == 'K') { value *= 1024ULL; end++; }
+    else if (*end == 'm' || *end == 'M') { value *= 1024ULL * 1024ULL; end++; }
+    if (*end != '\0' || value == 0 || value > 0xFFFFFFFFULL) return false;
+    *out = (uint32_t)value;
+    return true;
+}
+
+// Percentual entre 0 e 100 exclusivos ("95", "99.9", "0.1%"), devolvido como fração.
+static bool parse_percent_arg(const char* text, double* out) {
+    char* end = NULL;
+    double value = strtod(text, &end);
+    if (end == text) return false;
+    if (*end == '%') end++;
+    if (*end != '\0' || !(value > 0.0 && value < 100.0)) return false;
+    *out = value / 100.0;
+    return true;
+}
+
+// Número positivo (aceita fração), para limites como --max-mbps 12.5.
+static bool parse_positive_arg(const char* text, double* value) {
+    char* end = NULL;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || !(parsed > 0.0)) return false;
+    *value = parsed;
+    return true;
+}
+
+// controls é preenchido pelas opções de throttle e só é ligado a opts se alguma for usada.
+static int parse_surface_scan_options(int argc, char* argv[], int first, scan_options_t* opts, scan_controls_t* controls, unsigned* max_concurrent) {
+    bool block_size_set = false;
+    for (int i = first; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--deep") == 0) {
+            opts->mode = "deep";
+        } else if (strcmp(arg, "--quick") == 0) {
+            opts->mode = "quick";
+        } else if (strcmp(arg, "--verify") == 0) {
+            opts->verify = true;
+            opts->mode = "deep";
+        } else if (strcmp(arg, "--classify") == 0) {
+            opts->classify = true;
+        } else if (strcmp(arg, "--direct") == 0) {
+            opts->direct_io = true;
+        } else if (strcmp(arg, "--engine") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "sync") == 0) opts->engine = SCAN_ENGINE_SYNC;
+            else if (strcmp(name, "uring") == 0 || strcmp(name, "io_uring") == 0) opts->engine = SCAN_ENGINE_URING;
+            else if (strcmp(name, "auto") == 0) opts->engine = SCAN_ENGINE_AUTO;
+            else if (strcmp(name, "media-verify") == 0) opts->engine = SCAN_ENGINE_MEDIA_VERIFY;
+            else {
+                fprintf(stderr, "Unknown scan engine '%s' (expected sync, uring, media-verify or auto).\n", name);
+                return 1;
+            }
+        } else if (strcmp(arg, "--block-size") == 0 && i + 1 < argc) {
+            if (!parse_size_arg(argv[++i], &opts->block_size) || opts->block_size % 512 != 0 || opts->block_size > SCAN_MAX_BLOCK_SIZE) {
+                fprintf(stderr, "Invalid block size '%s' (must be a multiple of 512 up to 64M, e.g. 4K, 1M).\n", argv[i]);
+                return 1;
+            }
+            block_size_set = true;
+        } else if (strcmp(arg, "--auto-tune") == 0) {
+            opts->auto_tune = true;
+        } else if (strcmp(arg, "--qd") == 0 && i + 1 < argc) {
+            int qd = atoi(argv[++i]);
+            if (qd < 1 || qd > SCAN_MAX_QUEUE_DEPTH) {
+                fprintf(stderr, "Invalid queue depth '%s' (1-%d).\n", argv[i], SCAN_MAX_QUEUE_DEPTH);
+                return 1;
+            }
+            opts->queue_depth = (uint32_t)qd;
+        } else if (strcmp(arg, "--resume") == 0) {
+            opts->resume = true;
+            opts->mode = "deep";
+        } else if (strcmp(arg, "--journal") == 0 && i + 1 < argc) {
+            opts->journal_path = argv[++i];
+        } else if (strcmp(arg, "--allocated") == 0 && i + 1 < argc) {
+            opts->allocated_path = argv[++i];
+            opts->mode = "deep";
+            // Quem escaneia só os arquivos quer saber quais foram atingidos.
+            if (opts->map_files_path == NULL) opts->map_files_path = opts->allocated_path;
+        } else if (strcmp(arg, "--map-files") == 0 && i + 1 < argc) {
+            opts->map_files_path = argv[++i];
+        } else if (strcmp(arg, "--order") == 0 && i + 1 < argc) {
+            if (!scan_order_parse(argv[++i], &opts->order)) {
+                fprintf(stderr, "Unknown read order '%s' (expected sequential, reverse, strided, random or butterfly).\n", argv[i]);
+                return 1;
+            }
+            opts->mode = "deep";
+        } else if (strcmp(arg, "--stride") == 0 && i + 1 < argc) {
+            char* end = NULL;
+            unsigned long long stride = strtoull(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || stride == 0) {
+                fprintf(stderr, "Invalid stride '%s' (blocks between two reads, e.g. 64).\n", argv[i]);
+                return 1;
+            }
+            opts->stride = stride;
+            opts->order = SCAN_ORDER_STRIDED;
+            opts->mode = "deep";
+        } else if (strcmp(arg, "--samples") == 0 && i + 1 < argc) {
+            char* end = NULL;
+            unsigned long long samples = strtoull(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || samples == 0 || samples > SCAN_SAMPLE_MAX_BLOCKS) {
+                fprintf(stderr, "Invalid sample count '%s' (1-%llu).\n", argv[i], (unsigned long long)SCAN_SAMPLE_MAX_BLOCKS);
+                return 1;
+            }
+            opts->samples = samples;
+            opts->mode = "quick";
+        } else if (strcmp(arg, "--confidence") == 0 && i + 1 < argc) {
+            if (!parse_percent_arg(argv[++i], &opts->confidence)) {
+                fprintf(stderr, "Invalid confidence '%s' (a percentage, e.g. 95 or 99.9).\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--tolerance") == 0 && i + 1 < argc) {
+            if (!parse_percent_arg(argv[++i], &opts->tolerance)) {
+                fprintf(stderr, "Invalid tolerance '%s' (a percentage, e.g. 0.1).\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--max-concurrent") == 0 && i + 1 < argc) {
+            int limit = atoi(argv[++i]);
+            if (limit < 1 || limit > SCAN_SCHEDULER_MAX_JOBS) {
+                fprintf(stderr, "Invalid concurrency limit '%s' (1-%d).\n", argv[i], SCAN_SCHEDULER_MAX_JOBS);
+                return 1;
+            }
+            *max_concurrent = (unsigned)limit;
+        } else if (strcmp(arg, "--max-mbps") == 0 && i + 1 < argc) {
+            double mbps = 0.0;
+            if (!parse_positive_arg(argv[++i], &mbps)) {
+                fprintf(stderr, "Invalid bandwidth limit '%s' (MB/s, e.g. 50).\n", argv[i]);
+                return 1;
+            }
+            controls->max_bytes_per_sec = (uint64_t)(mbps * 1024.0 * 1024.0);
+            opts->controls = controls;
+        } else if (strcmp(arg, "--max-iops") == 0 && i + 1 < argc) {
+            double iops = 0.0;
+            if (!parse_positive_arg(argv[++i], &iops) || iops < 1.0) {
+                fprintf(stderr, "Invalid IOPS limit '%s' (reads per second, e.g. 200).\n", argv[i]);
+                return 1;
+            }
+            controls->max_iops = (uint64_t)iops;
+            opts->controls = controls;
+        } else if (strcmp(arg, "--latency-target") == 0 && i + 1 < argc) {
+            double ms = 0.0;
+            if (!parse_positive_arg(argv[++i], &ms)) {
+                fprintf(stderr, "Invalid latency target '%s' (milliseconds, e.g. 20).\n", argv[i]);
+                return 1;
+            }
+            controls->latency_target_us = (uint64_t)(ms * 1000.0);
+            if (controls->latency_target_us == 0) controls->latency_target_us = 1;
+            opts->controls = controls;
+        } else if (strcmp(arg, "--idle") == 0) {
+            controls->idle_priority = true;
+            opts->controls = controls;
+        } else if (strcmp(arg, "--idle-aware") == 0) {
+            controls->idle_aware = true;
+            opts->controls = controls;
+        } else if (strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            int threads = strcmp(value, "auto") == 0 ? SCAN_THREADS_AUTO : atoi(value);
+            if (threads < 0 || threads > SCAN_MAX_THREADS || (threads == 0 && strcmp(value, "auto") != 0)) {
+                fprintf(stderr, "Invalid thread count '%s' (1-%d or auto).\n", value, SCAN_MAX_THREADS);
+                return 1;
+            }
+            opts->threads = (unsigned)threads;
+        } else {
+            fprintf(stderr, "Unknown surface scan option '%s'.\n", arg);
+            return 1;
+        }
+    }
+    if (opts->engine == SCAN_ENGINE_MEDIA_VERIFY) {
+        // O disco não devolve os dados: não há o que comparar nem classificar.
+        if (opts->verify || opts->classify) {
+            fprintf(stderr, "--engine media-verify cannot be combined with %s, which needs the data read.\n", opts->verify ? "--verify" : "--classify");
+            return 1;
+        }
+        if (!block_size_set && opts->mode && strcmp(opts->mode, "deep") == 0) {
+            opts->block_size = SCAN_MEDIA_VERIFY_BLOCK_SIZE;
+        }
+    }
+    return 0;
+}
+
+// --idle-aware depende dos contadores de I/O do disco; sem eles o scan roda sem ceder.
+static void warn_idle_aware_unsupported(const char* const* paths, size_t count, const scan_controls_t* controls) {
+    if (!controls->idle_aware) return;
+    for (size_t i = 0; i < count; ++i) {
+        pal_io_counters_t counters;
+        if (pal_get_io_counters(paths[i], &counters) != PAL_STATUS_SUCCESS) {
+            fprintf(stderr, "Warning: No I/O counters for %s; --idle-aware cannot watch it for foreground I/O.\n", paths[i]);
+        }
+    }
+}
+
+#define SURFACE_SCAN_USAGE_OPTIONS "[--deep] [--verify] [--classify] [--direct] [--engine sync|uring|media-verify] [--block-size N] [--qd N] [--auto-tune] [--threads N|auto] [--order sequential|reverse|strided|random|butterfly] [--stride N] [--resume] [--journal FILE] [--allocated MOUNTPOINT] [--map-files MOUNTPOINT] [--samples N] [--confidence PCT] [--tolerance PCT] [--max-mbps N] [--max-iops N] [--latency-target MS] [--idle] [--idle-aware] [--max-concurrent N]"
+
 int handle_surface_scan(int argc, char* argv[]) {
     if (argc < 3) {
         style_set_fg(COLOR_BRIGHT_YELLOW);
         fprintf(stderr, "The Oracle requires a focus, a sacrifice... a device path.\n");
         style_reset();
-        fprintf(stderr, "Usage: diskoracle --surface <device_path>\n");
+        fprintf(stderr, "Usage: diskoracle --surface <device_path> [<device_path> ...] " SURFACE_SCAN_USAGE_OPTIONS "\n");
+        return 1;
+    }
+
+    // Os caminhos vêm antes das opções; mais de um caminho liga o modo multi-dispositivo.
+    int first_option = 2;
+    while (first_option < argc && strncmp(argv[first_option], "--", 2) != 0) {
+        first_option++;
+    }
+    size_t device_count = (size_t)(first_option - 2);
+    if (device_count == 0) {
+        fprintf(stderr, "Usage: diskoracle --surface <device_path> [<device_path> ...] " SURFACE_SCAN_USAGE_OPTIONS "\n");
+        return 1;
+    }
+    if (device_count > SCAN_SCHEDULER_MAX_JOBS) {
+        fprintf(stderr, "Too many devices (at most %d per run).\n", SCAN_SCHEDULER_MAX_JOBS);
+        return 1;
+    }
+
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    scan_controls_t controls;
+    memset(&controls, 0, sizeof(controls));
+    unsigned max_concurrent = SCAN_SCHEDULER_DEFAULT_CONCURRENCY;
+    if (parse_surface_scan_options(argc, argv, first_option, &opts, &controls, &max_concurrent) != 0) {
         return 1;
     }
-    run_surface_scan_command(argv[2]);
+
+    warn_idle_aware_unsupported((const char* const*)&argv[2], device_count, &controls);
+    if (device_count == 1) {
+        run_surface_scan_command(argv[2], &opts);
+        return 0;
+    }
+    if (opts.journal_path != NULL) {
+        fprintf(stderr, "--journal names a single checkpoint file; it cannot be used with several devices.\n");
+        return 1;
+    }
+    if (opts.allocated_path != NULL || opts.map_files_path != NULL) {
+        fprintf(stderr, "%s names one filesystem; it cannot be used with several devices.\n", opts.allocated_path ? "--allocated" : "--map-files");
+        return 1;
+    }
+    run_surface_scan_fleet((const char* const*)&argv[2], device_count, &opts, max_concurrent);
+    return 0;
+}
+
+int handle_surface_scan_all(int argc, char* argv[]) {
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    scan_controls_t controls;
+    memset(&controls, 0, sizeof(controls));
+    unsigned max_concurrent = SCAN_SCHEDULER_DEFAULT_CONCURRENCY;
+    if (parse_surface_scan_options(argc, argv, 2, &opts, &controls, &max_concurrent) != 0) {
+        fprintf(stderr, "Usage: diskoracle --surface-all " SURFACE_SCAN_USAGE_OPTIONS "\n");
+        return 1;
+    }
+    if (opts.journal_path != NULL || opts.allocated_path != NULL || opts.map_files_path != NULL) {
+        fprintf(stderr, "%s applies to a single device; it cannot be used with --surface-all.\n",
+                opts.journal_path ? "--journal" : opts.allocated_path ? "--allocated" : "--map-files");
+        return 1;
+    }
+
+    DriveInfo drives[MAX_DRIVES];
+    int drive_count = 0;
+    if (pal_list_drives(drives, MAX_DRIVES, &drive_count) != PAL_STATUS_SUCCESS || drive_count <= 0) {
+        fprintf(stderr, "Error: No drives found to scan.\n");
+        return 1;
+    }
+
+    const char* paths[MAX_DRIVES];
+    for (int i = 0; i < drive_count; ++i) {
+        paths[i] = drives[i].device_path;
+    }
+    warn_idle_aware_unsupported(paths, (size_t)drive_count, &controls);
+    run_surface_scan_fleet(paths, (size_t)drive_count, &opts, max_concurrent);
+    return 0;
+}
+
+// Duração como "90" (segundos), "30m", "2h" ou "1d".
+static bool parse_duration_arg(const char* text, double* seconds) {
+    char* end = NULL;
+    double value = strtod(text, &end);
+    if (end == text || !(value > 0.0)) return false;
+    if (*end == 's') end++;
+    else if (*end == 'm') { value *= 60.0; end++; }
+    else if (*end == 'h') { value *= 3600.0; end++; }
+    else if (*end == 'd') { value *= 86400.0; end++; }
+    if (*end != '\0') return false;
+    *seconds = value;
+    return true;
+}
+
+// Quantidade de bytes de 64 bits: "500M", "100G", "2T".
+static bool parse_byte_count_arg(const char* text, uint64_t* out) {
+    char* end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || value == 0) return false;
+    unsigned shift = 0;
+    switch (*end) {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+        case 't': case 'T': shift = 40; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || value > (UINT64_MAX >> shift)) return false;
+    *out = (uint64_t)value << shift;
+    return true;
+}
+
+#define PATROL_USAGE "Usage: diskoracle --patrol <device_path> [--budget-time 30m|2h|1d] [--budget-bytes N[M|G|T]] [--cycle-days N] [--state FILE] [--engine sync|uring|media-verify] [--block-size N] [--max-mbps N] [--idle] [--idle-aware] ...\n"
+
+int handle_patrol(int argc, char* argv[]) {
+    if (argc < 3 || strncmp(argv[2], "--", 2) == 0) {
+        fprintf(stderr, PATROL_USAGE);
+        return 1;
+    }
+
+    // As opções da patrulha saem daqui; o resto vai para o parser do scan de superfície.
+    scan_patrol_budget_t budget;
+    memset(&budget, 0, sizeof(budget));
+    const char* state_path = NULL;
+    char** scan_args = (char**)calloc((size_t)argc, sizeof(char*));
+    if (scan_args == NULL) return 1;
+    int scan_argc = 0;
+    for (int i = 3; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--budget-time") == 0 && i + 1 < argc) {
+            if (!parse_duration_arg(argv[++i], &budget.seconds)) {
+                fprintf(stderr, "Invalid time budget '%s' (e.g. 900, 30m, 2h).\n", argv[i]);
+                free(scan_args);
+                return 1;
+            }
+        } else if (strcmp(arg, "--budget-bytes") == 0 && i + 1 < argc) {
+            if (!parse_byte_count_arg(argv[++i], &budget.bytes)) {
+                fprintf(stderr, "Invalid byte budget '%s' (e.g. 500M, 100G).\n", argv[i]);
+                free(scan_args);
+                return 1;
+            }
+        } else if (strcmp(arg, "--cycle-days") == 0 && i + 1 < argc) {
+            if (!parse_positive_arg(argv[++i], &budget.cycle_days)) {
+                fprintf(stderr, "Invalid cycle '%s' (days for a full pass, e.g. 7).\n", argv[i]);
+                free(scan_args);
+                return 1;
+            }
+        } else if (strcmp(arg, "--state") == 0 && i + 1 < argc) {
+            state_path = argv[++i];
+        } else if (strcmp(arg, "--resume") == 0 || strcmp(arg, "--journal") == 0 || strcmp(arg, "--quick") == 0 ||
+                   strcmp(arg, "--samples") == 0 || strcmp(arg, "--allocated") == 0 || strcmp(arg, "--map-files") == 0 ||
+                   strcmp(arg, "--order") == 0 || strcmp(arg, "--stride") == 0) {
+            fprintf(stderr, "%s does not apply to --patrol, which keeps its own cursor.\n", arg);
+            free(scan_args);
+            return 1;
+        } else {
+            scan_args[scan_argc++] = argv[i];
+        }
+    }
+
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    scan_controls_t controls;
+    memset(&controls, 0, sizeof(controls));
+    unsigned max_concurrent = 1;
+    int parsed = parse_surface_scan_options(scan_argc, scan_args, 0, &opts, &controls, &max_concurrent);
+    free(scan_args);
+    if (parsed != 0) {
+        fprintf(stderr, PATROL_USAGE);
+        return 1;
+    }
+
+    // Sem limite nenhum, uma execução não passa de meia hora.
+    if (budget.bytes == 0 && budget.seconds == 0.0 && budget.cycle_days == 0.0) {
+        budget.seconds = SCAN_PATROL_DEFAULT_BUDGET_SECONDS;
+    }
+
+    const char* path = argv[2];
+    warn_idle_aware_unsupported(&path, 1, &controls);
+    return run_patrol_command(argv[2], &opts, &budget, state_path);
+}
+
+#define PROFILE_USAGE "Usage: diskoracle --profile <device_path> [--zones N] [--zone-size N[M|G]] [--baseline FILE] [--save-baseline] [--engine sync|uring] [--block-size N] [--qd N] [--cached]\n"
+
+int handle_profile(int argc, char* argv[]) {
+    if (argc < 3 || strncmp(argv[2], "--", 2) == 0) {
+        fprintf(stderr, PROFILE_USAGE);
+        return 1;
+    }
+
+    // Leituras grandes e sem page cache por padrão: a taxa medida é a da mídia.
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    opts.mode = "deep";
+    opts.block_size = SCAN_PROFILE_DEFAULT_BLOCK_SIZE;
+    opts.direct_io = true;
+
+    unsigned zones = 0;
+    uint64_t zone_bytes = 0;
+    const char* baseline_path = NULL;
+    bool save_baseline = false;
+    char** scan_args = (char**)calloc((size_t)argc, sizeof(char*));
+    if (scan_args == NULL) return 1;
+    int scan_argc = 0;
+    for (int i = 3; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--zones") == 0 && i + 1 < argc) {
+            int count = atoi(argv[++i]);
+            if (count < 1 || count > SCAN_PROFILE_MAX_ZONES) {
+                fprintf(stderr, "Invalid zone count '%s' (1-%d).\n", argv[i], SCAN_PROFILE_MAX_ZONES);
+                free(scan_args);
+                return 1;
+            }
+            zones = (unsigned)count;
+        } else if (strcmp(arg, "--zone-size") == 0 && i + 1 < argc) {
+            if (!parse_byte_count_arg(argv[++i], &zone_bytes)) {
+                fprintf(stderr, "Invalid zone size '%s' (e.g. 256M, 1G).\n", argv[i]);
+                free(scan_args);
+                return 1;
+            }
+        } else if (strcmp(arg, "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(arg, "--save-baseline") == 0) {
+            save_baseline = true;
+        } else if (strcmp(arg, "--cached") == 0) {
+            opts.direct_io = false;
+        } else if (strcmp(arg, "--engine") == 0 || strcmp(arg, "--block-size") == 0 || strcmp(arg, "--qd") == 0) {
+            scan_args[scan_argc++] = argv[i];
+            if (i + 1 < argc) scan_args[scan_argc++] = argv[++i];
+        } else if (strcmp(arg, "--direct") == 0) {
+            continue;
+        } else {
+            // Throttle, ordem, threads e verificação distorceriam a taxa medida.
+            fprintf(stderr, "%s does not apply to --profile, which reads each zone sequentially at full speed.\n", arg);
+            free(scan_args);
+            return 1;
+        }
+    }
+
+    scan_controls_t controls;
+    memset(&controls, 0, sizeof(controls));
+    unsigned max_concurrent = 1;
+    int parsed = parse_surface_scan_options(scan_argc, scan_args, 0, &opts, &controls, &max_concurrent);
+    free(scan_args);
+    if (parsed != 0) {
+        fprintf(stderr, PROFILE_USAGE);
+        return 1;
+    }
+    if (opts.engine == SCAN_ENGINE_MEDIA_VERIFY) {
+        fprintf(stderr, "--engine media-verify does not apply to --profile, which measures data transfers.\n");
+        return 1;
+    }
+    return run_profile_command(argv[2], &opts, zones, zone_bytes, baseline_path, save_baseline);
+}
+
+#define BENCHMARK_USAGE "Usage: diskoracle --benchmark <device_path> [--duration 5|30s|1m] [--max-qd N] [--engine sync|uring] [--cached]\n"
+
+int handle_benchmark(int argc, char* argv[]) {
+    if (argc < 3 || strncmp(argv[2], "--", 2) == 0) {
+        fprintf(stderr, BENCHMARK_USAGE);
+        return 1;
+    }
+
+    // Sem page cache por padrão: cada leitura vai ao disco.
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    opts.direct_io = true;
+
+    double seconds = 0.0;
+    uint32_t max_queue_depth = 0;
+    for (int i = 3; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--duration") == 0 && i + 1 < argc) {
+            if (!parse_duration_arg(argv[++i], &seconds)) {
+                fprintf(stderr, "Invalid duration '%s' (seconds per configuration, e.g. 5, 30s, 1m).\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--max-qd") == 0 && i + 1 < argc) {
+            int qd = atoi(argv[++i]);
+            if (qd < 1 || qd > SCAN_BENCH_MAX_QUEUE_DEPTH) {
+                fprintf(stderr, "Invalid queue depth '%s' (1-%d).\n", argv[i], SCAN_BENCH_MAX_QUEUE_DEPTH);
+                return 1;
+            }
+            max_queue_depth = (uint32_t)qd;
+        } else if (strcmp(arg, "--cached") == 0) {
+            opts.direct_io = false;
+        } else if (strcmp(arg, "--direct") == 0) {
+            continue;
+        } else if (strcmp(arg, "--engine") == 0 && i + 1 < argc) {
+            scan_controls_t controls;
+            memset(&controls, 0, sizeof(controls));
+            unsigned max_concurrent = 1;
+            if (parse_surface_scan_options(2, &argv[i], 0, &opts, &controls, &max_concurrent) != 0) return 1;
+            i++;
+        } else {
+            fprintf(stderr, "%s does not apply to --benchmark.\n", arg);
+            fprintf(stderr, BENCHMARK_USAGE);
+            return 1;
+        }
+    }
+    if (opts.engine == SCAN_ENGINE_MEDIA_VERIFY) {
+        fprintf(stderr, "--engine media-verify does not apply to --benchmark, which measures data transfers.\n");
+        return 1;
+    }
+    return run_benchmark_command(argv[2], &opts, seconds, max_queue_depth);
+}
+
+// Colunas mostradas por --latency-map: quatro linhas de 64.
+#define LATENCY_MAP_VIEW_CELLS 256
+
+int handle_latency_map(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: diskoracle --latency-map <file> [<first_lba> <last_lba>]\n");
+        return 1;
+    }
+
+    // Uma consulta de faixa vazia só lê o cabeçalho, para saber a geometria.
+    // Sem faixa, mostra o disco inteiro; com faixa, amplia só aquele trecho.
+    uint64_t device_size = 0;
+    uint32_t sector_size = 0;
+    latency_cell_t cells[LATENCY_MAP_VIEW_CELLS];
+    if (latency_map_file_query(argv[2], 0, 0, cells, 1, &device_size, &sector_size) != 0 || sector_size == 0) {
+        fprintf(stderr, "Error: '%s' is not a valid latency map.\n", argv[2]);
+        return 1;
+    }
+    uint64_t first_lba = 0, last_lba = device_size / sector_size - 1;
+    if (argc >= 5) {
+        first_lba = strtoull(argv[3], NULL, 0);
+        last_lba = strtoull(argv[4], NULL, 0);
+        if (last_lba < first_lba || last_lba >= device_size / sector_size) {
+            fprintf(stderr, "Invalid LBA range %s-%s (the map covers 0-%llu).\n", argv[3], argv[4],
+                    (unsigned long long)(device_size / sector_size - 1));
+            return 1;
+        }
+    }
+
+    uint64_t lbas = last_lba - first_lba + 1;
+    if (latency_map_file_query(argv[2], first_lba * sector_size, (last_lba + 1) * sector_size, cells, LATENCY_MAP_VIEW_CELLS, NULL, NULL) != 0) {
+        fprintf(stderr, "Error: Could not read '%s'.\n", argv[2]);
+        return 1;
+    }
+
+    printf("Latency map %s: LBA %llu-%llu (%u-byte sectors)\n", argv[2], (unsigned long long)first_lba,
+           (unsigned long long)last_lba, sector_size);
+    ui_display_latency_heatmap(cells, LATENCY_MAP_VIEW_CELLS, first_lba, (lbas + LATENCY_MAP_VIEW_CELLS - 1) / LATENCY_MAP_VIEW_CELLS);
     return 0;
 }
 
@@ -231,13 +790,31 @@ int handle_smart_json(int argc, char* argv[]) {
         style_set_fg(COLOR_BRIGHT_YELLOW);
         fprintf(stderr, "The Oracle cannot weave prophecies into JSON without a device path.\n");
         style_reset();
-        fprintf(stderr, "Usage: diskoracle --smart-json <device_path> [output_file]\n");
+        fprintf(stderr, "Usage: diskoracle --smart-json <device_path> [output_file] [--bad-index FILE --map-files MOUNTPOINT]\n");
         return 1;
     }
     const char* device_path = argv[2];
-    const char* output_file = (argc > 3) ? argv[3] : NULL; // Arquivo de saída é opcional
+    const char* output_file = NULL; // Arquivo de saída é opcional
+    const char* bad_index_path = NULL;
+    const char* map_files_path = NULL;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--bad-index") == 0 && i + 1 < argc) {
+            bad_index_path = argv[++i];
+        } else if (strcmp(argv[i], "--map-files") == 0 && i + 1 < argc) {
+            map_files_path = argv[++i];
+        } else if (output_file == NULL && strncmp(argv[i], "--", 2) != 0) {
+            output_file = argv[i];
+        } else {
+            fprintf(stderr, "Usage: diskoracle --smart-json <device_path> [output_file] [--bad-index FILE --map-files MOUNTPOINT]\n");
+            return 1;
+        }
+    }
+    if ((bad_index_path == NULL) != (map_files_path == NULL)) {
+        fprintf(stderr, "--bad-index and --map-files go together: the index saved by a surface scan and the filesystem to map it to.\n");
+        return 1;
+    }
 
-    return execute_json_export_command(device_path, output_file);
+    return execute_json_export_command(device_path, output_file, bad_index_path, map_files_path);
 }
 
 void handle_error_log_command(const char* device_path) {
@@ -5,14 +5,22 @@
 #include "../include/report.h" 
 #include <stdio.h>    
 #include <string.h>   
+#include <stdlib.h>
 #include <inttypes.h> 
 #include "surface.h"
+#include "scan_journal.h"
+#include "scan_patrol.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
+#include "scan_tune.h"
+#include "scan_scheduler.h"
 #include "ui.h"
 #include <unistd.h> 
 #ifdef _WIN32
 #include <windows.h> 
 #endif
 #include <errno.h>
+#include <signal.h>
 
 // Using the correct 'CriticalAttributeRule' struct from 'info.h'.
 // The local, conflicting definition has been removed.
@@ -24,14 +32,189 @@ static const CriticalAttributeRule critical_rules[] = {
     {199, "UDMA CRC Error Count", 0, "This often points to a faulty SATA cable or a poor connection between the drive and the motherboard, causing data transmission errors. Before replacing the drive, try replacing the SATA cable."}
 };
 
-static scan_state_t g_final_scan_state;
+// Ctrl+C, kill ou queda da sessão: pede aos scans que parem e gravem o checkpoint.
+static void scan_signal_handler(int sig) {
+    (void)sig;
+    surface_scan_request_stop();
+}
+
+#if defined(SIGUSR1) && defined(SIGUSR2)
+// SIGUSR1 deixa o scan em segundo plano mais lento, SIGUSR2 mais rápido.
+// O handler só anota o pedido; o callback de progresso aplica os novos limites.
+static volatile sig_atomic_t g_throttle_request = 0;
+
+static void scan_throttle_signal_handler(int sig) {
+    g_throttle_request = sig == SIGUSR1 ? -1 : 1;
+}
+#endif
+
+static void scan_signals_install(void) {
+    signal(SIGINT, scan_signal_handler);
+    signal(SIGTERM, scan_signal_handler);
+#ifdef SIGHUP
+    signal(SIGHUP, scan_signal_handler);
+#endif
+#if defined(SIGUSR1) && defined(SIGUSR2)
+    g_throttle_request = 0;
+    signal(SIGUSR1, scan_throttle_signal_handler);
+    signal(SIGUSR2, scan_throttle_signal_handler);
+#endif
+}
+
+static void scan_signals_restore(void) {
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+#ifdef SIGHUP
+    signal(SIGHUP, SIG_DFL);
+#endif
+#if defined(SIGUSR1) && defined(SIGUSR2)
+    signal(SIGUSR1, SIG_DFL);
+    signal(SIGUSR2, SIG_DFL);
+#endif
+}
+
+// Pedido pendente de SIGUSR1/SIGUSR2 (-1 mais lento, 1 mais rápido, 0 nenhum).
+static int scan_take_throttle_request(void) {
+#if defined(SIGUSR1) && defined(SIGUSR2)
+    int request = g_throttle_request;
+    g_throttle_request = 0;
+    return request;
+#else
+    return 0;
+#endif
+}
+
+// Divide ou dobra os limites de um scan em andamento. Sem teto de banda, o
+// primeiro pedido de desaceleração parte da velocidade atual.
+static void scan_adjust_limits(scan_controls_t* controls, const scan_state_t* state, int direction) {
+    if (controls == NULL || direction == 0) return;
+    uint64_t bps = controls->max_bytes_per_sec;
+    uint64_t iops = controls->max_iops;
+    if (direction < 0) {
+        if (bps == 0) {
+            bps = state->throttle_bytes_per_sec ? state->throttle_bytes_per_sec
+                                                : (uint64_t)(state->current_speed_mbps * 1024.0 * 1024.0);
+        }
+        bps /= 2;
+        if (bps < 1024 * 1024) bps = 1024 * 1024;
+        iops /= 2;
+        if (controls->max_iops > 0 && iops == 0) iops = 1;
+    } else {
+        bps *= 2;
+        iops *= 2;
+    }
+    scan_controls_set_limits(controls, bps, iops);
+}
 
-// Callback local para atualizar a UI durante o scan e salvar o estado final.
-static void scan_progress_callback(const scan_state_t* state, void* user_data) {
-    BasicDriveInfo* drive_info = (BasicDriveInfo*)user_data;
-    // A função ui_draw_scan_progress já sabe como desenhar a barra de progresso.
-    ui_draw_scan_progress(state, drive_info);
-    memcpy(&g_final_scan_state, state, sizeof(scan_state_t));
+// Callback do scan de um só dispositivo: aplica ajustes de limite e desenha a barra de progresso.
+static void scan_progress_callback(const scan_job_t* job, const scan_state_t* state, void* user_data) {
+    (void)user_data;
+    scan_adjust_limits(state->controls, state, scan_take_throttle_request());
+    ui_draw_scan_progress(state, &job->drive_info);
+}
+
+static void scan_dashboard_tick(scan_job_t* jobs, size_t count, void* user_data) {
+    (void)user_data;
+    // Com vários dispositivos o ajuste vale para todos os scans limitados.
+    int direction = scan_take_throttle_request();
+    for (size_t i = 0; direction != 0 && i < count; ++i) {
+        scan_state_t state;
+        scan_job_status_t status;
+        scan_job_snapshot(&jobs[i], &state, &status);
+        if (status == SCAN_JOB_RUNNING || status == SCAN_JOB_PENDING) {
+            scan_adjust_limits(jobs[i].opts.controls, &state, direction);
+        }
+    }
+    ui_draw_scan_dashboard(jobs, count);
+}
+
+// Grava o relatório JSON e, se o scan terminou, o índice de setores ruins e o mapa de latência.
+static void save_scan_reports(scan_job_t* job) {
+    if (job->state.scanned_blocks > 0) {
+        if (report_save_scan_json(job->device_path, &job->state, job->report_path, sizeof(job->report_path)) == 0) {
+            printf("Scan report saved to: %s\n", job->report_path);
+        }
+    }
+
+    // A lista completa de LBAs ruins fica num arquivo binário junto dos relatórios.
+    if (job->rc == 0 && job->opts.bad_index && bad_extent_index_sectors(job->opts.bad_index) > 0) {
+        char index_path[1024];
+        if (report_save_bad_extents(job->device_path, job->opts.bad_index, index_path, sizeof(index_path)) == 0) {
+            printf("Bad sector index saved to: %s\n", index_path);
+        }
+    }
+    if (job->rc == 0 && latency_map_device_size(job->opts.latency_map) > 0) {
+        char map_path[1024];
+        if (report_save_latency_map(job->device_path, job->opts.latency_map, map_path, sizeof(map_path)) == 0) {
+            printf("Latency map saved to: %s (view with --latency-map)\n", map_path);
+        }
+    }
+}
+
+static void warn_unfinished_journal(const scan_job_t* job) {
+    if (job->opts.journal_path && !job->opts.resume && scan_journal_exists(job->opts.journal_path)) {
+        printf("Note: an unfinished scan checkpoint exists (%s); starting over. Use --resume to continue it.\n", job->opts.journal_path);
+    }
+}
+
+// Num resume os modos do checkpoint prevalecem sobre os da linha de comando.
+static void note_resumed_modes(const scan_job_t* job, const scan_options_t* opts) {
+    if (!job->opts.resume || opts == NULL) return;
+    bool same_allocated = (opts->allocated_path == NULL) == (job->opts.allocated_path == NULL) &&
+                          (opts->allocated_path == NULL || strcmp(opts->allocated_path, job->opts.allocated_path) == 0);
+    if (opts->verify == job->opts.verify && opts->classify == job->opts.classify && same_allocated) return;
+    printf("Note: resuming with the modes of the checkpoint: %s, %s, %s%s.\n",
+           job->opts.verify ? "--verify" : "no --verify",
+           job->opts.classify ? "--classify" : "no --classify",
+           job->opts.allocated_path ? "--allocated " : "whole device",
+           job->opts.allocated_path ? job->opts.allocated_path : "");
+}
+
+static void tune_progress_callback(const scan_state_t* state, void* user_data) {
+    (void)user_data;
+    printf("\rCalibrating: %5uK blocks %8.1f MB/s   ", state->block_size / 1024, state->current_speed_mbps);
+    fflush(stdout);
+}
+
+// --auto-tune: mede o dispositivo e troca o bloco e a fila do job pelos mais
+// rápidos. Retorna 1 só se a calibração foi interrompida (o scan não deve começar).
+static int auto_tune_job(scan_job_t* job) {
+    if (!job->opts.auto_tune) return 0;
+    if (job->opts.resume) {
+        printf("Note: --auto-tune skipped; a resumed scan keeps the settings of its checkpoint.\n");
+        return 0;
+    }
+
+    printf("Auto-tuning block size and queue depth for %s...\n", job->device_path);
+    scan_tune_result_t* result = (scan_tune_result_t*)malloc(sizeof(scan_tune_result_t));
+    if (result == NULL) {
+        fprintf(stderr, "Error: Not enough memory to auto-tune %s.\n", job->device_path);
+        return 0;
+    }
+    scan_signals_install();
+    int rc = scan_tune_run(job->device_path, &job->opts, 0.0, tune_progress_callback, NULL, result);
+    scan_signals_restore();
+    printf("\r%60s\r", "");
+
+    int interrupted = 0;
+    if (rc != 0) {
+        interrupted = result->interrupted;
+        if (interrupted) printf("Auto-tune interrupted; the scan was not started.\n");
+        else fprintf(stderr, "Warning: Auto-tune could not read %s; keeping --block-size %u --qd %u.\n",
+                     job->device_path, job->opts.block_size, job->opts.queue_depth);
+    } else {
+        job->opts.block_size = result->block_size;
+        job->opts.queue_depth = result->queue_depth;
+        ui_display_tune_result(result);
+        printf("Auto-tune picked --block-size %u --qd %u (%.1f MB/s); pass these instead of --auto-tune to pin them.\n",
+               result->block_size, result->queue_depth, result->mbps);
+        char tune_path[1024];
+        if (report_save_tune_json(job->device_path, result, tune_path, sizeof(tune_path)) == 0) {
+            printf("Auto-tune report saved to: %s\n", tune_path);
+        }
+    }
+    free(result);
+    return interrupted;
 }
 
 static const char* smart_status_to_string(SmartStatus status) {
@@ -125,18 +308,30 @@ void display_drive_info(const char *device_path) {
  * initializes the UI, runs the scan, cleans up the UI, and displays the final report.
  * 
  * @param device_path The system path to the device (e.g., \\.\PhysicalDrive0).
+ * @param opts Scan options parsed from the command line, or NULL for a default quick scan.
  */
-void run_surface_scan_command(const char *device_path) {
+void run_surface_scan_command(const char *device_path, const scan_options_t *opts) {
     if (device_path == NULL) {
         fprintf(stderr, "Error: A device path must be provided for the surface scan.\n");
         return;
     }
 
-    BasicDriveInfo drive_info;
-    memset(&drive_info, 0, sizeof(BasicDriveInfo));
-    pal_get_basic_drive_info(device_path, &drive_info);
-    
-    printf("Preparing surface scan for %s (%s)...\n", drive_info.path, drive_info.model);
+    scan_job_t* job = (scan_job_t*)malloc(sizeof(scan_job_t));
+    if (job == NULL || scan_job_init(job, device_path, opts) != 0) {
+        fprintf(stderr, "Error: Not enough memory to prepare the surface scan.\n");
+        free(job);
+        return;
+    }
+    job->on_progress = scan_progress_callback;
+
+    printf("Preparing surface scan for %s (%s)...\n", job->drive_info.path, job->drive_info.model);
+    warn_unfinished_journal(job);
+    note_resumed_modes(job, opts);
+    if (auto_tune_job(job) != 0) {
+        scan_job_release(job);
+        free(job);
+        return;
+    }
 
     #ifdef _WIN32
         Sleep(1500);
@@ -145,10 +340,385 @@ void run_surface_scan_command(const char *device_path) {
     #endif
 
     ui_init(); 
-    surface_scan(device_path, "quick", scan_progress_callback, &drive_info, &g_final_scan_state);
+    scan_signals_install();
+    scan_job_run(job);
+    scan_signals_restore();
     ui_cleanup(); 
 
-    ui_display_scan_report(&g_final_scan_state, &drive_info);
+    ui_display_scan_report(&job->state, &job->drive_info);
+    ui_display_bad_extents(job->extents, job->extent_count, job->state.bad_extents, job->sector_size);
+    ui_display_file_damage(job->state.file_damage);
+    save_scan_reports(job);
+
+    scan_job_release(job);
+    free(job);
+}
+
+void run_surface_scan_fleet(const char *const *device_paths, size_t count, const scan_options_t *opts, unsigned max_concurrent) {
+    if (device_paths == NULL || count == 0) {
+        fprintf(stderr, "Error: No devices to scan.\n");
+        return;
+    }
+
+    scan_job_t* jobs = (scan_job_t*)calloc(count, sizeof(scan_job_t));
+    if (jobs == NULL) {
+        fprintf(stderr, "Error: Not enough memory to prepare the surface scans.\n");
+        return;
+    }
+    size_t prepared = 0;
+    for (; prepared < count; ++prepared) {
+        if (scan_job_init(&jobs[prepared], device_paths[prepared], opts) != 0) {
+            fprintf(stderr, "Error: Not enough memory to prepare the surface scan of %s.\n", device_paths[prepared]);
+            break;
+        }
+        warn_unfinished_journal(&jobs[prepared]);
+        note_resumed_modes(&jobs[prepared], opts);
+        if (auto_tune_job(&jobs[prepared]) != 0) {
+            scan_job_release(&jobs[prepared]);
+            break;
+        }
+    }
+
+    if (prepared == count) {
+        printf("Preparing surface scans of %zu devices, up to %u at a time...\n", count, max_concurrent ? max_concurrent : (unsigned)count);
+        #ifdef _WIN32
+            Sleep(1500);
+        #else
+            sleep(1);
+        #endif
+
+        ui_init();
+        scan_signals_install();
+        scan_scheduler_run(jobs, count, max_concurrent, scan_dashboard_tick, NULL);
+        scan_signals_restore();
+        ui_cleanup();
+
+        ui_display_scan_summary(jobs, count);
+        printf("\n");
+        for (size_t i = 0; i < count; ++i) {
+            save_scan_reports(&jobs[i]);
+        }
+        char summary_path[1024];
+        if (report_save_scan_summary_json(jobs, count, summary_path, sizeof(summary_path)) == 0) {
+            printf("Scan summary saved to: %s\n", summary_path);
+        }
+    }
+
+    for (size_t i = 0; i < prepared; ++i) {
+        scan_job_release(&jobs[i]);
+    }
+    free(jobs);
+}
+
+// Callback da patrulha: o mesmo da barra de progresso, com o job no user_data.
+static void patrol_progress_callback(const scan_state_t* state, void* user_data) {
+    scan_progress_callback((const scan_job_t*)user_data, state, NULL);
+}
+
+int run_patrol_command(const char *device_path, const scan_options_t *opts, const scan_patrol_budget_t *budget, const char *state_path) {
+    if (device_path == NULL || budget == NULL) {
+        fprintf(stderr, "Error: A device path must be provided for the patrol.\n");
+        return 1;
+    }
+
+    int64_t device_size = pal_get_device_size(device_path);
+    if (device_size <= 0) {
+        fprintf(stderr, "Error: Could not determine the size of %s.\n", device_path);
+        return 1;
+    }
+
+    scan_job_t* job = (scan_job_t*)malloc(sizeof(scan_job_t));
+    if (job == NULL || scan_job_init(job, device_path, opts) != 0) {
+        fprintf(stderr, "Error: Not enough memory to prepare the patrol.\n");
+        free(job);
+        return 1;
+    }
+
+    char default_path[512];
+    if (state_path == NULL) {
+        pal_ensure_directory_exists("reports");
+        scan_patrol_default_path(job->drive_info.serial, device_path, default_path, sizeof(default_path));
+        state_path = default_path;
+    }
+
+    // Outro disco no mesmo caminho (ou o mesmo disco com outro tamanho) começa uma patrulha nova.
+    scan_patrol_t patrol;
+    int64_t now = (int64_t)time(NULL);
+    if (scan_patrol_load(state_path, &patrol) != 0) {
+        printf("Starting a new patrol of %s (state: %s).\n", device_path, state_path);
+        scan_patrol_init(&patrol, device_path, job->drive_info.serial, (uint64_t)device_size, now);
+    } else if (patrol.device_size != (uint64_t)device_size ||
+               (job->drive_info.serial[0] && strncmp(patrol.serial, job->drive_info.serial, sizeof(patrol.serial) - 1) != 0)) {
+        printf("Note: %s belongs to another drive or size; starting a new patrol.\n", state_path);
+        scan_patrol_init(&patrol, device_path, job->drive_info.serial, (uint64_t)device_size, now);
+    }
+    uint64_t start_cursor = patrol.cursor;
+    uint64_t start_passes = patrol.passes;
+    if (auto_tune_job(job) != 0) {
+        scan_job_release(job);
+        free(job);
+        return 1;
+    }
+
+    printf("Patrolling %s (%s) from %.1f%%...\n", job->drive_info.path, job->drive_info.model,
+           100.0 * (double)patrol.cursor / (double)patrol.device_size);
+    #ifdef _WIN32
+        Sleep(1500);
+    #else
+        sleep(1);
+    #endif
+
+    ui_init();
+    scan_signals_install();
+    job->rc = scan_patrol_run(device_path, &patrol, &job->opts, budget, patrol_progress_callback, job, &job->state);
+    scan_signals_restore();
+    ui_cleanup();
+
+    // O estado é gravado mesmo se a execução foi interrompida: o que foi lido conta.
+    int rc = job->rc;
+    if (scan_patrol_save(state_path, &patrol) != 0) {
+        fprintf(stderr, "Error: Could not save the patrol state to %s.\n", state_path);
+        rc = 1;
+    }
+
+    if (job->state.scanned_blocks > 0) {
+        ui_display_scan_report(&job->state, &job->drive_info);
+        ui_display_bad_extents(job->extents, job->extent_count, job->state.bad_extents, job->sector_size);
+    }
+    uint64_t read = patrol.passes > start_passes ? patrol.device_size - start_cursor + patrol.cursor
+                                                 : patrol.cursor - start_cursor;
+    printf("\nPatrol read %.1f MB this run; next run starts at %.1f%%.\n", (double)read / (1024.0 * 1024.0),
+           100.0 * (double)patrol.cursor / (double)patrol.device_size);
+    if (patrol.passes > start_passes) {
+        printf("Full pass #%llu completed.\n", (unsigned long long)patrol.passes);
+    }
+    ui_display_patrol_coverage(&patrol, (int64_t)time(NULL));
+
+    if (job->state.scanned_blocks > 0) {
+        save_scan_reports(job);
+    }
+    char report_path[1024];
+    if (report_save_patrol_json(device_path, &patrol, &job->state, report_path, sizeof(report_path)) == 0) {
+        printf("Patrol report saved to: %s\n", report_path);
+    }
+
+    scan_job_release(job);
+    free(job);
+    return rc;
+}
+
+// O que o callback do perfil desenha: a barra da zona atual e a curva até aqui.
+typedef struct {
+    const scan_job_t* job;
+    const scan_profile_t* profile;
+    const scan_profile_t* baseline;
+} profile_view_t;
+
+static void profile_progress_callback(const scan_state_t* state, void* user_data) {
+    const profile_view_t* view = (const profile_view_t*)user_data;
+    ui_draw_scan_progress(state, &view->job->drive_info);
+    printf("Zone %u of %u\n", view->profile->measured + 1, view->profile->zone_count);
+    ui_draw_transfer_curve(view->profile, view->baseline);
+    fflush(stdout);
+}
+
+int run_profile_command(const char *device_path, const scan_options_t *opts, unsigned zones, uint64_t zone_bytes,
+                        const char *baseline_path, bool save_baseline) {
+    if (device_path == NULL) {
+        fprintf(stderr, "Error: A device path must be provided for the transfer profile.\n");
+        return 1;
+    }
+
+    int64_t device_size = pal_get_device_size(device_path);
+    if (device_size <= 0) {
+        fprintf(stderr, "Error: Could not determine the size of %s.\n", device_path);
+        return 1;
+    }
+
+    scan_job_t* job = (scan_job_t*)malloc(sizeof(scan_job_t));
+    scan_profile_t* profiles = (scan_profile_t*)calloc(2, sizeof(scan_profile_t));
+    if (job == NULL || profiles == NULL || scan_job_init(job, device_path, opts) != 0) {
+        fprintf(stderr, "Error: Not enough memory to prepare the transfer profile.\n");
+        free(profiles);
+        free(job);
+        return 1;
+    }
+    scan_profile_t* profile = &profiles[0];
+    scan_profile_t* baseline = &profiles[1];
+
+    int rc = 1;
+    if (scan_profile_init(profile, device_path, job->drive_info.model, job->drive_info.serial, (uint64_t)device_size,
+                          zones, zone_bytes, job->opts.block_size) != 0) {
+        fprintf(stderr, "Error: %s is too small for %u zones.\n", device_path, zones ? zones : SCAN_PROFILE_DEFAULT_ZONES);
+        goto done;
+    }
+
+    // Sem --baseline, a linha de base é a do modelo, guardada junto dos relatórios.
+    char default_baseline[512];
+    bool explicit_baseline = baseline_path != NULL;
+    if (!explicit_baseline) {
+        pal_ensure_directory_exists("reports");
+        scan_profile_baseline_path(job->drive_info.model, default_baseline, sizeof(default_baseline));
+        baseline_path = default_baseline;
+    }
+    bool has_baseline = scan_profile_load_csv(baseline_path, baseline) == 0;
+    if (!has_baseline) {
+        memset(baseline, 0, sizeof(*baseline));
+        if (explicit_baseline && !save_baseline) {
+            fprintf(stderr, "Error: '%s' is not a transfer profile.\n", baseline_path);
+            goto done;
+        }
+    } else if (strcmp(baseline->model, profile->model) != 0) {
+        printf("Note: the baseline %s was recorded on a %s, not a %s.\n", baseline_path,
+               baseline->model[0] ? baseline->model : "unknown model", profile->model);
+    }
+
+    printf("Profiling %s (%s): %u zones of %.0f MB...\n", job->drive_info.path, job->drive_info.model,
+           profile->zone_count, (double)profile->zone_bytes / (1024.0 * 1024.0));
+    if (job->drive_info.is_ssd) {
+        printf("Note: solid-state drive; expect a flat curve.\n");
+    }
+    #ifdef _WIN32
+        Sleep(1500);
+    #else
+        sleep(1);
+    #endif
+
+    profile_view_t view = { job, profile, has_baseline ? baseline : NULL };
+    ui_init();
+    scan_signals_install();
+    rc = scan_profile_run(device_path, profile, &job->opts, profile_progress_callback, &view);
+    scan_signals_restore();
+    ui_cleanup();
+
+    printf("\n");
+    if (rc != 0) {
+        printf("Profile interrupted after %u of %u zones.\n", profile->measured, profile->zone_count);
+    }
+    if (profile->measured == 0) goto done;
+
+    ui_draw_transfer_curve(profile, has_baseline ? baseline : NULL);
+
+    unsigned slowest = 0;
+    uint64_t bad_sectors = 0;
+    for (unsigned z = 0; z < profile->measured; ++z) {
+        if (profile->zones[z].mbps < profile->zones[slowest].mbps) slowest = z;
+        bad_sectors += profile->zones[z].bad_sectors;
+    }
+    const scan_profile_zone_t* outer = &profile->zones[0];
+    const scan_profile_zone_t* inner = &profile->zones[profile->measured - 1];
+    printf("\nOuter zone: %.1f MB/s, inner zone: %.1f MB/s (%.0f%% of the outer), slowest: zone %u at %.1f MB/s.\n",
+           outer->mbps, inner->mbps, outer->mbps > 0.0 ? 100.0 * inner->mbps / outer->mbps : 0.0,
+           slowest, profile->zones[slowest].mbps);
+    if (bad_sectors > 0) {
+        printf("%llu unreadable sectors found while profiling.\n", (unsigned long long)bad_sectors);
+        uint64_t total_extents = job->opts.bad_index ? bad_extent_index_extents(job->opts.bad_index) : job->extent_count;
+        ui_display_bad_extents(job->extents, job->extent_count, total_extents, job->sector_size);
+    }
+
+    if (has_baseline) {
+        scan_profile_comparison_t cmp;
+        scan_profile_compare(profile, baseline, &cmp);
+        printf("Against the baseline: %+.1f%% on average; zone %u is the furthest off (%+.1f%%).\n",
+               cmp.mean_percent, cmp.worst_zone, cmp.worst_percent);
+        if (cmp.slower > 0) {
+            printf("%u of %u zones are more than %.0f%% slower than the baseline.\n", cmp.slower, cmp.compared, SCAN_PROFILE_SLOW_PERCENT);
+        }
+    }
+
+    char report_path[1024];
+    if (report_save_profile_json(device_path, profile, has_baseline ? baseline : NULL, report_path, sizeof(report_path)) == 0) {
+        printf("Transfer profile saved to: %s\n", report_path);
+    }
+    if (report_save_profile_csv(device_path, profile, report_path, sizeof(report_path)) == 0) {
+        printf("Transfer profile CSV saved to: %s\n", report_path);
+    }
+
+    // O primeiro perfil completo de um modelo vira a linha de base dele.
+    if (rc == 0 && (save_baseline || !has_baseline)) {
+        if (scan_profile_save_csv(baseline_path, profile) == 0) {
+            printf("Baseline for %s saved to: %s\n", profile->model[0] ? profile->model : device_path, baseline_path);
+        } else {
+            fprintf(stderr, "Error: Could not save the baseline to %s.\n", baseline_path);
+            rc = 1;
+        }
+    }
+
+done:
+    scan_job_release(job);
+    free(job);
+    free(profiles);
+    return rc;
+}
+
+// Configuração em andamento do benchmark, para a linha de progresso.
+typedef struct {
+    const scan_bench_config_t* config;
+    unsigned index;
+    unsigned count;
+} bench_view_t;
+
+static void bench_progress_callback(const scan_state_t* state, void* user_data) {
+    const bench_view_t* view = (const bench_view_t*)user_data;
+    printf("\r[%2u/%u] %-10s %5uK QD %-3u %8.1f MB/s   ", view->index + 1, view->count,
+           scan_bench_pattern_name(view->config->pattern), view->config->block_size / 1024,
+           view->config->queue_depth, state->current_speed_mbps);
+    fflush(stdout);
+}
+
+int run_benchmark_command(const char *device_path, const scan_options_t *opts, double seconds, uint32_t max_queue_depth) {
+    if (device_path == NULL) {
+        fprintf(stderr, "Error: A device path must be provided for the benchmark.\n");
+        return 1;
+    }
+    if (pal_get_device_size(device_path) <= 0) {
+        fprintf(stderr, "Error: Could not determine the size of %s.\n", device_path);
+        return 1;
+    }
+
+    BasicDriveInfo drive_info;
+    memset(&drive_info, 0, sizeof(drive_info));
+    pal_get_basic_drive_info(device_path, &drive_info);
+
+    scan_options_t base;
+    if (opts) base = *opts;
+    else surface_scan_options_init(&base);
+    if (!(seconds > 0.0)) seconds = SCAN_BENCH_DEFAULT_SECONDS;
+
+    scan_bench_config_t configs[SCAN_BENCH_MAX_CONFIGS];
+    scan_bench_result_t results[SCAN_BENCH_MAX_CONFIGS];
+    unsigned count = scan_bench_default_plan(configs, SCAN_BENCH_MAX_CONFIGS, max_queue_depth);
+
+    printf("Benchmarking %s (%s): %u configurations of %.0f s each (about %.0f s), read-only.\n",
+           device_path, drive_info.model[0] ? drive_info.model : "unknown model", count, seconds, seconds * count);
+
+    // Só leituras: nada é escrito, então o disco pode estar montado e em uso.
+    int rc = 0;
+    unsigned done = 0;
+    scan_signals_install();
+    for (; done < count; ++done) {
+        bench_view_t view = { &configs[done], done, count };
+        if (scan_bench_run(device_path, &base, &configs[done], seconds, bench_progress_callback, &view, &results[done]) != 0) {
+            rc = 1;
+            break;
+        }
+        // Sem io_uring nesta máquina as próximas configurações já vão direto para a engine que leu.
+        if (results[done].engine != SCAN_ENGINE_URING) base.engine = results[done].engine;
+    }
+    scan_signals_restore();
+    printf("\n");
+
+    if (rc != 0) {
+        printf("Benchmark stopped after %u of %u configurations.\n", done, count);
+    }
+    if (done == 0) return rc;
+
+    ui_display_benchmark(results, done);
+    char report_path[1024];
+    if (report_save_benchmark_json(device_path, &drive_info, results, done, report_path, sizeof(report_path)) == 0) {
+        printf("\nBenchmark report saved to: %s\n", report_path);
+    }
+    return rc;
 }
 
 void run_smart_analysis(FILE* output_stream, const struct smart_data* data) {
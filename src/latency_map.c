@@ -0,0 +1,445 @@
+#include "latency_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#define LATENCY_MAP_MAGIC "DOLM"
+#define LATENCY_MAP_VERSION 1
+#define LATENCY_MAP_CELL_BYTES 32
+
+struct latency_map_s {
+    uint32_t max_buckets;
+    uint64_t device_size;
+    uint32_t sector_size;
+    uint64_t bucket_bytes;              // nível 0; o nível k cobre bucket_bytes << k
+    unsigned level_count;
+    uint64_t level_buckets[LATENCY_MAP_MAX_LEVELS];
+    size_t level_offset[LATENCY_MAP_MAX_LEVELS];
+    latency_cell_t* cells;              // todos os níveis, do 0 ao topo
+    size_t cell_count;
+};
+
+// Vários workers somam no mesmo mapa: contadores com fetch-add, min/máx com CAS.
+#if defined(_MSC_VER)
+static void atomic_add64(uint64_t* ptr, uint64_t value) {
+    InterlockedExchangeAdd64((volatile LONG64*)ptr, (LONG64)value);
+}
+
+static uint64_t atomic_load64(const uint64_t* ptr) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)ptr, 0, 0);
+}
+
+static uint32_t atomic_load32(const uint32_t* ptr) {
+    return (uint32_t)InterlockedCompareExchange((volatile LONG*)ptr, 0, 0);
+}
+
+static bool atomic_cas32(uint32_t* ptr, uint32_t* expected, uint32_t desired) {
+    LONG prev = InterlockedCompareExchange((volatile LONG*)ptr, (LONG)desired, (LONG)*expected);
+    if ((uint32_t)prev == *expected) return true;
+    *expected = (uint32_t)prev;
+    return false;
+}
+#else
+static void atomic_add64(uint64_t* ptr, uint64_t value) {
+    __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+}
+
+static uint64_t atomic_load64(const uint64_t* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+static uint32_t atomic_load32(const uint32_t* ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+
+static bool atomic_cas32(uint32_t* ptr, uint32_t* expected, uint32_t desired) {
+    return __atomic_compare_exchange_n(ptr, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+#endif
+
+static void atomic_min32(uint32_t* ptr, uint32_t value) {
+    uint32_t current = atomic_load32(ptr);
+    while (value < current && !atomic_cas32(ptr, &current, value)) {
+    }
+}
+
+static void atomic_max32(uint32_t* ptr, uint32_t value) {
+    uint32_t current = atomic_load32(ptr);
+    while (value > current && !atomic_cas32(ptr, &current, value)) {
+    }
+}
+
+static void cell_snapshot(latency_cell_t* dst, const latency_cell_t* src) {
+    dst->min_us = atomic_load32(&src->min_us);
+    dst->max_us = atomic_load32(&src->max_us);
+    dst->count = atomic_load64(&src->count);
+    dst->sum_us = atomic_load64(&src->sum_us);
+    dst->errors = atomic_load64(&src->errors);
+}
+
+void latency_cell_clear(latency_cell_t* cell) {
+    memset(cell, 0, sizeof(*cell));
+    cell->min_us = UINT32_MAX;
+}
+
+void latency_cell_sample(latency_cell_t* cell, uint64_t latency_us, bool ok) {
+    if (!ok) {
+        cell->errors++;
+        return;
+    }
+    uint32_t us = latency_us > UINT32_MAX - 1 ? UINT32_MAX - 1 : (uint32_t)latency_us;
+    if (us < cell->min_us) cell->min_us = us;
+    if (us > cell->max_us) cell->max_us = us;
+    cell->count++;
+    cell->sum_us += us;
+}
+
+void latency_cell_merge(latency_cell_t* dst, const latency_cell_t* src) {
+    if (src->count > 0) {
+        if (src->min_us < dst->min_us) dst->min_us = src->min_us;
+        if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+        dst->count += src->count;
+        dst->sum_us += src->sum_us;
+    }
+    dst->errors += src->errors;
+}
+
+latency_map_t* latency_map_create(uint32_t max_buckets) {
+    latency_map_t* map = (latency_map_t*)calloc(1, sizeof(latency_map_t));
+    if (map) {
+        map->max_buckets = max_buckets ? max_buckets : LATENCY_MAP_DEFAULT_BUCKETS;
+    }
+    return map;
+}
+
+void latency_map_destroy(latency_map_t* map) {
+    if (!map) return;
+    free(map->cells);
+    free(map);
+}
+
+// Calcula os níveis da pirâmide: faixas de 2^k bytes até caber em max_buckets.
+static void compute_levels(latency_map_t* map) {
+    uint64_t bucket_bytes = LATENCY_MAP_MIN_BUCKET_BYTES;
+    while ((map->device_size + bucket_bytes - 1) / bucket_bytes > map->max_buckets) {
+        bucket_bytes <<= 1;
+    }
+    map->bucket_bytes = bucket_bytes;
+
+    uint64_t buckets = (map->device_size + bucket_bytes - 1) / bucket_bytes;
+    if (buckets == 0) buckets = 1;
+    size_t offset = 0;
+    map->level_count = 0;
+    for (;;) {
+        map->level_buckets[map->level_count] = buckets;
+        map->level_offset[map->level_count] = offset;
+        map->level_count++;
+        offset += (size_t)buckets;
+        if (buckets == 1 || map->level_count == LATENCY_MAP_MAX_LEVELS) break;
+        buckets = (buckets + 1) / 2;
+    }
+    map->cell_count = offset;
+}
+
+int latency_map_set_geometry(latency_map_t* map, uint64_t device_size, uint32_t sector_size) {
+    if (!map) return 1;
+    if (map->cells && map->device_size == device_size && map->sector_size == sector_size) {
+        return 0;
+    }
+
+    free(map->cells);
+    map->cells = NULL;
+    map->device_size = device_size;
+    map->sector_size = sector_size;
+    compute_levels(map);
+
+    map->cells = (latency_cell_t*)malloc(map->cell_count * sizeof(latency_cell_t));
+    if (!map->cells) {
+        map->device_size = 0;
+        map->cell_count = 0;
+        return 1;
+    }
+    for (size_t i = 0; i < map->cell_count; ++i) {
+        latency_cell_clear(&map->cells[i]);
+    }
+    return 0;
+}
+
+uint64_t latency_map_device_size(const latency_map_t* map) {
+    return map ? map->device_size : 0;
+}
+
+uint32_t latency_map_sector_size(const latency_map_t* map) {
+    return map ? map->sector_size : 0;
+}
+
+uint64_t latency_map_bucket_bytes(const latency_map_t* map) {
+    return map && map->cells ? map->bucket_bytes : 0;
+}
+
+void latency_map_add(latency_map_t* map, uint64_t offset, const latency_cell_t* cell) {
+    if (!map || !map->cells || offset >= map->device_size) return;
+    if (cell->count == 0 && cell->errors == 0) return;
+
+    uint64_t bucket = offset / map->bucket_bytes;
+    for (unsigned level = 0; level < map->level_count; ++level, bucket >>= 1) {
+        latency_cell_t* target = &map->cells[map->level_offset[level] + bucket];
+        if (cell->count > 0) {
+            atomic_min32(&target->min_us, cell->min_us);
+            atomic_max32(&target->max_us, cell->max_us);
+            atomic_add64(&target->count, cell->count);
+            atomic_add64(&target->sum_us, cell->sum_us);
+        }
+        if (cell->errors > 0) {
+            atomic_add64(&target->errors, cell->errors);
+        }
+    }
+}
+
+void latency_map_record(latency_map_t* map, uint64_t offset, uint64_t latency_us, bool ok) {
+    latency_cell_t cell;
+    latency_cell_clear(&cell);
+    latency_cell_sample(&cell, latency_us, ok);
+    latency_map_add(map, offset, &cell);
+}
+
+int latency_map_merge(latency_map_t* dst, const latency_map_t* src) {
+    if (!dst || !src || !src->cells) return 1;
+    if (!dst->cells && latency_map_set_geometry(dst, src->device_size, src->sector_size) != 0) return 1;
+    if (dst->device_size != src->device_size || dst->bucket_bytes != src->bucket_bytes) return 1;
+
+    for (uint64_t i = 0; i < src->level_buckets[0]; ++i) {
+        latency_map_add(dst, i * src->bucket_bytes, &src->cells[i]);
+    }
+    return 0;
+}
+
+// Escolhe o nível mais grosso que ainda tem ao menos cell_count faixas no trecho.
+static unsigned pick_level(unsigned level_count, uint64_t bucket_bytes, uint64_t start, uint64_t end, unsigned cell_count) {
+    unsigned level = 0;
+    while (level + 1 < level_count) {
+        uint64_t bytes = bucket_bytes << (level + 1);
+        uint64_t in_range = (end + bytes - 1) / bytes - start / bytes;
+        if (in_range < cell_count) break;
+        level++;
+    }
+    return level;
+}
+
+// Distribui as faixas [first, first + count) de um nível pelas colunas do trecho.
+static void render_buckets(const latency_cell_t* buckets, uint64_t first, uint64_t count, uint64_t bytes,
+                           uint64_t start, uint64_t end, latency_cell_t* cells, unsigned cell_count) {
+    double span = (double)(end - start);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t lo = (first + i) * bytes, hi = lo + bytes;
+        if (lo < start) lo = start;
+        if (hi > end) hi = end;
+        if (lo >= hi) continue;
+
+        // Faixa menor que a coluna conta só na coluna onde começa; maior, se repete.
+        unsigned c0 = (unsigned)((double)(lo - start) / span * cell_count);
+        unsigned c1 = (double)bytes * cell_count < span ? c0 : (unsigned)((double)(hi - 1 - start) / span * cell_count);
+        if (c1 >= cell_count) c1 = cell_count - 1;
+        latency_cell_t cell;
+        cell_snapshot(&cell, &buckets[i]);
+        for (unsigned c = c0; c <= c1; ++c) {
+            latency_cell_merge(&cells[c], &cell);
+        }
+    }
+}
+
+int latency_map_render(const latency_map_t* map, uint64_t start, uint64_t end, latency_cell_t* cells, unsigned cell_count) {
+    if (!map || !cells || cell_count == 0) return 1;
+    for (unsigned c = 0; c < cell_count; ++c) latency_cell_clear(&cells[c]);
+    if (!map->cells) return 0;
+    if (end > map->device_size) end = map->device_size;
+    if (start >= end) return 0;
+
+    unsigned level = pick_level(map->level_count, map->bucket_bytes, start, end, cell_count);
+    uint64_t bytes = map->bucket_bytes << level;
+    uint64_t first = start / bytes;
+    uint64_t last = (end + bytes - 1) / bytes;
+    if (last > map->level_buckets[level]) last = map->level_buckets[level];
+    render_buckets(&map->cells[map->level_offset[level] + first], first, last - first, bytes, start, end, cells, cell_count);
+    return 0;
+}
+
+// Formato (little-endian), offsets relativos ao início do cabeçalho:
+//   "DOLM" | u32 versão | u64 tamanho do dispositivo | u32 setor | u64 bytes por faixa do nível 0
+//   u32 níveis | por nível: u64 faixas, u64 offset
+//   células de 32 bytes: u32 min, u32 máx, u64 leituras, u64 soma (µs), u64 erros
+static void put_le(FILE* fp, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        fputc((int)((value >> (8 * i)) & 0xFF), fp);
+    }
+}
+
+static uint64_t get_le_buf(const uint8_t* buf, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+static bool get_le(FILE* fp, uint64_t* value, int bytes) {
+    uint8_t buf[8];
+    if (fread(buf, 1, (size_t)bytes, fp) != (size_t)bytes) return false;
+    *value = get_le_buf(buf, bytes);
+    return true;
+}
+
+static size_t header_bytes(unsigned level_count) {
+    return 4 + 4 + 8 + 4 + 8 + 4 + (size_t)level_count * 16;
+}
+
+static void decode_cell(const uint8_t* buf, latency_cell_t* cell) {
+    cell->min_us = (uint32_t)get_le_buf(buf, 4);
+    cell->max_us = (uint32_t)get_le_buf(buf + 4, 4);
+    cell->count = get_le_buf(buf + 8, 8);
+    cell->sum_us = get_le_buf(buf + 16, 8);
+    cell->errors = get_le_buf(buf + 24, 8);
+}
+
+int latency_map_write(const latency_map_t* map, FILE* fp) {
+    if (!map || !map->cells || !fp) return 1;
+
+    fwrite(LATENCY_MAP_MAGIC, 1, 4, fp);
+    put_le(fp, LATENCY_MAP_VERSION, 4);
+    put_le(fp, map->device_size, 8);
+    put_le(fp, map->sector_size, 4);
+    put_le(fp, map->bucket_bytes, 8);
+    put_le(fp, map->level_count, 4);
+    uint64_t offset = header_bytes(map->level_count);
+    for (unsigned level = 0; level < map->level_count; ++level) {
+        put_le(fp, map->level_buckets[level], 8);
+        put_le(fp, offset, 8);
+        offset += map->level_buckets[level] * LATENCY_MAP_CELL_BYTES;
+    }
+
+    for (size_t i = 0; i < map->cell_count; ++i) {
+        latency_cell_t cell;
+        cell_snapshot(&cell, &map->cells[i]);
+        put_le(fp, cell.min_us, 4);
+        put_le(fp, cell.max_us, 4);
+        put_le(fp, cell.count, 8);
+        put_le(fp, cell.sum_us, 8);
+        put_le(fp, cell.errors, 8);
+    }
+    return ferror(fp) ? 1 : 0;
+}
+
+// Lê e valida o cabeçalho; os níveis têm que bater com a geometria declarada.
+static bool read_header(FILE* fp, latency_map_t* map, uint64_t* offsets) {
+    char magic[4];
+    uint64_t version, device_size, sector_size, bucket_bytes, level_count;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, LATENCY_MAP_MAGIC, 4) != 0 ||
+        !get_le(fp, &version, 4) || version != LATENCY_MAP_VERSION ||
+        !get_le(fp, &device_size, 8) || !get_le(fp, &sector_size, 4) ||
+        !get_le(fp, &bucket_bytes, 8) || !get_le(fp, &level_count, 4) ||
+        level_count == 0 || level_count > LATENCY_MAP_MAX_LEVELS ||
+        bucket_bytes < LATENCY_MAP_MIN_BUCKET_BYTES || (bucket_bytes & (bucket_bytes - 1)) != 0) {
+        return false;
+    }
+
+    map->device_size = device_size;
+    map->sector_size = (uint32_t)sector_size;
+    map->max_buckets = (uint32_t)((device_size + bucket_bytes - 1) / bucket_bytes);
+    if (map->max_buckets == 0) map->max_buckets = 1;
+    compute_levels(map);
+    if (map->bucket_bytes != bucket_bytes || map->level_count != level_count) return false;
+
+    for (unsigned level = 0; level < map->level_count; ++level) {
+        uint64_t buckets;
+        if (!get_le(fp, &buckets, 8) || !get_le(fp, &offsets[level], 8) || buckets != map->level_buckets[level]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+latency_map_t* latency_map_read(FILE* fp) {
+    if (!fp) return NULL;
+    latency_map_t* map = latency_map_create(0);
+    if (!map) return NULL;
+
+    uint64_t offsets[LATENCY_MAP_MAX_LEVELS];
+    bool ok = read_header(fp, map, offsets);
+    if (ok) {
+        map->cells = (latency_cell_t*)malloc(map->cell_count * sizeof(latency_cell_t));
+        ok = map->cells != NULL;
+    }
+    uint8_t buf[LATENCY_MAP_CELL_BYTES];
+    for (size_t i = 0; ok && i < map->cell_count; ++i) {
+        ok = fread(buf, 1, sizeof(buf), fp) == sizeof(buf);
+        if (ok) decode_cell(buf, &map->cells[i]);
+    }
+
+    if (!ok) {
+        latency_map_destroy(map);
+        return NULL;
+    }
+    return map;
+}
+
+int latency_map_save(const latency_map_t* map, const char* path) {
+    if (!map || !path) return 1;
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return 1;
+
+    int rc = latency_map_write(map, fp);
+    if (fclose(fp) != 0) rc = 1;
+    return rc;
+}
+
+int latency_map_file_query(const char* path, uint64_t start, uint64_t end, latency_cell_t* cells, unsigned cell_count,
+                           uint64_t* device_size, uint32_t* sector_size) {
+    if (!path || !cells || cell_count == 0) return 1;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 1;
+
+    // Só o cabeçalho e a fatia do nível escolhido são lidos.
+    latency_map_t header;
+    memset(&header, 0, sizeof(header));
+    uint64_t offsets[LATENCY_MAP_MAX_LEVELS];
+    if (!read_header(fp, &header, offsets)) {
+        fclose(fp);
+        return 1;
+    }
+    if (device_size) *device_size = header.device_size;
+    if (sector_size) *sector_size = header.sector_size;
+
+    for (unsigned c = 0; c < cell_count; ++c) latency_cell_clear(&cells[c]);
+    if (end > header.device_size) end = header.device_size;
+    if (start >= end) {
+        fclose(fp);
+        return 0;
+    }
+
+    unsigned level = pick_level(header.level_count, header.bucket_bytes, start, end, cell_count);
+    uint64_t bytes = header.bucket_bytes << level;
+    uint64_t first = start / bytes;
+    uint64_t last = (end + bytes - 1) / bytes;
+    if (last > header.level_buckets[level]) last = header.level_buckets[level];
+
+    int rc = 1;
+    size_t count = (size_t)(last - first);
+    latency_cell_t* slice = (latency_cell_t*)malloc(count * sizeof(latency_cell_t));
+    if (slice && fseek(fp, (long)(offsets[level] + first * LATENCY_MAP_CELL_BYTES), SEEK_SET) == 0) {
+        uint8_t buf[LATENCY_MAP_CELL_BYTES];
+        size_t i = 0;
+        for (; i < count && fread(buf, 1, sizeof(buf), fp) == sizeof(buf); ++i) {
+            decode_cell(buf, &slice[i]);
+        }
+        if (i == count) {
+            render_buckets(slice, first, count, bytes, start, end, cells, cell_count);
+            rc = 0;
+        }
+    }
+    free(slice);
+    fclose(fp);
+    return rc;
+}
@@ -4,6 +4,9 @@
 #include "pal.h"
 #include "style.h"
 #include "interactive.h"
+#include "scan_scheduler.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
 
 #define PROJECT_VERSION "1.0.0"
 
@@ -22,8 +25,6 @@ static const char* disk_oracle_subtitle_text[] = {
     NULL
 };
 
-static scan_state_t g_final_scan_state;
-
 void print_welcome_screen(void) {
     const int term_width = 80;
     const int logo_width = 48; 
@@ -88,9 +89,101 @@ void print_full_help(void) {
     style_reset();
     printf(" ");
     style_set_fg(COLOR_DIM);
-    printf("<device_path>\n");
+    printf("<device_path> [<device_path> ...] [options]\n");
+    style_reset();
+    printf("    Commands the Oracle to gaze upon the disk's physical plane, seeking out weary or corrupted sectors.\n");
+    printf("    With several paths (or --surface-all for every drive) the disks are scanned together from one process.\n");
+    printf("    --deep                 Read every block instead of a quick sample.\n");
+    printf("    --verify               Deep scan that reads every block twice, the second time past the OS cache,\n");
+    printf("                           and reports each LBA whose data changed between the reads (marginal sectors).\n");
+    printf("                           Reads run on a double-buffered pipeline of their own; --engine and --qd do not apply.\n");
+    printf("    --classify             Classify every block read as zeroed, all 0xFF, a repeating pattern or data,\n");
+    printf("                           and report the totals for each 1/64 of the disk (checks wipes, thin provisioning).\n");
+    printf("    --samples <N>          Blocks read by the quick scan, spread evenly at random (default: enough for --tolerance).\n");
+    printf("    --confidence <pct>     Confidence level of the estimated bad-block rate (default: 95).\n");
+    printf("    --tolerance <pct>      Bad-block rate a clean quick scan must rule out; sizes the sample (default: 0.1).\n");
+    printf("    --direct               Bypass the OS page cache (O_DIRECT); always on under Windows.\n");
+    printf("    --engine <engine>      I/O engine: sync, uring (default on Linux when available) or media-verify, where\n");
+    printf("                           the drive checks its own media (SCSI VERIFY / ATA READ VERIFY over SG_IO or\n");
+    printf("                           NVMe Verify over the I/O passthrough ioctl, Linux)\n");
+    printf("                           and no data is transferred; 8M blocks by default, falls back to reads if unsupported.\n");
+    printf("    --block-size <N>       Bytes per read, 4K up to 64M, aligned to the logical sector (default: 4K).\n");
+    printf("    --qd <N>               Reads kept in flight by the io_uring engine (default: %d).\n", SCAN_DEFAULT_QUEUE_DEPTH);
+    printf("    --auto-tune            Before the scan, read the device's queue limits, time a few block sizes and\n");
+    printf("                           queue depths for about a second each and use the fastest (printed, to pin).\n");
+    printf("    --threads <N|auto>     Split a deep scan across N workers; auto uses one per hardware queue (default: 1).\n");
+    printf("    --order <order>        Deep scan read order: sequential (default), reverse, strided, random (a full\n");
+    printf("                           shuffle, seeded like the quick scan) or butterfly (alternating ends, inward).\n");
+    printf("    --stride <N>           Strided order: blocks skipped between reads, one pass per offset (default: %d).\n", SCAN_ORDER_DEFAULT_STRIDE);
+    printf("    --resume               Continue an interrupted deep scan from its last checkpoint.\n");
+    printf("    --journal <file>       Checkpoint file (default: reports/diskoracle_scan_<device>.journal; single device only).\n");
+    printf("    --allocated <path>     Deep scan of only the blocks used by the files of the filesystem mounted at <path>\n");
+    printf("                           (on the scanned device or one of its partitions); free space is skipped.\n");
+    printf("    --map-files <path>     After the scan, list the files of the filesystem mounted at <path> that sit on\n");
+    printf("                           unreadable or mismatched sectors, with their byte offsets (implied by --allocated).\n");
+    printf("    --max-mbps <N>         Throttle a deep scan to N MB/s so it can run on a live server.\n");
+    printf("    --max-iops <N>         Throttle a deep scan to N reads per second.\n");
+    printf("    --latency-target <ms>  Back off automatically while reads take longer than this on average.\n");
+    printf("    --idle                 Use the idle I/O priority class (ioprio on Linux, background mode on Windows).\n");
+    printf("    --idle-aware           Watch the disk's I/O counters and yield to other processes: shrink the\n");
+    printf("                           queue, pause, and speed up again once the disk is idle (Linux, Windows).\n");
+    printf("                           While throttled, SIGUSR1 halves the limits and SIGUSR2 doubles them.\n");
+    printf("    --max-concurrent <N>   Devices scanned at the same time when scanning several (default: %d).\n\n", SCAN_SCHEDULER_DEFAULT_CONCURRENCY);
+
+    printf("  ");
+    style_set_fg(COLOR_MAGENTA); 
+    printf("> ");
+    style_set_fg(COLOR_BRIGHT_CYAN);
+    printf("--patrol");
+    style_reset();
+    printf(" ");
+    style_set_fg(COLOR_DIM);
+    printf("<device_path> [options]\n");
+    style_reset();
+    printf("    Walks the disk a little at a time: each run (e.g. from cron) deep scans from where the last one\n");
+    printf("    stopped, wraps around at the end, and shows how long ago each region of the disk was read.\n");
+    printf("    --budget-time <T>      Stop after T (e.g. 900, 30m, 2h; default: 30m when no other budget is set).\n");
+    printf("    --budget-bytes <N>     Stop after reading N bytes (e.g. 500M, 100G).\n");
+    printf("    --cycle-days <N>       Read enough per run to cover the whole disk every N days.\n");
+    printf("    --state <file>         Patrol state (default: reports/diskoracle_patrol_<serial>.state).\n");
+    printf("    The --surface options --engine, --block-size, --qd, --auto-tune, --threads, --direct and the throttling ones apply too.\n\n");
+
+    printf("  ");
+    style_set_fg(COLOR_MAGENTA); 
+    printf("> ");
+    style_set_fg(COLOR_BRIGHT_CYAN);
+    printf("--profile");
+    style_reset();
+    printf(" ");
+    style_set_fg(COLOR_DIM);
+    printf("<device_path> [options]\n");
+    style_reset();
+    printf("    Measures the sustained sequential transfer rate at evenly spaced zones from the outer to the inner\n");
+    printf("    tracks, draws the curve and compares it with the stored baseline of the same drive model.\n");
+    printf("    --zones <N>            Zones measured across the disk (default: %d, up to %d).\n", SCAN_PROFILE_DEFAULT_ZONES, SCAN_PROFILE_MAX_ZONES);
+    printf("    --zone-size <N>        Bytes read in each zone (default: %lluM).\n", (unsigned long long)(SCAN_PROFILE_DEFAULT_ZONE_BYTES >> 20));
+    printf("    --baseline <file>      Profile CSV to compare against (default: reports/diskoracle_profile_<model>.csv,\n");
+    printf("                           written by the first complete run of each model).\n");
+    printf("    --save-baseline        Store this run as the baseline.\n");
+    printf("    --cached               Read through the OS page cache (direct I/O is the default here).\n");
+    printf("    --engine, --block-size (default: 1M) and --qd apply as in --surface. The curve is exported as JSON and CSV.\n\n");
+
+    printf("  ");
+    style_set_fg(COLOR_MAGENTA); 
+    printf("> ");
+    style_set_fg(COLOR_BRIGHT_CYAN);
+    printf("--benchmark");
+    style_reset();
+    printf(" ");
+    style_set_fg(COLOR_DIM);
+    printf("<device_path> [options]\n");
     style_reset();
-    printf("    Commands the Oracle to gaze upon the disk's physical plane, seeking out weary or corrupted sectors.\n\n");
+    printf("    Read-only drive benchmark: random 4K and 64K reads at queue depths 1 to %d, then sequential 128K\n", SCAN_BENCH_MAX_QUEUE_DEPTH);
+    printf("    and 1M reads, with IOPS, MB/s and p50/p99/p99.9 latency for each. Never writes; safe on mounted disks.\n");
+    printf("    --duration <T>         Time per configuration (default: %.0f s).\n", SCAN_BENCH_DEFAULT_SECONDS);
+    printf("    --max-qd <N>           Deepest queue tried (default: %d).\n", SCAN_BENCH_MAX_QUEUE_DEPTH);
+    printf("    --cached               Read through the OS page cache (direct I/O is the default here).\n");
+    printf("    --engine sync|uring    As in --surface; without io_uring the queue is filled by synchronous workers.\n\n");
 
     printf("  ");
     style_set_fg(COLOR_MAGENTA); 
@@ -106,7 +199,9 @@ void print_full_help(void) {
     style_set_fg(COLOR_BRIGHT_CYAN);
     printf("--smart-json\n");
     style_reset();
-    printf("    Translates the disk's whispers into the universal machine tongue of JSON.\n\n");
+    printf("    Translates the disk's whispers into the universal machine tongue of JSON.\n");
+    printf("    <device_path> [output_file] [--bad-index <file> --map-files <path>]: with the bad sector index saved by\n");
+    printf("    a surface scan, also lists the files under <path> stored on those sectors.\n\n");
 
     printf("  ");
     style_set_fg(COLOR_MAGENTA); 
@@ -120,6 +215,18 @@ void print_full_help(void) {
     style_reset();
     printf("    Commands the Oracle to decipher the disk's chronicle of past errors, revealing its deepest scars.\n\n");
 
+    printf("  ");
+    style_set_fg(COLOR_MAGENTA); 
+    printf("> ");
+    style_set_fg(COLOR_BRIGHT_CYAN);
+    printf("--latency-map");
+    style_reset();
+    printf(" ");
+    style_set_fg(COLOR_DIM);
+    printf("<file> [<first_lba> <last_lba>]\n");
+    style_reset();
+    printf("    Unfolds the latency map saved by a surface scan, for the whole disk or zoomed into an LBA range.\n\n");
+
     printf("  ");
     style_set_fg(COLOR_MAGENTA); 
     printf("> ");
@@ -133,7 +240,14 @@ void print_full_help(void) {
     style_reset();
     printf("  diskoracle --list-drives\n");
     printf("  diskoracle --surface \\\\.\\PhysicalDrive0    (Windows example)\n");
-    printf("  diskoracle --surface /dev/sda              (Linux/macOS example)\n\n");
+    printf("  diskoracle --surface /dev/sda              (Linux/macOS example)\n");
+    printf("  diskoracle --surface /dev/nvme0n1 --deep --direct --block-size 1M --qd 64 --threads auto\n");
+    printf("  diskoracle --surface-all --deep --max-concurrent 12\n");
+    printf("  diskoracle --surface /dev/sdb --deep --idle --max-mbps 50 --latency-target 20\n");
+    printf("  diskoracle --surface-all --deep --idle-aware --engine uring\n");
+    printf("  diskoracle --patrol /dev/sda --budget-time 20m --cycle-days 7 --idle-aware\n");
+    printf("  diskoracle --profile /dev/sdb --zones 64\n");
+    printf("  diskoracle --benchmark /dev/nvme0n1 --duration 10\n\n");
     printf("===============================================================================\n");
 }
 
@@ -142,7 +256,7 @@ void print_full_help(void) {
  */
 void print_brief_usage(void) {
     fprintf(stderr, "Usage: diskoracle <command>\n");
-    fprintf(stderr, "Commands: --list-drives, --surface, --smart, --smart-json, --error-log, --help\n");
+    fprintf(stderr, "Commands: --list-drives, --surface, --surface-all, --patrol, --profile, --benchmark, --smart, --smart-json, --error-log, --latency-map, --help\n");
     fprintf(stderr, "Try 'diskoracle --help' for more details.\n");
 }
 
@@ -166,9 +280,14 @@ void print_usage(void);
 const command_t commands[] = {
     {"--list-drives",   handle_list_drives},
     {"--surface",       handle_surface_scan},
+    {"--surface-all",   handle_surface_scan_all},
     {"--smart",         handle_smart},
     {"--smart-json",    handle_smart_json},
     {"--error-log",     handle_error_log_wrapper},
+    {"--latency-map",   handle_latency_map},
+    {"--patrol",        handle_patrol},
+    {"--profile",       handle_profile},
+    {"--benchmark",     handle_benchmark},
     {"--help",          handle_help},
     {NULL, NULL}  
 };
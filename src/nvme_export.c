@@ -1,6 +1,7 @@
 #include "nvme_export.h"
 #include "pal.h"
 #include "smart.h"
+#include "scan_filemap.h"
 #include <stdio.h>
 #include <string.h>
 #include <strsafe.h>
@@ -74,6 +75,7 @@ int nvme_export_to_json(
     const struct smart_data* sdata,           
     const nvme_health_alerts_t* alerts,       
     const nvme_hybrid_context_t* hybrid_ctx,  
+    const scan_file_damage_t* file_damage,
     const char* output_file_path              
 ) {
     FILE* outfile = stdout; 
@@ -231,6 +233,35 @@ int nvme_export_to_json(
         first_section_written = true;
     }
     
+    // Seção 5: Arquivos atingidos por setores ruins (mapeamento reverso de um índice de LBAs ruins)
+    if (file_damage) {
+        char escaped_path[2 * MAX_PATH + 1];
+        if (first_section_written) fprintf(outfile, ",");
+        fprintf(outfile, "\n  \"affectedFiles\": {\n");
+        escape_json_string(file_damage->fs_path, escaped_path, sizeof(escaped_path));
+        fprintf(outfile, "    \"mountPoint\": \"%s\",\n", escaped_path);
+        if (file_damage->status != PAL_STATUS_SUCCESS) {
+            escape_json_string(pal_get_error_string(file_damage->status), escaped_str, sizeof(escaped_str));
+            fprintf(outfile, "    \"error\": \"%s\"\n  }", escaped_str);
+        } else {
+            fprintf(outfile, "    \"sectorSize\": %u,\n", file_damage->sector_size);
+            fprintf(outfile, "    \"files\": %" PRIu64 ",\n", file_damage->files);
+            fprintf(outfile, "    \"affectedBytes\": %" PRIu64 ",\n", file_damage->bytes);
+            fprintf(outfile, "    \"unmappedSectors\": %" PRIu64 ",\n", file_damage->unmapped_sectors);
+            fprintf(outfile, "    \"hits\": [\n");
+            for (size_t i = 0; i < file_damage->hit_count; ++i) {
+                const scan_file_hit_t* hit = &file_damage->hits[i];
+                escape_json_string(scan_file_damage_path(file_damage, hit), escaped_path, sizeof(escaped_path));
+                fprintf(outfile, "      { \"lba\": %" PRIu64 ", \"count\": %" PRIu64 ", \"kind\": \"%s\", \"fileOffset\": %" PRIu64 ", \"path\": \"%s\" }%s\n",
+                        hit->lba, hit->sectors, scan_damage_kind_name(hit->kind), hit->file_offset, escaped_path,
+                        (i == file_damage->hit_count - 1) ? "" : ",");
+            }
+            fprintf(outfile, "    ],\n");
+            fprintf(outfile, "    \"truncated\": %s\n  }", file_damage->total_hits > file_damage->hit_count ? "true" : "false");
+        }
+        first_section_written = true;
+    }
+
     time_t now = time(NULL);
     struct tm ptm_utc;
     if (gmtime_s(&ptm_utc, &now) == 0) {
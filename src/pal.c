@@ -34,4 +34,13 @@ const char* pal_get_error_string(pal_status_t status) {
         default:
             return "An unknown omen has been received from the depths of the machine.";
     }
-} 
\ No newline at end of file
+} 
+
+const char* pal_verify_method_name(pal_verify_method_t method) {
+    switch (method) {
+        case PAL_VERIFY_SCSI: return "SCSI VERIFY(16)";
+        case PAL_VERIFY_ATA: return "ATA READ VERIFY SECTORS EXT";
+        case PAL_VERIFY_NVME: return "NVMe Verify";
+        default: return "none";
+    }
+}
@@ -15,9 +15,12 @@
 
 #if defined(__linux__)
 #include <linux/fs.h>
+#include <linux/fiemap.h>
+#include <sys/sysmacros.h>
 #include <linux/hdreg.h>
 #include <linux/nvme_ioctl.h>
 #include <scsi/sg.h>
+#include <limits.h>
 
 static char* read_sysfs_line(const char *path) {
     FILE *f = fopen(path, "r");
@@ -37,6 +40,23 @@ static char* read_sysfs_line(const char *path) {
     }
 }
 
+// Diretório sysfs do disco inteiro que contém device_path. Para partições
+// (/dev/sda1, /dev/nvme0n1p2) sobe até o disco pai, onde ficam queue/ e mq/.
+static bool sysfs_block_dir(const char *device_path, char *out, size_t out_size) {
+    const char *dev_name = strrchr(device_path, '/');
+    dev_name = dev_name ? dev_name + 1 : device_path;
+
+    char partition_path[512];
+    snprintf(partition_path, sizeof(partition_path), "/sys/class/block/%s/partition", dev_name);
+    struct stat st;
+    if (stat(partition_path, &st) == 0) {
+        snprintf(out, out_size, "/sys/class/block/%s/..", dev_name);
+    } else {
+        snprintf(out, out_size, "/sys/class/block/%s", dev_name);
+    }
+    return stat(out, &st) == 0;
+}
+
 static void trim_whitespace(char *str) {
     if (!str || *str == '\0') return;
     char *start = str;
@@ -63,28 +83,378 @@ int64_t pal_get_device_size(const char *device_path) {
     return (int64_t)size_in_bytes;
 }
 
-int pal_list_drives() {
-    printf("Available physical drives (Linux):\n");
-    printf("%-15s | %-30s | %-25s | %-10s | %s\n", "Device", "Model", "Serial", "Size (GB)", "Type");
-    printf("----------------------------------------------------------------------------------------------------\n");
+pal_status_t pal_get_sector_sizes(const char *device_path, uint32_t *logical_size, uint32_t *physical_size) {
+    if (!device_path || !logical_size) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    int fd = open(device_path, O_RDONLY);
+    if (fd < 0) {
+        return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        // Imagem de disco em arquivo: setor lógico clássico de 512 bytes.
+        *logical_size = 512;
+        if (physical_size) *physical_size = st.st_blksize > 0 ? (uint32_t)st.st_blksize : 4096;
+        close(fd);
+        return PAL_STATUS_SUCCESS;
+    }
+
+    int logical = 0;
+    unsigned int physical = 0;
+    if (ioctl(fd, BLKSSZGET, &logical) < 0 || logical <= 0) {
+        close(fd);
+        return PAL_STATUS_IO_ERROR;
+    }
+    if (ioctl(fd, BLKPBSZGET, &physical) < 0 || physical == 0) {
+        physical = (unsigned int)logical;
+    }
+    close(fd);
+
+    *logical_size = (uint32_t)logical;
+    if (physical_size) *physical_size = physical;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_queue_count(const char *device_path, int *queue_count) {
+    if (!device_path || !queue_count) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    char block_dir[512], mq_path[600];
+    if (!sysfs_block_dir(device_path, block_dir, sizeof(block_dir))) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    snprintf(mq_path, sizeof(mq_path), "%s/mq", block_dir);
+
+    DIR *dir = opendir(mq_path);
+    if (!dir) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(dir);
+
+    if (count == 0) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    *queue_count = count;
+    return PAL_STATUS_SUCCESS;
+}
+
+// Lê um inteiro de <block_dir>/queue/<name>; 0 se o arquivo não existir.
+static uint32_t read_sysfs_queue_value(const char *block_dir, const char *name) {
+    char path[700];
+    snprintf(path, sizeof(path), "%s/queue/%s", block_dir, name);
+    char *line = read_sysfs_line(path);
+    if (!line) return 0;
+    unsigned long value = strtoul(line, NULL, 10);
+    free(line);
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+// MDTS do Identify Controller em bytes (2^MDTS páginas de 4 KiB, o CAP.MPSMIN
+// de quase todos os controladores); 0 se o controlador não informar limite.
+static int nvme_identify_controller(int fd, uint8_t *identify_4k) {
+    struct nvme_admin_cmd cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.opcode = 0x06;      // Identify
+    cmd.addr = (uint64_t)(uintptr_t)identify_4k;
+    cmd.data_len = 4096;
+    cmd.cdw10 = 1;          // CNS 1: controlador
+    return ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd) == 0 ? 0 : 1;
+}
+
+static uint32_t nvme_mdts_bytes(const uint8_t *identify_4k) {
+    if (identify_4k[77] == 0 || identify_4k[77] > 19) return 0;
+    return 4096u << identify_4k[77];
+}
+
+static uint32_t nvme_identify_mdts_bytes(const char *device_path) {
+    int fd = open(device_path, O_RDONLY);
+    if (fd < 0) return 0;
+    uint8_t identify[4096];
+    int rc = nvme_identify_controller(fd, identify);
+    close(fd);
+    return rc == 0 ? nvme_mdts_bytes(identify) : 0;
+}
+
+pal_status_t pal_get_queue_limits(const char *device_path, pal_queue_limits_t *limits) {
+    if (!device_path || !limits) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    memset(limits, 0, sizeof(*limits));
+    limits->rotational = -1;
+
+    char block_dir[512];
+    if (sysfs_block_dir(device_path, block_dir, sizeof(block_dir))) {
+        uint32_t max_sectors_kb = read_sysfs_queue_value(block_dir, "max_sectors_kb");
+        limits->max_transfer_bytes = max_sectors_kb > UINT32_MAX / 1024 ? UINT32_MAX : max_sectors_kb * 1024;
+        limits->logical_block_size = read_sysfs_queue_value(block_dir, "logical_block_size");
+        limits->physical_block_size = read_sysfs_queue_value(block_dir, "physical_block_size");
+        limits->nr_requests = read_sysfs_queue_value(block_dir, "nr_requests");
+
+        char path[700];
+        snprintf(path, sizeof(path), "%s/queue/rotational", block_dir);
+        char *line = read_sysfs_line(path);
+        if (line) {
+            limits->rotational = atoi(line) != 0;
+            free(line);
+        }
+    }
+    // Imagens de disco não têm sysfs; os setores ainda vêm do ioctl.
+    if (limits->logical_block_size == 0) {
+        pal_get_sector_sizes(device_path, &limits->logical_block_size, &limits->physical_block_size);
+    }
+
+    const char *dev_name = strrchr(device_path, '/');
+    dev_name = dev_name ? dev_name + 1 : device_path;
+    if (strncmp(dev_name, "nvme", 4) == 0) {
+        limits->nvme_mdts_bytes = nvme_identify_mdts_bytes(device_path);
+        if (limits->nvme_mdts_bytes > 0 && (limits->max_transfer_bytes == 0 || limits->nvme_mdts_bytes < limits->max_transfer_bytes)) {
+            limits->max_transfer_bytes = limits->nvme_mdts_bytes;
+        }
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_io_counters(const char *device_path, pal_io_counters_t *counters) {
+    if (!device_path || !counters) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    char block_dir[512], stat_path[600];
+    if (!sysfs_block_dir(device_path, block_dir, sizeof(block_dir))) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    snprintf(stat_path, sizeof(stat_path), "%s/stat", block_dir);
+
+    char *line = read_sysfs_line(stat_path);
+    if (!line) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    // Campos (Documentation/block/stat.rst): leituras, merges, setores, ticks,
+    // escritas, merges, setores, ticks, ...
+    unsigned long long field[7];
+    int parsed = sscanf(line, "%llu %llu %llu %llu %llu %llu %llu", &field[0], &field[1], &field[2],
+                        &field[3], &field[4], &field[5], &field[6]);
+    free(line);
+    if (parsed != 7) {
+        return PAL_STATUS_IO_ERROR;
+    }
+    counters->reads_completed = field[0];
+    counters->sectors_read = field[2];
+    counters->writes_completed = field[4];
+    counters->sectors_written = field[6];
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_ensure_directory_exists(const char* path) {
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        return S_ISDIR(st.st_mode) ? PAL_STATUS_SUCCESS : PAL_STATUS_ERROR_CREATING_DIR;
+    }
+    if (mkdir(path, 0755) == 0 || errno == EEXIST) {
+        return PAL_STATUS_SUCCESS;
+    }
+    return PAL_STATUS_ERROR_CREATING_DIR;
+}
+
+// Offset em bytes do dispositivo de bloco fs_dev (onde está o sistema de
+// arquivos) dentro de device_path: o próprio dispositivo, o disco que contém a
+// partição ou a imagem por trás de um loop device.
+static pal_status_t fs_device_offset(dev_t fs_dev, const char *device_path, uint64_t *offset) {
+    char sys_dir[128], path[256];
+    snprintf(sys_dir, sizeof(sys_dir), "/sys/dev/block/%u:%u", major(fs_dev), minor(fs_dev));
+    struct stat st;
+    if (stat(sys_dir, &st) != 0) {
+        return PAL_STATUS_UNSUPPORTED;  // btrfs, overlay, tmpfs: sem dispositivo de bloco próprio
+    }
+
+    uint64_t partition_start = 0;
+    snprintf(path, sizeof(path), "%s/partition", sys_dir);
+    bool is_partition = stat(path, &st) == 0;
+    if (is_partition) {
+        snprintf(path, sizeof(path), "%s/start", sys_dir);
+        char *line = read_sysfs_line(path);
+        if (!line) return PAL_STATUS_IO_ERROR;
+        partition_start = strtoull(line, NULL, 10) * 512;   // sempre em setores de 512 bytes
+        free(line);
+    }
+
+    struct stat dev_st;
+    if (stat(device_path, &dev_st) != 0) {
+        return PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    if (S_ISBLK(dev_st.st_mode)) {
+        if (dev_st.st_rdev == fs_dev) {
+            *offset = 0;
+            return PAL_STATUS_SUCCESS;
+        }
+        if (is_partition) {
+            snprintf(path, sizeof(path), "%s/../dev", sys_dir);
+            char *line = read_sysfs_line(path);
+            unsigned disk_major, disk_minor;
+            bool same_disk = line && sscanf(line, "%u:%u", &disk_major, &disk_minor) == 2 &&
+                             major(dev_st.st_rdev) == disk_major && minor(dev_st.st_rdev) == disk_minor;
+            free(line);
+            if (same_disk) {
+                *offset = partition_start;
+                return PAL_STATUS_SUCCESS;
+            }
+        }
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    if (S_ISREG(dev_st.st_mode)) {
+        snprintf(path, sizeof(path), is_partition ? "%s/../loop/backing_file" : "%s/loop/backing_file", sys_dir);
+        char *backing = read_sysfs_line(path);
+        char *image = realpath(device_path, NULL);
+        bool same_file = backing && image && strcmp(backing, image) == 0;
+        free(backing);
+        free(image);
+        if (!same_file) return PAL_STATUS_INVALID_PARAMETER;
+        snprintf(path, sizeof(path), is_partition ? "%s/../loop/offset" : "%s/loop/offset", sys_dir);
+        char *line = read_sysfs_line(path);
+        *offset = (line ? strtoull(line, NULL, 10) : 0) + partition_start;
+        free(line);
+        return PAL_STATUS_SUCCESS;
+    }
+    return PAL_STATUS_INVALID_PARAMETER;
+}
+
+#define FIEMAP_BATCH 256
+
+typedef struct {
+    dev_t fs_dev;
+    uint64_t base;
+    pal_fs_extent_callback callback;
+    void *user_data;
+    bool unsupported;       // FIEMAP recusado num arquivo regular
+    uint64_t extents;
+    char path[4096];
+} fs_walk_t;
+
+static void fs_map_fd(fs_walk_t *walk, int fd, bool regular) {
+    union {
+        struct fiemap map;
+        char raw[sizeof(struct fiemap) + FIEMAP_BATCH * sizeof(struct fiemap_extent)];
+    } request;
+    struct fiemap *fm = &request.map;
+    uint64_t next = 0;
+    for (;;) {
+        memset(fm, 0, sizeof(*fm));
+        fm->fm_start = next;
+        fm->fm_length = FIEMAP_MAX_OFFSET - next;
+        fm->fm_extent_count = FIEMAP_BATCH;
+        if (ioctl(fd, FS_IOC_FIEMAP, fm) < 0) {
+            if (regular && (errno == EOPNOTSUPP || errno == ENOTTY)) walk->unsupported = true;
+            return;
+        }
+        if (fm->fm_mapped_extents == 0) return;
+        for (unsigned i = 0; i < fm->fm_mapped_extents; ++i) {
+            const struct fiemap_extent *e = &fm->fm_extents[i];
+            // Sem endereço no disco ainda (alocação atrasada) ou desconhecido.
+            if ((e->fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC)) == 0) {
+                walk->callback(walk->path, e->fe_logical, walk->base + e->fe_physical, e->fe_length, walk->user_data);
+                walk->extents++;
+            }
+            next = e->fe_logical + e->fe_length;
+            if (e->fe_flags & FIEMAP_EXTENT_LAST) return;
+        }
+    }
+}
+
+// Percorre a árvore sem seguir links simbólicos nem entrar em outros pontos de montagem.
+static void fs_walk_dir(fs_walk_t *walk, int dir_fd) {
+    fs_map_fd(walk, dir_fd, false);
+    DIR *dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return;
+    }
+    size_t len = strlen(walk->path);
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        const char *separator = (len > 0 && walk->path[len - 1] == '/') ? "" : "/";
+        if (len + strlen(separator) + strlen(entry->d_name) >= sizeof(walk->path)) continue;
+        snprintf(walk->path + len, sizeof(walk->path) - len, "%s%s", separator, entry->d_name);
+
+        struct stat st;
+        if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && st.st_dev == walk->fs_dev) {
+            if (S_ISDIR(st.st_mode)) {
+                int fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                if (fd >= 0) fs_walk_dir(walk, fd);
+            } else if (S_ISREG(st.st_mode)) {
+                int fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+                if (fd >= 0) {
+                    fs_map_fd(walk, fd, true);
+                    close(fd);
+                }
+            }
+        }
+        walk->path[len] = '\0';
+    }
+    closedir(dir);
+}
+
+pal_status_t pal_map_fs_extents(const char *fs_path, const char *device_path, pal_fs_extent_callback callback, void *user_data) {
+    if (!fs_path || !device_path || !callback) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    fs_walk_t *walk = (fs_walk_t *)calloc(1, sizeof(fs_walk_t));
+    if (!walk) {
+        return PAL_STATUS_NO_MEMORY;
+    }
+    int fd = open(fs_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) close(fd);
+        free(walk);
+        return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    pal_status_t status = fs_device_offset(st.st_dev, device_path, &walk->base);
+    if (status != PAL_STATUS_SUCCESS) {
+        close(fd);
+        free(walk);
+        return status;
+    }
+    walk->fs_dev = st.st_dev;
+    walk->callback = callback;
+    walk->user_data = user_data;
+    snprintf(walk->path, sizeof(walk->path), "%s", fs_path);
+    fs_walk_dir(walk, fd);
+    // Só é falta de suporte se nenhum arquivo pôde ser mapeado.
+    status = walk->unsupported && walk->extents == 0 ? PAL_STATUS_UNSUPPORTED : PAL_STATUS_SUCCESS;
+    free(walk);
+    return status;
+}
+
+pal_status_t pal_list_drives(DriveInfo *drive_list, int max_drives, int *drive_count) {
+    if (!drive_list || !drive_count || max_drives <= 0) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    *drive_count = 0;
 
     DIR *dir = opendir("/sys/block");
     if (!dir) {
         perror("pal_list_drives (opendir /sys/block)");
-        return 1;
+        return PAL_STATUS_ERROR;
     }
 
     struct dirent *entry;
-    int found_any = 0;
-    while ((entry = readdir(dir)) != NULL) {
+    while ((entry = readdir(dir)) != NULL && *drive_count < max_drives) {
         const char *dev_name = entry->d_name;
         if (dev_name[0] == '.') continue;
         if (strncmp(dev_name, "loop", 4) == 0 || strncmp(dev_name, "ram", 3) == 0 || strncmp(dev_name, "sr", 2) == 0) {
             continue;
         }
 
-        char dev_path[256];
-        snprintf(dev_path, sizeof(dev_path), "/dev/%s", dev_name);
+        DriveInfo *drive = &drive_list[*drive_count];
+        memset(drive, 0, sizeof(*drive));
+        snprintf(drive->device_path, sizeof(drive->device_path), "/dev/%s", dev_name);
 
         char model_path[512], serial_path[512], rotational_path[512];
         snprintf(model_path, sizeof(model_path), "/sys/block/%s/device/model", dev_name);
@@ -95,19 +465,16 @@ int pal_list_drives() {
         char *serial = read_sysfs_line(serial_path);
         char *rotational_str = read_sysfs_line(rotational_path);
 
-        char model_disp[31] = "N/A";
-        char serial_disp[26] = "N/A";
-
+        snprintf(drive->model, sizeof(drive->model), "N/A");
+        snprintf(drive->serial, sizeof(drive->serial), "N/A");
         if (model) {
             trim_whitespace(model);
-            strncpy(model_disp, model, sizeof(model_disp) -1);
-            model_disp[sizeof(model_disp)-1] = '\0';
+            snprintf(drive->model, sizeof(drive->model), "%s", model);
             free(model);
         }
         if (serial) {
             trim_whitespace(serial);
-            strncpy(serial_disp, serial, sizeof(serial_disp) -1);
-            serial_disp[sizeof(serial_disp)-1] = '\0';
+            snprintf(drive->serial, sizeof(drive->serial), "%s", serial);
             free(serial);
         }
 
@@ -118,27 +485,19 @@ int pal_list_drives() {
             trim_whitespace(rotational_str);
             if (strcmp(rotational_str, "0") == 0) type_str = "SSD";
             else if (strcmp(rotational_str, "1") == 0) type_str = "HDD";
-            free(rotational_str);
         }
         else if (strncmp(dev_name, "sd", 2) == 0 || strncmp(dev_name, "hd", 2) == 0) {
              type_str = "SATA/SCSI";
         }
+        free(rotational_str);
+        snprintf(drive->type, sizeof(drive->type), "%s", type_str);
 
-        int64_t size_bytes = pal_get_device_size(dev_path);
-        double size_gb = -1.0;
-        if (size_bytes > 0) {
-            size_gb = (double)size_bytes / (1024.0 * 1024.0 * 1024.0);
-        }
-        
-        printf("%-15s | %-30s | %-25s | %-10.2f | %s\n",
-               dev_path, model_disp, serial_disp, size_gb > 0.0 ? size_gb : 0.0, type_str);
-        found_any = 1;
+        int64_t size_bytes = pal_get_device_size(drive->device_path);
+        drive->size_bytes = size_bytes > 0 ? size_bytes : 0;
+        (*drive_count)++;
     }
     closedir(dir);
-    if (!found_any) {
-        printf("No suitable physical drives found in /sys/block.\n");
-    }
-    return 0;
+    return PAL_STATUS_SUCCESS;
 }
 
 bool pal_get_basic_drive_info(const char *device_path, BasicDriveInfo *info) {
@@ -259,14 +618,30 @@ static int nvme_get_health_log(int fd, struct smart_data *out) {
     return 0;
 }
 
+// Entrega um CDB ao dispositivo via SG_IO. Retorna 0 se o comando chegou ao
+// dispositivo (o resultado fica em io_hdr e sense), 1 se o próprio ioctl falhou.
+static int sgio_exec(int fd, unsigned char *cdb, unsigned char cdb_len, int direction, void *data, unsigned int data_len,
+                     unsigned char *sense, unsigned char sense_len, unsigned int timeout_ms, struct sg_io_hdr *io_hdr) {
+    memset(io_hdr, 0, sizeof(*io_hdr));
+    memset(sense, 0, sense_len);
+    io_hdr->interface_id = 'S';
+    io_hdr->cmd_len = cdb_len;
+    io_hdr->mx_sb_len = sense_len;
+    io_hdr->dxfer_direction = direction;
+    io_hdr->dxfer_len = data_len;
+    io_hdr->dxferp = data;
+    io_hdr->cmdp = cdb;
+    io_hdr->sbp = sense;
+    io_hdr->timeout = timeout_ms;
+    return ioctl(fd, SG_IO, io_hdr) < 0 ? 1 : 0;
+}
+
 static int ata_sgio_cmd(int fd, uint8_t ata_cmd_code, uint8_t feature_reg, uint8_t sector_count_val, unsigned char *data_buf, unsigned int timeout_val_ms) {
     unsigned char sense_b[32];
     struct sg_io_hdr io_hdr_s;
     unsigned char cdb_s[16]; 
 
-    memset(&io_hdr_s, 0, sizeof(io_hdr_s));
     memset(cdb_s, 0, sizeof(cdb_s));
-    memset(sense_b, 0, sizeof(sense_b));
 
     cdb_s[0] = 0x85; 
     cdb_s[1] = (4 << 1); 
@@ -278,17 +653,7 @@ static int ata_sgio_cmd(int fd, uint8_t ata_cmd_code, uint8_t feature_reg, uint8
     cdb_s[14] = 0xC2; 
     cdb_s[15] = ata_cmd_code; 
 
-    io_hdr_s.interface_id = 'S';
-    io_hdr_s.cmd_len = sizeof(cdb_s);
-    io_hdr_s.mx_sb_len = sizeof(sense_b);
-    io_hdr_s.dxfer_direction = SG_DXFER_FROM_DEV;
-    io_hdr_s.dxfer_len = 512;
-    io_hdr_s.dxferp = data_buf;
-    io_hdr_s.cmdp = cdb_s;
-    io_hdr_s.sbp = sense_b;
-    io_hdr_s.timeout = timeout_val_ms;
-
-    if (ioctl(fd, SG_IO, &io_hdr_s) < 0) {
+    if (sgio_exec(fd, cdb_s, sizeof(cdb_s), SG_DXFER_FROM_DEV, data_buf, 512, sense_b, sizeof(sense_b), timeout_val_ms, &io_hdr_s) != 0) {
         perror("pal_linux: SG_IO ioctl failed");
         return 1;
     }
@@ -306,6 +671,280 @@ static int ata_sgio_cmd(int fd, uint8_t ata_cmd_code, uint8_t feature_reg, uint8
     return 0;
 }
 
+// --- Verify no próprio disco (SG_IO) ---
+
+#define PAL_VERIFY_MAX_SECTORS 65536u
+#define PAL_VERIFY_TIMEOUT_MS 60000u
+
+static uint64_t sense_be(const unsigned char *p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+// Resultado de um comando de verify pelo status SCSI e pelo sense (formato
+// fixo ou por descritores). Erro de mídia com o LBA no campo INFORMATION ou,
+// via ATA PASS-THROUGH, nos registradores do descritor de retorno ATA.
+static pal_status_t sgio_verify_result(const struct sg_io_hdr *io_hdr, const unsigned char *sense, uint64_t *error_lba) {
+    *error_lba = UINT64_MAX;
+    if (io_hdr->host_status != 0) {
+        return PAL_STATUS_IO_ERROR;
+    }
+    int sense_len = io_hdr->sb_len_wr;
+    if (sense_len < 8) {
+        return io_hdr->status == 0 ? PAL_STATUS_SUCCESS : PAL_STATUS_IO_ERROR;
+    }
+
+    uint8_t key;
+    bool ata_error = false;
+    uint8_t response = sense[0] & 0x7F;
+    if (response == 0x72 || response == 0x73) {
+        key = sense[1] & 0x0F;
+        int end = 8 + sense[7];
+        if (end > sense_len) end = sense_len;
+        for (int pos = 8; pos + 2 <= end; pos += 2 + sense[pos + 1]) {
+            const unsigned char *d = &sense[pos];
+            if (d[0] == 0x00 && pos + 12 <= end && (d[2] & 0x80)) {
+                *error_lba = sense_be(d + 4, 8);
+            } else if (d[0] == 0x09 && pos + 14 <= end && (d[13] & 0x01)) {
+                // Descritor de retorno ATA: ERR no status; com UNC ou IDNF o LBA aponta o setor.
+                ata_error = true;
+                if (d[3] & 0x50) {
+                    uint64_t lba = d[7] | ((uint64_t)d[9] << 8) | ((uint64_t)d[11] << 16);
+                    if (d[2] & 0x01) lba |= ((uint64_t)d[6] << 24) | ((uint64_t)d[8] << 32) | ((uint64_t)d[10] << 40);
+                    *error_lba = lba;
+                }
+            }
+        }
+    } else if (response == 0x70 || response == 0x71) {
+        key = sense[2] & 0x0F;
+        if (sense[0] & 0x80) *error_lba = sense_be(sense + 3, 4);
+    } else {
+        return PAL_STATUS_IO_ERROR;
+    }
+
+    if (ata_error || key == 0x03 || key == 0x04) {
+        return PAL_STATUS_DEVICE_ERROR;     // MEDIUM ERROR, HARDWARE ERROR ou erro do ATA
+    }
+    *error_lba = UINT64_MAX;
+    if (key == 0x00 || key == 0x01) {
+        return PAL_STATUS_SUCCESS;          // sem erro ou RECOVERED ERROR: o setor foi lido
+    }
+    return PAL_STATUS_IO_ERROR;
+}
+
+static pal_status_t sgio_verify(int fd, pal_verify_method_t method, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    unsigned char cdb[16], sense[64];
+    memset(cdb, 0, sizeof(cdb));
+    if (method == PAL_VERIFY_SCSI) {
+        cdb[0] = 0x8F;                      // VERIFY(16)
+        cdb[1] = 0x10;                      // DPO; BYTCHK 0: nada é transferido
+        for (int i = 0; i < 8; ++i) cdb[2 + i] = (unsigned char)(lba >> (56 - 8 * i));
+        for (int i = 0; i < 4; ++i) cdb[10 + i] = (unsigned char)(count >> (24 - 8 * i));
+    } else {
+        cdb[0] = 0x85;                      // ATA PASS-THROUGH(16)
+        cdb[1] = (3 << 1) | 1;              // sem dados, comando de 48 bits
+        cdb[5] = (unsigned char)(count >> 8);   // 65536 vira 0, como o ATA espera
+        cdb[6] = (unsigned char)count;
+        cdb[7] = (unsigned char)(lba >> 24);
+        cdb[8] = (unsigned char)lba;
+        cdb[9] = (unsigned char)(lba >> 32);
+        cdb[10] = (unsigned char)(lba >> 8);
+        cdb[11] = (unsigned char)(lba >> 40);
+        cdb[12] = (unsigned char)(lba >> 16);
+        cdb[13] = 0x40;                     // modo LBA
+        cdb[14] = 0x42;                     // READ VERIFY SECTORS EXT
+    }
+
+    struct sg_io_hdr io_hdr;
+    if (sgio_exec(fd, cdb, sizeof(cdb), SG_DXFER_NONE, NULL, 0, sense, sizeof(sense), PAL_VERIFY_TIMEOUT_MS, &io_hdr) != 0) {
+        *error_lba = UINT64_MAX;
+        return PAL_STATUS_IO_ERROR;
+    }
+    return sgio_verify_result(&io_hdr, sense, error_lba);
+}
+
+// LBA do erro mais recente do Error Information log, se ele for um erro de
+// mídia deste namespace dentro de [lba, lba + count); UINT64_MAX se não for.
+static uint64_t nvme_error_log_lba(int fd, uint32_t nsid, uint64_t lba, uint32_t count) {
+    uint8_t entry[64];
+    struct nvme_admin_cmd cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.opcode = 0x02;      // Get Log Page
+    cmd.nsid = 0xFFFFFFFF;
+    cmd.addr = (uint64_t)(uintptr_t)entry;
+    cmd.data_len = sizeof(entry);
+    cmd.cdw10 = ((sizeof(entry) / 4 - 1) << 16) | 0x01;    // log 01h, só a entrada mais nova
+    if (ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd) != 0) return UINT64_MAX;
+
+    uint16_t status = entry[12] | (entry[13] << 8);
+    uint64_t error_lba = 0;
+    for (int i = 7; i >= 0; --i) error_lba = (error_lba << 8) | entry[16 + i];
+    uint32_t error_nsid = entry[24] | (entry[25] << 8) | (entry[26] << 16) | ((uint32_t)entry[27] << 24);
+    if (((status >> 9) & 0x7) != 2 || error_nsid != nsid || error_lba < lba || error_lba - lba >= count) {
+        return UINT64_MAX;
+    }
+    return error_lba;
+}
+
+static pal_status_t nvme_verify(int fd, uint32_t nsid, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    *error_lba = UINT64_MAX;
+    struct nvme_passthru_cmd cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.opcode = 0x0C;      // Verify
+    cmd.nsid = nsid;
+    cmd.cdw10 = (uint32_t)lba;
+    cmd.cdw11 = (uint32_t)(lba >> 32);
+    cmd.cdw12 = count - 1;  // NLB é zero-based
+    cmd.timeout_ms = PAL_VERIFY_TIMEOUT_MS;
+    int rc = ioctl(fd, NVME_IOCTL_IO_CMD, &cmd);
+    if (rc == 0) {
+        return PAL_STATUS_SUCCESS;
+    }
+    // Um valor positivo é o status da conclusão; o tipo 2 é erro de mídia ou de integridade.
+    if (rc > 0 && ((rc >> 8) & 0x7) == 2) {
+        *error_lba = nvme_error_log_lba(fd, nsid, lba, count);
+        return PAL_STATUS_DEVICE_ERROR;
+    }
+    return PAL_STATUS_IO_ERROR;
+}
+
+// Verify do NVMe só com o bit 7 do ONCS. O comando não transfere dados, mas
+// há controladores que ainda o limitam ao MDTS: se a faixa máxima for
+// recusada, fica-se no MDTS.
+static pal_status_t nvme_verify_probe(int fd, pal_verifier_t *verifier, uint64_t disk_sectors) {
+    int nsid = ioctl(fd, NVME_IOCTL_ID);
+    if (nsid <= 0) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    uint8_t identify[4096];
+    if (nvme_identify_controller(fd, identify) != 0) {
+        return (errno == EPERM || errno == EACCES) ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_UNSUPPORTED;
+    }
+    uint16_t oncs = identify[520] | (identify[521] << 8);
+    if (!(oncs & 0x80)) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+
+    uint32_t candidates[2] = { PAL_VERIFY_MAX_SECTORS, nvme_mdts_bytes(identify) / verifier->sector_size };
+    for (int i = 0; i < 2; ++i) {
+        uint32_t count = candidates[i];
+        if (count == 0 || (i > 0 && count >= candidates[0])) continue;
+        if (count > disk_sectors) count = (uint32_t)disk_sectors;
+        uint64_t error_lba;
+        pal_status_t probe = nvme_verify(fd, (uint32_t)nsid, 0, count, &error_lba);
+        if (probe == PAL_STATUS_SUCCESS || probe == PAL_STATUS_DEVICE_ERROR) {
+            verifier->method = PAL_VERIFY_NVME;
+            verifier->nsid = (uint32_t)nsid;
+            verifier->max_sectors = candidates[i];
+            return PAL_STATUS_SUCCESS;
+        }
+    }
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+// Comandos passthrough endereçam o disco inteiro: uma partição é verificada
+// pelo disco pai, com o LBA de início dela somado a cada comando.
+static bool verify_whole_disk(const char *device_path, uint32_t sector_size, char *disk_path, size_t disk_path_size, uint64_t *lba_offset) {
+    const char *dev_name = strrchr(device_path, '/');
+    dev_name = dev_name ? dev_name + 1 : device_path;
+    *lba_offset = 0;
+    snprintf(disk_path, disk_path_size, "%s", device_path);
+
+    char path[512], parent[PATH_MAX];
+    snprintf(path, sizeof(path), "/sys/class/block/%s/start", dev_name);
+    char *line = read_sysfs_line(path);
+    if (!line) {
+        return true;
+    }
+    uint64_t start = strtoull(line, NULL, 10);     // sempre em setores de 512 bytes
+    free(line);
+    snprintf(path, sizeof(path), "/sys/class/block/%s/..", dev_name);
+    if (!realpath(path, parent)) {
+        return false;
+    }
+    const char *parent_name = strrchr(parent, '/');
+    snprintf(disk_path, disk_path_size, "/dev/%s", parent_name ? parent_name + 1 : parent);
+    *lba_offset = start * 512 / sector_size;
+    return true;
+}
+
+pal_status_t pal_verify_open(const char *device_path, pal_verifier_t *verifier) {
+    if (!device_path || !verifier) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    memset(verifier, 0, sizeof(*verifier));
+    verifier->fd = -1;
+
+    pal_status_t status = pal_get_sector_sizes(device_path, &verifier->sector_size, NULL);
+    if (status != PAL_STATUS_SUCCESS) {
+        return status;
+    }
+    char disk_path[512];
+    if (!verify_whole_disk(device_path, verifier->sector_size, disk_path, sizeof(disk_path), &verifier->lba_offset)) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    int fd = open(disk_path, O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+
+    const char *dev_name = strrchr(disk_path, '/');
+    dev_name = dev_name ? dev_name + 1 : disk_path;
+    if (strncmp(dev_name, "nvme", 4) == 0) {
+        int64_t disk_size = pal_get_device_size(disk_path);
+        status = disk_size > 0 ? nvme_verify_probe(fd, verifier, (uint64_t)disk_size / verifier->sector_size) : PAL_STATUS_IO_ERROR;
+        if (status == PAL_STATUS_SUCCESS) {
+            verifier->fd = fd;
+        } else {
+            close(fd);
+        }
+        return status;
+    }
+
+    // Um setor do LBA 0 decide o método; um erro de mídia ali também prova que o comando existe.
+    static const pal_verify_method_t methods[] = { PAL_VERIFY_SCSI, PAL_VERIFY_ATA };
+    bool denied = false;
+    for (size_t i = 0; i < sizeof(methods) / sizeof(methods[0]); ++i) {
+        uint64_t error_lba;
+        errno = 0;
+        pal_status_t probe = sgio_verify(fd, methods[i], 0, 1, &error_lba);
+        if (probe == PAL_STATUS_SUCCESS || probe == PAL_STATUS_DEVICE_ERROR) {
+            verifier->method = methods[i];
+            verifier->max_sectors = PAL_VERIFY_MAX_SECTORS;
+            verifier->fd = fd;
+            return PAL_STATUS_SUCCESS;
+        }
+        if (errno == EPERM || errno == EACCES) denied = true;
+    }
+    close(fd);
+    return denied ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_verify_sectors(pal_verifier_t *verifier, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    uint64_t ignored;
+    if (!error_lba) error_lba = &ignored;
+    *error_lba = UINT64_MAX;
+    if (!verifier || verifier->fd < 0 || count == 0 || count > verifier->max_sectors) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    uint64_t disk_lba = lba + verifier->lba_offset;
+    pal_status_t status = verifier->method == PAL_VERIFY_NVME
+        ? nvme_verify(verifier->fd, verifier->nsid, disk_lba, count, error_lba)
+        : sgio_verify(verifier->fd, verifier->method, disk_lba, count, error_lba);
+    if (*error_lba != UINT64_MAX) {
+        *error_lba = *error_lba >= verifier->lba_offset ? *error_lba - verifier->lba_offset : UINT64_MAX;
+    }
+    return status;
+}
+
+void pal_verify_close(pal_verifier_t *verifier) {
+    if (verifier && verifier->fd >= 0) {
+        close(verifier->fd);
+        verifier->fd = -1;
+    }
+}
+
 int pal_get_smart_data(const char *device_path, struct smart_data *out) {
     if (!device_path || !out) {
         fprintf(stderr, "pal_get_smart_data (Linux): Invalid parameters.\n");
@@ -378,9 +1017,50 @@ int pal_get_smart_data(const char *device_path, struct smart_data *out) {
 
 #else 
 
-int pal_list_drives() {
-    printf("PAL Linux: Not available (not compiling for Linux).\n");
-    return 1;
+pal_status_t pal_list_drives(DriveInfo *drive_list, int max_drives, int *drive_count) {
+    (void)drive_list; (void)max_drives;
+    if (drive_count) *drive_count = 0;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_get_sector_sizes(const char *device_path, uint32_t *logical_size, uint32_t *physical_size) {
+    (void)device_path; (void)logical_size; (void)physical_size;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_get_queue_count(const char *device_path, int *queue_count) {
+    (void)device_path; (void)queue_count;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_get_queue_limits(const char *device_path, pal_queue_limits_t *limits) {
+    (void)device_path; (void)limits;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_verify_open(const char *device_path, pal_verifier_t *verifier) {
+    (void)device_path;
+    if (verifier) { memset(verifier, 0, sizeof(*verifier)); verifier->fd = -1; }
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_verify_sectors(pal_verifier_t *verifier, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    (void)verifier; (void)lba; (void)count; (void)error_lba;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+void pal_verify_close(pal_verifier_t *verifier) {
+    (void)verifier;
+}
+
+pal_status_t pal_get_io_counters(const char *device_path, pal_io_counters_t *counters) {
+    (void)device_path; (void)counters;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_map_fs_extents(const char *fs_path, const char *device_path, pal_fs_extent_callback callback, void *user_data) {
+    (void)fs_path; (void)device_path; (void)callback; (void)user_data;
+    return PAL_STATUS_UNSUPPORTED;
 }
 
 int64_t pal_get_device_size(const char *device_path) {
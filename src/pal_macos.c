@@ -21,6 +21,10 @@
 #include <IOKit/IOCFPlugIn.h>
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/disk.h>
+#include <sys/stat.h>
 #include <sys/sysctl.h>
 
 #define kIOPropertyNVMeSMARTCapableKey "NVMe SMART Capable"
@@ -687,6 +691,88 @@ int64_t pal_get_device_size(const char *device_path) {
     return device_size;
 }
 
+pal_status_t pal_get_sector_sizes(const char *device_path, uint32_t *logical_size, uint32_t *physical_size) {
+    if (!device_path || !logical_size) return PAL_STATUS_INVALID_PARAMETER;
+    int fd = open(device_path, O_RDONLY);
+    if (fd < 0) return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+
+    uint32_t logical = 0, physical = 0;
+    if (ioctl(fd, DKIOCGETBLOCKSIZE, &logical) < 0 || logical == 0) {
+        close(fd);
+        return PAL_STATUS_IO_ERROR;
+    }
+    if (ioctl(fd, DKIOCGETPHYSICALBLOCKSIZE, &physical) < 0 || physical == 0) {
+        physical = logical;
+    }
+    close(fd);
+
+    *logical_size = logical;
+    if (physical_size) *physical_size = physical;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_queue_count(const char *device_path, int *queue_count) {
+    (void)device_path; (void)queue_count;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_get_queue_limits(const char *device_path, pal_queue_limits_t *limits) {
+    if (!device_path || !limits) return PAL_STATUS_INVALID_PARAMETER;
+    memset(limits, 0, sizeof(*limits));
+    limits->rotational = -1;
+    pal_status_t status = pal_get_sector_sizes(device_path, &limits->logical_block_size, &limits->physical_block_size);
+    if (status != PAL_STATUS_SUCCESS) return status;
+
+    int fd = open(device_path, O_RDONLY);
+    if (fd >= 0) {
+        uint64_t max_read = 0;
+        if (ioctl(fd, DKIOCGETMAXBYTECOUNTREAD, &max_read) == 0 && max_read > 0) {
+            limits->max_transfer_bytes = max_read > UINT32_MAX ? UINT32_MAX : (uint32_t)max_read;
+        }
+        close(fd);
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_verify_open(const char *device_path, pal_verifier_t *verifier) {
+    // O macOS não deixa enviar comandos SCSI/ATA arbitrários a discos de bloco.
+    (void)device_path;
+    if (verifier) { memset(verifier, 0, sizeof(*verifier)); verifier->fd = -1; }
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_verify_sectors(pal_verifier_t *verifier, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    (void)verifier; (void)lba; (void)count; (void)error_lba;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+void pal_verify_close(pal_verifier_t *verifier) {
+    (void)verifier;
+}
+
+pal_status_t pal_get_io_counters(const char *device_path, pal_io_counters_t *counters) {
+    // As estatísticas do IOBlockStorageDriver não distinguem quem fez o I/O; sem suporte por ora.
+    (void)device_path; (void)counters;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_map_fs_extents(const char *fs_path, const char *device_path, pal_fs_extent_callback callback, void *user_data) {
+    // O APFS não expõe um FIEMAP; F_LOG2PHYS_EXT só resolve um offset por chamada.
+    (void)fs_path; (void)device_path; (void)callback; (void)user_data;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_ensure_directory_exists(const char* path) {
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        return S_ISDIR(st.st_mode) ? PAL_STATUS_SUCCESS : PAL_STATUS_ERROR_CREATING_DIR;
+    }
+    if (mkdir(path, 0755) == 0 || errno == EEXIST) {
+        return PAL_STATUS_SUCCESS;
+    }
+    return PAL_STATUS_ERROR_CREATING_DIR;
+}
+
 bool pal_get_basic_drive_info(const char *device_path, BasicDriveInfo *info) {
     if (!device_path || !info) return false;
     memset(info, 0, sizeof(BasicDriveInfo));
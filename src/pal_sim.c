@@ -0,0 +1,942 @@
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // O_DIRECT
+#endif
+
+#include "pal_sim.h"
+#include "pal.h"
+#include "smart.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#define SIM_MAX_FDS 4096
+
+typedef struct {
+    bool used;
+    char path[512];
+    pal_sim_config_t config;
+    uint64_t size;                              // bytes, múltiplo do setor lógico
+    pthread_mutex_t head;                       // rotacional: uma leitura por vez
+    atomic_uint_fast64_t reads;
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t fault_reads[PAL_SIM_MAX_FAULTS];   // leituras de cada faixa, para as falhas alternadas
+} sim_device_t;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_device_t g_devices[PAL_SIM_MAX_DEVICES];
+static sim_device_t* g_fd_devices[SIM_MAX_FDS];
+
+static void sim_copy(char* dst, size_t dst_size, const char* src) {
+    snprintf(dst, dst_size, "%s", src);
+}
+
+static void sim_add_attr(pal_sim_config_t* config, uint8_t id, uint8_t value, uint8_t worst, uint8_t threshold, uint64_t raw, uint16_t flags) {
+    if (config->attr_count >= MAX_SMART_ATTRIBUTES) {
+        return;
+    }
+    struct smart_attr* attr = &config->attrs[config->attr_count++];
+    memset(attr, 0, sizeof(*attr));
+    attr->id = id;
+    attr->flags = flags;
+    attr->value = value;
+    attr->worst = worst;
+    attr->threshold = threshold;
+    for (int i = 0; i < 6; i++) {
+        attr->raw[i] = (uint8_t)(raw >> (8 * i));
+    }
+}
+
+void pal_sim_config_init(pal_sim_config_t* config) {
+    memset(config, 0, sizeof(*config));
+    config->bus = PAL_SIM_BUS_ATA;
+    sim_copy(config->model, sizeof(config->model), "DiskOracle Simulated Disk");
+    sim_copy(config->serial, sizeof(config->serial), "SIM00000001");
+    sim_copy(config->firmware, sizeof(config->firmware), "SIM1.0");
+    config->sector_size = 512;
+    config->physical_sector_size = 4096;
+    config->queues = 1;
+
+    // Um disco saudável: nada realocado, pendente ou incorrigível.
+    sim_add_attr(config, 5, 100, 100, 10, 0, SMART_ATTR_FLAG_PREFAIL | SMART_ATTR_FLAG_ONLINE_COLLECTION);
+    sim_add_attr(config, 9, 99, 99, 0, 1200, SMART_ATTR_FLAG_ONLINE_COLLECTION);
+    sim_add_attr(config, 12, 99, 99, 0, 150, SMART_ATTR_FLAG_ONLINE_COLLECTION);
+    sim_add_attr(config, 194, 65, 50, 0, 35, SMART_ATTR_FLAG_ONLINE_COLLECTION);
+    sim_add_attr(config, 197, 100, 100, 0, 0, SMART_ATTR_FLAG_ONLINE_COLLECTION);
+    sim_add_attr(config, 198, 100, 100, 0, 0, 0);
+
+    config->health.temperature_kelvin = 308;
+    config->health.available_spare = 100;
+    config->health.spare_threshold = 10;
+    config->health.power_on_hours = 1200;
+    config->health.power_cycles = 150;
+    config->mdts = 5;
+}
+
+// --- Arquivo de configuração ---
+
+static char* sim_trim(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) *--end = '\0';
+    return s;
+}
+
+// Número com sufixo binário opcional (K, M, G, T), ou porcentagem do tamanho
+// do disco quando percent não é NULL.
+static bool sim_parse_size(const char* text, uint64_t* out, double* percent) {
+    char* end = NULL;
+    errno = 0;
+    double value = strtod(text, &end);
+    if (end == text || errno != 0 || value < 0) {
+        return false;
+    }
+    if (percent) *percent = -1.0;
+    switch (toupper((unsigned char)*end)) {
+        case '\0': break;
+        case 'K': value *= 1024.0; end++; break;
+        case 'M': value *= 1024.0 * 1024.0; end++; break;
+        case 'G': value *= 1024.0 * 1024.0 * 1024.0; end++; break;
+        case 'T': value *= 1024.0 * 1024.0 * 1024.0 * 1024.0; end++; break;
+        case '%':
+            if (!percent || value > 100.0) return false;
+            *percent = value;
+            value = 0;
+            end++;
+            break;
+        default: return false;
+    }
+    if (toupper((unsigned char)*end) == 'B') end++;
+    if (*end != '\0') {
+        return false;
+    }
+    *out = (uint64_t)value;
+    return true;
+}
+
+static bool sim_parse_uint(const char* text, uint64_t max, uint64_t* out) {
+    char* end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 0);
+    if (end == text || *end != '\0' || errno != 0 || value > max || text[0] == '-') {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static bool sim_parse_bool(const char* text, bool* out) {
+    if (strcasecmp(text, "yes") == 0 || strcasecmp(text, "true") == 0 || strcmp(text, "1") == 0) {
+        *out = true;
+        return true;
+    }
+    if (strcasecmp(text, "no") == 0 || strcasecmp(text, "false") == 0 || strcmp(text, "0") == 0) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+// Divide value em até max campos separados por espaços (in-place).
+static int sim_split(char* value, char** fields, int max) {
+    int count = 0;
+    char* save = NULL;
+    for (char* tok = strtok_r(value, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        if (count == max) {
+            return max + 1;
+        }
+        fields[count++] = tok;
+    }
+    return count;
+}
+
+typedef struct {
+    double start_percent[PAL_SIM_MAX_REGIONS];  // -1 = em bytes
+    double end_percent[PAL_SIM_MAX_REGIONS];
+    bool attrs_seen;
+} sim_parse_state_t;
+
+static bool sim_parse_line(pal_sim_config_t* config, sim_parse_state_t* state, char* key, char* value) {
+    uint64_t n = 0;
+    char* fields[6];
+
+    if (strcasecmp(key, "bus") == 0) {
+        if (strcasecmp(value, "ata") == 0 || strcasecmp(value, "sata") == 0) config->bus = PAL_SIM_BUS_ATA;
+        else if (strcasecmp(value, "nvme") == 0) config->bus = PAL_SIM_BUS_NVME;
+        else return false;
+    } else if (strcasecmp(key, "model") == 0) {
+        sim_copy(config->model, sizeof(config->model), value);
+    } else if (strcasecmp(key, "serial") == 0) {
+        sim_copy(config->serial, sizeof(config->serial), value);
+    } else if (strcasecmp(key, "firmware") == 0) {
+        sim_copy(config->firmware, sizeof(config->firmware), value);
+    } else if (strcasecmp(key, "image") == 0) {
+        sim_copy(config->image, sizeof(config->image), value);
+    } else if (strcasecmp(key, "size") == 0) {
+        return sim_parse_size(value, &config->size, NULL);
+    } else if (strcasecmp(key, "sector_size") == 0 || strcasecmp(key, "physical_sector_size") == 0) {
+        if (!sim_parse_uint(value, 65536, &n) || n < 512 || (n & (n - 1)) != 0) return false;
+        if (tolower((unsigned char)key[0]) == 's') config->sector_size = (uint32_t)n;
+        else config->physical_sector_size = (uint32_t)n;
+    } else if (strcasecmp(key, "queues") == 0) {
+        if (!sim_parse_uint(value, 1024, &n) || n == 0) return false;
+        config->queues = (int)n;
+    } else if (strcasecmp(key, "rotational") == 0) {
+        return sim_parse_bool(value, &config->rotational);
+    } else if (strcasecmp(key, "region") == 0) {
+        // region = início fim latência_us [MiB/s]
+        int count = sim_split(value, fields, 4);
+        if (count < 3 || count > 4 || config->region_count >= PAL_SIM_MAX_REGIONS) return false;
+        pal_sim_region_t* region = &config->regions[config->region_count];
+        if (!sim_parse_size(fields[0], &region->start, &state->start_percent[config->region_count]) ||
+            !sim_parse_size(fields[1], &region->end, &state->end_percent[config->region_count]) ||
+            !sim_parse_uint(fields[2], UINT32_MAX, &n)) {
+            return false;
+        }
+        region->latency_us = (uint32_t)n;
+        region->mbps = 0;
+        if (count == 4) {
+            char* end = NULL;
+            region->mbps = strtod(fields[3], &end);
+            if (end == fields[3] || *end != '\0' || region->mbps < 0) return false;
+        }
+        config->region_count++;
+    } else if (strcasecmp(key, "fault") == 0) {
+        // fault = lba quantidade [eio|flaky|flip]
+        int count = sim_split(value, fields, 3);
+        if (count < 2 || count > 3 || config->fault_count >= PAL_SIM_MAX_FAULTS) return false;
+        pal_sim_fault_t* fault = &config->faults[config->fault_count];
+        if (!sim_parse_uint(fields[0], UINT64_MAX, &fault->lba) || !sim_parse_uint(fields[1], UINT64_MAX, &fault->count) || fault->count == 0) {
+            return false;
+        }
+        fault->kind = PAL_SIM_FAULT_EIO;
+        if (count == 3) {
+            if (strcasecmp(fields[2], "eio") == 0) fault->kind = PAL_SIM_FAULT_EIO;
+            else if (strcasecmp(fields[2], "flaky") == 0) fault->kind = PAL_SIM_FAULT_FLAKY;
+            else if (strcasecmp(fields[2], "flip") == 0) fault->kind = PAL_SIM_FAULT_FLIP;
+            else return false;
+        }
+        config->fault_count++;
+    } else if (strcasecmp(key, "attr") == 0) {
+        // attr = id valor pior limite raw [flags]; o primeiro substitui os atributos padrão
+        uint64_t v[6] = {0};
+        int count = sim_split(value, fields, 6);
+        if (count < 5 || count > 6) return false;
+        static const uint64_t max[6] = {255, 255, 255, 255, 0xFFFFFFFFFFFFULL, 0xFFFF};
+        for (int i = 0; i < count; i++) {
+            if (!sim_parse_uint(fields[i], max[i], &v[i])) return false;
+        }
+        if (v[0] == 0) return false;
+        if (!state->attrs_seen) {
+            config->attr_count = 0;
+            state->attrs_seen = true;
+        }
+        for (int i = 0; i < config->attr_count; i++) {
+            if (config->attrs[i].id == v[0]) {
+                config->attrs[i] = config->attrs[--config->attr_count];
+                break;
+            }
+        }
+        if (config->attr_count >= MAX_SMART_ATTRIBUTES) return false;
+        sim_add_attr(config, (uint8_t)v[0], (uint8_t)v[1], (uint8_t)v[2], (uint8_t)v[3], v[4], (uint16_t)v[5]);
+    } else if (strcasecmp(key, "temperature") == 0) {
+        // Celsius, como o usuário lê; o log guarda Kelvin.
+        if (!sim_parse_uint(value, 200, &n)) return false;
+        config->health.temperature_kelvin = (uint16_t)(n + 273);
+    } else {
+        static const struct {
+            const char* key;
+            size_t offset;
+            int width;
+            uint64_t max;
+        } numeric[] = {
+            { "critical_warning", offsetof(pal_sim_config_t, health.critical_warning), 1, 0xFF },
+            { "available_spare", offsetof(pal_sim_config_t, health.available_spare), 1, 100 },
+            { "spare_threshold", offsetof(pal_sim_config_t, health.spare_threshold), 1, 100 },
+            { "percentage_used", offsetof(pal_sim_config_t, health.percentage_used), 1, 255 },
+            { "data_units_read", offsetof(pal_sim_config_t, health.data_units_read), 8, UINT64_MAX },
+            { "data_units_written", offsetof(pal_sim_config_t, health.data_units_written), 8, UINT64_MAX },
+            { "power_cycles", offsetof(pal_sim_config_t, health.power_cycles), 8, UINT64_MAX },
+            { "power_on_hours", offsetof(pal_sim_config_t, health.power_on_hours), 8, UINT64_MAX },
+            { "unsafe_shutdowns", offsetof(pal_sim_config_t, health.unsafe_shutdowns), 8, UINT64_MAX },
+            { "media_errors", offsetof(pal_sim_config_t, health.media_errors), 8, UINT64_MAX },
+            { "error_log_entries", offsetof(pal_sim_config_t, health.error_log_entries), 8, UINT64_MAX },
+            { "mdts", offsetof(pal_sim_config_t, mdts), 1, 0xFF },
+            { "oncs", offsetof(pal_sim_config_t, oncs), 2, 0xFFFF },
+        };
+        for (size_t i = 0; i < sizeof(numeric) / sizeof(numeric[0]); i++) {
+            if (strcasecmp(key, numeric[i].key) != 0) continue;
+            if (!sim_parse_uint(value, numeric[i].max, &n)) return false;
+            uint8_t* field = (uint8_t*)config + numeric[i].offset;
+            if (numeric[i].width == 1) *field = (uint8_t)n;
+            else if (numeric[i].width == 2) *(uint16_t*)field = (uint16_t)n;
+            else *(uint64_t*)field = n;
+            return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+// Tamanho final do disco (o da imagem se não foi dado) e regiões em porcentagem.
+static pal_status_t sim_resolve(const pal_sim_config_t* config, const sim_parse_state_t* state, uint64_t* size_out, pal_sim_config_t* resolved) {
+    uint64_t size = config->size;
+    if (config->image[0] != '\0') {
+        struct stat st;
+        if (stat(config->image, &st) != 0) {
+            return PAL_STATUS_DEVICE_NOT_FOUND;
+        }
+        if (size == 0) size = (uint64_t)st.st_size;
+    }
+    size -= size % config->sector_size;
+    if (size == 0 || config->physical_sector_size < config->sector_size) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    if (resolved) {
+        for (unsigned i = 0; i < resolved->region_count; i++) {
+            if (state && state->start_percent[i] >= 0) resolved->regions[i].start = (uint64_t)((double)size * state->start_percent[i] / 100.0);
+            if (state && state->end_percent[i] >= 0) resolved->regions[i].end = (uint64_t)((double)size * state->end_percent[i] / 100.0);
+        }
+    }
+    *size_out = size;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_sim_load_config(const char* config_path, pal_sim_config_t* config) {
+    if (!config_path || !config) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    FILE* file = fopen(config_path, "r");
+    if (!file) {
+        return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    pal_sim_config_init(config);
+    sim_parse_state_t state;
+    memset(&state, 0, sizeof(state));
+
+    char line[1024];
+    int line_number = 0;
+    pal_status_t status = PAL_STATUS_SUCCESS;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* text = sim_trim(line);
+        if (*text == '\0') continue;
+
+        char* eq = strchr(text, '=');
+        if (!eq) {
+            status = PAL_STATUS_INVALID_PARAMETER;
+        } else {
+            *eq = '\0';
+            char* key = sim_trim(text);
+            char* value = sim_trim(eq + 1);
+            if (!sim_parse_line(config, &state, key, value)) {
+                status = PAL_STATUS_INVALID_PARAMETER;
+            }
+        }
+        if (status != PAL_STATUS_SUCCESS) {
+            fprintf(stderr, "%s:%d: invalid simulated device setting.\n", config_path, line_number);
+            break;
+        }
+    }
+    fclose(file);
+    if (status != PAL_STATUS_SUCCESS) {
+        return status;
+    }
+
+    // A imagem é relativa ao diretório do arquivo de configuração.
+    if (config->image[0] != '\0' && config->image[0] != '/') {
+        const char* slash = strrchr(config_path, '/');
+        if (slash) {
+            char image[sizeof(config->image) * 2];
+            int written = snprintf(image, sizeof(image), "%.*s/%s", (int)(slash - config_path), config_path, config->image);
+            if (written < 0 || (size_t)written >= sizeof(config->image)) {
+                fprintf(stderr, "%s: image path too long.\n", config_path);
+                return PAL_STATUS_INVALID_PARAMETER;
+            }
+            memcpy(config->image, image, (size_t)written + 1);
+        }
+    }
+
+    if (config->physical_sector_size < config->sector_size) {
+        config->physical_sector_size = config->sector_size;
+    }
+    uint64_t size = 0;
+    status = sim_resolve(config, &state, &size, config);
+    if (status != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "%s: %s\n", config_path, config->image[0] != '\0' && status == PAL_STATUS_DEVICE_NOT_FOUND
+                ? "image file not found." : "the simulated device has no size.");
+        return status;
+    }
+    config->size = size;
+    return PAL_STATUS_SUCCESS;
+}
+
+// --- Registro de dispositivos ---
+
+static sim_device_t* sim_find_locked(const char* device_path) {
+    for (int i = 0; i < PAL_SIM_MAX_DEVICES; i++) {
+        if (g_devices[i].used && strcmp(g_devices[i].path, device_path) == 0) {
+            return &g_devices[i];
+        }
+    }
+    return NULL;
+}
+
+static pal_status_t sim_register_locked(const char* device_path, const pal_sim_config_t* config, sim_device_t** out) {
+    uint64_t size = 0;
+    pal_status_t status = sim_resolve(config, NULL, &size, NULL);
+    if (status != PAL_STATUS_SUCCESS) {
+        return status;
+    }
+    sim_device_t* dev = sim_find_locked(device_path);
+    for (int i = 0; !dev && i < PAL_SIM_MAX_DEVICES; i++) {
+        if (!g_devices[i].used) {
+            dev = &g_devices[i];
+            pthread_mutex_init(&dev->head, NULL);
+        }
+    }
+    if (!dev) {
+        return PAL_STATUS_NO_MEMORY;
+    }
+    dev->used = true;
+    sim_copy(dev->path, sizeof(dev->path), device_path);
+    dev->config = *config;
+    dev->size = size;
+    atomic_store(&dev->reads, 0);
+    atomic_store(&dev->bytes, 0);
+    for (int i = 0; i < PAL_SIM_MAX_FAULTS; i++) {
+        atomic_store(&dev->fault_reads[i], 0);
+    }
+    if (out) *out = dev;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_sim_register(const char* device_path, const pal_sim_config_t* config) {
+    if (!device_path || !config || config->sector_size == 0) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pthread_mutex_lock(&g_lock);
+    pal_status_t status = sim_register_locked(device_path, config, NULL);
+    pthread_mutex_unlock(&g_lock);
+    return status;
+}
+
+void pal_sim_reset(void) {
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < PAL_SIM_MAX_DEVICES; i++) {
+        if (g_devices[i].used) {
+            pthread_mutex_destroy(&g_devices[i].head);
+        }
+        g_devices[i].used = false;
+    }
+    memset(g_fd_devices, 0, sizeof(g_fd_devices));
+    pthread_mutex_unlock(&g_lock);
+}
+
+// Dispositivo de device_path; um caminho ainda não registrado é lido como
+// arquivo de configuração.
+static sim_device_t* sim_lookup(const char* device_path, pal_status_t* status_out) {
+    pal_status_t status = PAL_STATUS_SUCCESS;
+    pthread_mutex_lock(&g_lock);
+    sim_device_t* dev = sim_find_locked(device_path);
+    if (!dev) {
+        pal_sim_config_t* config = malloc(sizeof(*config));
+        if (!config) {
+            status = PAL_STATUS_NO_MEMORY;
+        } else {
+            status = pal_sim_load_config(device_path, config);
+            if (status == PAL_STATUS_SUCCESS) {
+                status = sim_register_locked(device_path, config, &dev);
+            }
+            free(config);
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+    if (status_out) *status_out = status;
+    return dev;
+}
+
+static sim_device_t* sim_fd_device(int fd) {
+    return (fd >= 0 && fd < SIM_MAX_FDS) ? g_fd_devices[fd] : NULL;
+}
+
+// --- E/S ---
+
+int pal_sim_open(const char* device_path, bool direct_io) {
+    pal_status_t status = PAL_STATUS_DEVICE_NOT_FOUND;
+    sim_device_t* dev = device_path ? sim_lookup(device_path, &status) : NULL;
+    if (!dev) {
+        errno = (device_path && status == PAL_STATUS_ACCESS_DENIED) ? EACCES : ENOENT;
+        return -1;
+    }
+    int fd;
+    if (dev->config.image[0] != '\0') {
+#ifdef O_DIRECT
+        fd = open(dev->config.image, direct_io ? (O_RDONLY | O_DIRECT) : O_RDONLY);
+#else
+        (void)direct_io;
+        fd = open(dev->config.image, O_RDONLY);
+#endif
+    } else {
+        // Sem imagem o disco só tem zeros: o descritor serve de identificador.
+        fd = open("/dev/null", O_RDONLY);
+    }
+    if (fd < 0) {
+        return -1;
+    }
+    if (fd >= SIM_MAX_FDS) {
+        close(fd);
+        errno = EMFILE;
+        return -1;
+    }
+    pthread_mutex_lock(&g_lock);
+    g_fd_devices[fd] = dev;
+    pthread_mutex_unlock(&g_lock);
+    return fd;
+}
+
+void pal_sim_close(int fd) {
+    if (fd < 0) {
+        return;
+    }
+    if (fd < SIM_MAX_FDS) {
+        pthread_mutex_lock(&g_lock);
+        g_fd_devices[fd] = NULL;
+        pthread_mutex_unlock(&g_lock);
+    }
+    close(fd);
+}
+
+static void sim_sleep_ns(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+// Custo da leitura pela região onde ela começa; a última região que contém o
+// offset vence, para uma faixa lenta poder ser declarada dentro de outra.
+static uint64_t sim_read_cost_ns(const sim_device_t* dev, uint64_t offset, uint32_t len) {
+    const pal_sim_region_t* region = NULL;
+    for (unsigned i = 0; i < dev->config.region_count; i++) {
+        const pal_sim_region_t* r = &dev->config.regions[i];
+        if (offset >= r->start && offset < r->end) region = r;
+    }
+    if (!region) {
+        return 0;
+    }
+    uint64_t ns = (uint64_t)region->latency_us * 1000ULL;
+    if (region->mbps > 0) {
+        ns += (uint64_t)((double)len * 1e9 / (region->mbps * 1024.0 * 1024.0));
+    }
+    return ns;
+}
+
+int64_t pal_sim_read(int fd, void* buf, uint32_t len, uint64_t offset) {
+    sim_device_t* dev = sim_fd_device(fd);
+    if (!dev) {
+        return (int64_t)pread(fd, buf, len, (off_t)offset);
+    }
+    if (offset >= dev->size || len == 0) {
+        return 0;
+    }
+    if ((uint64_t)len > dev->size - offset) {
+        len = (uint32_t)(dev->size - offset);
+    }
+
+    uint64_t cost = sim_read_cost_ns(dev, offset, len);
+    if (dev->config.rotational) {
+        pthread_mutex_lock(&dev->head);
+        sim_sleep_ns(cost);
+        pthread_mutex_unlock(&dev->head);
+    } else if (cost > 0) {
+        sim_sleep_ns(cost);
+    }
+    atomic_fetch_add(&dev->reads, 1);
+    atomic_fetch_add(&dev->bytes, len);
+
+    uint32_t sector = dev->config.sector_size;
+    uint64_t first = offset / sector;
+    uint64_t last = (offset + len - 1) / sector;
+    uint64_t flip_lba = UINT64_MAX;
+    for (unsigned i = 0; i < dev->config.fault_count; i++) {
+        const pal_sim_fault_t* fault = &dev->config.faults[i];
+        if (fault->lba > last || fault->lba + fault->count <= first) {
+            continue;
+        }
+        bool odd = atomic_fetch_add(&dev->fault_reads[i], 1) % 2 == 0;
+        if (fault->kind == PAL_SIM_FAULT_EIO || (fault->kind == PAL_SIM_FAULT_FLAKY && odd)) {
+            errno = EIO;
+            return -1;
+        }
+        if (fault->kind == PAL_SIM_FAULT_FLIP && odd && flip_lba == UINT64_MAX) {
+            flip_lba = fault->lba > first ? fault->lba : first;
+        }
+    }
+
+    ssize_t n = pread(fd, buf, len, (off_t)offset);
+    if (n < 0) {
+        return -1;
+    }
+    if ((uint32_t)n < len) {
+        memset((uint8_t*)buf + n, 0, len - (uint32_t)n);   // além do fim da imagem
+    }
+    if (flip_lba != UINT64_MAX) {
+        ((uint8_t*)buf)[flip_lba * sector - offset] ^= 0x01;
+    }
+    return (int64_t)len;
+}
+
+// --- PAL ---
+
+pal_status_t pal_initialize(void) {
+    return PAL_STATUS_SUCCESS;
+}
+
+void pal_cleanup(void) {
+}
+
+int64_t pal_get_device_size(const char* device_path) {
+    sim_device_t* dev = device_path ? sim_lookup(device_path, NULL) : NULL;
+    return dev ? (int64_t)dev->size : -1;
+}
+
+pal_status_t pal_get_sector_sizes(const char* device_path, uint32_t* logical_size, uint32_t* physical_size) {
+    if (!device_path || !logical_size) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    *logical_size = dev->config.sector_size;
+    if (physical_size) *physical_size = dev->config.physical_sector_size;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_queue_count(const char* device_path, int* queue_count) {
+    if (!device_path || !queue_count) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    *queue_count = dev->config.queues;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_queue_limits(const char* device_path, pal_queue_limits_t* limits) {
+    if (!device_path || !limits) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    memset(limits, 0, sizeof(*limits));
+    limits->logical_block_size = dev->config.sector_size;
+    limits->physical_block_size = dev->config.physical_sector_size;
+    limits->rotational = dev->config.rotational ? 1 : 0;
+    if (dev->config.bus == PAL_SIM_BUS_NVME && dev->config.mdts > 0 && dev->config.mdts <= 19) {
+        limits->nvme_mdts_bytes = 4096u << dev->config.mdts;
+        limits->max_transfer_bytes = limits->nvme_mdts_bytes;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Verify simulado no barramento ATA e, com o bit 7 do ONCS, no NVMe: o disco
+// lê a faixa sem transferir nada, com o mesmo custo e as mesmas falhas de uma leitura.
+pal_status_t pal_verify_open(const char* device_path, pal_verifier_t* verifier) {
+    if (!device_path || !verifier) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    memset(verifier, 0, sizeof(*verifier));
+    verifier->fd = -1;
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    if (dev->config.bus == PAL_SIM_BUS_NVME && !(dev->config.oncs & 0x80)) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    int fd = pal_sim_open(device_path, false);
+    if (fd < 0) {
+        return errno == EACCES ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    verifier->method = dev->config.bus == PAL_SIM_BUS_NVME ? PAL_VERIFY_NVME : PAL_VERIFY_ATA;
+    verifier->nsid = dev->config.bus == PAL_SIM_BUS_NVME ? 1 : 0;
+    verifier->sector_size = dev->config.sector_size;
+    verifier->max_sectors = 65536;
+    verifier->fd = fd;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_verify_sectors(pal_verifier_t* verifier, uint64_t lba, uint32_t count, uint64_t* error_lba) {
+    uint64_t ignored;
+    if (!error_lba) error_lba = &ignored;
+    *error_lba = UINT64_MAX;
+    if (!verifier || count == 0 || count > verifier->max_sectors) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    sim_device_t* dev = sim_fd_device(verifier->fd);
+    if (!dev) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    uint32_t sector = dev->config.sector_size;
+    uint64_t sectors = dev->size / sector;
+    if (lba >= sectors || count > sectors - lba) {
+        return PAL_STATUS_IO_ERROR;     // ILLEGAL REQUEST: além do fim do disco
+    }
+
+    uint64_t cost = sim_read_cost_ns(dev, lba * sector, (uint32_t)((uint64_t)count * sector > UINT32_MAX ? UINT32_MAX : (uint64_t)count * sector));
+    if (dev->config.rotational) {
+        pthread_mutex_lock(&dev->head);
+        sim_sleep_ns(cost);
+        pthread_mutex_unlock(&dev->head);
+    } else if (cost > 0) {
+        sim_sleep_ns(cost);
+    }
+
+    // Como o disco, para no primeiro setor ilegível e informa o LBA dele.
+    uint64_t last = lba + count - 1;
+    for (unsigned i = 0; i < dev->config.fault_count; i++) {
+        const pal_sim_fault_t* fault = &dev->config.faults[i];
+        if (fault->lba > last || fault->lba + fault->count <= lba || fault->kind == PAL_SIM_FAULT_FLIP) {
+            continue;
+        }
+        bool odd = atomic_fetch_add(&dev->fault_reads[i], 1) % 2 == 0;
+        if (fault->kind == PAL_SIM_FAULT_EIO || odd) {
+            uint64_t first_bad = fault->lba > lba ? fault->lba : lba;
+            if (first_bad < *error_lba) *error_lba = first_bad;
+        }
+    }
+    return *error_lba == UINT64_MAX ? PAL_STATUS_SUCCESS : PAL_STATUS_DEVICE_ERROR;
+}
+
+void pal_verify_close(pal_verifier_t* verifier) {
+    if (verifier && verifier->fd >= 0) {
+        pal_sim_close(verifier->fd);
+        verifier->fd = -1;
+    }
+}
+
+pal_status_t pal_get_io_counters(const char* device_path, pal_io_counters_t* counters) {
+    if (!device_path || !counters) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    memset(counters, 0, sizeof(*counters));
+    counters->reads_completed = atomic_load(&dev->reads);
+    counters->sectors_read = atomic_load(&dev->bytes) / 512;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_map_fs_extents(const char* fs_path, const char* device_path, pal_fs_extent_callback callback, void* user_data) {
+    (void)fs_path;
+    (void)device_path;
+    (void)callback;
+    (void)user_data;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+PAL_BUS_TYPE pal_get_device_bus_type(const char* device_path) {
+    sim_device_t* dev = device_path ? sim_lookup(device_path, NULL) : NULL;
+    if (!dev) {
+        return PAL_BUS_TYPE_UNKNOWN;
+    }
+    return dev->config.bus == PAL_SIM_BUS_NVME ? PAL_BUS_TYPE_NVME : PAL_BUS_TYPE_SATA;
+}
+
+pal_status_t pal_get_basic_drive_info(const char* device_path, BasicDriveInfo* drive_info) {
+    if (!device_path || !drive_info) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    memset(drive_info, 0, sizeof(*drive_info));
+    bool nvme = dev->config.bus == PAL_SIM_BUS_NVME;
+    sim_copy(drive_info->path, sizeof(drive_info->path), device_path);
+    sim_copy(drive_info->model, sizeof(drive_info->model), dev->config.model);
+    sim_copy(drive_info->serial, sizeof(drive_info->serial), dev->config.serial);
+    sim_copy(drive_info->firmware_rev, sizeof(drive_info->firmware_rev), dev->config.firmware);
+    sim_copy(drive_info->type, sizeof(drive_info->type), dev->config.rotational ? "HDD" : "SSD");
+    sim_copy(drive_info->bus_type, sizeof(drive_info->bus_type), nvme ? "NVMe" : "SATA");
+    drive_info->size_bytes = (int64_t)dev->size;
+    drive_info->is_ssd = !dev->config.rotational;
+    drive_info->smart_capable = true;
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_list_drives(DriveInfo* drives, int max_drives, int* drive_count) {
+    if (!drives || !drive_count || max_drives <= 0) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    *drive_count = 0;
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < PAL_SIM_MAX_DEVICES && *drive_count < max_drives; i++) {
+        const sim_device_t* dev = &g_devices[i];
+        if (!dev->used) continue;
+        DriveInfo* drive = &drives[(*drive_count)++];
+        memset(drive, 0, sizeof(*drive));
+        sim_copy(drive->device_path, sizeof(drive->device_path), dev->path);
+        sim_copy(drive->model, sizeof(drive->model), dev->config.model);
+        sim_copy(drive->serial, sizeof(drive->serial), dev->config.serial);
+        sim_copy(drive->type, sizeof(drive->type), dev->config.bus == PAL_SIM_BUS_NVME ? "NVMe" : "SATA");
+        drive->size_bytes = (int64_t)dev->size;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return *drive_count > 0 ? PAL_STATUS_SUCCESS : PAL_STATUS_NO_DRIVES_FOUND;
+}
+
+// Contador de 128 bits do health log, little-endian.
+static void sim_put_counter(uint8_t dst[16], uint64_t value) {
+    memset(dst, 0, 16);
+    for (int i = 0; i < 8; i++) {
+        dst[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+pal_status_t pal_get_smart_data(const char* device_path, struct smart_data* data) {
+    if (!device_path || !data) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    memset(data, 0, sizeof(*data));
+    sim_copy(data->device_name, sizeof(data->device_name), device_path);
+    const pal_sim_config_t* config = &dev->config;
+
+    if (config->bus == PAL_SIM_BUS_ATA) {
+        data->is_nvme = 0;
+        data->drive_type = DRIVE_TYPE_ATA;
+        data->attr_count = config->attr_count;
+        memcpy(data->data.attrs, config->attrs, sizeof(config->attrs[0]) * (size_t)config->attr_count);
+        return PAL_STATUS_SUCCESS;
+    }
+
+    data->is_nvme = 1;
+    data->drive_type = DRIVE_TYPE_NVME;
+    data->attr_count = 1;
+    struct smart_nvme* nvme = &data->data.nvme;
+    NVME_HEALTH_INFO_LOG* log = &nvme->raw_health_log;
+    const pal_sim_nvme_health_t* health = &config->health;
+    log->CriticalWarning.AsUchar = health->critical_warning;
+    log->Temperature[0] = (uint8_t)(health->temperature_kelvin & 0xFF);
+    log->Temperature[1] = (uint8_t)(health->temperature_kelvin >> 8);
+    log->AvailableSpare = health->available_spare;
+    log->AvailableSpareThreshold = health->spare_threshold;
+    log->PercentageUsed = health->percentage_used;
+    sim_put_counter(log->DataUnitRead, health->data_units_read);
+    sim_put_counter(log->DataUnitWritten, health->data_units_written);
+    sim_put_counter(log->PowerCycle, health->power_cycles);
+    sim_put_counter(log->PowerOnHours, health->power_on_hours);
+    sim_put_counter(log->UnsafeShutdowns, health->unsafe_shutdowns);
+    sim_put_counter(log->MediaErrors, health->media_errors);
+    sim_put_counter(log->ErrorInfoLogEntryCount, health->error_log_entries);
+
+    nvme->critical_warning = log->CriticalWarning.AsUchar;
+    memcpy(nvme->temperature, log->Temperature, 2);
+    nvme->avail_spare = log->AvailableSpare;
+    nvme->spare_thresh = log->AvailableSpareThreshold;
+    nvme->percent_used = log->PercentageUsed;
+    memcpy(nvme->firmware, config->firmware, strnlen(config->firmware, sizeof(nvme->firmware)));
+    memcpy(nvme->data_units_read, log->DataUnitRead, 16);
+    memcpy(nvme->data_units_written, log->DataUnitWritten, 16);
+    memcpy(nvme->power_cycles, log->PowerCycle, 16);
+    memcpy(nvme->power_on_hours, log->PowerOnHours, 16);
+    memcpy(nvme->unsafe_shutdowns, log->UnsafeShutdowns, 16);
+    memcpy(nvme->media_errors, log->MediaErrors, 16);
+    memcpy(nvme->num_err_log_entries, log->ErrorInfoLogEntryCount, 16);
+    return PAL_STATUS_SUCCESS;
+}
+
+// Campo ASCII do Identify, completado com espaços.
+static void sim_put_ascii(uint8_t* dst, size_t width, const char* text) {
+    memset(dst, ' ', width);
+    memcpy(dst, text, strnlen(text, width));
+}
+
+pal_status_t pal_get_nvme_identify_data(const char* device_path, uint8_t* buffer_4k) {
+    if (!device_path || !buffer_4k) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    pal_status_t status;
+    sim_device_t* dev = sim_lookup(device_path, &status);
+    if (!dev) {
+        return status;
+    }
+    if (dev->config.bus != PAL_SIM_BUS_NVME) {
+        return PAL_STATUS_WRONG_DRIVE_TYPE;
+    }
+    memset(buffer_4k, 0, 4096);
+    sim_put_ascii(buffer_4k + 4, 20, dev->config.serial);
+    sim_put_ascii(buffer_4k + 24, 40, dev->config.model);
+    sim_put_ascii(buffer_4k + 64, 8, dev->config.firmware);
+    buffer_4k[77] = dev->config.mdts;
+    buffer_4k[520] = (uint8_t)(dev->config.oncs & 0xFF);
+    buffer_4k[521] = (uint8_t)(dev->config.oncs >> 8);
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_get_nvme_error_log(const char* device_path, uint8_t entry_index, NVMeErrorLogEntry* log_entry) {
+    (void)entry_index;
+    if (!device_path || !log_entry) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    memset(log_entry, 0, sizeof(*log_entry));
+    return pal_get_device_bus_type(device_path) == PAL_BUS_TYPE_NVME ? PAL_STATUS_SUCCESS : PAL_STATUS_WRONG_DRIVE_TYPE;
+}
+
+pal_status_t pal_create_directory(const char* path) {
+    if (!path) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    return (mkdir(path, 0755) == 0 || errno == EEXIST) ? PAL_STATUS_SUCCESS : PAL_STATUS_ERROR_CREATING_DIR;
+}
+
+pal_status_t pal_ensure_directory_exists(const char* path) {
+    if (!path || !*path) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    char buffer[1024];
+    sim_copy(buffer, sizeof(buffer), path);
+    for (char* p = buffer + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            if (pal_create_directory(buffer) != PAL_STATUS_SUCCESS) return PAL_STATUS_ERROR_CREATING_DIR;
+            *p = '/';
+        }
+    }
+    return pal_create_directory(buffer);
+}
+
+bool pal_is_running_as_admin(void) {
+    return true;    // nada a proteger: o "hardware" é um arquivo
+}
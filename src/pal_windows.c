@@ -388,6 +388,281 @@ int64_t pal_get_device_size(const char *device_path) {
     return length_info.Length.QuadPart;
 }
 
+pal_status_t pal_get_sector_sizes(const char *device_path, uint32_t *logical_size, uint32_t *physical_size) {
+    if (!device_path || !logical_size) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+
+    HANDLE hDevice = CreateFileA(device_path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+    if (hDevice == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_ACCESS_DENIED ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+
+    STORAGE_PROPERTY_QUERY query;
+    memset(&query, 0, sizeof(query));
+    query.PropertyId = StorageAccessAlignmentProperty;
+    query.QueryType = PropertyStandardQuery;
+
+    STORAGE_ACCESS_ALIGNMENT_DESCRIPTOR alignment;
+    memset(&alignment, 0, sizeof(alignment));
+    DWORD bytes_returned = 0;
+    pal_status_t status = PAL_STATUS_IO_ERROR;
+
+    if (DeviceIoControl(hDevice, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query),
+                        &alignment, sizeof(alignment), &bytes_returned, NULL) &&
+        bytes_returned >= sizeof(alignment) && alignment.BytesPerLogicalSector > 0) {
+        *logical_size = alignment.BytesPerLogicalSector;
+        if (physical_size) *physical_size = alignment.BytesPerPhysicalSector ? alignment.BytesPerPhysicalSector : alignment.BytesPerLogicalSector;
+        status = PAL_STATUS_SUCCESS;
+    } else {
+        // Alguns drivers não implementam StorageAccessAlignmentProperty.
+        DISK_GEOMETRY_EX geometry;
+        if (DeviceIoControl(hDevice, IOCTL_DISK_GET_DRIVE_GEOMETRY_EX, NULL, 0,
+                            &geometry, sizeof(geometry), &bytes_returned, NULL) &&
+            geometry.Geometry.BytesPerSector > 0) {
+            *logical_size = geometry.Geometry.BytesPerSector;
+            if (physical_size) *physical_size = geometry.Geometry.BytesPerSector;
+            status = PAL_STATUS_SUCCESS;
+        }
+    }
+
+    CloseHandle(hDevice);
+    return status;
+}
+
+pal_status_t pal_get_queue_count(const char *device_path, int *queue_count) {
+    // O Windows não expõe o número de filas do controlador por disco.
+    (void)device_path; (void)queue_count;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_get_queue_limits(const char *device_path, pal_queue_limits_t *limits) {
+    if (!device_path || !limits) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    memset(limits, 0, sizeof(*limits));
+    limits->rotational = -1;
+    pal_status_t status = pal_get_sector_sizes(device_path, &limits->logical_block_size, &limits->physical_block_size);
+    if (status != PAL_STATUS_SUCCESS) {
+        return status;
+    }
+
+    HANDLE hDevice = CreateFileA(device_path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+    if (hDevice != INVALID_HANDLE_VALUE) {
+        STORAGE_PROPERTY_QUERY query;
+        DWORD bytes_returned = 0;
+
+        // O adaptador informa a maior transferência; o Windows não expõe a fila do SO.
+        memset(&query, 0, sizeof(query));
+        query.PropertyId = StorageAdapterProperty;
+        query.QueryType = PropertyStandardQuery;
+        STORAGE_ADAPTER_DESCRIPTOR adapter;
+        memset(&adapter, 0, sizeof(adapter));
+        if (DeviceIoControl(hDevice, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query),
+                            &adapter, sizeof(adapter), &bytes_returned, NULL) &&
+            bytes_returned >= offsetof(STORAGE_ADAPTER_DESCRIPTOR, MaximumPhysicalPages)) {
+            limits->max_transfer_bytes = adapter.MaximumTransferLength;
+        }
+
+        memset(&query, 0, sizeof(query));
+        query.PropertyId = StorageDeviceSeekPenaltyProperty;
+        query.QueryType = PropertyStandardQuery;
+        DEVICE_SEEK_PENALTY_DESCRIPTOR penalty;
+        if (DeviceIoControl(hDevice, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query),
+                            &penalty, sizeof(penalty), &bytes_returned, NULL) &&
+            bytes_returned >= sizeof(penalty)) {
+            limits->rotational = penalty.IncursSeekPenalty ? 1 : 0;
+        }
+        CloseHandle(hDevice);
+    }
+
+    if (pal_get_device_bus_type(device_path) == PAL_BUS_TYPE_NVME) {
+        uint8_t identify[4096];
+        if (pal_get_nvme_identify_data(device_path, identify) == PAL_STATUS_SUCCESS && identify[77] > 0 && identify[77] <= 19) {
+            limits->nvme_mdts_bytes = 4096u << identify[77];
+            if (limits->max_transfer_bytes == 0 || limits->nvme_mdts_bytes < limits->max_transfer_bytes) {
+                limits->max_transfer_bytes = limits->nvme_mdts_bytes;
+            }
+        }
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+pal_status_t pal_verify_open(const char *device_path, pal_verifier_t *verifier) {
+    // IOCTL_SCSI_PASS_THROUGH poderia levar o VERIFY; por ora o scan cai para leituras.
+    (void)device_path;
+    if (verifier) { memset(verifier, 0, sizeof(*verifier)); verifier->fd = -1; }
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+pal_status_t pal_verify_sectors(pal_verifier_t *verifier, uint64_t lba, uint32_t count, uint64_t *error_lba) {
+    (void)verifier; (void)lba; (void)count; (void)error_lba;
+    return PAL_STATUS_UNSUPPORTED;
+}
+
+void pal_verify_close(pal_verifier_t *verifier) {
+    (void)verifier;
+}
+
+pal_status_t pal_get_io_counters(const char *device_path, pal_io_counters_t *counters) {
+    if (!device_path || !counters) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    HANDLE hDevice = CreateFileA(device_path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                 NULL, OPEN_EXISTING, 0, NULL);
+    if (hDevice == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_ACCESS_DENIED ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+
+    // Contadores do disk.sys (os mesmos do Gerenciador de Tarefas).
+    DISK_PERFORMANCE perf;
+    DWORD bytes_returned = 0;
+    BOOL ok = DeviceIoControl(hDevice, IOCTL_DISK_PERFORMANCE, NULL, 0, &perf, sizeof(perf), &bytes_returned, NULL);
+    CloseHandle(hDevice);
+    if (!ok) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    counters->reads_completed = perf.ReadCount;
+    counters->sectors_read = (uint64_t)perf.BytesRead.QuadPart / 512;
+    counters->writes_completed = perf.WriteCount;
+    counters->sectors_written = (uint64_t)perf.BytesWritten.QuadPart / 512;
+    return PAL_STATUS_SUCCESS;
+}
+
+typedef struct {
+    uint64_t base;              // início do volume no dispositivo escaneado
+    uint64_t cluster_size;
+    pal_fs_extent_callback callback;
+    void *user_data;
+    uint64_t extents;
+    char path[32768];
+} fs_walk_t;
+
+// Clusters de um arquivo ou diretório; arquivos pequenos residentes na MFT
+// (ERROR_HANDLE_EOF) e trechos esparsos (Lcn -1) não ocupam clusters.
+static void fs_map_handle(fs_walk_t *walk, HANDLE hFile) {
+    STARTING_VCN_INPUT_BUFFER input;
+    union {
+        RETRIEVAL_POINTERS_BUFFER pointers;
+        BYTE raw[16 * 1024];
+    } output;
+    input.StartingVcn.QuadPart = 0;
+    for (;;) {
+        DWORD bytes_returned = 0;
+        BOOL ok = DeviceIoControl(hFile, FSCTL_GET_RETRIEVAL_POINTERS, &input, sizeof(input), &output, sizeof(output), &bytes_returned, NULL);
+        if (!ok && GetLastError() != ERROR_MORE_DATA) return;
+        LONGLONG vcn = output.pointers.StartingVcn.QuadPart;
+        for (DWORD i = 0; i < output.pointers.ExtentCount; ++i) {
+            LONGLONG next_vcn = output.pointers.Extents[i].NextVcn.QuadPart;
+            LONGLONG lcn = output.pointers.Extents[i].Lcn.QuadPart;
+            if (lcn >= 0) {
+                walk->callback(walk->path, (uint64_t)vcn * walk->cluster_size, walk->base + (uint64_t)lcn * walk->cluster_size,
+                               (uint64_t)(next_vcn - vcn) * walk->cluster_size, walk->user_data);
+                walk->extents++;
+            }
+            vcn = next_vcn;
+        }
+        if (ok) return;
+        input.StartingVcn.QuadPart = vcn;
+    }
+}
+
+static void fs_map_path(fs_walk_t *walk) {
+    HANDLE hFile = CreateFileA(walk->path, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                               NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OPEN_REPARSE_POINT, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return;
+    fs_map_handle(walk, hFile);
+    CloseHandle(hFile);
+}
+
+// Pontos de reparse (junções, links, volumes montados em pasta) não são seguidos.
+static void fs_walk_dir(fs_walk_t *walk) {
+    fs_map_path(walk);
+    size_t len = strlen(walk->path);
+    const char *separator = (len > 0 && walk->path[len - 1] == '\\') ? "" : "\\";
+    if (len + 3 >= sizeof(walk->path)) return;
+    snprintf(walk->path + len, sizeof(walk->path) - len, "%s*", separator);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE hFind = FindFirstFileA(walk->path, &entry);
+    walk->path[len] = '\0';
+    if (hFind == INVALID_HANDLE_VALUE) return;
+    do {
+        if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0) continue;
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+        if (len + strlen(separator) + strlen(entry.cFileName) >= sizeof(walk->path)) continue;
+        snprintf(walk->path + len, sizeof(walk->path) - len, "%s%s", separator, entry.cFileName);
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            fs_walk_dir(walk);
+        } else {
+            fs_map_path(walk);
+        }
+        walk->path[len] = '\0';
+    } while (FindNextFileA(hFind, &entry));
+    FindClose(hFind);
+}
+
+pal_status_t pal_map_fs_extents(const char *fs_path, const char *device_path, pal_fs_extent_callback callback, void *user_data) {
+    if (!fs_path || !device_path || !callback) {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+    char root[MAX_PATH], volume_name[MAX_PATH], fs_name[MAX_PATH];
+    if (!GetVolumePathNameA(fs_path, root, sizeof(root)) ||
+        !GetVolumeNameForVolumeMountPointA(root, volume_name, sizeof(volume_name))) {
+        return PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    // No FAT/exFAT os LCNs contam a partir da área de dados, não do início do volume.
+    if (!GetVolumeInformationA(root, NULL, 0, NULL, NULL, NULL, fs_name, sizeof(fs_name)) ||
+        (_stricmp(fs_name, "NTFS") != 0 && _stricmp(fs_name, "ReFS") != 0)) {
+        return PAL_STATUS_UNSUPPORTED;
+    }
+    DWORD sectors_per_cluster = 0, bytes_per_sector = 0, free_clusters = 0, total_clusters = 0;
+    if (!GetDiskFreeSpaceA(root, &sectors_per_cluster, &bytes_per_sector, &free_clusters, &total_clusters)) {
+        return PAL_STATUS_IO_ERROR;
+    }
+
+    // \\?\Volume{...}\ sem a barra final é o dispositivo do volume.
+    size_t name_len = strlen(volume_name);
+    if (name_len > 0 && volume_name[name_len - 1] == '\\') volume_name[name_len - 1] = '\0';
+    HANDLE hVolume = CreateFileA(volume_name, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+    if (hVolume == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_ACCESS_DENIED ? PAL_STATUS_ACCESS_DENIED : PAL_STATUS_DEVICE_NOT_FOUND;
+    }
+    VOLUME_DISK_EXTENTS disk_extents;
+    DWORD bytes_returned = 0;
+    BOOL ok = DeviceIoControl(hVolume, IOCTL_VOLUME_GET_VOLUME_DISK_EXTENTS, NULL, 0, &disk_extents, sizeof(disk_extents), &bytes_returned, NULL);
+    CloseHandle(hVolume);
+    if (!ok || disk_extents.NumberOfDiskExtents != 1) {
+        return PAL_STATUS_UNSUPPORTED;  // volume dinâmico ou espalhado por vários discos
+    }
+
+    // O dispositivo escaneado é o disco físico do volume ou o próprio volume (\\.\C:).
+    uint64_t base;
+    char disk_path[64];
+    snprintf(disk_path, sizeof(disk_path), "\\\\.\\PhysicalDrive%lu", disk_extents.Extents[0].DiskNumber);
+    if (_stricmp(device_path, disk_path) == 0) {
+        base = (uint64_t)disk_extents.Extents[0].StartingOffset.QuadPart;
+    } else if (strlen(device_path) == 6 && strncmp(device_path, "\\\\.\\", 4) == 0 && device_path[5] == ':' &&
+               toupper((unsigned char)device_path[4]) == toupper((unsigned char)root[0]) && root[1] == ':') {
+        base = 0;
+    } else {
+        return PAL_STATUS_INVALID_PARAMETER;
+    }
+
+    fs_walk_t *walk = (fs_walk_t *)calloc(1, sizeof(fs_walk_t));
+    if (!walk) {
+        return PAL_STATUS_NO_MEMORY;
+    }
+    walk->base = base;
+    walk->cluster_size = (uint64_t)sectors_per_cluster * bytes_per_sector;
+    walk->callback = callback;
+    walk->user_data = user_data;
+    snprintf(walk->path, sizeof(walk->path), "%s", fs_path);
+    fs_walk_dir(walk);
+    free(walk);
+    return PAL_STATUS_SUCCESS;
+}
+
 pal_status_t pal_get_basic_drive_info(const char *device_path, BasicDriveInfo *info) {
     if (!device_path || !info) {
         return PAL_STATUS_INVALID_PARAMETER;
@@ -1036,7 +1311,7 @@ pal_status_t pal_list_drives(DriveInfo *drive_list, int max_drives, int *drive_c
     BasicDriveInfo basic_info;
     HANDLE hDevice;
 
-    for (int i = 0; i < 16; ++i) { // Check for up to 16 physical drives
+    for (int i = 0; i < MAX_DRIVES; ++i) { // Check for up to MAX_DRIVES physical drives
         if (*drive_count >= max_drives) {
             break;
         }
@@ -9,6 +9,11 @@
 #include "logging.h"
 #include "nvme_hybrid.h"
 #include "style.h"
+#include "bad_extents.h"
+#include "surface.h"
+#include "scan_patrol.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
 #include "../include/info.h"
 
 /*
@@ -56,6 +61,36 @@ static void print_last_log(FILE *f, const char *format) {
     
     for (int i = 0; i < 5; ++i) if (lines[i]) free(lines[i]);
 }
+
+// Builds reports/<prefix>_<sanitized device>_<timestamp>.<extension>.
+static void report_default_path(const char* reports_dir, const char* device_path_in, const char* prefix, const char* extension, char* out, size_t out_size) {
+    char sanitized_device_path[256];
+    // A simple sanitization: replace backslashes and colons.
+    const char* p_in = device_path_in;
+    char* p_out = sanitized_device_path;
+    while (*p_in && (p_out - sanitized_device_path) < (sizeof(sanitized_device_path) - 1)) {
+        if (*p_in == '\\' || *p_in == ':' || *p_in == '/') {
+            *p_out = '_';
+        } else {
+            *p_out = *p_in;
+        }
+        p_in++;
+        p_out++;
+    }
+    *p_out = '\0';
+
+    time_t now = time(NULL);
+    struct tm* t = localtime(&now);
+    char timestamp[20];
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d%H%M%S", t);
+
+    #ifdef _WIN32
+    snprintf(out, out_size, "%s\\%s_%s_%s.%s", reports_dir, prefix, sanitized_device_path, timestamp, extension);
+    #else
+    snprintf(out, out_size, "%s/%s_%s_%s.%s", reports_dir, prefix, sanitized_device_path, timestamp, extension);
+    #endif
+}
+
 int report_generate(const char *device_path_in, const struct smart_data *data, const char *format, const char *output_filepath) {
     char final_filepath[1024];
     
@@ -84,31 +119,7 @@ int report_generate(const char *device_path_in, const struct smart_data *data, c
         #endif
     } else {
         // Generate a default filename if none is provided.
-        char sanitized_device_path[256];
-        // A simple sanitization: replace backslashes and colons.
-        const char* p_in = device_path_in;
-        char* p_out = sanitized_device_path;
-        while (*p_in && (p_out - sanitized_device_path) < (sizeof(sanitized_device_path) - 1)) {
-            if (*p_in == '\\' || *p_in == ':' || *p_in == '/') {
-                *p_out = '_';
-            } else {
-                *p_out = *p_in;
-            }
-            p_in++;
-            p_out++;
-        }
-        *p_out = '\0';
-
-        time_t now = time(NULL);
-        struct tm* t = localtime(&now);
-        char timestamp[20];
-        strftime(timestamp, sizeof(timestamp), "%Y%m%d%H%M%S", t);
-
-        #ifdef _WIN32
-        snprintf(final_filepath, sizeof(final_filepath), "%s\\diskoracle_report_%s_%s.%s", reports_dir, sanitized_device_path, timestamp, format);
-        #else
-        snprintf(final_filepath, sizeof(final_filepath), "%s/diskoracle_report_%s_%s.%s", reports_dir, sanitized_device_path, timestamp, format);
-        #endif
+        report_default_path(reports_dir, device_path_in, "diskoracle_report", format, final_filepath, sizeof(final_filepath));
     }
     
     printf("Generating report at: %s\n", final_filepath);
@@ -136,6 +147,574 @@ int report_generate(const char *device_path_in, const struct smart_data *data, c
     return result;
 }
 
+int report_save_bad_extents(const char *device_path, const bad_extent_index_t *index, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !index) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_badlba", "bin", final_filepath, sizeof(final_filepath));
+    if (bad_extent_index_save(index, final_filepath) != 0) {
+        fprintf(stderr, "Error: Could not write the bad sector index to %s.\n", final_filepath);
+        return 1;
+    }
+    if (saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return 0;
+}
+
+int report_save_latency_map(const char *device_path, const latency_map_t *map, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !map) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_latmap", "bin", final_filepath, sizeof(final_filepath));
+    if (latency_map_save(map, final_filepath) != 0) {
+        fprintf(stderr, "Error: Could not write the latency map to %s.\n", final_filepath);
+        return 1;
+    }
+    if (saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return 0;
+}
+
+// Caminhos de dispositivo podem ter barras invertidas (\\.\PhysicalDrive0).
+static void report_json_string(FILE* f, const char* text) {
+    fputc('"', f);
+    for (const char* p = text; *p; ++p) {
+        if (*p == '\\' || *p == '"') fputc('\\', f);
+        if ((unsigned char)*p >= 0x20) fputc(*p, f);
+    }
+    fputc('"', f);
+}
+
+// Extensões inconsistentes listadas no JSON; acima disso só os totais.
+#define REPORT_MAX_MISMATCHES 4096
+
+typedef struct {
+    FILE* f;
+    uint64_t written;
+} report_mismatch_writer_t;
+
+static void report_write_mismatch(const bad_extent_t* extent, void* user_data) {
+    report_mismatch_writer_t* writer = (report_mismatch_writer_t*)user_data;
+    if (writer->written >= REPORT_MAX_MISMATCHES) return;
+    fprintf(writer->f, "%s\n      { \"lba\": %" PRIu64 ", \"count\": %" PRIu64 " }", writer->written ? "," : "", extent->lba, extent->count);
+    writer->written++;
+}
+
+static void report_write_mismatches(FILE* f, const scan_state_t* state) {
+    fprintf(f, "  \"verify\": {\n");
+    fprintf(f, "    \"mismatchedBlocks\": %" PRIu64 ",\n", state->mismatch_blocks);
+    fprintf(f, "    \"mismatchedSectors\": %" PRIu64 ",\n", state->mismatch_sectors);
+    fprintf(f, "    \"mismatchedExtents\": %" PRIu64 ",\n", state->mismatch_extents);
+    fprintf(f, "    \"sectorSize\": %u,\n", bad_extent_index_sector_size(state->mismatch_index));
+    report_mismatch_writer_t writer = { f, 0 };
+    fprintf(f, "    \"mismatches\": [");
+    bad_extent_index_foreach(state->mismatch_index, report_write_mismatch, &writer);
+    fprintf(f, "%s],\n", writer.written ? "\n    " : "");
+    fprintf(f, "    \"truncated\": %s\n  },\n", state->mismatch_extents > writer.written ? "true" : "false");
+}
+
+static void report_write_content(FILE* f, const scan_content_map_t* map) {
+    static const char* const keys[SCAN_CONTENT_CLASSES] = { "zeroBytes", "onesBytes", "patternBytes", "dataBytes" };
+    uint64_t totals[SCAN_CONTENT_CLASSES];
+    scan_content_totals(map, totals);
+    fprintf(f, "  \"content\": {\n");
+    fprintf(f, "    \"patternPeriod\": %u,\n", SCAN_CONTENT_PATTERN_PERIOD);
+    for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+        fprintf(f, "    \"%s\": %" PRIu64 ",\n", keys[c], totals[c]);
+    }
+    uint32_t sector = map->sector_size ? map->sector_size : 512;
+    fprintf(f, "    \"regions\": [");
+    for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+        uint64_t start = scan_content_region_start(map, r);
+        uint64_t end = scan_content_region_start(map, r + 1);
+        fprintf(f, "%s\n      { \"firstLba\": %" PRIu64 ", \"lastLba\": %" PRIu64, r ? "," : "", start / sector, end > start ? (end - 1) / sector : start / sector);
+        for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+            fprintf(f, ", \"%s\": %" PRIu64, keys[c], map->bytes[r][c]);
+        }
+        fprintf(f, " }");
+    }
+    fprintf(f, "\n    ]\n  },\n");
+}
+
+static void report_write_file_damage(FILE* f, const scan_file_damage_t* damage) {
+    fprintf(f, "  \"affectedFiles\": {\n");
+    fprintf(f, "    \"mountPoint\": ");
+    report_json_string(f, damage->fs_path);
+    fprintf(f, ",\n");
+    if (damage->status != PAL_STATUS_SUCCESS) {
+        fprintf(f, "    \"error\": ");
+        report_json_string(f, pal_get_error_string(damage->status));
+        fprintf(f, "\n  },\n");
+        return;
+    }
+    fprintf(f, "    \"sectorSize\": %u,\n", damage->sector_size);
+    fprintf(f, "    \"files\": %" PRIu64 ",\n", damage->files);
+    fprintf(f, "    \"affectedBytes\": %" PRIu64 ",\n", damage->bytes);
+    fprintf(f, "    \"unmappedSectors\": %" PRIu64 ",\n", damage->unmapped_sectors);
+    fprintf(f, "    \"hits\": [");
+    for (size_t i = 0; i < damage->hit_count; ++i) {
+        const scan_file_hit_t* hit = &damage->hits[i];
+        fprintf(f, "%s\n      { \"lba\": %" PRIu64 ", \"count\": %" PRIu64 ", \"kind\": \"%s\", \"fileOffset\": %" PRIu64 ", \"path\": ",
+                i ? "," : "", hit->lba, hit->sectors, scan_damage_kind_name(hit->kind), hit->file_offset);
+        report_json_string(f, scan_file_damage_path(damage, hit));
+        fprintf(f, " }");
+    }
+    fprintf(f, "%s],\n", damage->hit_count ? "\n    " : "");
+    fprintf(f, "    \"truncated\": %s\n  },\n", damage->total_hits > damage->hit_count ? "true" : "false");
+}
+
+// Colunas do heatmap de latência no relatório JSON.
+#define REPORT_HEATMAP_CELLS 1024
+
+int report_save_scan_json(const char *device_path, const scan_state_t *state, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !state) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_scan", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the scan report to %s.\n", final_filepath);
+        return 1;
+    }
+
+    fprintf(f, "{\n  \"device\": ");
+    report_json_string(f, device_path);
+    fprintf(f, ",\n");
+    fprintf(f, "  \"blockSize\": %u,\n", state->block_size);
+    fprintf(f, "  \"order\": \"%s\",\n", scan_order_name(state->order));
+    fprintf(f, "  \"totalBlocks\": %" PRIu64 ",\n", state->total_blocks);
+    fprintf(f, "  \"scannedBlocks\": %" PRIu64 ",\n", state->scanned_blocks);
+    fprintf(f, "  \"badBlocks\": %" PRIu64 ",\n", state->bad_blocks);
+    fprintf(f, "  \"readErrors\": %" PRIu64 ",\n", state->read_errors);
+    fprintf(f, "  \"badSectors\": %" PRIu64 ",\n", state->bad_sectors);
+    fprintf(f, "  \"badExtents\": %" PRIu64 ",\n", state->bad_extents);
+    if (state->index_incomplete) {
+        fprintf(f, "  \"indexIncomplete\": true,\n");
+    }
+    if (state->allocated_bytes > 0) {
+        fprintf(f, "  \"allocatedBytes\": %" PRIu64 ",\n", state->allocated_bytes);
+    }
+    if (state->population_blocks > 0 && state->scanned_blocks > 0) {
+        double low, high;
+        scan_sampling_interval(state->bad_blocks, state->scanned_blocks, state->confidence, &low, &high);
+        fprintf(f, "  \"sampling\": {\n");
+        fprintf(f, "    \"populationBlocks\": %" PRIu64 ",\n", state->population_blocks);
+        fprintf(f, "    \"sampledBlocks\": %" PRIu64 ",\n", state->scanned_blocks);
+        fprintf(f, "    \"badRate\": %.9g,\n", (double)state->bad_blocks / state->scanned_blocks);
+        fprintf(f, "    \"confidence\": %.6g,\n", state->confidence);
+        fprintf(f, "    \"badRateLow\": %.9g,\n", low);
+        fprintf(f, "    \"badRateHigh\": %.9g,\n", high);
+        fprintf(f, "    \"estimatedBadBlocksMax\": %.0f\n", high * (double)state->population_blocks);
+        fprintf(f, "  },\n");
+    }
+
+    if (state->verify) {
+        report_write_mismatches(f, state);
+    }
+    if (state->content_map) {
+        report_write_content(f, state->content_map);
+    }
+    if (state->file_damage) {
+        report_write_file_damage(f, state->file_damage);
+    }
+
+    const scan_latency_t* latency = &state->latency;
+    fprintf(f, "  \"latency\": {\n");
+    fprintf(f, "    \"tiers\": {");
+    for (int tier = 0; tier < SCAN_TIER_COUNT; ++tier) {
+        fprintf(f, "%s\n      \"%s\": %" PRIu64, tier ? "," : "", scan_latency_tier_label((scan_latency_tier_t)tier), latency->tiers[tier]);
+    }
+    fprintf(f, "\n    },\n");
+    fprintf(f, "    \"samples\": %" PRIu64 ",\n", latency->count);
+    fprintf(f, "    \"minUs\": %" PRIu64 ",\n", latency->min_us);
+    fprintf(f, "    \"meanUs\": %" PRIu64 ",\n", latency->count ? latency->sum_us / latency->count : 0);
+    fprintf(f, "    \"p50Us\": %" PRIu64 ",\n", scan_latency_percentile_us(latency, 50.0));
+    fprintf(f, "    \"p90Us\": %" PRIu64 ",\n", scan_latency_percentile_us(latency, 90.0));
+    fprintf(f, "    \"p99Us\": %" PRIu64 ",\n", scan_latency_percentile_us(latency, 99.0));
+    fprintf(f, "    \"p999Us\": %" PRIu64 ",\n", scan_latency_percentile_us(latency, 99.9));
+    fprintf(f, "    \"maxUs\": %" PRIu64 ",\n", latency->max_us);
+    // Só os buckets não vazios: [limite inferior, limite superior) em µs.
+    fprintf(f, "    \"histogram\": [");
+    bool first = true;
+    for (unsigned i = 0; i < SCAN_LATENCY_BUCKETS; ++i) {
+        if (latency->buckets[i] == 0) continue;
+        uint64_t low, high;
+        scan_latency_bucket_range(i, &low, &high);
+        fprintf(f, "%s\n      { \"fromUs\": %" PRIu64 ", \"toUs\": %" PRIu64 ", \"count\": %" PRIu64 " }",
+                first ? "" : ",", low, high, latency->buckets[i]);
+        first = false;
+    }
+    fprintf(f, "%s]\n  }", first ? "" : "\n    ");
+
+    // Heatmap do disco inteiro, lido do nível do mapa que resolve REPORT_HEATMAP_CELLS colunas.
+    uint64_t mapped_bytes = latency_map_device_size(state->latency_map);
+    uint32_t map_sector = latency_map_sector_size(state->latency_map);
+    latency_cell_t cells[REPORT_HEATMAP_CELLS];
+    if (mapped_bytes > 0 && map_sector > 0 &&
+        latency_map_render(state->latency_map, 0, mapped_bytes, cells, REPORT_HEATMAP_CELLS) == 0) {
+        uint64_t lbas = mapped_bytes / map_sector;
+        fprintf(f, ",\n  \"latencyMap\": {\n");
+        fprintf(f, "    \"sectorSize\": %u,\n", map_sector);
+        fprintf(f, "    \"totalLbas\": %" PRIu64 ",\n", lbas);
+        fprintf(f, "    \"lbasPerCell\": %" PRIu64 ",\n", (lbas + REPORT_HEATMAP_CELLS - 1) / REPORT_HEATMAP_CELLS);
+        fprintf(f, "    \"fields\": [\"minUs\", \"avgUs\", \"maxUs\", \"errors\"],\n");
+        fprintf(f, "    \"cells\": [");
+        for (unsigned c = 0; c < REPORT_HEATMAP_CELLS; ++c) {
+            fprintf(f, "%s%s", c ? "," : "", c % 8 ? " " : "\n      ");
+            const latency_cell_t* cell = &cells[c];
+            if (cell->count == 0 && cell->errors == 0) {
+                fprintf(f, "null");
+            } else if (cell->count == 0) {
+                fprintf(f, "[null, null, null, %" PRIu64 "]", cell->errors);
+            } else {
+                fprintf(f, "[%u, %" PRIu64 ", %u, %" PRIu64 "]", cell->min_us, cell->sum_us / cell->count, cell->max_us, cell->errors);
+            }
+        }
+        fprintf(f, "\n    ]\n  }");
+    }
+    fprintf(f, "\n}\n");
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
+int report_save_scan_summary_json(const scan_job_t *jobs, size_t count, char *saved_path, size_t saved_path_size) {
+    if (!jobs || count == 0) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, "all", "diskoracle_scan", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the scan summary to %s.\n", final_filepath);
+        return 1;
+    }
+
+    uint64_t scanned = 0, bad = 0, bad_sectors = 0;
+    fprintf(f, "{\n  \"devices\": [");
+    for (size_t i = 0; i < count; ++i) {
+        const scan_job_t* job = &jobs[i];
+        const scan_state_t* state = &job->state;
+        scanned += state->scanned_blocks;
+        bad += state->bad_blocks;
+        bad_sectors += state->bad_sectors;
+
+        fprintf(f, "%s\n    {\n      \"device\": ", i ? "," : "");
+        report_json_string(f, job->device_path);
+        fprintf(f, ",\n      \"model\": ");
+        report_json_string(f, job->drive_info.model);
+        fprintf(f, ",\n      \"serial\": ");
+        report_json_string(f, job->drive_info.serial);
+        fprintf(f, ",\n      \"status\": \"%s\",\n", scan_job_status_name(job->status));
+        fprintf(f, "      \"scannedBlocks\": %" PRIu64 ",\n", state->scanned_blocks);
+        fprintf(f, "      \"badBlocks\": %" PRIu64 ",\n", state->bad_blocks);
+        fprintf(f, "      \"badSectors\": %" PRIu64 ",\n", state->bad_sectors);
+        fprintf(f, "      \"p99Us\": %" PRIu64 ",\n", scan_latency_percentile_us(&state->latency, 99.0));
+        fprintf(f, "      \"slowReads\": %" PRIu64 ",\n", state->latency.tiers[SCAN_TIER_SLOW]);
+        fprintf(f, "      \"report\": ");
+        if (job->report_path[0]) {
+            report_json_string(f, job->report_path);
+        } else {
+            fprintf(f, "null");
+        }
+        fprintf(f, "\n    }");
+    }
+    fprintf(f, "\n  ],\n");
+    fprintf(f, "  \"scannedBlocks\": %" PRIu64 ",\n", scanned);
+    fprintf(f, "  \"badBlocks\": %" PRIu64 ",\n", bad);
+    fprintf(f, "  \"badSectors\": %" PRIu64 "\n}\n", bad_sectors);
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
+int report_save_patrol_json(const char *device_path, const scan_patrol_t *patrol, const scan_state_t *state, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !patrol || !state) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_patrol", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the patrol report to %s.\n", final_filepath);
+        return 1;
+    }
+
+    uint32_t sector_size = latency_map_sector_size(state->latency_map);
+    if (sector_size == 0) sector_size = 512;
+    int64_t now = (int64_t)time(NULL);
+
+    fprintf(f, "{\n  \"device\": ");
+    report_json_string(f, device_path);
+    fprintf(f, ",\n  \"serial\": ");
+    report_json_string(f, patrol->serial);
+    fprintf(f, ",\n  \"deviceSize\": %" PRIu64 ",\n", patrol->device_size);
+    fprintf(f, "  \"sectorSize\": %u,\n", sector_size);
+    fprintf(f, "  \"patrol\": {\n");
+    fprintf(f, "    \"cursor\": %" PRIu64 ",\n", patrol->cursor);
+    fprintf(f, "    \"passes\": %" PRIu64 ",\n", patrol->passes);
+    fprintf(f, "    \"passStarted\": %" PRId64 ",\n", patrol->pass_started);
+    fprintf(f, "    \"lastFullCoverage\": ");
+    if (patrol->last_full_coverage > 0) fprintf(f, "%" PRId64 ",\n", patrol->last_full_coverage);
+    else fprintf(f, "null,\n");
+    fprintf(f, "    \"lastRun\": %" PRId64 "\n  },\n", patrol->last_run);
+
+    fprintf(f, "  \"run\": {\n");
+    fprintf(f, "    \"scannedBlocks\": %" PRIu64 ",\n", state->scanned_blocks);
+    fprintf(f, "    \"blockSize\": %u,\n", state->block_size);
+    fprintf(f, "    \"badBlocks\": %" PRIu64 ",\n", state->bad_blocks);
+    fprintf(f, "    \"badSectors\": %" PRIu64 ",\n", state->bad_sectors);
+    fprintf(f, "    \"p99Us\": %" PRIu64 "\n  },\n", scan_latency_percentile_us(&state->latency, 99.0));
+
+    // Idade da cobertura de cada região, em segundos (null = ainda não lida).
+    fprintf(f, "  \"regions\": [");
+    for (unsigned r = 0; r < SCAN_PATROL_REGIONS; ++r) {
+        uint64_t first = scan_patrol_region_start(patrol, r) / sector_size;
+        uint64_t end = scan_patrol_region_start(patrol, r + 1) / sector_size;
+        int64_t age = scan_patrol_region_age(patrol, r, now);
+        fprintf(f, "%s\n    { \"firstLba\": %" PRIu64 ", \"lastLba\": %" PRIu64 ", \"ageSeconds\": ", r ? "," : "",
+                first, end > first ? end - 1 : first);
+        if (age >= 0) fprintf(f, "%" PRId64 " }", age);
+        else fprintf(f, "null }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
+int report_save_profile_json(const char *device_path, const scan_profile_t *profile, const scan_profile_t *baseline, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !profile) return 1;
+    if (baseline && baseline->measured == 0) baseline = NULL;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_profile", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the transfer profile to %s.\n", final_filepath);
+        return 1;
+    }
+
+    fprintf(f, "{\n  \"device\": ");
+    report_json_string(f, device_path);
+    fprintf(f, ",\n  \"model\": ");
+    report_json_string(f, profile->model);
+    fprintf(f, ",\n  \"serial\": ");
+    report_json_string(f, profile->serial);
+    fprintf(f, ",\n  \"deviceSize\": %" PRIu64 ",\n", profile->device_size);
+    fprintf(f, "  \"created\": %" PRId64 ",\n", profile->created);
+    fprintf(f, "  \"blockSize\": %u,\n", profile->block_size);
+    fprintf(f, "  \"zoneBytes\": %" PRIu64 ",\n", profile->zone_bytes);
+    fprintf(f, "  \"zoneCount\": %u,\n", profile->zone_count);
+    fprintf(f, "  \"measuredZones\": %u,\n", profile->measured);
+
+    fprintf(f, "  \"baseline\": ");
+    if (baseline) {
+        scan_profile_comparison_t cmp;
+        scan_profile_compare(profile, baseline, &cmp);
+        fprintf(f, "{\n    \"model\": ");
+        report_json_string(f, baseline->model);
+        fprintf(f, ",\n    \"serial\": ");
+        report_json_string(f, baseline->serial);
+        fprintf(f, ",\n    \"created\": %" PRId64 ",\n", baseline->created);
+        fprintf(f, "    \"comparedZones\": %u,\n", cmp.compared);
+        fprintf(f, "    \"slowZones\": %u,\n", cmp.slower);
+        fprintf(f, "    \"slowThresholdPercent\": %.1f,\n", SCAN_PROFILE_SLOW_PERCENT);
+        fprintf(f, "    \"meanDeltaPercent\": %.2f,\n", cmp.mean_percent);
+        fprintf(f, "    \"worstZone\": %u,\n", cmp.worst_zone);
+        fprintf(f, "    \"worstDeltaPercent\": %.2f\n  },\n", cmp.worst_percent);
+    } else {
+        fprintf(f, "null,\n");
+    }
+
+    // Uma entrada por zona medida; baselineMbps é a linha de base interpolada na mesma posição.
+    fprintf(f, "  \"zones\": [");
+    for (unsigned z = 0; z < profile->measured; ++z) {
+        const scan_profile_zone_t* zone = &profile->zones[z];
+        fprintf(f, "%s\n    { \"offset\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"position\": %.4f, \"mbps\": %.2f, "
+                "\"meanUs\": %" PRIu64 ", \"p50Us\": %" PRIu64 ", \"p99Us\": %" PRIu64 ", \"maxUs\": %" PRIu64 ", \"badSectors\": %" PRIu64,
+                z ? "," : "", zone->offset, zone->bytes, scan_profile_zone_position(profile, z), zone->mbps,
+                zone->mean_us, zone->p50_us, zone->p99_us, zone->max_us, zone->bad_sectors);
+        if (baseline) {
+            double expected = scan_profile_rate_at(baseline, scan_profile_zone_position(profile, z));
+            fprintf(f, ", \"baselineMbps\": %.2f, \"deltaPercent\": ", expected);
+            if (expected > 0.0) fprintf(f, "%.2f", 100.0 * (zone->mbps - expected) / expected);
+            else fprintf(f, "null");
+        }
+        fprintf(f, " }");
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
+int report_save_profile_csv(const char *device_path, const scan_profile_t *profile, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !profile) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_profile", "csv", final_filepath, sizeof(final_filepath));
+    if (scan_profile_save_csv(final_filepath, profile) != 0) {
+        fprintf(stderr, "Error: Could not write the transfer profile to %s.\n", final_filepath);
+        return 1;
+    }
+    if (saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return 0;
+}
+
+int report_save_benchmark_json(const char *device_path, const BasicDriveInfo *drive_info, const scan_bench_result_t *results, size_t count, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !results) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_benchmark", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the benchmark report to %s.\n", final_filepath);
+        return 1;
+    }
+
+    fprintf(f, "{\n  \"device\": ");
+    report_json_string(f, device_path);
+    fprintf(f, ",\n  \"model\": ");
+    report_json_string(f, drive_info ? drive_info->model : "");
+    fprintf(f, ",\n  \"serial\": ");
+    report_json_string(f, drive_info ? drive_info->serial : "");
+    fprintf(f, ",\n  \"firmware\": ");
+    report_json_string(f, drive_info ? drive_info->firmware_rev : "");
+    fprintf(f, ",\n  \"timestamp\": %" PRId64 ",\n", (int64_t)time(NULL));
+
+    fprintf(f, "  \"results\": [");
+    for (size_t i = 0; i < count; ++i) {
+        const scan_bench_result_t* r = &results[i];
+        fprintf(f, "%s\n    { \"pattern\": \"%s\", \"blockSize\": %u, \"queueDepth\": %u, \"threads\": %u, \"engine\": \"%s\", "
+                "\"seconds\": %.3f, \"reads\": %" PRIu64 ", \"errors\": %" PRIu64 ", \"iops\": %.1f, \"mbps\": %.2f, "
+                "\"meanUs\": %.1f, \"p50Us\": %" PRIu64 ", \"p99Us\": %" PRIu64 ", \"p999Us\": %" PRIu64 ", \"maxUs\": %" PRIu64 " }",
+                i ? "," : "", scan_bench_pattern_name(r->config.pattern), r->config.block_size, r->config.queue_depth, r->threads,
+                surface_scan_engine_name(r->engine),
+                r->seconds, r->reads, r->errors, r->iops, r->mbps, r->mean_us, r->p50_us, r->p99_us, r->p999_us, r->max_us);
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
+int report_save_tune_json(const char *device_path, const scan_tune_result_t *result, char *saved_path, size_t saved_path_size) {
+    if (!device_path || !result) return 1;
+
+    const char* reports_dir = "reports";
+    if (pal_ensure_directory_exists(reports_dir) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: Could not create the 'reports' directory.\n");
+        return 1;
+    }
+
+    char final_filepath[1024];
+    report_default_path(reports_dir, device_path, "diskoracle_tune", "json", final_filepath, sizeof(final_filepath));
+    FILE* f = fopen(final_filepath, "w");
+    if (!f) {
+        fprintf(stderr, "Error: Could not write the auto-tune report to %s.\n", final_filepath);
+        return 1;
+    }
+
+    const pal_queue_limits_t* limits = &result->limits;
+    fprintf(f, "{\n  \"device\": ");
+    report_json_string(f, device_path);
+    fprintf(f, ",\n  \"timestamp\": %" PRId64 ",\n", (int64_t)time(NULL));
+    fprintf(f, "  \"limits\": { \"maxTransferBytes\": %u, \"logicalBlockSize\": %u, \"physicalBlockSize\": %u, "
+            "\"nrRequests\": %u, \"nvmeMdtsBytes\": %u, \"rotational\": %s },\n",
+            limits->max_transfer_bytes, limits->logical_block_size, limits->physical_block_size, limits->nr_requests,
+            limits->nvme_mdts_bytes, limits->rotational < 0 ? "null" : limits->rotational ? "true" : "false");
+    fprintf(f, "  \"queueDepthTuned\": %s,\n  \"blockSizeTuned\": %s,\n",
+            result->async ? "true" : "false", result->tuned_block_size ? "true" : "false");
+    fprintf(f, "  \"chosen\": { \"blockSize\": %u, \"queueDepth\": %u, \"iops\": %.1f, \"mbps\": %.2f },\n",
+            result->block_size, result->queue_depth, result->iops, result->mbps);
+
+    fprintf(f, "  \"probes\": [");
+    for (unsigned i = 0; i < result->probe_count; ++i) {
+        const scan_tune_probe_t* p = &result->probes[i];
+        fprintf(f, "%s\n    { \"blockSize\": %u, \"queueDepth\": %u, \"iops\": %.1f, \"mbps\": %.2f }",
+                i ? "," : "", p->block_size, p->queue_depth, p->iops, p->mbps);
+    }
+    fprintf(f, "\n  ]\n}\n");
+
+    int rc = ferror(f) ? 1 : 0;
+    if (fclose(f) != 0) rc = 1;
+    if (rc == 0 && saved_path && saved_path_size > 0) {
+        snprintf(saved_path, saved_path_size, "%s", final_filepath);
+    }
+    return rc;
+}
+
 // Function to display NVMe health alerts
 void report_display_nvme_alerts(const nvme_health_alerts_t *alerts_data) {
     if (!alerts_data || alerts_data->alert_count == 0) {
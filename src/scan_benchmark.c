@@ -0,0 +1,80 @@
+#include "scan_benchmark.h"
+#include "surface_engine.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t bench_random_sizes[] = { 4096, 64 * 1024 };
+static const uint32_t bench_sequential_sizes[] = { 128 * 1024, 1024 * 1024 };
+
+const char* scan_bench_pattern_name(scan_bench_pattern_t pattern) {
+    return pattern == SCAN_BENCH_SEQUENTIAL ? "sequential" : "random";
+}
+
+unsigned scan_bench_default_plan(scan_bench_config_t* configs, unsigned max_configs, uint32_t max_queue_depth) {
+    if (max_queue_depth == 0 || max_queue_depth > SCAN_BENCH_MAX_QUEUE_DEPTH) max_queue_depth = SCAN_BENCH_MAX_QUEUE_DEPTH;
+    unsigned count = 0;
+    for (unsigned s = 0; s < sizeof(bench_random_sizes) / sizeof(bench_random_sizes[0]); ++s) {
+        for (uint32_t qd = 1; qd <= max_queue_depth && count < max_configs; qd *= 2) {
+            configs[count++] = (scan_bench_config_t){ SCAN_BENCH_RANDOM, bench_random_sizes[s], qd };
+        }
+    }
+    uint32_t sequential_qd = max_queue_depth < SCAN_BENCH_SEQUENTIAL_QUEUE_DEPTH ? max_queue_depth : SCAN_BENCH_SEQUENTIAL_QUEUE_DEPTH;
+    for (unsigned s = 0; s < sizeof(bench_sequential_sizes) / sizeof(bench_sequential_sizes[0]) && count < max_configs; ++s) {
+        configs[count++] = (scan_bench_config_t){ SCAN_BENCH_SEQUENTIAL, bench_sequential_sizes[s], sequential_qd };
+    }
+    return count;
+}
+
+int scan_bench_run(const char* device_path, const scan_options_t* opts, const scan_bench_config_t* config, double seconds,
+                   scan_callback_t callback, void* user_data, scan_bench_result_t* result) {
+    if (!device_path || !opts || !config || !result) return 1;
+    memset(result, 0, sizeof(*result));
+    result->config = *config;
+    if (!(seconds > 0.0)) seconds = SCAN_BENCH_DEFAULT_SECONDS;
+
+    scan_options_t run;
+    scan_options_for_measurement(&run, opts);
+    run.order = config->pattern == SCAN_BENCH_RANDOM ? SCAN_ORDER_RANDOM : SCAN_ORDER_SEQUENTIAL;
+    run.block_size = config->block_size;
+    run.queue_depth = config->queue_depth;
+    run.time_budget_seconds = seconds;
+
+    // Sem io_uring, cada leitura aleatória em voo é um worker síncrono; a
+    // sequencial fica num worker só, senão viraria várias leituras
+    // intercaladas, e é medida com QD 1. Com engine automática só a engine
+    // que de fato leu diz se a fila valeu: a medida é refeita sem ela.
+    bool queued = opts->engine != SCAN_ENGINE_SYNC && opts->engine != SCAN_ENGINE_MEDIA_VERIFY;
+    scan_state_t state;
+    uint64_t elapsed_ns;
+    for (;;) {
+        run.threads = 1;
+        if (!queued && config->pattern == SCAN_BENCH_RANDOM) {
+            run.threads = config->queue_depth < SCAN_MAX_THREADS ? config->queue_depth : SCAN_MAX_THREADS;
+            run.queue_depth = 1;
+        }
+        memset(&state, 0, sizeof(state));
+        uint64_t started_ns = scan_now_ns();
+        int rc = surface_scan_ex(device_path, &run, callback, user_data, &state);
+        elapsed_ns = scan_now_ns() - started_ns;
+        if (rc != 0 || state.scanned_blocks == 0) return 1;
+        if (!queued || state.engine == SCAN_ENGINE_URING || run.queue_depth <= 1) break;
+        queued = false;
+        if (config->pattern != SCAN_BENCH_RANDOM) break;
+    }
+    if (!queued && run.threads == 1) result->config.queue_depth = 1;
+    result->threads = run.threads;
+    result->engine = state.engine;
+
+    result->seconds = elapsed_ns / 1e9;
+    result->reads = state.scanned_blocks;
+    result->bytes = state.scanned_blocks * (uint64_t)state.block_size;
+    result->errors = state.read_errors;
+    result->iops = result->seconds > 0.0 ? (double)result->reads / result->seconds : 0.0;
+    result->mbps = result->seconds > 0.0 ? (double)result->bytes / (1024.0 * 1024.0) / result->seconds : 0.0;
+    result->mean_us = state.latency.count > 0 ? (double)state.latency.sum_us / (double)state.latency.count : 0.0;
+    result->p50_us = scan_latency_percentile_us(&state.latency, 50.0);
+    result->p99_us = scan_latency_percentile_us(&state.latency, 99.0);
+    result->p999_us = scan_latency_percentile_us(&state.latency, 99.9);
+    result->max_us = state.latency.max_us;
+    return 0;
+}
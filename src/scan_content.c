@@ -0,0 +1,173 @@
+#include "scan_content.h"
+#include "scan_sampling.h"
+#include "scan_verify.h"
+#include "surface_engine.h"
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCAN_CONTENT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SCAN_CONTENT_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SCAN_CONTENT_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define SCAN_CONTENT_TARGET_AVX2
+#else
+#define SCAN_CONTENT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Os kernels de preenchimento acumulam OR e AND de todos os bytes: OR zero é
+// um bloco zerado, AND 0xFF um bloco todo 0xFF. Devolvem DATA assim que os
+// dois acumuladores descartam as duas classes.
+static scan_content_class_t fill_scalar_from(const uint8_t* buf, size_t i, size_t len, uint64_t any, uint64_t all) {
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, buf + i, 8);
+        any |= word;
+        all &= word;
+        if (any != 0 && all != UINT64_MAX) return SCAN_CONTENT_DATA;
+    }
+    for (; i < len; ++i) {
+        any |= buf[i];
+        all &= buf[i] | ~(uint64_t)0xFF;
+    }
+    if (any == 0) return SCAN_CONTENT_ZERO;
+    if (all == UINT64_MAX) return SCAN_CONTENT_ONES;
+    return SCAN_CONTENT_DATA;
+}
+
+static scan_content_class_t fill_scalar(const uint8_t* buf, size_t len) {
+    return fill_scalar_from(buf, 0, len, 0, UINT64_MAX);
+}
+
+#if defined(SCAN_CONTENT_SSE2)
+static scan_content_class_t fill_sse2(const uint8_t* buf, size_t len) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+    __m128i any = zero, all = ones;
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)(buf + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(buf + i + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(buf + i + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i*)(buf + i + 48));
+        any = _mm_or_si128(any, _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)));
+        all = _mm_and_si128(all, _mm_and_si128(_mm_and_si128(v0, v1), _mm_and_si128(v2, v3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF &&
+            _mm_movemask_epi8(_mm_cmpeq_epi8(all, ones)) != 0xFFFF) {
+            return SCAN_CONTENT_DATA;
+        }
+    }
+    bool may_be_zero = _mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) == 0xFFFF;
+    bool may_be_ones = _mm_movemask_epi8(_mm_cmpeq_epi8(all, ones)) == 0xFFFF;
+    return fill_scalar_from(buf, i, len, may_be_zero ? 0 : 1, may_be_ones ? UINT64_MAX : 0);
+}
+#endif
+
+#if defined(SCAN_CONTENT_AVX2)
+SCAN_CONTENT_TARGET_AVX2
+static scan_content_class_t fill_avx2(const uint8_t* buf, size_t len) {
+    const __m256i ones = _mm256_set1_epi8((char)0xFF);
+    __m256i any = _mm256_setzero_si256(), all = ones;
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)(buf + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(buf + i + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i*)(buf + i + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i*)(buf + i + 96));
+        any = _mm256_or_si256(any, _mm256_or_si256(_mm256_or_si256(v0, v1), _mm256_or_si256(v2, v3)));
+        all = _mm256_and_si256(all, _mm256_and_si256(_mm256_and_si256(v0, v1), _mm256_and_si256(v2, v3)));
+        if (!_mm256_testz_si256(any, any) && !_mm256_testc_si256(all, ones)) {
+            return SCAN_CONTENT_DATA;
+        }
+    }
+    bool may_be_zero = _mm256_testz_si256(any, any) != 0;
+    bool may_be_ones = _mm256_testc_si256(all, ones) != 0;
+    return fill_scalar_from(buf, i, len, may_be_zero ? 0 : 1, may_be_ones ? UINT64_MAX : 0);
+}
+#endif
+
+// Escolhida na primeira chamada, como em scan_verify.c: atômica porque os
+// workers do scan paralelo podem chegar aqui juntos.
+enum { FILL_UNSET, FILL_SCALAR, FILL_SSE2, FILL_AVX2 };
+static uint64_t g_fill_level = FILL_UNSET;
+
+static scan_content_class_t fill_dispatch(const uint8_t* buf, size_t len) {
+    uint64_t level = SCAN_ATOMIC_LOAD(&g_fill_level);
+    if (level == FILL_UNSET) {
+        level = FILL_SCALAR;
+#if defined(SCAN_CONTENT_SSE2)
+        level = FILL_SSE2;
+#endif
+#if defined(SCAN_CONTENT_AVX2)
+        if (scan_cpu_has_avx2()) level = FILL_AVX2;
+#endif
+        SCAN_ATOMIC_STORE(&g_fill_level, level);
+    }
+    switch (level) {
+#if defined(SCAN_CONTENT_AVX2)
+        case FILL_AVX2: return fill_avx2(buf, len);
+#endif
+#if defined(SCAN_CONTENT_SSE2)
+        case FILL_SSE2: return fill_sse2(buf, len);
+#endif
+        default: return fill_scalar(buf, len);
+    }
+}
+
+scan_content_class_t scan_content_classify(const uint8_t* buf, size_t len) {
+    if (buf == NULL || len == 0) return SCAN_CONTENT_DATA;
+    scan_content_class_t content = fill_dispatch(buf, len);
+    if (content != SCAN_CONTENT_DATA) return content;
+
+    // Periódico: igual a si mesmo deslocado de um período (a mesma comparação SIMD do verify).
+    if (len > 2 * SCAN_CONTENT_PATTERN_PERIOD &&
+        scan_verify_diff(buf, buf + SCAN_CONTENT_PATTERN_PERIOD, len - SCAN_CONTENT_PATTERN_PERIOD) == len - SCAN_CONTENT_PATTERN_PERIOD) {
+        return SCAN_CONTENT_PATTERN;
+    }
+    return SCAN_CONTENT_DATA;
+}
+
+const char* scan_content_class_name(scan_content_class_t content) {
+    switch (content) {
+        case SCAN_CONTENT_ZERO: return "zero";
+        case SCAN_CONTENT_ONES: return "ones";
+        case SCAN_CONTENT_PATTERN: return "pattern";
+        case SCAN_CONTENT_DATA: return "data";
+        default: return "unknown";
+    }
+}
+
+void scan_content_map_set_geometry(scan_content_map_t* map, uint64_t device_size, uint32_t sector_size) {
+    if (!map) return;
+    if (map->device_size == device_size && map->sector_size == sector_size) return;
+    memset(map, 0, sizeof(*map));
+    map->device_size = device_size;
+    map->sector_size = sector_size;
+}
+
+uint64_t scan_content_region_start(const scan_content_map_t* map, unsigned region) {
+    return scan_split_point(map->device_size, SCAN_CONTENT_REGIONS, region);
+}
+
+unsigned scan_content_region_of(const scan_content_map_t* map, uint64_t offset) {
+    if (map->device_size == 0) return 0;
+    unsigned region = (unsigned)((double)offset / (double)map->device_size * SCAN_CONTENT_REGIONS);
+    if (region >= SCAN_CONTENT_REGIONS) region = SCAN_CONTENT_REGIONS - 1;
+    // O double pode errar por uma região na fronteira.
+    while (region > 0 && offset < scan_content_region_start(map, region)) region--;
+    while (region + 1 < SCAN_CONTENT_REGIONS && offset >= scan_content_region_start(map, region + 1)) region++;
+    return region;
+}
+
+void scan_content_totals(const scan_content_map_t* map, uint64_t totals[SCAN_CONTENT_CLASSES]) {
+    for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) totals[c] = 0;
+    if (!map) return;
+    for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+        for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) totals[c] += map->bytes[r][c];
+    }
+}
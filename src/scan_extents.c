@@ -0,0 +1,127 @@
+#include "scan_extents.h"
+#include "pal.h"
+#include <stdlib.h>
+#include <string.h>
+
+void scan_extent_list_init(scan_extent_list_t* list) {
+    memset(list, 0, sizeof(*list));
+}
+
+void scan_extent_list_free(scan_extent_list_t* list) {
+    if (!list) return;
+    free(list->items);
+    memset(list, 0, sizeof(*list));
+}
+
+int scan_extent_list_add(scan_extent_list_t* list, uint64_t start, uint64_t length) {
+    if (length == 0) return 0;
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        scan_extent_t* items = (scan_extent_t*)realloc(list->items, capacity * sizeof(scan_extent_t));
+        if (!items) return 1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].start = start;
+    list->items[list->count].end = start + length;
+    list->count++;
+    return 0;
+}
+
+static int extent_compare(const void* a, const void* b) {
+    const scan_extent_t* x = (const scan_extent_t*)a;
+    const scan_extent_t* y = (const scan_extent_t*)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return (x->end > y->end) - (x->end < y->end);
+}
+
+void scan_extent_list_coalesce(scan_extent_list_t* list, uint32_t sector_size, uint64_t max_gap, uint64_t limit) {
+    if (sector_size == 0) sector_size = 512;
+    qsort(list->items, list->count, sizeof(scan_extent_t), extent_compare);
+
+    size_t out = 0;
+    list->bytes = 0;
+    for (size_t i = 0; i < list->count; ++i) {
+        uint64_t start = list->items[i].start / sector_size * sector_size;
+        uint64_t end = (list->items[i].end + sector_size - 1) / sector_size * sector_size;
+        if (end > limit) end = limit;
+        if (start >= end) continue;
+        // Ordenadas por início: basta olhar a última faixa já emitida.
+        if (out > 0 && start <= list->items[out - 1].end + max_gap) {
+            if (end > list->items[out - 1].end) list->items[out - 1].end = end;
+            continue;
+        }
+        list->items[out].start = start;
+        list->items[out].end = end;
+        out++;
+    }
+    list->count = out;
+    for (size_t i = 0; i < out; ++i) list->bytes += list->items[i].end - list->items[i].start;
+}
+
+size_t scan_extent_list_find(const scan_extent_list_t* list, uint64_t offset) {
+    size_t lo = 0, hi = list->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (list->items[mid].end <= offset) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+uint64_t scan_extent_list_bytes_in(const scan_extent_list_t* list, uint64_t start, uint64_t end) {
+    uint64_t bytes = 0;
+    for (size_t i = scan_extent_list_find(list, start); i < list->count && list->items[i].start < end; ++i) {
+        uint64_t s = list->items[i].start > start ? list->items[i].start : start;
+        uint64_t e = list->items[i].end < end ? list->items[i].end : end;
+        bytes += e - s;
+    }
+    return bytes;
+}
+
+uint64_t scan_extent_list_blocks_in(const scan_extent_list_t* list, uint64_t start, uint64_t end, uint32_t block_size) {
+    uint64_t blocks = 0;
+    for (size_t i = scan_extent_list_find(list, start); i < list->count && list->items[i].start < end; ++i) {
+        uint64_t s = list->items[i].start > start ? list->items[i].start : start;
+        uint64_t e = list->items[i].end < end ? list->items[i].end : end;
+        blocks += (e - s + block_size - 1) / block_size;
+    }
+    return blocks;
+}
+
+uint64_t scan_extent_list_offset_after(const scan_extent_list_t* list, uint64_t start, uint64_t end, uint64_t bytes, uint32_t align) {
+    if (align == 0) align = 1;
+    for (size_t i = scan_extent_list_find(list, start); i < list->count && list->items[i].start < end; ++i) {
+        uint64_t s = list->items[i].start > start ? list->items[i].start : start;
+        uint64_t e = list->items[i].end < end ? list->items[i].end : end;
+        if (bytes < e - s) {
+            uint64_t offset = (s + bytes) / align * align;
+            return offset > start ? offset : start;
+        }
+        bytes -= e - s;
+    }
+    return end;
+}
+
+typedef struct {
+    scan_extent_list_t* list;
+    int failed;
+} extent_collector_t;
+
+static void extent_collect(const char* file_path, uint64_t file_offset, uint64_t device_offset, uint64_t length, void* user_data) {
+    (void)file_path; (void)file_offset;
+    extent_collector_t* collector = (extent_collector_t*)user_data;
+    if (!collector->failed && scan_extent_list_add(collector->list, device_offset, length) != 0) {
+        collector->failed = 1;
+    }
+}
+
+int scan_extent_list_collect_fs(scan_extent_list_t* list, const char* fs_path, const char* device_path,
+                                uint32_t sector_size, uint64_t device_size) {
+    extent_collector_t collector = { list, 0 };
+    pal_status_t status = pal_map_fs_extents(fs_path, device_path, extent_collect, &collector);
+    if (status != PAL_STATUS_SUCCESS) return status;
+    if (collector.failed) return PAL_STATUS_NO_MEMORY;
+    scan_extent_list_coalesce(list, sector_size, SCAN_EXTENT_MERGE_GAP, device_size);
+    return PAL_STATUS_SUCCESS;
+}
@@ -0,0 +1,298 @@
+#include "scan_filemap.h"
+#include "pal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Estado de cada arquivo do índice em scan_file_damage_t::file_slots.
+#define FILE_SLOT_UNSEEN ((size_t)-1)      // ainda não atingido
+#define FILE_SLOT_COUNTED ((size_t)-2)     // contado, caminho não copiado (nenhum trecho guardado)
+
+void scan_file_index_init(scan_file_index_t* index) {
+    memset(index, 0, sizeof(*index));
+}
+
+void scan_file_index_free(scan_file_index_t* index) {
+    if (!index) return;
+    free(index->items);
+    free(index->max_end);
+    free(index->file_paths);
+    free(index->paths);
+    memset(index, 0, sizeof(*index));
+}
+
+static int pool_append(char** pool, size_t* size, size_t* capacity, const char* text, size_t* offset) {
+    size_t len = strlen(text) + 1;
+    if (*size + len > *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 64 * 1024;
+        while (grown < *size + len) grown *= 2;
+        char* bigger = (char*)realloc(*pool, grown);
+        if (!bigger) return 1;
+        *pool = bigger;
+        *capacity = grown;
+    }
+    memcpy(*pool + *size, text, len);
+    *offset = *size;
+    *size += len;
+    return 0;
+}
+
+int scan_file_index_add(scan_file_index_t* index, const char* file_path, uint64_t file_offset, uint64_t device_offset, uint64_t length) {
+    if (length == 0) return 0;
+    // O walker entrega as extensões de um arquivo em sequência: basta comparar com o último caminho.
+    if (index->files == 0 || strcmp(index->paths + index->file_paths[index->files - 1], file_path) != 0) {
+        if (index->files == index->files_capacity) {
+            uint32_t capacity = index->files_capacity ? index->files_capacity * 2 : 1024;
+            size_t* file_paths = (size_t*)realloc(index->file_paths, capacity * sizeof(size_t));
+            if (!file_paths) return 1;
+            index->file_paths = file_paths;
+            index->files_capacity = capacity;
+        }
+        if (pool_append(&index->paths, &index->paths_size, &index->paths_capacity, file_path, &index->file_paths[index->files]) != 0) return 1;
+        index->files++;
+    }
+    if (index->count == index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 4096;
+        scan_file_extent_t* items = (scan_file_extent_t*)realloc(index->items, capacity * sizeof(scan_file_extent_t));
+        if (!items) return 1;
+        index->items = items;
+        index->capacity = capacity;
+    }
+    scan_file_extent_t* extent = &index->items[index->count++];
+    extent->start = device_offset;
+    extent->end = device_offset + length;
+    extent->file_offset = file_offset;
+    extent->file = index->files - 1;
+    return 0;
+}
+
+static int file_extent_compare(const void* a, const void* b) {
+    const scan_file_extent_t* x = (const scan_file_extent_t*)a;
+    const scan_file_extent_t* y = (const scan_file_extent_t*)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return (x->file > y->file) - (x->file < y->file);
+}
+
+int scan_file_index_sort(scan_file_index_t* index) {
+    free(index->max_end);
+    index->max_end = NULL;
+    if (index->count == 0) return 0;
+    qsort(index->items, index->count, sizeof(scan_file_extent_t), file_extent_compare);
+    index->max_end = (uint64_t*)malloc(index->count * sizeof(uint64_t));
+    if (!index->max_end) return 1;
+    uint64_t max_end = 0;
+    for (size_t i = 0; i < index->count; ++i) {
+        if (index->items[i].end > max_end) max_end = index->items[i].end;
+        index->max_end[i] = max_end;
+    }
+    return 0;
+}
+
+typedef struct {
+    scan_file_index_t* index;
+    int failed;
+} file_collector_t;
+
+static void file_collect(const char* file_path, uint64_t file_offset, uint64_t device_offset, uint64_t length, void* user_data) {
+    file_collector_t* collector = (file_collector_t*)user_data;
+    if (!collector->failed && scan_file_index_add(collector->index, file_path, file_offset, device_offset, length) != 0) {
+        collector->failed = 1;
+    }
+}
+
+int scan_file_index_build(scan_file_index_t* index, const char* fs_path, const char* device_path) {
+    file_collector_t collector = { index, 0 };
+    pal_status_t status = pal_map_fs_extents(fs_path, device_path, file_collect, &collector);
+    if (status != PAL_STATUS_SUCCESS) return status;
+    if (collector.failed || scan_file_index_sort(index) != 0) return PAL_STATUS_NO_MEMORY;
+    return PAL_STATUS_SUCCESS;
+}
+
+const char* scan_file_index_path(const scan_file_index_t* index, uint32_t file) {
+    return file < index->files ? index->paths + index->file_paths[file] : "";
+}
+
+void scan_file_damage_init(scan_file_damage_t* damage) {
+    memset(damage, 0, sizeof(*damage));
+}
+
+void scan_file_damage_free(scan_file_damage_t* damage) {
+    if (!damage) return;
+    free(damage->hits);
+    free(damage->paths);
+    free(damage->file_slots);
+    memset(damage, 0, sizeof(*damage));
+}
+
+const char* scan_file_damage_path(const scan_file_damage_t* damage, const scan_file_hit_t* hit) {
+    return hit->path < damage->paths_size ? damage->paths + hit->path : "";
+}
+
+const char* scan_damage_kind_name(scan_damage_kind_t kind) {
+    switch (kind) {
+        case SCAN_DAMAGE_UNREADABLE: return "unreadable";
+        case SCAN_DAMAGE_MISMATCH: return "mismatch";
+        default: return "unknown";
+    }
+}
+
+typedef struct {
+    scan_file_damage_t* damage;
+    const scan_file_index_t* index;
+    scan_damage_kind_t kind;
+    uint32_t sector_size;
+    const scan_file_extent_t** overlaps;    // extensões que cruzam a faixa ruim atual
+    size_t overlap_capacity;
+    int failed;
+} damage_resolver_t;
+
+static int overlap_compare(const void* a, const void* b) {
+    return file_extent_compare(*(const scan_file_extent_t* const*)a, *(const scan_file_extent_t* const*)b);
+}
+
+static int damage_add_hit(damage_resolver_t* resolver, const scan_file_extent_t* extent, uint64_t start, uint64_t end) {
+    scan_file_damage_t* damage = resolver->damage;
+    uint32_t sector = resolver->sector_size;
+    size_t* slot = &damage->file_slots[extent->file];
+
+    damage->total_hits++;
+    damage->bytes += end - start;
+    if (*slot == FILE_SLOT_UNSEEN) {
+        damage->files++;
+        *slot = FILE_SLOT_COUNTED;
+    }
+    if (damage->hit_count >= SCAN_FILEMAP_MAX_HITS) return 0;
+
+    if (*slot == FILE_SLOT_COUNTED &&
+        pool_append(&damage->paths, &damage->paths_size, &damage->paths_capacity,
+                    scan_file_index_path(resolver->index, extent->file), slot) != 0) {
+        return 1;
+    }
+    if (damage->hit_count == damage->hit_capacity) {
+        size_t capacity = damage->hit_capacity ? damage->hit_capacity * 2 : 64;
+        scan_file_hit_t* hits = (scan_file_hit_t*)realloc(damage->hits, capacity * sizeof(scan_file_hit_t));
+        if (!hits) return 1;
+        damage->hits = hits;
+        damage->hit_capacity = capacity;
+    }
+    scan_file_hit_t* hit = &damage->hits[damage->hit_count++];
+    hit->lba = start / sector;
+    hit->sectors = (end + sector - 1) / sector - hit->lba;
+    hit->file_offset = extent->file_offset + (start - extent->start);
+    hit->path = *slot;
+    hit->kind = resolver->kind;
+    return 0;
+}
+
+static void damage_resolve_extent(const bad_extent_t* bad, void* user_data) {
+    damage_resolver_t* resolver = (damage_resolver_t*)user_data;
+    const scan_file_index_t* index = resolver->index;
+    if (resolver->failed) return;
+
+    uint64_t start = bad->lba * resolver->sector_size;
+    uint64_t end = (bad->lba + bad->count) * resolver->sector_size;
+
+    // Primeira extensão que começa em end ou depois; as candidatas estão antes dela.
+    size_t lo = 0, hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->items[mid].start < end) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t found = 0;
+    for (size_t i = lo; i > 0 && index->max_end[i - 1] > start; --i) {
+        const scan_file_extent_t* extent = &index->items[i - 1];
+        if (extent->end <= start) continue;
+        if (found == resolver->overlap_capacity) {
+            size_t capacity = resolver->overlap_capacity ? resolver->overlap_capacity * 2 : 64;
+            const scan_file_extent_t** overlaps = (const scan_file_extent_t**)realloc((void*)resolver->overlaps, capacity * sizeof(*overlaps));
+            if (!overlaps) {
+                resolver->failed = 1;
+                return;
+            }
+            resolver->overlaps = overlaps;
+            resolver->overlap_capacity = capacity;
+        }
+        resolver->overlaps[found++] = extent;
+    }
+    qsort((void*)resolver->overlaps, found, sizeof(*resolver->overlaps), overlap_compare);
+
+    // Trechos em ordem de LBA; a união deles diz quanto da faixa caiu em algum arquivo.
+    uint64_t covered = 0, covered_end = start;
+    for (size_t k = 0; k < found; ++k) {
+        const scan_file_extent_t* extent = resolver->overlaps[k];
+        uint64_t s = extent->start > start ? extent->start : start;
+        uint64_t e = extent->end < end ? extent->end : end;
+        if (e > covered_end) {
+            covered += e - (s > covered_end ? s : covered_end);
+            covered_end = e;
+        }
+        if (damage_add_hit(resolver, extent, s, e) != 0) {
+            resolver->failed = 1;
+            return;
+        }
+    }
+    uint64_t covered_sectors = (covered + resolver->sector_size - 1) / resolver->sector_size;
+    if (covered_sectors < bad->count) resolver->damage->unmapped_sectors += bad->count - covered_sectors;
+}
+
+int scan_file_damage_resolve(scan_file_damage_t* damage, const scan_file_index_t* index,
+                             const bad_extent_index_t* bad, scan_damage_kind_t kind) {
+    if (!damage || !index || !bad) return 0;
+    if (damage->file_slot_count < index->files) {
+        size_t* slots = (size_t*)realloc(damage->file_slots, index->files * sizeof(size_t));
+        if (!slots) return 1;
+        for (uint32_t i = damage->file_slot_count; i < index->files; ++i) slots[i] = FILE_SLOT_UNSEEN;
+        damage->file_slots = slots;
+        damage->file_slot_count = index->files;
+    }
+    if (index->count == 0) {
+        damage->unmapped_sectors += bad_extent_index_sectors(bad);
+        return 0;
+    }
+
+    damage_resolver_t resolver;
+    memset(&resolver, 0, sizeof(resolver));
+    resolver.damage = damage;
+    resolver.index = index;
+    resolver.kind = kind;
+    resolver.sector_size = bad_extent_index_sector_size(bad);
+    if (resolver.sector_size == 0) resolver.sector_size = 512;
+    if (damage->sector_size == 0) damage->sector_size = resolver.sector_size;
+
+    bad_extent_index_foreach(bad, damage_resolve_extent, &resolver);
+    free((void*)resolver.overlaps);
+    return resolver.failed;
+}
+
+static int hit_compare(const void* a, const void* b) {
+    const scan_file_hit_t* x = (const scan_file_hit_t*)a;
+    const scan_file_hit_t* y = (const scan_file_hit_t*)b;
+    if (x->lba != y->lba) return x->lba < y->lba ? -1 : 1;
+    return (x->kind > y->kind) - (x->kind < y->kind);
+}
+
+int scan_file_damage_map(scan_file_damage_t* damage, const char* fs_path, const char* device_path,
+                         const bad_extent_index_t* bad, const bad_extent_index_t* mismatch) {
+    snprintf(damage->fs_path, sizeof(damage->fs_path), "%s", fs_path);
+
+    scan_file_index_t index;
+    scan_file_index_init(&index);
+    int status = scan_file_index_build(&index, fs_path, device_path);
+    // Ilegíveis primeiro: se o limite de trechos for atingido, são eles que ficam.
+    if (status == PAL_STATUS_SUCCESS &&
+        (scan_file_damage_resolve(damage, &index, bad, SCAN_DAMAGE_UNREADABLE) != 0 ||
+         scan_file_damage_resolve(damage, &index, mismatch, SCAN_DAMAGE_MISMATCH) != 0)) {
+        status = PAL_STATUS_NO_MEMORY;
+    }
+    scan_file_index_free(&index);
+
+    free(damage->file_slots);
+    damage->file_slots = NULL;
+    damage->file_slot_count = 0;
+    if (damage->hit_count > 1) {
+        qsort(damage->hits, damage->hit_count, sizeof(scan_file_hit_t), hit_compare);
+    }
+    damage->status = status;
+    return status;
+}
@@ -0,0 +1,400 @@
+#include "scan_journal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SCAN_JOURNAL_MAGIC "DOSJ"
+#define SCAN_JOURNAL_VERSION 1
+#define SCAN_PATROL_MAGIC "DOPT"
+#define SCAN_PATROL_VERSION 1
+
+// Nome de arquivo seguro a partir de um caminho de dispositivo ou número de série.
+static void sanitize_name(const char* name, char* out, size_t out_size) {
+    size_t n = 0;
+    for (const char* p = name; *p && n < out_size - 1; ++p) {
+        char c = *p;
+        out[n++] = (c == '\\' || c == ':' || c == '/' || c == '.') ? '_' : c;
+    }
+    out[n] = '\0';
+}
+
+void scan_journal_default_path(const char* device_path, char* out, size_t out_size) {
+    char sanitized[256];
+    sanitize_name(device_path, sanitized, sizeof(sanitized));
+#ifdef _WIN32
+    snprintf(out, out_size, "reports\\diskoracle_scan_%s.journal", sanitized);
+#else
+    snprintf(out, out_size, "reports/diskoracle_scan_%s.journal", sanitized);
+#endif
+}
+
+void scan_patrol_default_path(const char* serial, const char* device_path, char* out, size_t out_size) {
+    char sanitized[256];
+    sanitize_name(serial && serial[0] ? serial : device_path, sanitized, sizeof(sanitized));
+#ifdef _WIN32
+    snprintf(out, out_size, "reports\\diskoracle_patrol_%s.state", sanitized);
+#else
+    snprintf(out, out_size, "reports/diskoracle_patrol_%s.state", sanitized);
+#endif
+}
+
+// Campos numéricos em little-endian, independentes da plataforma que gravou.
+static void put_le(FILE* fp, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        fputc((int)((value >> (8 * i)) & 0xFF), fp);
+    }
+}
+
+static bool get_le(FILE* fp, uint64_t* value, int bytes) {
+    *value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        int c = fgetc(fp);
+        if (c == EOF) return false;
+        *value |= (uint64_t)(uint8_t)c << (8 * i);
+    }
+    return true;
+}
+
+// O histograma é esparso na prática: só os buckets não vazios são gravados.
+static void put_latency(FILE* fp, const scan_latency_t* latency) {
+    for (int i = 0; i < SCAN_TIER_COUNT; ++i) {
+        put_le(fp, latency->tiers[i], 8);
+    }
+    put_le(fp, latency->count, 8);
+    put_le(fp, latency->sum_us, 8);
+    put_le(fp, latency->min_us, 8);
+    put_le(fp, latency->max_us, 8);
+
+    unsigned used = 0;
+    for (unsigned i = 0; i < SCAN_LATENCY_BUCKETS; ++i) {
+        if (latency->buckets[i]) used++;
+    }
+    put_le(fp, used, 2);
+    for (unsigned i = 0; i < SCAN_LATENCY_BUCKETS; ++i) {
+        if (latency->buckets[i] == 0) continue;
+        put_le(fp, i, 2);
+        put_le(fp, latency->buckets[i], 8);
+    }
+}
+
+static bool get_latency(FILE* fp, scan_latency_t* latency) {
+    for (int i = 0; i < SCAN_TIER_COUNT; ++i) {
+        if (!get_le(fp, &latency->tiers[i], 8)) return false;
+    }
+    uint64_t used;
+    if (!get_le(fp, &latency->count, 8) || !get_le(fp, &latency->sum_us, 8) ||
+        !get_le(fp, &latency->min_us, 8) || !get_le(fp, &latency->max_us, 8) ||
+        !get_le(fp, &used, 2) || used > SCAN_LATENCY_BUCKETS) {
+        return false;
+    }
+    for (uint64_t i = 0; i < used; ++i) {
+        uint64_t bucket, count;
+        if (!get_le(fp, &bucket, 2) || bucket >= SCAN_LATENCY_BUCKETS || !get_le(fp, &count, 8)) return false;
+        latency->buckets[bucket] = count;
+    }
+    return true;
+}
+
+// Classificação do conteúdo: contagens por região e classe, na ordem do mapa.
+static void put_content(FILE* fp, const scan_content_map_t* content) {
+    for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+        for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+            put_le(fp, content->bytes[r][c], 8);
+        }
+    }
+}
+
+static bool get_content(FILE* fp, scan_content_map_t* content) {
+    for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+        for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+            if (!get_le(fp, &content->bytes[r][c], 8)) return false;
+        }
+    }
+    return true;
+}
+
+static void put_string(FILE* fp, const char* str) {
+    size_t len = strlen(str);
+    put_le(fp, len, 2);
+    fwrite(str, 1, len, fp);
+}
+
+static bool get_string(FILE* fp, char* out, size_t out_size) {
+    uint64_t len;
+    if (!get_le(fp, &len, 2) || len >= out_size) return false;
+    if (fread(out, 1, (size_t)len, fp) != len) return false;
+    out[len] = '\0';
+    return true;
+}
+
+// Garante que os dados chegaram ao disco antes do rename.
+static int flush_to_disk(FILE* fp) {
+    if (fflush(fp) != 0) return 1;
+#ifdef _WIN32
+    return _commit(_fileno(fp)) == 0 ? 0 : 1;
+#else
+    return fsync(fileno(fp)) == 0 ? 0 : 1;
+#endif
+}
+
+static int replace_file(const char* tmp_path, const char* path) {
+#ifdef _WIN32
+    return MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : 1;
+#else
+    if (rename(tmp_path, path) != 0) return 1;
+
+    // O rename só é durável depois do fsync do diretório que o contém.
+    char dir[1024];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char* slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+    } else {
+        snprintf(dir, sizeof(dir), ".");
+    }
+    int dir_fd = open(dir, O_RDONLY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return 0;
+#endif
+}
+
+int scan_journal_save(const char* path, const scan_journal_t* journal, const bad_extent_index_t* bad_index,
+                      const bad_extent_index_t* mismatch_index, const latency_map_t* latency_map) {
+    if (!path || !journal) return 1;
+
+    char tmp_path[1100];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE* fp = fopen(tmp_path, "wb");
+    if (!fp) return 1;
+
+    fwrite(SCAN_JOURNAL_MAGIC, 1, 4, fp);
+    put_le(fp, SCAN_JOURNAL_VERSION, 4);
+    put_string(fp, journal->device_path);
+    put_string(fp, journal->serial);
+    put_le(fp, journal->device_size, 8);
+    put_le(fp, journal->sector_size, 4);
+
+    put_le(fp, journal->block_size, 4);
+    put_le(fp, journal->queue_depth, 4);
+    put_le(fp, journal->engine, 4);
+    put_le(fp, journal->direct_io ? 1 : 0, 1);
+    put_le(fp, journal->order, 4);
+    put_le(fp, journal->stride, 8);
+    put_le(fp, journal->order_seed, 8);
+    put_le(fp, journal->verify ? 1 : 0, 1);
+    put_le(fp, journal->classify ? 1 : 0, 1);
+    put_string(fp, journal->allocated_path);
+
+    put_le(fp, journal->scanned_blocks, 8);
+    put_le(fp, journal->bad_blocks, 8);
+    put_le(fp, journal->read_errors, 8);
+    put_le(fp, journal->mismatch_blocks, 8);
+    put_le(fp, (uint64_t)(journal->elapsed_seconds * 1000.0), 8);
+    put_latency(fp, &journal->latency);
+    put_le(fp, journal->segment_count, 4);
+    for (unsigned i = 0; i < journal->segment_count; ++i) {
+        put_le(fp, journal->segments[i].start, 8);
+        put_le(fp, journal->segments[i].end, 8);
+        put_le(fp, journal->segments[i].cursor, 8);
+    }
+    if (journal->classify) put_content(fp, &journal->content);
+
+    put_le(fp, bad_index ? 1 : 0, 1);
+    int rc = bad_index ? bad_extent_index_write(bad_index, fp) : 0;
+    put_le(fp, mismatch_index ? 1 : 0, 1);
+    if (rc == 0 && mismatch_index) rc = bad_extent_index_write(mismatch_index, fp);
+    bool has_map = latency_map && latency_map_bucket_bytes(latency_map) > 0;
+    put_le(fp, has_map ? 1 : 0, 1);
+    if (rc == 0 && has_map) rc = latency_map_write(latency_map, fp);
+    if (ferror(fp) || flush_to_disk(fp) != 0) rc = 1;
+    if (fclose(fp) != 0) rc = 1;
+
+    if (rc == 0) {
+        rc = replace_file(tmp_path, path);
+    }
+    if (rc != 0) {
+        remove(tmp_path);
+    }
+    return rc;
+}
+
+int scan_journal_load(const char* path, scan_journal_t* journal, bad_extent_index_t** bad_index,
+                      bad_extent_index_t** mismatch_index, latency_map_t** latency_map) {
+    if (!path || !journal) return 1;
+    if (bad_index) *bad_index = NULL;
+    if (mismatch_index) *mismatch_index = NULL;
+    if (latency_map) *latency_map = NULL;
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 1;
+
+    memset(journal, 0, sizeof(*journal));
+    char magic[4];
+    uint64_t version, v_sector, v_block, v_qd, v_engine, v_direct, v_order, v_verify, v_classify, v_elapsed_ms, v_segments;
+    uint64_t has_index, has_mismatches, has_map;
+    bool ok = fread(magic, 1, 4, fp) == 4 && memcmp(magic, SCAN_JOURNAL_MAGIC, 4) == 0 &&
+              get_le(fp, &version, 4) && version == SCAN_JOURNAL_VERSION &&
+              get_string(fp, journal->device_path, sizeof(journal->device_path)) &&
+              get_string(fp, journal->serial, sizeof(journal->serial)) &&
+              get_le(fp, &journal->device_size, 8) && get_le(fp, &v_sector, 4) &&
+              get_le(fp, &v_block, 4) && get_le(fp, &v_qd, 4) && get_le(fp, &v_engine, 4) && get_le(fp, &v_direct, 1) &&
+              get_le(fp, &v_order, 4) && v_order < SCAN_ORDER_SAMPLED &&
+              get_le(fp, &journal->stride, 8) && get_le(fp, &journal->order_seed, 8) &&
+              get_le(fp, &v_verify, 1) && get_le(fp, &v_classify, 1) &&
+              get_string(fp, journal->allocated_path, sizeof(journal->allocated_path)) &&
+              get_le(fp, &journal->scanned_blocks, 8) && get_le(fp, &journal->bad_blocks, 8) &&
+              get_le(fp, &journal->read_errors, 8) && get_le(fp, &journal->mismatch_blocks, 8) &&
+              get_le(fp, &v_elapsed_ms, 8) &&
+              get_latency(fp, &journal->latency) &&
+              get_le(fp, &v_segments, 4) && v_segments >= 1 && v_segments <= SCAN_MAX_THREADS;
+
+    for (uint64_t i = 0; ok && i < v_segments; ++i) {
+        scan_segment_t* seg = &journal->segments[i];
+        ok = get_le(fp, &seg->start, 8) && get_le(fp, &seg->end, 8) && get_le(fp, &seg->cursor, 8) &&
+             seg->start <= seg->cursor && seg->cursor <= seg->end && seg->end <= journal->device_size;
+    }
+    if (ok && v_classify) ok = get_content(fp, &journal->content);
+    ok = ok && get_le(fp, &has_index, 1);
+
+    bad_extent_index_t* index = NULL;
+    if (ok && has_index) {
+        index = bad_extent_index_read(fp);
+        ok = index != NULL;
+    }
+    ok = ok && get_le(fp, &has_mismatches, 1);
+    bad_extent_index_t* mismatches = NULL;
+    if (ok && has_mismatches) {
+        mismatches = bad_extent_index_read(fp);
+        ok = mismatches != NULL;
+    }
+    ok = ok && get_le(fp, &has_map, 1);
+    latency_map_t* map = NULL;
+    if (ok && has_map) {
+        map = latency_map_read(fp);
+        ok = map != NULL;
+    }
+    fclose(fp);
+
+    if (!ok) {
+        bad_extent_index_destroy(index);
+        bad_extent_index_destroy(mismatches);
+        latency_map_destroy(map);
+        return 1;
+    }
+
+    journal->sector_size = (uint32_t)v_sector;
+    journal->block_size = (uint32_t)v_block;
+    journal->queue_depth = (uint32_t)v_qd;
+    journal->engine = (uint32_t)v_engine;
+    journal->direct_io = v_direct != 0;
+    journal->order = (uint32_t)v_order;
+    journal->verify = v_verify != 0;
+    journal->classify = v_classify != 0;
+    journal->elapsed_seconds = v_elapsed_ms / 1000.0;
+    journal->segment_count = (unsigned)v_segments;
+
+    if (bad_index) {
+        *bad_index = index;
+    } else {
+        bad_extent_index_destroy(index);
+    }
+    if (mismatch_index) {
+        *mismatch_index = mismatches;
+    } else {
+        bad_extent_index_destroy(mismatches);
+    }
+    if (latency_map) {
+        *latency_map = map;
+    } else {
+        latency_map_destroy(map);
+    }
+    return 0;
+}
+
+bool scan_journal_exists(const char* path) {
+    FILE* fp = path ? fopen(path, "rb") : NULL;
+    if (!fp) return false;
+    fclose(fp);
+    return true;
+}
+
+void scan_journal_remove(const char* path) {
+    if (path) remove(path);
+}
+
+int scan_patrol_save(const char* path, const scan_patrol_t* patrol) {
+    if (!path || !patrol) return 1;
+
+    char tmp_path[1100];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    FILE* fp = fopen(tmp_path, "wb");
+    if (!fp) return 1;
+
+    fwrite(SCAN_PATROL_MAGIC, 1, 4, fp);
+    put_le(fp, SCAN_PATROL_VERSION, 4);
+    put_string(fp, patrol->device_path);
+    put_string(fp, patrol->serial);
+    put_le(fp, patrol->device_size, 8);
+    put_le(fp, patrol->cursor, 8);
+    put_le(fp, patrol->passes, 8);
+    put_le(fp, (uint64_t)patrol->pass_started, 8);
+    put_le(fp, (uint64_t)patrol->last_full_coverage, 8);
+    put_le(fp, (uint64_t)patrol->last_run, 8);
+    put_le(fp, SCAN_PATROL_REGIONS, 4);
+    for (unsigned i = 0; i < SCAN_PATROL_REGIONS; ++i) {
+        put_le(fp, (uint64_t)patrol->region_scanned[i], 8);
+    }
+
+    int rc = 0;
+    if (ferror(fp) || flush_to_disk(fp) != 0) rc = 1;
+    if (fclose(fp) != 0) rc = 1;
+    if (rc == 0) {
+        rc = replace_file(tmp_path, path);
+    }
+    if (rc != 0) {
+        remove(tmp_path);
+    }
+    return rc;
+}
+
+int scan_patrol_load(const char* path, scan_patrol_t* patrol) {
+    if (!path || !patrol) return 1;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return 1;
+
+    memset(patrol, 0, sizeof(*patrol));
+    char magic[4];
+    uint64_t version, pass_started, last_full, last_run, regions;
+    bool ok = fread(magic, 1, 4, fp) == 4 && memcmp(magic, SCAN_PATROL_MAGIC, 4) == 0 &&
+              get_le(fp, &version, 4) && version >= 1 && version <= SCAN_PATROL_VERSION &&
+              get_string(fp, patrol->device_path, sizeof(patrol->device_path)) &&
+              get_string(fp, patrol->serial, sizeof(patrol->serial)) &&
+              get_le(fp, &patrol->device_size, 8) && get_le(fp, &patrol->cursor, 8) &&
+              get_le(fp, &patrol->passes, 8) && get_le(fp, &pass_started, 8) &&
+              get_le(fp, &last_full, 8) && get_le(fp, &last_run, 8) &&
+              get_le(fp, &regions, 4) && regions == SCAN_PATROL_REGIONS &&
+              patrol->cursor < patrol->device_size;
+    for (unsigned i = 0; ok && i < SCAN_PATROL_REGIONS; ++i) {
+        uint64_t when;
+        ok = get_le(fp, &when, 8);
+        patrol->region_scanned[i] = (int64_t)when;
+    }
+    fclose(fp);
+    if (!ok) return 1;
+
+    patrol->pass_started = (int64_t)pass_started;
+    patrol->last_full_coverage = (int64_t)last_full;
+    patrol->last_run = (int64_t)last_run;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "scan_latency.h"
+#include <string.h>
+
+static const uint64_t tier_limits_us[SCAN_TIER_SLOW] = { 5000, 20000, 50000, 150000, 500000 };
+
+static const char* const tier_labels[SCAN_TIER_COUNT] = {
+    "<5 ms", "<20 ms", "<50 ms", "<150 ms", "<500 ms", ">500 ms", "error"
+};
+
+static unsigned highest_bit(uint64_t value) {
+    unsigned bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+}
+
+// Abaixo de 2^SUB_BITS µs cada valor tem seu próprio bucket; acima, cada
+// potência de dois é dividida em SUB_BUCKETS partes iguais.
+static unsigned bucket_of(uint64_t us) {
+    if (us < SCAN_LATENCY_SUB_BUCKETS) return (unsigned)us;
+
+    unsigned exponent = highest_bit(us);
+    if (exponent > SCAN_LATENCY_MAX_EXPONENT) return SCAN_LATENCY_BUCKETS - 1;
+    unsigned sub = (unsigned)(us >> (exponent - SCAN_LATENCY_SUB_BITS)) - SCAN_LATENCY_SUB_BUCKETS;
+    return (exponent - SCAN_LATENCY_SUB_BITS + 1) * SCAN_LATENCY_SUB_BUCKETS + sub;
+}
+
+void scan_latency_bucket_range(unsigned bucket, uint64_t* low_us, uint64_t* high_us) {
+    unsigned group = bucket / SCAN_LATENCY_SUB_BUCKETS;
+    uint64_t sub = bucket % SCAN_LATENCY_SUB_BUCKETS;
+    if (group == 0) {
+        *low_us = sub;
+        *high_us = sub + 1;
+        return;
+    }
+    unsigned shift = group - 1;
+    *low_us = (SCAN_LATENCY_SUB_BUCKETS + sub) << shift;
+    *high_us = (SCAN_LATENCY_SUB_BUCKETS + sub + 1) << shift;
+}
+
+scan_latency_tier_t scan_latency_tier_of(uint64_t latency_us) {
+    for (int tier = 0; tier < SCAN_TIER_SLOW; ++tier) {
+        if (latency_us < tier_limits_us[tier]) return (scan_latency_tier_t)tier;
+    }
+    return SCAN_TIER_SLOW;
+}
+
+const char* scan_latency_tier_label(scan_latency_tier_t tier) {
+    return (tier >= 0 && tier < SCAN_TIER_COUNT) ? tier_labels[tier] : "?";
+}
+
+void scan_latency_record(scan_latency_t* latency, uint64_t latency_ns, bool ok) {
+    if (!ok) {
+        latency->tiers[SCAN_TIER_ERROR]++;
+        return;
+    }
+
+    uint64_t us = latency_ns / 1000;
+    latency->tiers[scan_latency_tier_of(us)]++;
+    latency->buckets[bucket_of(us)]++;
+    if (latency->count == 0 || us < latency->min_us) latency->min_us = us;
+    if (us > latency->max_us) latency->max_us = us;
+    latency->count++;
+    latency->sum_us += us;
+}
+
+void scan_latency_merge(scan_latency_t* dst, const scan_latency_t* src) {
+    for (int i = 0; i < SCAN_TIER_COUNT; ++i) {
+        dst->tiers[i] += src->tiers[i];
+    }
+    if (src->count == 0) return;
+
+    for (unsigned i = 0; i < SCAN_LATENCY_BUCKETS; ++i) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    if (dst->count == 0 || src->min_us < dst->min_us) dst->min_us = src->min_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+    dst->count += src->count;
+    dst->sum_us += src->sum_us;
+}
+
+uint64_t scan_latency_percentile_us(const scan_latency_t* latency, double percentile) {
+    if (latency->count == 0) return 0;
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+
+    // Posição (1-based) da amostra pedida na ordem crescente.
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)latency->count + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > latency->count) rank = latency->count;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < SCAN_LATENCY_BUCKETS; ++i) {
+        seen += latency->buckets[i];
+        if (seen >= rank) {
+            uint64_t low, high;
+            scan_latency_bucket_range(i, &low, &high);
+            uint64_t value = high - 1;
+            if (value > latency->max_us) value = latency->max_us;
+            if (value < latency->min_us) value = latency->min_us;
+            return value;
+        }
+    }
+    return latency->max_us;
+}
@@ -0,0 +1,126 @@
+#include "scan_order.h"
+#include <string.h>
+#include <time.h>
+
+static const char* const order_names[] = {
+    "sequential", "reverse", "strided", "random", "butterfly", "sampled"
+};
+
+// splitmix64, a mesma mistura de scan_sampling.c.
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void scan_order_init(scan_order_t* order, scan_order_kind_t kind, uint64_t blocks, uint64_t stride, uint64_t seed) {
+    memset(order, 0, sizeof(*order));
+    order->kind = kind;
+    order->blocks = blocks;
+    order->count = blocks;
+
+    if (kind == SCAN_ORDER_STRIDED) {
+        if (stride == 0) stride = SCAN_ORDER_DEFAULT_STRIDE;
+        // Stride maior que a faixa degenera na ordem sequencial.
+        if (blocks > 0 && stride > blocks) stride = blocks;
+        order->stride = stride;
+    }
+
+    if (kind == SCAN_ORDER_RANDOM) {
+        order->seed = seed ? seed : mix64((uint64_t)time(NULL) ^ (uint64_t)clock());
+        // Menor domínio 2^(2h) >= blocks: o cycle walking dá em média menos de 4 voltas.
+        unsigned bits = 0;
+        while (bits < 64 && blocks > 1 && ((blocks - 1) >> bits) != 0) bits++;
+        order->half_bits = bits < 2 ? 1 : (bits + 1) / 2;
+        for (int i = 0; i < 4; ++i) {
+            order->keys[i] = mix64(order->seed + (uint64_t)i);
+        }
+    }
+}
+
+void scan_order_init_sampled(scan_order_t* order, uint64_t blocks, uint64_t samples, uint64_t seed) {
+    memset(order, 0, sizeof(*order));
+    order->kind = SCAN_ORDER_SAMPLED;
+    order->blocks = blocks;
+    scan_sampler_init(&order->sampler, blocks, samples, seed);
+    order->count = order->sampler.count;
+    order->seed = order->sampler.seed;
+}
+
+// Uma cifra de Feistel é uma permutação de [0, 2^(2h)) para qualquer função de rodada.
+static uint64_t feistel(const scan_order_t* order, uint64_t value) {
+    unsigned h = order->half_bits;
+    uint64_t mask = h >= 32 ? 0xFFFFFFFFULL : ((1ULL << h) - 1);
+    uint64_t left = (value >> h) & mask;
+    uint64_t right = value & mask;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t next = left ^ (mix64(right ^ order->keys[i]) & mask);
+        left = right;
+        right = next;
+    }
+    return (left << h) | right;
+}
+
+uint64_t scan_order_block(const scan_order_t* order, uint64_t position) {
+    uint64_t n = order->blocks;
+    if (n == 0) return 0;
+
+    switch (order->kind) {
+    case SCAN_ORDER_REVERSE:
+        return n - 1 - position;
+
+    case SCAN_ORDER_BUTTERFLY:
+        // 0, n-1, 1, n-2, ...: cada leitura cruza o disco até a outra ponta.
+        return (position & 1) ? n - 1 - position / 2 : position / 2;
+
+    case SCAN_ORDER_STRIDED: {
+        // Passada j lê os blocos j, j+S, j+2S...; as r primeiras têm um bloco a mais.
+        uint64_t stride = order->stride;
+        uint64_t per_pass = n / stride;
+        uint64_t longer = n % stride;
+        uint64_t pass, index;
+        if (position < longer * (per_pass + 1)) {
+            pass = position / (per_pass + 1);
+            index = position % (per_pass + 1);
+        } else {
+            uint64_t rest = position - longer * (per_pass + 1);
+            pass = longer + rest / per_pass;
+            index = rest % per_pass;
+        }
+        return pass + index * stride;
+    }
+
+    case SCAN_ORDER_RANDOM: {
+        uint64_t block = position;
+        do {
+            block = feistel(order, block);
+        } while (block >= n);
+        return block;
+    }
+
+    case SCAN_ORDER_SAMPLED:
+        return scan_sampler_block(&order->sampler, position);
+
+    case SCAN_ORDER_SEQUENTIAL:
+    default:
+        return position;
+    }
+}
+
+const char* scan_order_name(scan_order_kind_t kind) {
+    if ((unsigned)kind < sizeof(order_names) / sizeof(order_names[0])) return order_names[kind];
+    return "unknown";
+}
+
+bool scan_order_parse(const char* name, scan_order_kind_t* kind) {
+    if (!name) return false;
+    for (unsigned i = 0; i < sizeof(order_names) / sizeof(order_names[0]); ++i) {
+        if (i == SCAN_ORDER_SAMPLED) continue;
+        if (strcmp(name, order_names[i]) == 0) {
+            *kind = (scan_order_kind_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,145 @@
+#include "scan_patrol.h"
+#include "scan_sampling.h"
+#include "surface_engine.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PATROL_SECONDS_PER_DAY 86400.0
+
+void scan_patrol_init(scan_patrol_t* patrol, const char* device_path, const char* serial, uint64_t device_size, int64_t now) {
+    memset(patrol, 0, sizeof(*patrol));
+    snprintf(patrol->device_path, sizeof(patrol->device_path), "%s", device_path ? device_path : "");
+    snprintf(patrol->serial, sizeof(patrol->serial), "%s", serial ? serial : "");
+    patrol->device_size = device_size;
+    patrol->pass_started = now;
+}
+
+uint64_t scan_patrol_region_start(const scan_patrol_t* patrol, unsigned region) {
+    return scan_split_point(patrol->device_size, SCAN_PATROL_REGIONS, region);
+}
+
+int64_t scan_patrol_region_age(const scan_patrol_t* patrol, unsigned region, int64_t now) {
+    if (region >= SCAN_PATROL_REGIONS || patrol->region_scanned[region] == 0) return -1;
+    int64_t age = now - patrol->region_scanned[region];
+    return age > 0 ? age : 0;
+}
+
+void scan_patrol_advance(scan_patrol_t* patrol, uint64_t end, int64_t now) {
+    if (end > patrol->device_size) end = patrol->device_size;
+    if (end <= patrol->cursor) return;
+
+    for (unsigned r = 0; r < SCAN_PATROL_REGIONS; ++r) {
+        uint64_t region_end = scan_patrol_region_start(patrol, r + 1);
+        if (region_end > patrol->cursor && region_end <= end) {
+            patrol->region_scanned[r] = now;
+        }
+    }
+    patrol->cursor = end;
+    if (patrol->cursor >= patrol->device_size) {
+        patrol->cursor = 0;
+        patrol->passes++;
+        patrol->last_full_coverage = now;
+        patrol->pass_started = now;
+    }
+}
+
+uint64_t scan_patrol_cycle_budget(const scan_patrol_t* patrol, double cycle_days, int64_t now) {
+    if (!(cycle_days > 0.0)) return 0;
+    double cycle = cycle_days * PATROL_SECONDS_PER_DAY;
+
+    // O intervalo entre execuções (o do cron) vem da anterior; sem ela, um dia.
+    double interval = PATROL_SECONDS_PER_DAY;
+    if (patrol->last_run > 0 && now > patrol->last_run) {
+        interval = (double)(now - patrol->last_run);
+    }
+    if (interval > cycle) interval = cycle;
+
+    double bytes = (double)patrol->device_size * interval / cycle;
+    return bytes < 1.0 ? 1 : (uint64_t)bytes + 1;
+}
+
+// Soma o resultado de um trecho ao total da execução.
+static void patrol_accumulate(scan_state_t* total, const scan_state_t* step, bool first) {
+    if (first) {
+        *total = *step;
+        return;
+    }
+    total->total_blocks += step->total_blocks;
+    total->scanned_blocks += step->scanned_blocks;
+    total->bad_blocks += step->bad_blocks;
+    total->read_errors += step->read_errors;
+    total->bad_sectors += step->bad_sectors;
+    total->bad_extents += step->bad_extents;
+    total->last_update_time = step->last_update_time;
+    total->latency_map = step->latency_map;
+    scan_latency_merge(&total->latency, &step->latency);
+}
+
+int scan_patrol_run(const char* device_path, scan_patrol_t* patrol, const scan_options_t* opts, const scan_patrol_budget_t* budget,
+                    scan_callback_t callback, void* user_data, scan_state_t* out_state) {
+    if (!device_path || !patrol || !opts || !budget || patrol->device_size == 0) return 1;
+
+    uint64_t budget_bytes = budget->bytes;
+    if (budget->cycle_days > 0.0) {
+        uint64_t cycle_bytes = scan_patrol_cycle_budget(patrol, budget->cycle_days, (int64_t)time(NULL));
+        if (budget_bytes == 0 || cycle_bytes < budget_bytes) budget_bytes = cycle_bytes;
+    }
+
+    uint64_t start_ns = scan_now_ns();
+    uint64_t start_cursor = patrol->cursor;
+    uint64_t bytes_done = 0;
+    bool wrapped = false;
+    bool first = true;
+    int rc = 0;
+    scan_state_t total;
+    memset(&total, 0, sizeof(total));
+
+    for (;;) {
+        // Um trecho vai do cursor até o fim do disco; uma execução nunca lê o mesmo byte duas vezes.
+        uint64_t stop_at = wrapped ? start_cursor : patrol->device_size;
+        uint64_t length = stop_at > patrol->cursor ? stop_at - patrol->cursor : 0;
+        if (budget_bytes > 0) {
+            if (bytes_done >= budget_bytes) break;
+            if (budget_bytes - bytes_done < length) length = budget_bytes - bytes_done;
+        }
+        if (length == 0) break;
+
+        double seconds_left = 0.0;
+        if (budget->seconds > 0.0) {
+            seconds_left = budget->seconds - (scan_now_ns() - start_ns) / 1e9;
+            if (seconds_left <= 0.0) break;
+        }
+
+        scan_options_t run = *opts;
+        run.mode = "deep";
+        run.range_offset = patrol->cursor;
+        run.range_length = length;
+        run.time_budget_seconds = seconds_left;
+        run.journal_path = NULL;
+        run.resume = false;
+
+        scan_state_t step;
+        memset(&step, 0, sizeof(step));
+        rc = surface_scan_ex(device_path, &run, callback, user_data, &step);
+        if (step.block_size == 0) break;        // falhou antes de ler qualquer coisa
+
+        // Um scan interrompido ainda devolve até onde leu sem buracos.
+        patrol_accumulate(&total, &step, first);
+        first = false;
+        uint64_t from = patrol->cursor;
+        uint64_t reached = step.resume_offset > from ? step.resume_offset : from;
+        bytes_done += reached - from;
+        scan_patrol_advance(patrol, reached, (int64_t)time(NULL));
+
+        if (rc != 0 || reached < from + length) break;
+        if (patrol->cursor == 0) wrapped = true;
+    }
+
+    patrol->last_run = (int64_t)time(NULL);
+    if (out_state) {
+        total.resume_offset = patrol->cursor;
+        *out_state = total;
+    }
+    return rc;
+}
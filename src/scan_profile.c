@@ -0,0 +1,218 @@
+#include "scan_profile.h"
+#include "surface_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#define PROFILE_CSV_MAGIC "# diskoracle transfer profile"
+#define PROFILE_CSV_COLUMNS "zone,offset,bytes,seconds,mbps,mean_us,p50_us,p99_us,max_us,bad_sectors"
+
+int scan_profile_init(scan_profile_t* profile, const char* device_path, const char* model, const char* serial,
+                      uint64_t device_size, unsigned zones, uint64_t zone_bytes, uint32_t block_size) {
+    memset(profile, 0, sizeof(*profile));
+    snprintf(profile->device_path, sizeof(profile->device_path), "%s", device_path ? device_path : "");
+    snprintf(profile->model, sizeof(profile->model), "%s", model ? model : "");
+    snprintf(profile->serial, sizeof(profile->serial), "%s", serial ? serial : "");
+    if (zones == 0) zones = SCAN_PROFILE_DEFAULT_ZONES;
+    if (zones > SCAN_PROFILE_MAX_ZONES) zones = SCAN_PROFILE_MAX_ZONES;
+    if (zone_bytes == 0) zone_bytes = SCAN_PROFILE_DEFAULT_ZONE_BYTES;
+    if (block_size == 0) block_size = SCAN_PROFILE_DEFAULT_BLOCK_SIZE;
+
+    // Zonas que se sobreporiam encolhem; cada uma lê blocos inteiros.
+    if (zone_bytes > device_size / zones) zone_bytes = device_size / zones;
+    zone_bytes -= zone_bytes % block_size;
+    if (zone_bytes == 0) return 1;
+
+    profile->device_size = device_size;
+    profile->block_size = block_size;
+    profile->zone_bytes = zone_bytes;
+    profile->zone_count = zones;
+    profile->created = (int64_t)time(NULL);
+
+    // A primeira zona começa no LBA 0 e a última termina no fim do disco.
+    uint64_t span = device_size - zone_bytes;
+    for (unsigned z = 0; z < zones; ++z) {
+        uint64_t offset = zones > 1 ? span / (zones - 1) * z + (span % (zones - 1)) * z / (zones - 1) : 0;
+        profile->zones[z].offset = offset - offset % block_size;
+    }
+    return 0;
+}
+
+int scan_profile_run(const char* device_path, scan_profile_t* profile, const scan_options_t* opts,
+                     scan_callback_t callback, void* user_data) {
+    if (!device_path || !profile || !opts || profile->zone_count == 0) return 1;
+
+    int rc = 0;
+    profile->measured = 0;
+    profile->created = (int64_t)time(NULL);
+    for (unsigned z = 0; z < profile->zone_count; ++z) {
+        scan_profile_zone_t* zone = &profile->zones[z];
+
+        // Uma leitura por vez, em ordem, para medir a taxa que a mídia sustenta.
+        scan_options_t run;
+        scan_options_for_measurement(&run, opts);
+        run.block_size = profile->block_size;
+        run.range_offset = zone->offset;
+        run.range_length = profile->zone_bytes;
+        run.order = SCAN_ORDER_SEQUENTIAL;
+        run.threads = 1;
+
+        scan_state_t step;
+        memset(&step, 0, sizeof(step));
+        uint64_t started_ns = scan_now_ns();
+        rc = surface_scan_ex(device_path, &run, callback, user_data, &step);
+        uint64_t elapsed_ns = scan_now_ns() - started_ns;
+        if (rc != 0 || step.scanned_blocks < step.total_blocks) {
+            rc = 1;
+            break;
+        }
+
+        zone->bytes = profile->zone_bytes;
+        zone->seconds = elapsed_ns / 1e9;
+        zone->mbps = zone->seconds > 0.0 ? (double)zone->bytes / (1024.0 * 1024.0) / zone->seconds : 0.0;
+        zone->mean_us = step.latency.count > 0 ? step.latency.sum_us / step.latency.count : 0;
+        zone->p50_us = scan_latency_percentile_us(&step.latency, 50.0);
+        zone->p99_us = scan_latency_percentile_us(&step.latency, 99.0);
+        zone->max_us = step.latency.max_us;
+        zone->bad_sectors = step.bad_sectors;
+        profile->measured = z + 1;
+    }
+    return rc;
+}
+
+double scan_profile_zone_position(const scan_profile_t* profile, unsigned zone) {
+    if (profile->device_size == 0 || zone >= profile->zone_count) return 0.0;
+    return ((double)profile->zones[zone].offset + (double)profile->zone_bytes / 2.0) / (double)profile->device_size;
+}
+
+double scan_profile_rate_at(const scan_profile_t* profile, double position) {
+    unsigned n = profile->measured;
+    if (n == 0) return 0.0;
+    if (n == 1 || position <= scan_profile_zone_position(profile, 0)) return profile->zones[0].mbps;
+    for (unsigned z = 1; z < n; ++z) {
+        double right = scan_profile_zone_position(profile, z);
+        if (position <= right) {
+            double left = scan_profile_zone_position(profile, z - 1);
+            double t = right > left ? (position - left) / (right - left) : 1.0;
+            return profile->zones[z - 1].mbps + t * (profile->zones[z].mbps - profile->zones[z - 1].mbps);
+        }
+    }
+    // Depois da última zona medida a curva fica no último valor.
+    return profile->zones[n - 1].mbps;
+}
+
+void scan_profile_compare(const scan_profile_t* profile, const scan_profile_t* baseline, scan_profile_comparison_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!profile || !baseline || baseline->measured == 0) return;
+
+    double total = 0.0;
+    for (unsigned z = 0; z < profile->measured; ++z) {
+        double expected = scan_profile_rate_at(baseline, scan_profile_zone_position(profile, z));
+        if (expected <= 0.0) continue;
+        double percent = 100.0 * (profile->zones[z].mbps - expected) / expected;
+        if (out->compared == 0 || percent < out->worst_percent) {
+            out->worst_percent = percent;
+            out->worst_zone = z;
+        }
+        if (percent < -SCAN_PROFILE_SLOW_PERCENT) out->slower++;
+        total += percent;
+        out->compared++;
+    }
+    if (out->compared > 0) out->mean_percent = total / out->compared;
+}
+
+void scan_profile_baseline_path(const char* model, char* out, size_t out_size) {
+    // Um arquivo por modelo: espaços e separadores viram '_'.
+    char name[64];
+    size_t n = 0;
+    for (const char* p = model && model[0] ? model : "unknown"; *p && n < sizeof(name) - 1; ++p) {
+        char c = *p;
+        name[n++] = (c == ' ' || c == '\\' || c == ':' || c == '/' || c == '.') ? '_' : c;
+    }
+    name[n] = '\0';
+#ifdef _WIN32
+    snprintf(out, out_size, "reports\\diskoracle_profile_%s.csv", name);
+#else
+    snprintf(out, out_size, "reports/diskoracle_profile_%s.csv", name);
+#endif
+}
+
+int scan_profile_save_csv(const char* path, const scan_profile_t* profile) {
+    if (!path || !profile) return 1;
+    FILE* fp = fopen(path, "w");
+    if (!fp) return 1;
+
+    fprintf(fp, "%s\n", PROFILE_CSV_MAGIC);
+    fprintf(fp, "# device,%s\n", profile->device_path);
+    fprintf(fp, "# model,%s\n", profile->model);
+    fprintf(fp, "# serial,%s\n", profile->serial);
+    fprintf(fp, "# device_size,%" PRIu64 "\n", profile->device_size);
+    fprintf(fp, "# block_size,%u\n", profile->block_size);
+    fprintf(fp, "# zone_bytes,%" PRIu64 "\n", profile->zone_bytes);
+    fprintf(fp, "# zones,%u\n", profile->zone_count);
+    fprintf(fp, "# created,%" PRId64 "\n", profile->created);
+    fprintf(fp, "%s\n", PROFILE_CSV_COLUMNS);
+    for (unsigned z = 0; z < profile->measured; ++z) {
+        const scan_profile_zone_t* zone = &profile->zones[z];
+        fprintf(fp, "%u,%" PRIu64 ",%" PRIu64 ",%.6f,%.2f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                z, zone->offset, zone->bytes, zone->seconds, zone->mbps,
+                zone->mean_us, zone->p50_us, zone->p99_us, zone->max_us, zone->bad_sectors);
+    }
+    return fclose(fp) == 0 ? 0 : 1;
+}
+
+// Copia o valor de uma linha "# chave,valor" sem o fim de linha.
+static void profile_header_value(const char* value, char* out, size_t out_size) {
+    size_t n = strcspn(value, "\r\n");
+    if (n >= out_size) n = out_size - 1;
+    memcpy(out, value, n);
+    out[n] = '\0';
+}
+
+int scan_profile_load_csv(const char* path, scan_profile_t* profile) {
+    if (!path || !profile) return 1;
+    FILE* fp = fopen(path, "r");
+    if (!fp) return 1;
+
+    memset(profile, 0, sizeof(*profile));
+    char line[512];
+    bool valid = fgets(line, sizeof(line), fp) != NULL && strncmp(line, PROFILE_CSV_MAGIC, strlen(PROFILE_CSV_MAGIC)) == 0;
+    while (valid && fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#') {
+            const char* comma = strchr(line, ',');
+            if (!comma) continue;
+            size_t key = (size_t)(comma - line);
+            const char* value = comma + 1;
+            if (strncmp(line, "# device,", key + 1) == 0) profile_header_value(value, profile->device_path, sizeof(profile->device_path));
+            else if (strncmp(line, "# model,", key + 1) == 0) profile_header_value(value, profile->model, sizeof(profile->model));
+            else if (strncmp(line, "# serial,", key + 1) == 0) profile_header_value(value, profile->serial, sizeof(profile->serial));
+            else if (strncmp(line, "# device_size,", key + 1) == 0) profile->device_size = strtoull(value, NULL, 10);
+            else if (strncmp(line, "# block_size,", key + 1) == 0) profile->block_size = (uint32_t)strtoul(value, NULL, 10);
+            else if (strncmp(line, "# zone_bytes,", key + 1) == 0) profile->zone_bytes = strtoull(value, NULL, 10);
+            else if (strncmp(line, "# zones,", key + 1) == 0) profile->zone_count = (unsigned)strtoul(value, NULL, 10);
+            else if (strncmp(line, "# created,", key + 1) == 0) profile->created = strtoll(value, NULL, 10);
+            continue;
+        }
+        if (strncmp(line, "zone,", 5) == 0) continue;
+
+        // As zonas vêm em ordem; uma linha fora dela invalida o arquivo.
+        unsigned index = 0;
+        scan_profile_zone_t zone;
+        memset(&zone, 0, sizeof(zone));
+        if (sscanf(line, "%u,%" SCNu64 ",%" SCNu64 ",%lf,%lf,%" SCNu64 ",%" SCNu64 ",%" SCNu64 ",%" SCNu64 ",%" SCNu64,
+                   &index, &zone.offset, &zone.bytes, &zone.seconds, &zone.mbps,
+                   &zone.mean_us, &zone.p50_us, &zone.p99_us, &zone.max_us, &zone.bad_sectors) != 10 ||
+            index != profile->measured || index >= SCAN_PROFILE_MAX_ZONES) {
+            valid = false;
+            break;
+        }
+        profile->zones[profile->measured++] = zone;
+    }
+    fclose(fp);
+
+    if (profile->zone_count < profile->measured) profile->zone_count = profile->measured;
+    if (!valid || profile->device_size == 0 || profile->zone_count > SCAN_PROFILE_MAX_ZONES) return 1;
+    return 0;
+}
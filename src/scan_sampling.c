@@ -0,0 +1,117 @@
+#include "scan_sampling.h"
+#include <math.h>
+#include <time.h>
+
+// Quantil da normal padrão (aproximação racional de Acklam, erro < 1.2e-9).
+static double normal_quantile(double p) {
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    const double p_low = 0.02425;
+
+    if (p <= 0.0) p = 1e-300;
+    if (p >= 1.0) p = 1.0 - 1e-16;
+    if (p < p_low) {
+        double q = sqrt(-2.0 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (p > 1.0 - p_low) {
+        return -normal_quantile(1.0 - p);
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// z bilateral: P(|Z| <= z) = confidence.
+static double confidence_z(double confidence) {
+    if (!(confidence > 0.0 && confidence < 1.0)) confidence = SCAN_SAMPLE_DEFAULT_CONFIDENCE;
+    return normal_quantile(0.5 + confidence / 2.0);
+}
+
+uint64_t scan_sampling_size(double confidence, double tolerance) {
+    if (!(tolerance > 0.0 && tolerance < 1.0)) tolerance = SCAN_SAMPLE_DEFAULT_TOLERANCE;
+    double z = confidence_z(confidence);
+
+    // Com zero falhas o limite superior de Wilson é z²/(n+z²).
+    double n = ceil(z * z * (1.0 - tolerance) / tolerance);
+    if (n < 1.0) return 1;
+    if (n > (double)SCAN_SAMPLE_MAX_BLOCKS) return SCAN_SAMPLE_MAX_BLOCKS;
+    return (uint64_t)n;
+}
+
+void scan_sampling_interval(uint64_t bad, uint64_t samples, double confidence, double* low, double* high) {
+    if (samples == 0) {
+        *low = 0.0;
+        *high = 0.0;
+        return;
+    }
+    if (bad > samples) bad = samples;
+
+    double z = confidence_z(confidence);
+    double n = (double)samples;
+    double p = (double)bad / n;
+    double z2 = z * z;
+    double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    double margin = z / (1.0 + z2 / n) * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+
+    *low = bad == 0 ? 0.0 : center - margin;
+    *high = bad == samples ? 1.0 : center + margin;
+    if (*low < 0.0) *low = 0.0;
+    if (*high > 1.0) *high = 1.0;
+}
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// splitmix64: espalha (seed, estrato) num valor uniforme de 64 bits.
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void scan_sampler_init(scan_sampler_t* sampler, uint64_t population, uint64_t count, uint64_t seed) {
+    if (count > SCAN_SAMPLE_MAX_BLOCKS) count = SCAN_SAMPLE_MAX_BLOCKS;
+    if (count > population) count = population;
+    sampler->population = population;
+    sampler->count = count;
+    sampler->seed = seed ? seed : mix64((uint64_t)time(NULL) ^ (uint64_t)clock());
+
+    // Passo de Fibonacci: estratos consecutivos na ordem de visita caem longe
+    // uns dos outros e cada prefixo preenche os maiores vazios.
+    uint64_t step = (uint64_t)((double)count * 0.6180339887498949);
+    if (step == 0) step = 1;
+    while (count > 1 && gcd_u64(step, count) != 1) step++;
+    sampler->step = step;
+}
+
+uint64_t scan_split_point(uint64_t total, uint64_t parts, uint64_t i) {
+    // i * total estouraria 64 bits; i * rest < parts^2 cabe.
+    uint64_t whole = total / parts;
+    uint64_t rest = total % parts;
+    return i * whole + (i * rest) / parts;
+}
+
+uint64_t scan_sampler_block(const scan_sampler_t* sampler, uint64_t index) {
+    if (sampler->count == 0) return 0;
+    // count <= 2^24, então o produto cabe em 64 bits.
+    uint64_t stratum = (index % sampler->count) * sampler->step % sampler->count;
+    uint64_t first = scan_split_point(sampler->population, sampler->count, stratum);
+    uint64_t length = scan_split_point(sampler->population, sampler->count, stratum + 1) - first;
+    return first + mix64(sampler->seed ^ mix64(stratum)) % length;
+}
@@ -0,0 +1,277 @@
+#include "scan_scheduler.h"
+#include "surface_engine.h"
+#include "scan_journal.h"
+#include "pal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <time.h>
+#endif
+
+// Fila compartilhada pelo pool. lock protege next, running e o progresso e o
+// status de cada job (escritos pelas threads de scan, lidos pelo painel).
+struct scan_scheduler_s {
+    scan_mutex_t lock;
+    scan_job_t* jobs;
+    size_t count;
+    size_t next;
+    unsigned running;
+};
+
+const char* scan_job_status_name(scan_job_status_t status) {
+    switch (status) {
+        case SCAN_JOB_PENDING: return "queued";
+        case SCAN_JOB_RUNNING: return "scanning";
+        case SCAN_JOB_DONE: return "done";
+        case SCAN_JOB_FAILED: return "failed";
+        default: return "unknown";
+    }
+}
+
+static void scan_job_lock(const scan_job_t* job) {
+    if (job->scheduler) scan_mutex_lock(&job->scheduler->lock);
+}
+
+static void scan_job_unlock(const scan_job_t* job) {
+    if (job->scheduler) scan_mutex_unlock(&job->scheduler->lock);
+}
+
+static void scan_job_collect_extent(const bad_extent_t* extent, uint32_t sector_size, void* user_data) {
+    scan_job_t* job = (scan_job_t*)user_data;
+    job->sector_size = sector_size;
+    if (job->extent_count < SCAN_JOB_MAX_EXTENTS) {
+        job->extents[job->extent_count++] = *extent;
+    }
+}
+
+static void scan_job_progress(const scan_state_t* state, void* user_data) {
+    scan_job_t* job = (scan_job_t*)user_data;
+    scan_job_lock(job);
+    memcpy(&job->state, state, sizeof(scan_state_t));
+    scan_job_unlock(job);
+    if (job->on_progress) {
+        job->on_progress(job, state, job->progress_user_data);
+    }
+}
+
+// Um resume continua com os modos do checkpoint (surface.c também os impõe):
+// o job precisa do índice de inconsistências, do mapa de conteúdo e do caminho
+// das faixas alocadas que eles pedem. Sem checkpoint válido nada muda e o
+// próprio scan recusa o resume.
+static void scan_job_adopt_checkpoint(scan_job_t* job) {
+    scan_journal_t* journal = (scan_journal_t*)malloc(sizeof(scan_journal_t));
+    if (journal == NULL) return;
+    if (scan_journal_load(job->opts.journal_path, journal, NULL, NULL, NULL) == 0) {
+        job->opts.verify = journal->verify;
+        job->opts.classify = journal->classify;
+        job->opts.allocated_path = NULL;
+        if (journal->allocated_path[0] != '\0') {
+            snprintf(job->allocated_path, sizeof(job->allocated_path), "%s", journal->allocated_path);
+            job->opts.allocated_path = job->allocated_path;
+            if (job->opts.map_files_path == NULL) job->opts.map_files_path = job->allocated_path;
+        }
+    }
+    free(journal);
+}
+
+int scan_job_init(scan_job_t* job, const char* device_path, const scan_options_t* opts) {
+    memset(job, 0, sizeof(*job));
+    snprintf(job->device_path, sizeof(job->device_path), "%s", device_path);
+    if (pal_get_basic_drive_info(device_path, &job->drive_info) != PAL_STATUS_SUCCESS || job->drive_info.path[0] == '\0') {
+        snprintf(job->drive_info.path, sizeof(job->drive_info.path), "%s", device_path);
+    }
+
+    if (opts) {
+        job->opts = *opts;
+    } else {
+        surface_scan_options_init(&job->opts);
+    }
+    if (job->opts.controls) {
+        job->controls = *job->opts.controls;
+        job->opts.controls = &job->controls;
+    }
+
+    // Scans profundos gravam checkpoints para poderem ser retomados com --resume.
+    if (job->opts.mode && strcmp(job->opts.mode, "deep") == 0) {
+        job->opts.device_serial = job->drive_info.serial;
+        if (job->opts.journal_path == NULL) {
+            pal_ensure_directory_exists("reports");
+            scan_journal_default_path(device_path, job->journal_path, sizeof(job->journal_path));
+            job->opts.journal_path = job->journal_path;
+        }
+    }
+    if (job->opts.resume) {
+        scan_job_adopt_checkpoint(job);
+    }
+
+    job->opts.content_map = job->opts.classify ? &job->content : NULL;
+    job->opts.on_bad_extent = scan_job_collect_extent;
+    job->opts.bad_extent_user_data = job;
+    job->opts.bad_index = bad_extent_index_create(0);
+    job->opts.latency_map = latency_map_create(0);
+    job->opts.mismatch_index = job->opts.verify ? bad_extent_index_create(0) : NULL;
+    if (job->opts.bad_index == NULL || job->opts.latency_map == NULL || (job->opts.verify && job->opts.mismatch_index == NULL)) {
+        scan_job_release(job);
+        return 1;
+    }
+    job->status = SCAN_JOB_PENDING;
+    return 0;
+}
+
+void scan_job_release(scan_job_t* job) {
+    bad_extent_index_destroy(job->opts.bad_index);
+    latency_map_destroy(job->opts.latency_map);
+    bad_extent_index_destroy(job->opts.mismatch_index);
+    job->opts.bad_index = NULL;
+    job->opts.latency_map = NULL;
+    job->opts.mismatch_index = NULL;
+    job->opts.content_map = NULL;
+    scan_file_damage_free(&job->damage);
+    job->state.file_damage = NULL;
+}
+
+int scan_job_run(scan_job_t* job) {
+    scan_job_lock(job);
+    job->status = SCAN_JOB_RUNNING;
+    scan_job_unlock(job);
+
+    scan_state_t final_state;
+    memset(&final_state, 0, sizeof(final_state));
+    int rc = surface_scan_ex(job->device_path, &job->opts, scan_job_progress, job, &final_state);
+
+    // Também depois de um scan interrompido: os setores já achados valem.
+    if (job->opts.map_files_path && (final_state.bad_sectors > 0 || final_state.mismatch_sectors > 0)) {
+        scan_file_damage_map(&job->damage, job->opts.map_files_path, job->device_path,
+                             job->opts.bad_index, job->opts.mismatch_index);
+        final_state.file_damage = &job->damage;
+    }
+
+    scan_job_lock(job);
+    memcpy(&job->state, &final_state, sizeof(scan_state_t));
+    job->rc = rc;
+    job->status = rc == 0 ? SCAN_JOB_DONE : SCAN_JOB_FAILED;
+    scan_job_unlock(job);
+    return rc;
+}
+
+void scan_job_snapshot(const scan_job_t* job, scan_state_t* state, scan_job_status_t* status) {
+    scan_job_lock(job);
+    if (state) memcpy(state, &job->state, sizeof(scan_state_t));
+    if (status) *status = job->status;
+    scan_job_unlock(job);
+}
+
+#ifdef _WIN32
+static unsigned __stdcall scan_scheduler_worker(void* arg) {
+#else
+static void* scan_scheduler_worker(void* arg) {
+#endif
+    struct scan_scheduler_s* scheduler = (struct scan_scheduler_s*)arg;
+    for (;;) {
+        scan_mutex_lock(&scheduler->lock);
+        size_t index = scheduler->next < scheduler->count ? scheduler->next++ : scheduler->count;
+        scan_mutex_unlock(&scheduler->lock);
+        if (index >= scheduler->count || scan_stop_requested()) break;
+        scan_job_run(&scheduler->jobs[index]);
+    }
+
+    scan_mutex_lock(&scheduler->lock);
+    scheduler->running--;
+    scan_mutex_unlock(&scheduler->lock);
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static void scan_scheduler_sleep_ms(unsigned ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = { 0, (long)ms * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+int scan_scheduler_run(scan_job_t* jobs, size_t count, unsigned max_concurrent, scan_scheduler_tick_t tick, void* user_data) {
+    if (jobs == NULL || count == 0) return 1;
+
+    unsigned threads = (max_concurrent == 0 || max_concurrent > count) ? (unsigned)count : max_concurrent;
+#ifdef _WIN32
+    HANDLE* handles = (HANDLE*)calloc(threads, sizeof(HANDLE));
+#else
+    pthread_t* handles = (pthread_t*)calloc(threads, sizeof(pthread_t));
+#endif
+    if (handles == NULL) return 1;
+
+    struct scan_scheduler_s scheduler;
+    memset(&scheduler, 0, sizeof(scheduler));
+    scan_mutex_init(&scheduler.lock);
+    scheduler.jobs = jobs;
+    scheduler.count = count;
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i].scheduler = &scheduler;
+    }
+
+    unsigned started = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        scan_mutex_lock(&scheduler.lock);
+        scheduler.running++;
+        scan_mutex_unlock(&scheduler.lock);
+#ifdef _WIN32
+        handles[i] = (HANDLE)_beginthreadex(NULL, 0, scan_scheduler_worker, &scheduler, 0, NULL);
+        bool ok = handles[i] != 0;
+#else
+        bool ok = pthread_create(&handles[i], NULL, scan_scheduler_worker, &scheduler) == 0;
+#endif
+        if (!ok) {
+            scan_mutex_lock(&scheduler.lock);
+            scheduler.running--;
+            scan_mutex_unlock(&scheduler.lock);
+            break;
+        }
+        started++;
+    }
+
+    // Sem nenhuma thread, os jobs rodam aqui mesmo, um por vez.
+    if (started == 0) {
+        for (size_t i = 0; i < count && !scan_stop_requested(); ++i) {
+            scan_job_run(&jobs[i]);
+            if (tick) tick(jobs, count, user_data);
+        }
+    }
+
+    for (;;) {
+        scan_mutex_lock(&scheduler.lock);
+        unsigned running = scheduler.running;
+        scan_mutex_unlock(&scheduler.lock);
+        if (running == 0) break;
+        if (tick) tick(jobs, count, user_data);
+        scan_scheduler_sleep_ms(200);
+    }
+
+    for (unsigned i = 0; i < started; ++i) {
+#ifdef _WIN32
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+#else
+        pthread_join(handles[i], NULL);
+#endif
+    }
+    free(handles);
+
+    if (tick) tick(jobs, count, user_data);
+
+    int rc = 0;
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i].scheduler = NULL;
+        if (jobs[i].status != SCAN_JOB_DONE) rc = 1;
+    }
+    scan_mutex_destroy(&scheduler.lock);
+    return rc;
+}
@@ -0,0 +1,292 @@
+#include "surface_engine.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#endif
+
+#define THROTTLE_BURST_NS (100ULL * 1000000ULL)     // o balde guarda no máximo 100 ms de créditos
+#define THROTTLE_WINDOW_NS (100ULL * 1000000ULL)    // janela do controlador de latência
+#define THROTTLE_SLICE_NS (50ULL * 1000000ULL)      // espera máxima antes de atualizar o progresso
+#define THROTTLE_MIN_BPS (256ULL * 1024ULL)         // o recuo nunca para o scan de vez
+#define THROTTLE_STEP_MIN_BPS (1024ULL * 1024ULL)
+#define THROTTLE_SAMPLE_NS (250ULL * 1000000ULL)    // intervalo entre amostras dos contadores do disco
+#define THROTTLE_FOREGROUND_BPS (64.0 * 1024.0)     // I/O alheio abaixo disso (logs, metadados) não conta
+#define THROTTLE_READAHEAD_SECTORS 256ULL           // folga para readahead e leituras de metadados
+
+#if defined(__linux__)
+#define SCAN_IOPRIO_WHO_PROCESS 1       // com id 0: a thread chamadora
+#define SCAN_IOPRIO_CLASS_IDLE 3
+#define SCAN_IOPRIO_CLASS_SHIFT 13
+#endif
+
+void scan_controls_set_limits(scan_controls_t* controls, uint64_t max_bytes_per_sec, uint64_t max_iops) {
+    if (!controls) return;
+    SCAN_ATOMIC_STORE(&controls->max_bytes_per_sec, max_bytes_per_sec);
+    SCAN_ATOMIC_STORE(&controls->max_iops, max_iops);
+}
+
+void scan_controls_set_latency_target(scan_controls_t* controls, uint64_t latency_target_us) {
+    if (!controls) return;
+    SCAN_ATOMIC_STORE(&controls->latency_target_us, latency_target_us);
+}
+
+void scan_throttle_init(scan_throttle_t* throttle, scan_controls_t* controls, const char* device_path) {
+    memset(throttle, 0, sizeof(*throttle));
+    throttle->controls = controls;
+    scan_mutex_init(&throttle->lock);
+    throttle->last_refill_ns = scan_now_ns();
+    throttle->window_start_ns = throttle->last_refill_ns;
+
+    // Sem contadores (imagens de disco, macOS) o modo idle-aware fica desligado.
+    throttle->device_path = device_path;
+    throttle->sample_ns = throttle->last_refill_ns;
+    throttle->idle_aware = controls->idle_aware && device_path &&
+                           pal_get_io_counters(device_path, &throttle->counters) == PAL_STATUS_SUCCESS;
+}
+
+void scan_throttle_destroy(scan_throttle_t* throttle) {
+    scan_mutex_destroy(&throttle->lock);
+}
+
+// Menor entre o limite do usuário e o imposto pelo alvo de latência. Chamar com lock.
+static uint64_t throttle_effective_bps(const scan_throttle_t* throttle) {
+    uint64_t cap = SCAN_ATOMIC_LOAD(&throttle->controls->max_bytes_per_sec);
+    uint64_t adaptive = throttle->adaptive_bps;
+    if (cap == 0) return adaptive;
+    if (adaptive == 0) return cap;
+    return adaptive < cap ? adaptive : cap;
+}
+
+void scan_throttle_report(scan_throttle_t* throttle, scan_state_t* state) {
+    if (!throttle) {
+        state->throttle_bytes_per_sec = 0;
+        state->foreground_io = false;
+        state->paused = false;
+        state->depth_limit = 0;
+        return;
+    }
+    scan_mutex_lock(&throttle->lock);
+    state->throttle_bytes_per_sec = throttle_effective_bps(throttle);
+    state->foreground_io = throttle->foreground;
+    state->paused = throttle->paused;
+    state->depth_limit = throttle->depth_limit;
+    scan_mutex_unlock(&throttle->lock);
+}
+
+unsigned scan_throttle_depth(scan_throttle_t* throttle, unsigned depth) {
+    if (!throttle || !throttle->idle_aware) return depth;
+    scan_mutex_lock(&throttle->lock);
+    if (depth > throttle->engine_depth) throttle->engine_depth = depth;
+    unsigned allowed = throttle->depth_limit && throttle->depth_limit < depth ? throttle->depth_limit : depth;
+    scan_mutex_unlock(&throttle->lock);
+    return allowed ? allowed : 1;
+}
+
+static uint64_t counter_delta(uint64_t now, uint64_t before) {
+    return now >= before ? now - before : 0;    // contadores zerados (disco reconectado)
+}
+
+// Compara o que o disco fez desde a última amostra com o que o scan pediu e
+// ajusta a fila. Chamar com lock.
+static void throttle_sample(scan_throttle_t* throttle, uint64_t now) {
+    if (!throttle->idle_aware || now - throttle->sample_ns < THROTTLE_SAMPLE_NS) return;
+
+    pal_io_counters_t counters;
+    if (pal_get_io_counters(throttle->device_path, &counters) != PAL_STATUS_SUCCESS) return;
+
+    // Escritas são sempre de outros processos; leituras, só o que passar das do scan.
+    uint64_t own = throttle->own_sectors - throttle->sampled_own_sectors;
+    uint64_t read = counter_delta(counters.sectors_read, throttle->counters.sectors_read);
+    uint64_t foreign = counter_delta(counters.sectors_written, throttle->counters.sectors_written);
+    uint64_t slack = own / 8 + THROTTLE_READAHEAD_SECTORS;
+    if (read > own + slack) foreign += read - own - slack;
+    double seconds = (now - throttle->sample_ns) / 1e9;
+    throttle->foreground = foreign * 512.0 / seconds > THROTTLE_FOREGROUND_BPS;
+
+    if (throttle->foreground) {
+        // Cede o disco aos poucos: metade da fila por amostra, depois pausa.
+        if (throttle->depth_limit == 1) {
+            throttle->paused = true;
+        } else {
+            unsigned current = throttle->depth_limit ? throttle->depth_limit : throttle->engine_depth;
+            throttle->depth_limit = current > 1 ? current / 2 : 1;
+        }
+    } else if (throttle->paused) {
+        throttle->paused = false;
+    } else if (throttle->depth_limit) {
+        throttle->depth_limit *= 2;
+        if (throttle->depth_limit >= throttle->engine_depth) throttle->depth_limit = 0;
+    }
+
+    throttle->counters = counters;
+    throttle->sampled_own_sectors = throttle->own_sectors;
+    throttle->sample_ns = now;
+}
+
+// Repõe os créditos de um balde e desconta cost; devolve quanto esperar até quitar a dívida.
+static uint64_t throttle_take(double* tokens, uint64_t rate, uint64_t elapsed_ns, double cost) {
+    if (rate == 0) {
+        *tokens = 0.0;
+        return 0;
+    }
+    double burst = (double)rate * THROTTLE_BURST_NS / 1e9;
+    if (burst < cost) burst = cost;
+    *tokens += (double)rate * elapsed_ns / 1e9;
+    if (*tokens > burst) *tokens = burst;
+    *tokens -= cost;
+    return *tokens < 0.0 ? (uint64_t)(-*tokens / rate * 1e9) : 0;
+}
+
+// Como throttle_take(), sem descontar: se cost já cabe no balde.
+static bool throttle_has(double tokens, uint64_t rate, uint64_t elapsed_ns, double cost) {
+    if (rate == 0) return true;
+    double burst = (double)rate * THROTTLE_BURST_NS / 1e9;
+    if (burst < cost) burst = cost;
+    tokens += (double)rate * elapsed_ns / 1e9;
+    if (tokens > burst) tokens = burst;
+    return tokens >= cost;
+}
+
+bool scan_throttle_ready(scan_throttle_t* throttle, uint32_t bytes) {
+    if (!throttle) return true;
+    scan_mutex_lock(&throttle->lock);
+    uint64_t now = scan_now_ns();
+    throttle_sample(throttle, now);
+    uint64_t elapsed = now - throttle->last_refill_ns;
+    bool ready = !throttle->paused &&
+                 throttle_has(throttle->byte_tokens, throttle_effective_bps(throttle), elapsed, (double)bytes) &&
+                 throttle_has(throttle->op_tokens, SCAN_ATOMIC_LOAD(&throttle->controls->max_iops), elapsed, 1.0);
+    scan_mutex_unlock(&throttle->lock);
+    return ready;
+}
+
+static void throttle_sleep_ns(uint64_t ns) {
+#ifdef _WIN32
+    Sleep((DWORD)((ns + 999999ULL) / 1000000ULL));
+#else
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+void scan_throttle_acquire(scan_ctx_t* ctx, uint32_t bytes) {
+    scan_throttle_t* throttle = ctx->throttle;
+    if (!throttle) return;
+
+    scan_mutex_lock(&throttle->lock);
+    uint64_t now = scan_now_ns();
+    throttle_sample(throttle, now);
+    bool paused = throttle->paused;
+    uint64_t elapsed = now - throttle->last_refill_ns;
+    throttle->last_refill_ns = now;
+    uint64_t wait_bytes = throttle_take(&throttle->byte_tokens, throttle_effective_bps(throttle), elapsed, (double)bytes);
+    uint64_t wait_ops = throttle_take(&throttle->op_tokens, SCAN_ATOMIC_LOAD(&throttle->controls->max_iops), elapsed, 1.0);
+    // Contado ao pedir, não ao concluir: leituras em voo não parecem I/O alheio.
+    throttle->own_sectors += (bytes + 511) / 512;
+    scan_mutex_unlock(&throttle->lock);
+
+    // Espera em fatias: o callback continua rodando (e pode mudar os limites).
+    uint64_t wait = wait_bytes > wait_ops ? wait_bytes : wait_ops;
+    uint64_t deadline = now + wait;
+    while ((wait > 0 || paused) && !scan_ctx_stop(ctx)) {
+        throttle_sleep_ns(wait > 0 && wait < THROTTLE_SLICE_NS ? wait : THROTTLE_SLICE_NS);
+        scan_ctx_update_progress(ctx, false);
+
+        now = scan_now_ns();
+        wait = now < deadline ? deadline - now : 0;
+        // Limites removidos no meio da espera liberam a leitura na hora.
+        if (SCAN_ATOMIC_LOAD(&throttle->controls->max_bytes_per_sec) == 0 &&
+            SCAN_ATOMIC_LOAD(&throttle->controls->max_iops) == 0 &&
+            SCAN_ATOMIC_LOAD(&throttle->controls->latency_target_us) == 0) {
+            wait = 0;
+        }
+        if (paused) {
+            scan_mutex_lock(&throttle->lock);
+            throttle_sample(throttle, now);
+            paused = throttle->paused;
+            scan_mutex_unlock(&throttle->lock);
+        }
+    }
+}
+
+void scan_throttle_observe(scan_throttle_t* throttle, uint32_t bytes, uint64_t latency_ns) {
+    if (!throttle) return;
+    uint64_t target_us = SCAN_ATOMIC_LOAD(&throttle->controls->latency_target_us);
+
+    scan_mutex_lock(&throttle->lock);
+    if (target_us == 0) {
+        throttle->adaptive_bps = 0;
+        throttle->window_reads = 0;
+        scan_mutex_unlock(&throttle->lock);
+        return;
+    }
+
+    throttle->window_reads++;
+    throttle->window_latency_ns += latency_ns;
+    throttle->window_bytes += bytes;
+    uint64_t now = scan_now_ns();
+    uint64_t span = now - throttle->window_start_ns;
+    if (span >= THROTTLE_WINDOW_NS) {
+        uint64_t mean_us = throttle->window_latency_ns / throttle->window_reads / 1000;
+        uint64_t observed_bps = (uint64_t)((double)throttle->window_bytes * 1e9 / span);
+        uint64_t cap = SCAN_ATOMIC_LOAD(&throttle->controls->max_bytes_per_sec);
+
+        if (mean_us > target_us) {
+            // Recuo multiplicativo a partir do ritmo real (ou do teto atual).
+            uint64_t base = throttle->adaptive_bps ? throttle->adaptive_bps : observed_bps;
+            if (cap && base > cap) base = cap;
+            throttle->adaptive_bps = base / 2 > THROTTLE_MIN_BPS ? base / 2 : THROTTLE_MIN_BPS;
+        } else if (throttle->adaptive_bps) {
+            // Subida aditiva; sem folga para ganhar, o recuo deixa de existir.
+            uint64_t step = cap ? cap / 20 : observed_bps / 10;
+            if (step < THROTTLE_STEP_MIN_BPS) step = THROTTLE_STEP_MIN_BPS;
+            throttle->adaptive_bps += step;
+            if ((cap && throttle->adaptive_bps >= cap) || (!cap && throttle->adaptive_bps > 2 * observed_bps)) {
+                throttle->adaptive_bps = 0;
+            }
+        }
+        throttle->window_start_ns = now;
+        throttle->window_reads = 0;
+        throttle->window_latency_ns = 0;
+        throttle->window_bytes = 0;
+    }
+    scan_mutex_unlock(&throttle->lock);
+}
+
+int scan_io_idle_begin(void) {
+#if defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) ? 1 : -1;
+#elif defined(__linux__)
+    long previous = syscall(SYS_ioprio_get, SCAN_IOPRIO_WHO_PROCESS, 0);
+    if (previous < 0) return -1;
+    if (syscall(SYS_ioprio_set, SCAN_IOPRIO_WHO_PROCESS, 0, SCAN_IOPRIO_CLASS_IDLE << SCAN_IOPRIO_CLASS_SHIFT) != 0) return -1;
+    return (int)previous;
+#elif defined(__APPLE__)
+    int previous = getiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD);
+    if (previous < 0) return -1;
+    if (setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, IOPOL_THROTTLE) != 0) return -1;
+    return previous;
+#else
+    return -1;
+#endif
+}
+
+void scan_io_idle_end(int previous) {
+    if (previous < 0) return;
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#elif defined(__linux__)
+    syscall(SYS_ioprio_set, SCAN_IOPRIO_WHO_PROCESS, 0, previous);
+#elif defined(__APPLE__)
+    setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, previous);
+#endif
+}
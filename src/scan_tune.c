@@ -0,0 +1,179 @@
+#include "scan_tune.h"
+#include "surface_engine.h"
+#include <string.h>
+
+static const uint32_t tune_block_sizes[] = { 64 * 1024, 256 * 1024, 1024 * 1024 };
+static const uint32_t tune_queue_depths[] = { 1, 4, 16, 32, 64 };
+static const uint32_t tune_rotational_queue_depths[] = { 1, 2, 4 };
+
+// Insere size em sizes (crescente, sem repetidos).
+static unsigned tune_insert_size(uint32_t* sizes, unsigned count, unsigned max_sizes, uint32_t size) {
+    unsigned pos = 0;
+    while (pos < count && sizes[pos] < size) pos++;
+    if ((pos < count && sizes[pos] == size) || count >= max_sizes) return count;
+    memmove(&sizes[pos + 1], &sizes[pos], (count - pos) * sizeof(sizes[0]));
+    sizes[pos] = size;
+    return count + 1;
+}
+
+unsigned scan_tune_block_sizes(const pal_queue_limits_t* limits, uint32_t* sizes, unsigned max_sizes) {
+    uint32_t largest = SCAN_TUNE_MAX_BLOCK_SIZE;
+    uint32_t smallest = 512;
+    if (limits) {
+        if (limits->physical_block_size > smallest) smallest = limits->physical_block_size;
+        if (limits->logical_block_size > smallest) smallest = limits->logical_block_size;
+        if (limits->max_transfer_bytes > 0 && limits->max_transfer_bytes < largest) {
+            largest = limits->max_transfer_bytes / smallest * smallest;
+        }
+    }
+
+    unsigned count = 0;
+    for (unsigned i = 0; i < sizeof(tune_block_sizes) / sizeof(tune_block_sizes[0]); ++i) {
+        if (tune_block_sizes[i] <= largest && tune_block_sizes[i] >= smallest) {
+            count = tune_insert_size(sizes, count, max_sizes, tune_block_sizes[i]);
+        }
+    }
+    // Sem limite conhecido não vale arriscar blocos que o kernel vai dividir.
+    if (limits && limits->max_transfer_bytes > 0 && largest >= smallest) {
+        count = tune_insert_size(sizes, count, max_sizes, largest);
+    }
+    if (count == 0 && max_sizes > 0) sizes[count++] = smallest;
+    return count;
+}
+
+unsigned scan_tune_queue_depths(const pal_queue_limits_t* limits, uint32_t* depths, unsigned max_depths) {
+    bool rotational = limits && limits->rotational == 1;
+    const uint32_t* list = rotational ? tune_rotational_queue_depths : tune_queue_depths;
+    unsigned length = rotational ? sizeof(tune_rotational_queue_depths) / sizeof(tune_rotational_queue_depths[0])
+                                 : sizeof(tune_queue_depths) / sizeof(tune_queue_depths[0]);
+    unsigned count = 0;
+    for (unsigned i = 0; i < length && count < max_depths; ++i) {
+        if (i > 0 && limits && limits->nr_requests > 0 && list[i] > limits->nr_requests) break;
+        depths[count++] = list[i];
+    }
+    return count;
+}
+
+typedef struct {
+    const char* device_path;
+    scan_options_t run;
+    uint64_t device_size;
+    uint64_t next_offset;       // onde a próxima medição sequencial começa
+    bool by_iops;
+    scan_callback_t callback;
+    void* user_data;
+    scan_tune_result_t* result;
+} tune_ctx_t;
+
+static double tune_score(const tune_ctx_t* tc, const scan_tune_probe_t* probe) {
+    return tc->by_iops ? probe->iops : probe->mbps;
+}
+
+static int tune_probe(tune_ctx_t* tc, uint32_t block_size, uint32_t queue_depth, scan_tune_probe_t** out) {
+    scan_tune_result_t* result = tc->result;
+    if (result->probe_count >= SCAN_TUNE_MAX_PROBES) return 1;
+
+    scan_options_t run = tc->run;
+    run.block_size = block_size;
+    run.queue_depth = queue_depth;
+    run.range_offset = run.order == SCAN_ORDER_SEQUENTIAL ? tc->next_offset : 0;
+
+    scan_state_t state;
+    memset(&state, 0, sizeof(state));
+    uint64_t started_ns = scan_now_ns();
+    int rc = surface_scan_ex(tc->device_path, &run, tc->callback, tc->user_data, &state);
+    uint64_t elapsed_ns = scan_now_ns() - started_ns;
+    if (rc != 0 || state.scanned_blocks == 0 || elapsed_ns == 0) {
+        result->interrupted = scan_stop_requested();
+        return 1;
+    }
+
+    if (run.order == SCAN_ORDER_SEQUENTIAL) {
+        tc->next_offset = state.resume_offset < tc->device_size ? state.resume_offset : 0;
+    }
+    // A engine que de fato leu diz se a fila conta; sem io_uring a medida é de QD 1.
+    result->async = state.engine == SCAN_ENGINE_URING;
+    scan_tune_probe_t* probe = &result->probes[result->probe_count++];
+    double seconds = elapsed_ns / 1e9;
+    probe->block_size = state.block_size;
+    probe->queue_depth = result->async ? queue_depth : 1;
+    probe->iops = (double)state.scanned_blocks / seconds;
+    probe->mbps = (double)state.scanned_blocks * state.block_size / (1024.0 * 1024.0) / seconds;
+    *out = probe;
+    return 0;
+}
+
+// Mede cada candidato e devolve o melhor; um candidato maior só vence se for
+// SCAN_TUNE_MIN_GAIN_PERCENT mais rápido, para não trocar por ruído.
+static int tune_pick(tune_ctx_t* tc, const uint32_t* blocks, const uint32_t* depths, unsigned count, const scan_tune_probe_t** best) {
+    *best = NULL;
+    for (unsigned i = 0; i < count; ++i) {
+        scan_tune_probe_t* probe = NULL;
+        if (tune_probe(tc, blocks ? blocks[i] : tc->result->block_size, depths ? depths[i] : tc->result->queue_depth, &probe) != 0) {
+            return 1;
+        }
+        if (*best == NULL || tune_score(tc, probe) > tune_score(tc, *best) * (1.0 + SCAN_TUNE_MIN_GAIN_PERCENT / 100.0)) {
+            *best = probe;
+        }
+        // Sem io_uring a fila não muda nada: uma medida basta.
+        if (depths && !tc->result->async) break;
+    }
+    return 0;
+}
+
+int scan_tune_run(const char* device_path, const scan_options_t* opts, double probe_seconds,
+                  scan_callback_t callback, void* user_data, scan_tune_result_t* result) {
+    if (!device_path || !opts || !result) return 1;
+    memset(result, 0, sizeof(*result));
+    result->limits.rotational = -1;
+    if (!(probe_seconds > 0.0)) probe_seconds = SCAN_TUNE_PROBE_SECONDS;
+
+    int64_t device_size = pal_get_device_size(device_path);
+    if (device_size <= 0) return 1;
+    result->have_limits = pal_get_queue_limits(device_path, &result->limits) == PAL_STATUS_SUCCESS;
+    if (!result->have_limits) {
+        memset(&result->limits, 0, sizeof(result->limits));
+        result->limits.rotational = -1;
+    }
+    bool quick = opts->mode && strcmp(opts->mode, "quick") == 0;
+    result->tuned_block_size = !quick;
+    result->block_size = opts->block_size;
+    result->queue_depth = opts->queue_depth;
+
+    tune_ctx_t tc;
+    memset(&tc, 0, sizeof(tc));
+    tc.device_path = device_path;
+    tc.device_size = (uint64_t)device_size;
+    tc.by_iops = quick;
+    tc.callback = callback;
+    tc.user_data = user_data;
+    tc.result = result;
+
+    // O scan rápido lê blocos sorteados: mede-se em leituras aleatórias.
+    scan_options_for_measurement(&tc.run, opts);
+    if (quick) tc.run.order = SCAN_ORDER_RANDOM;
+    tc.run.time_budget_seconds = probe_seconds;
+
+    uint32_t depths[8];
+    unsigned depth_count = scan_tune_queue_depths(&result->limits, depths, 8);
+    const scan_tune_probe_t* best = NULL;
+
+    if (result->tuned_block_size) {
+        uint32_t sizes[8];
+        unsigned size_count = scan_tune_block_sizes(&result->limits, sizes, 8);
+        // O bloco é escolhido com a fila do meio da lista de candidatas.
+        result->queue_depth = depth_count > 1 ? depths[depth_count / 2] : depths[0];
+        if (tune_pick(&tc, sizes, NULL, size_count, &best) != 0) return 1;
+        result->block_size = best->block_size;
+    }
+    // Sem io_uring a fila fica como estava; o scan rápido ainda precisa de uma medida.
+    if (result->async || best == NULL) {
+        if (tune_pick(&tc, NULL, depths, depth_count, &best) != 0) return 1;
+    }
+    result->queue_depth = result->async ? best->queue_depth : opts->queue_depth;
+    result->chosen = (unsigned)(best - result->probes);
+    result->block_size = best->block_size;
+    result->mbps = best->mbps;
+    result->iops = best->iops;
+    return 0;
+}
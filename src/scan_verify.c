@@ -0,0 +1,150 @@
+#include "scan_verify.h"
+#include "surface_engine.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCAN_VERIFY_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 é escolhido em tempo de execução: o binário continua rodando em CPUs sem ele.
+#if defined(SCAN_VERIFY_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SCAN_VERIFY_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SCAN_VERIFY_TARGET_AVX2
+#else
+#define SCAN_VERIFY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(SCAN_VERIFY_SSE2)
+static unsigned verify_ctz(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Resto (ou tudo, sem SIMD): palavras de 64 bits, depois byte a byte dentro da diferente.
+static size_t diff_scalar_from(const uint8_t* a, const uint8_t* b, size_t i, size_t len) {
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        if (x != y) break;
+    }
+    for (; i < len; ++i) {
+        if (a[i] != b[i]) return i;
+    }
+    return len;
+}
+
+static size_t diff_scalar(const uint8_t* a, const uint8_t* b, size_t len) {
+    return diff_scalar_from(a, b, 0, len);
+}
+
+#if defined(SCAN_VERIFY_SSE2)
+static size_t diff_sse2(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t i = 0;
+    // Quatro vetores por volta; a posição exata só é procurada no bloco que diferiu.
+    for (; i + 64 <= len; i += 64) {
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 16)), _mm_loadu_si128((const __m128i*)(b + i + 16)));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 32)), _mm_loadu_si128((const __m128i*)(b + i + 32)));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i + 48)), _mm_loadu_si128((const __m128i*)(b + i + 48)));
+        __m128i all = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (_mm_movemask_epi8(all) != 0xFFFF) break;
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(eq) ^ 0xFFFFu;
+        if (mask) return i + verify_ctz(mask);
+    }
+    return diff_scalar_from(a, b, i, len);
+}
+#endif
+
+#if defined(SCAN_VERIFY_AVX2)
+SCAN_VERIFY_TARGET_AVX2
+static size_t diff_avx2(const uint8_t* a, const uint8_t* b, size_t len) {
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i + 32)), _mm256_loadu_si256((const __m256i*)(b + i + 32)));
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i + 64)), _mm256_loadu_si256((const __m256i*)(b + i + 64)));
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i + 96)), _mm256_loadu_si256((const __m256i*)(b + i + 96)));
+        __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+        if ((unsigned)_mm256_movemask_epi8(all) != 0xFFFFFFFFu) break;
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(eq) ^ 0xFFFFFFFFu;
+        if (mask) return i + verify_ctz(mask);
+    }
+    return i + diff_sse2(a + i, b + i, len - i);
+}
+#endif
+
+// AVX2 exige suporte da CPU e do SO (estado YMM salvo nas trocas de contexto).
+int scan_cpu_has_avx2(void) {
+#if !defined(SCAN_VERIFY_AVX2)
+    return 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return 0;    // OSXSAVE, AVX
+    if ((_xgetbv(0) & 0x6) != 0x6) return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Escolhida na primeira chamada. Os workers do scan paralelo podem chegar
+// aqui juntos: o nível é lido e gravado de forma atômica e todos chegam ao mesmo.
+enum { VERIFY_UNSET, VERIFY_SCALAR, VERIFY_SSE2, VERIFY_AVX2 };
+static uint64_t g_verify_level = VERIFY_UNSET;
+
+static uint64_t verify_level(void) {
+    uint64_t level = SCAN_ATOMIC_LOAD(&g_verify_level);
+    if (level != VERIFY_UNSET) return level;
+    level = VERIFY_SCALAR;
+#if defined(SCAN_VERIFY_SSE2)
+    level = VERIFY_SSE2;
+#endif
+#if defined(SCAN_VERIFY_AVX2)
+    if (scan_cpu_has_avx2()) level = VERIFY_AVX2;
+#endif
+    SCAN_ATOMIC_STORE(&g_verify_level, level);
+    return level;
+}
+
+size_t scan_verify_diff(const uint8_t* a, const uint8_t* b, size_t len) {
+    switch (verify_level()) {
+#if defined(SCAN_VERIFY_AVX2)
+        case VERIFY_AVX2: return diff_avx2(a, b, len);
+#endif
+#if defined(SCAN_VERIFY_SSE2)
+        case VERIFY_SSE2: return diff_sse2(a, b, len);
+#endif
+        default: return diff_scalar(a, b, len);
+    }
+}
+
+const char* scan_verify_isa(void) {
+    switch (verify_level()) {
+        case VERIFY_AVX2: return "avx2";
+        case VERIFY_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -1,11 +1,20 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // O_DIRECT
+#endif
 #include "surface.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 #include <time.h>
+#include <signal.h>
 #include "pal.h"
 #include <stdlib.h> // Para malloc/free
 #include "logging.h" // Para DEBUG_PRINT
+#include "surface_engine.h"
+#include "scan_verify.h"
+#ifdef DISKORACLE_PAL_SIM
+#include "pal_sim.h"
+#endif
 
 #ifdef _WIN32
 #include <windows.h>
@@ -16,310 +25,1059 @@ typedef SSIZE_T ssize_t;
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
 #endif
 
-#define BUFFER_SIZE 4096
 #define BUFFER_ALIGNMENT 4096
 
-static int surface_scan_quick(const char *device, SurfaceScanResult *result, scan_callback_t callback, void* user_data, scan_state_t* out_final_state) {
+// Pedido de parada (SIGINT/SIGTERM), válido para todos os scans do processo.
+// Só é zerado quando um scan começa sem nenhum outro em andamento, para que
+// um job novo do agendador não apague um Ctrl+C recebido pelos outros.
+static volatile sig_atomic_t g_scan_stop_requested = 0;
+static volatile long g_scans_running = 0;
+
+void surface_scan_request_stop(void) {
+    g_scan_stop_requested = 1;
+}
+
+bool scan_stop_requested(void) {
+    return g_scan_stop_requested != 0;
+}
+
+bool scan_ctx_stop(const scan_ctx_t* ctx) {
+    return scan_stop_requested() || (ctx->deadline_ns != 0 && scan_now_ns() >= ctx->deadline_ns);
+}
+
+uint64_t scan_now_ns(void) {
 #ifdef _WIN32
-    LARGE_INTEGER freq, start_time, end_time;
+    LARGE_INTEGER freq, counter;
     QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start_time);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
 #else
-    clock_t start_time = clock();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 #endif
-    result->scan_performed = true;
+}
 
-    HANDLE hFile = INVALID_HANDLE_VALUE;
-#ifndef _WIN32
-    int fd = -1;
-#endif
+const char* surface_scan_engine_name(scan_engine_t engine) {
+    switch (engine) {
+        case SCAN_ENGINE_AUTO: return "auto";
+        case SCAN_ENGINE_SYNC: return "sync";
+        case SCAN_ENGINE_URING: return "io_uring";
+        case SCAN_ENGINE_MEDIA_VERIFY: return "media-verify";
+        default: return "unknown";
+    }
+}
 
+void* scan_buffer_alloc(size_t size, size_t alignment) {
 #ifdef _WIN32
-    hFile = CreateFileA(device, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
-    if (hFile == INVALID_HANDLE_VALUE) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not open device (quick). Error: %lu", GetLastError());
-        return 1;
-    }
+    return _aligned_malloc(size, alignment);
 #else
-    fd = open(device, O_RDONLY);
-    if (fd < 0) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not open device (quick).");
-        return 1;
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size) != 0) {
+        return NULL;
     }
+    return ptr;
 #endif
+}
 
-    int64_t device_size = pal_get_device_size(device);
-    if (device_size <= 0) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not get device size (quick).");
+void scan_buffer_free(void* ptr) {
+    if (!ptr) return;
 #ifdef _WIN32
-        CloseHandle(hFile);
+    _aligned_free(ptr);
 #else
-        close(fd);
+    free(ptr);
 #endif
-        return 1;
-    }
+}
+
+void surface_scan_options_init(scan_options_t* opts) {
+    if (!opts) return;
+    memset(opts, 0, sizeof(*opts));
+    opts->mode = "quick";
+    opts->engine = SCAN_ENGINE_AUTO;
+    opts->block_size = SCAN_DEFAULT_BLOCK_SIZE;
+    opts->queue_depth = SCAN_DEFAULT_QUEUE_DEPTH;
+    opts->threads = 1;
+    opts->order = SCAN_ORDER_SEQUENTIAL;
+    opts->confidence = SCAN_SAMPLE_DEFAULT_CONFIDENCE;
+    opts->tolerance = SCAN_SAMPLE_DEFAULT_TOLERANCE;
+}
 
+void scan_options_for_measurement(scan_options_t* run, const scan_options_t* opts) {
+    *run = *opts;
+    run->mode = "deep";
+    run->range_offset = 0;
+    run->range_length = 0;
+    run->time_budget_seconds = 0.0;
+    run->verify = false;
+    run->mismatch_index = NULL;
+    run->classify = false;
+    run->content_map = NULL;
+    run->allocated_path = NULL;
+    run->map_files_path = NULL;
+    run->auto_tune = false;
+    run->controls = NULL;
+    run->on_bad_extent = NULL;
+    run->bad_extent_user_data = NULL;
+    run->bad_index = NULL;
+    run->latency_map = NULL;
+    run->journal_path = NULL;
+    run->resume = false;
+}
+
+// Abre o dispositivo para leitura. Com direct_io as leituras não passam pelo
+// page cache do SO (O_DIRECT no Linux, F_NOCACHE no macOS). No Windows o
+// FILE_FLAG_NO_BUFFERING é sempre usado. Com DISKORACLE_PAL_SIM o dispositivo
+// é simulado e toda a E/S passa pelo pal_sim.
+static scan_dev_t scan_dev_open(const char* device, bool direct_io) {
 #ifdef _WIN32
-    uint8_t *buf = (uint8_t *)_aligned_malloc(BUFFER_SIZE, BUFFER_ALIGNMENT);
+    (void)direct_io;
+    return CreateFileA(device, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
+#elif defined(DISKORACLE_PAL_SIM)
+    return pal_sim_open(device, direct_io);
+#elif defined(O_DIRECT)
+    return open(device, direct_io ? (O_RDONLY | O_DIRECT) : O_RDONLY);
 #else
-    uint8_t *buf = (uint8_t *)malloc(BUFFER_SIZE);
+    int fd = open(device, O_RDONLY);
+#if defined(F_NOCACHE)
+    if (fd >= 0 && direct_io) fcntl(fd, F_NOCACHE, 1);
+#endif
+    return fd;
 #endif
+}
 
-    if (buf == NULL) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Memory allocation failed (quick).");
+static void scan_dev_close(scan_dev_t dev) {
 #ifdef _WIN32
-        CloseHandle(hFile);
+    CloseHandle(dev);
+#elif defined(DISKORACLE_PAL_SIM)
+    pal_sim_close(dev);
 #else
-        close(fd);
+    close(dev);
 #endif
-        return 1;
+}
+
+// Leitura posicional: não depende (nem altera) o ponteiro do arquivo.
+static int64_t scan_dev_read(scan_dev_t dev, void* buf, uint32_t len, uint64_t offset) {
+#ifdef _WIN32
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD)(offset & 0xFFFFFFFFULL);
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD win_bytes_read = 0;
+    if (!ReadFile(dev, buf, len, &win_bytes_read, &ov)) {
+        return -1;
     }
+    return (int64_t)win_bytes_read;
+#elif defined(DISKORACLE_PAL_SIM)
+    return pal_sim_read(dev, buf, len, offset);
+#else
+    return (int64_t)pread(dev, buf, len, (off_t)offset);
+#endif
+}
 
-    const int64_t total_blocks_to_check = 2048;
-    const int64_t jump_increment_blocks = (device_size / BUFFER_SIZE) / total_blocks_to_check > 0 ? (device_size / BUFFER_SIZE) / total_blocks_to_check : 1;
-    int64_t offset = 0;
+int64_t scan_ctx_pread(scan_dev_t dev, void* buf, uint32_t len, uint64_t offset) {
+    return scan_dev_read(dev, buf, len, offset);
+}
 
-    scan_state_t state;
-    memset(&state, 0, sizeof(state));
-    state.total_blocks = total_blocks_to_check;
-    state.start_time = time(NULL);
+// Sem O_DIRECT (p.ex. imagens num tmpfs) a releitura só sai do disco depois de
+// descartar as páginas do trecho.
+scan_dev_t scan_ctx_open_uncached(const scan_ctx_t* ctx, bool* drop_cache) {
+    *drop_cache = false;
+    scan_dev_t dev = scan_dev_open(ctx->device_path, true);
+#ifndef _WIN32
+    if (dev == SCAN_DEV_INVALID && errno == EINVAL) {
+        dev = scan_dev_open(ctx->device_path, false);
+        *drop_cache = dev != SCAN_DEV_INVALID;
+    }
+#endif
+    return dev;
+}
 
-#ifdef _WIN32
-    LARGE_INTEGER last_update_time, current_time;
-    QueryPerformanceCounter(&last_update_time);
+void scan_ctx_drop_cache(scan_dev_t dev, uint64_t offset, uint32_t len) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(dev, (off_t)offset, (off_t)len, POSIX_FADV_DONTNEED);
 #else
-    struct timespec last_update_time, current_time;
-    clock_gettime(CLOCK_MONOTONIC, &last_update_time);
+    (void)dev;
+    (void)offset;
+    (void)len;
 #endif
-    const double update_interval_ms = 50.0;
-    int64_t bytes_since_last_update = 0;
+}
 
-    for (int64_t i = 0; i < total_blocks_to_check && offset < device_size; ++i) {
-        ssize_t bytes_read = -1;
-#ifdef _WIN32
-            LARGE_INTEGER li_offset;
-            li_offset.QuadPart = offset;
-            DWORD win_bytes_read = 0;
-        if (SetFilePointerEx(hFile, li_offset, NULL, FILE_BEGIN) && ReadFile(hFile, buf, BUFFER_SIZE, &win_bytes_read, NULL)) {
-            bytes_read = win_bytes_read;
-        } else {
-            result->read_errors++;
+// Insere [lba, lba + count) num índice compartilhado e devolve quantos setores
+// são novos. Sem memória o índice fica incompleto (avisado uma vez) e os
+// setores que não entraram contam como novos: melhor sobrar que faltar.
+static uint64_t scan_ctx_index_add(scan_ctx_t* ctx, bad_extent_index_t* index, const char* what, uint64_t lba, uint64_t count) {
+    uint64_t added = count;
+    if (ctx->bad_lock) scan_mutex_lock(ctx->bad_lock);
+    bool warned = bad_extent_index_incomplete(index);
+    if (bad_extent_index_add(index, lba, count, &added) != 0) {
+        added = count;
+        if (!warned) {
+            fprintf(stderr, "Warning: Out of memory for the %s index at LBA %llu; it will not list every sector found.\n", what, (unsigned long long)lba);
         }
-#else
-        bytes_read = pread(fd, buf, BUFFER_SIZE, offset);
-        if (bytes_read < 0) result->read_errors++;
-#endif
-        result->total_sectors_scanned++;
-
-        if (bytes_read > 0 && bytes_read < BUFFER_SIZE) {
-            result->bad_sectors_found++;
-        } else if (bytes_read < 0) {
-                result->bad_sectors_found++;
-             }
-        
-        state.scanned_blocks = i + 1;
-        if (bytes_read < 0) {
-            state.bad_blocks++;
+    }
+    if (ctx->bad_lock) scan_mutex_unlock(ctx->bad_lock);
+    return added;
+}
+
+// Registra uma sequência de setores ruins no índice. A contagem de extensões
+// ao vivo é aproximada; a final vem do índice em scan_ctx_finish_bad_extents().
+void scan_ctx_mark_bad(scan_ctx_t* ctx, uint64_t lba, uint64_t count) {
+    // Setores já marcados (p.ex. relidos depois de um --resume) não contam de novo.
+    uint64_t added = ctx->bad_index ? scan_ctx_index_add(ctx, ctx->bad_index, "bad sector", lba, count) : count;
+    ctx->result->bad_sectors_found += added;
+    ctx->state.bad_sectors += added;
+
+    if (ctx->state.bad_extents == 0 || lba != ctx->last_bad_end) {
+        ctx->state.bad_extents++;
+    }
+    ctx->last_bad_end = lba + count;
+}
+
+// Bisseção de uma faixa com erro: relê cada metade com leituras síncronas até
+// chegar ao setor lógico. Custa O(k log n) leituras para k setores ruins.
+static void scan_ctx_localize(scan_ctx_t* ctx, uint64_t offset, uint32_t len, bool known_bad) {
+    uint32_t sector = ctx->logical_sector_size;
+
+    if (len <= sector) {
+        int attempts = known_bad ? SCAN_SECTOR_RETRIES : SCAN_SECTOR_RETRIES + 1;
+        for (int i = 0; i < attempts; ++i) {
+            if (scan_dev_read(ctx->dev, ctx->retry_buf, len, offset) == (int64_t)len) {
+                return;
+            }
         }
-        
-        offset += jump_increment_blocks * BUFFER_SIZE;
-        if (offset >= device_size) offset = device_size - BUFFER_SIZE;
+        scan_ctx_mark_bad(ctx, offset / sector, 1);
+        return;
+    }
 
-        bool should_update = false;
-#ifdef _WIN32
-        QueryPerformanceCounter(&current_time);
-        double elapsed_ms = (double)(current_time.QuadPart - last_update_time.QuadPart) * 1000.0 / freq.QuadPart;
-        if (elapsed_ms >= update_interval_ms || i == total_blocks_to_check - 1) {
-            should_update = true;
-            last_update_time = current_time;
+    if (!known_bad && scan_dev_read(ctx->dev, ctx->retry_buf, len, offset) == (int64_t)len) {
+        return;
+    }
+
+    uint32_t half = (len / sector / 2) * sector;
+    if (half == 0) half = sector;
+    scan_ctx_localize(ctx, offset, half, false);
+    scan_ctx_localize(ctx, offset + half, len - half, false);
+}
+
+// Contadores, latência e throttle de uma leitura, sem localizar os setores ruins.
+static void scan_ctx_account(scan_ctx_t* ctx, uint64_t offset, uint32_t requested, int64_t bytes_read, uint64_t latency_ns) {
+    SurfaceScanResult* result = ctx->result;
+
+    result->total_sectors_scanned++;
+    ctx->state.scanned_blocks++;
+    bool complete = bytes_read == (int64_t)requested;
+    scan_latency_record(&ctx->state.latency, latency_ns, complete);
+    scan_throttle_observe(ctx->throttle, requested, latency_ns);
+    if (ctx->latency_map) {
+        uint64_t bucket = offset / latency_map_bucket_bytes(ctx->latency_map);
+        if (bucket != ctx->map_pending_bucket) {
+            scan_ctx_flush_latency_map(ctx);
+            ctx->map_pending_bucket = bucket;
         }
-#else
-        clock_gettime(CLOCK_MONOTONIC, &current_time);
-        double elapsed_ms = (current_time.tv_sec - last_update_time.tv_sec) * 1000.0 + (current_time.tv_nsec - last_update_time.tv_nsec) / 1000000.0;
-        if (elapsed_ms >= update_interval_ms || i == total_blocks_to_check - 1) {
-            should_update = true;
-            last_update_time = current_time;
+        latency_cell_sample(&ctx->map_pending, latency_ns / 1000, complete);
+    }
+
+    if (bytes_read < 0) {
+        result->read_errors++;
+        ctx->state.read_errors++;
+    }
+    if (bytes_read < (int64_t)requested) {
+        ctx->state.bad_blocks++;
+    }
+    if (bytes_read > 0) {
+        ctx->bytes_since_update += (uint64_t)bytes_read;
+        ctx->bytes_total += (uint64_t)bytes_read;
+    }
+}
+
+void scan_ctx_record_read(scan_ctx_t* ctx, uint64_t offset, uint32_t requested, int64_t bytes_read, uint64_t latency_ns) {
+    scan_ctx_account(ctx, offset, requested, bytes_read, latency_ns);
+    if (bytes_read < (int64_t)requested) {
+        if (ctx->retry_buf == NULL) {
+            ctx->retry_buf = (uint8_t*)scan_buffer_alloc(ctx->block_size, ctx->alignment);
         }
-#endif
-        
-        if (bytes_read > 0) {
-            bytes_since_last_update += bytes_read;
+        // Numa leitura curta os setores devolvidos estão bons; o resto é localizado.
+        uint64_t good = bytes_read > 0 ? ((uint64_t)bytes_read / ctx->logical_sector_size) * ctx->logical_sector_size : 0;
+        if (ctx->retry_buf != NULL) {
+            scan_ctx_localize(ctx, offset + good, (uint32_t)(requested - good), true);
+        } else {
+            uint64_t first = (offset + good) / ctx->logical_sector_size;
+            uint64_t last = (offset + requested + ctx->logical_sector_size - 1) / ctx->logical_sector_size;
+            scan_ctx_mark_bad(ctx, first, last - first);
+        }
+    }
+}
+
+void scan_ctx_record_verified(scan_ctx_t* ctx, uint64_t offset, uint32_t len, bool failed, uint64_t latency_ns) {
+    scan_ctx_account(ctx, offset, len, failed ? -1 : (int64_t)len, latency_ns);
+}
+
+// Mesma contabilidade de scan_ctx_mark_bad(), no índice de setores inconsistentes.
+static void scan_ctx_mark_mismatch(scan_ctx_t* ctx, uint64_t lba, uint64_t count) {
+    uint64_t added = ctx->mismatch_index ? scan_ctx_index_add(ctx, ctx->mismatch_index, "mismatch", lba, count) : count;
+    ctx->state.mismatch_sectors += added;
+    if (ctx->state.mismatch_extents == 0 || lba != ctx->last_mismatch_end) {
+        ctx->state.mismatch_extents++;
+    }
+    ctx->last_mismatch_end = lba + count;
+}
+
+void scan_ctx_record_mismatch(scan_ctx_t* ctx, uint64_t offset, const uint8_t* first, const uint8_t* second, uint32_t len) {
+    size_t pos = scan_verify_diff(first, second, len);
+    if (pos >= len) return;
+    ctx->state.mismatch_blocks++;
+
+    // Cada diferença marca o seu setor; a busca recomeça no setor seguinte.
+    uint32_t sector = ctx->logical_sector_size;
+    uint64_t run_lba = 0, run_count = 0;
+    while (pos < len) {
+        size_t sector_start = pos / sector * sector;
+        uint64_t lba = (offset + sector_start) / sector;
+        if (run_count > 0 && lba == run_lba + run_count) {
+            run_count++;
+        } else {
+            if (run_count > 0) scan_ctx_mark_mismatch(ctx, run_lba, run_count);
+            run_lba = lba;
+            run_count = 1;
         }
+        size_t next = sector_start + sector;
+        if (next >= len) break;
+        pos = next + scan_verify_diff(first + next, second + next, len - next);
+    }
+    scan_ctx_mark_mismatch(ctx, run_lba, run_count);
+}
+
+void scan_ctx_classify(scan_ctx_t* ctx, uint64_t offset, const uint8_t* buf, uint32_t len) {
+    if (!ctx->content_map) return;
+    scan_ctx_add_content(ctx, offset, len, scan_content_classify(buf, len));
+}
+
+void scan_ctx_add_content(scan_ctx_t* ctx, uint64_t offset, uint32_t len, scan_content_class_t content) {
+    if (!ctx->content_map) return;
+    unsigned region = scan_content_region_of(ctx->content_map, offset);
+    SCAN_ATOMIC_ADD(&ctx->content_map->bytes[region][content], (uint64_t)len);
+}
+
+void scan_ctx_flush_latency_map(scan_ctx_t* ctx) {
+    if (!ctx->latency_map) return;
+    latency_map_add(ctx->latency_map, ctx->map_pending_bucket * latency_map_bucket_bytes(ctx->latency_map), &ctx->map_pending);
+    latency_cell_clear(&ctx->map_pending);
+}
+
+void scan_ctx_finish_bad_extents(scan_ctx_t* ctx) {
+    ctx->state.index_incomplete = bad_extent_index_incomplete(ctx->bad_index) || bad_extent_index_incomplete(ctx->mismatch_index);
+    if (ctx->mismatch_index) {
+        ctx->state.mismatch_extents = bad_extent_index_extents(ctx->mismatch_index);
+    }
+    if (!ctx->bad_index) return;
+    // Conclusões fora de ordem (io_uring) e fronteiras entre workers partem
+    // extensões na contagem ao vivo; o índice já as tem emendadas.
+    ctx->state.bad_extents = bad_extent_index_extents(ctx->bad_index);
+    ctx->result->bad_extents = ctx->state.bad_extents;
+}
+
+void scan_ctx_release(scan_ctx_t* ctx) {
+    scan_buffer_free(ctx->retry_buf);
+    ctx->retry_buf = NULL;
+    if (ctx->owns_bad_index) {
+        bad_extent_index_destroy(ctx->bad_index);
+    }
+    ctx->bad_index = NULL;
+    ctx->owns_bad_index = false;
+    if (ctx->owns_mismatch_index) {
+        bad_extent_index_destroy(ctx->mismatch_index);
+    }
+    ctx->mismatch_index = NULL;
+    ctx->owns_mismatch_index = false;
+    if (ctx->owns_extents) {
+        scan_extent_list_free(ctx->extents);
+        free(ctx->extents);
+    }
+    ctx->extents = NULL;
+    ctx->owns_extents = false;
+}
+
+void scan_ctx_update_progress(scan_ctx_t* ctx, bool force) {
+    const uint64_t update_interval_ns = 50ULL * 1000000ULL;
+    uint64_t now = scan_now_ns();
+    uint64_t elapsed_ns = now - ctx->last_update_ns;
 
-        if (callback && should_update) {
-            double elapsed_sec = elapsed_ms / 1000.0;
-            if (elapsed_sec > 0) {
-                state.current_speed_mbps = (bytes_since_last_update / (1024.0 * 1024.0)) / elapsed_sec;
-                bytes_since_last_update = 0; // Zera para o próximo intervalo
+    if (!force && elapsed_ns < update_interval_ns) {
+        return;
+    }
+
+    if (ctx->publish) {
+        // Worker paralelo: só publica os contadores; quem agrega é o coordenador.
+        uint64_t sequence = ctx->publish->sequence;
+        SCAN_ATOMIC_STORE(&ctx->publish->sequence, sequence + 1);
+        SCAN_ATOMIC_FENCE_RELEASE();
+        SCAN_ATOMIC_STORE(&ctx->publish->scanned_blocks, ctx->state.scanned_blocks);
+        SCAN_ATOMIC_STORE(&ctx->publish->bad_blocks, ctx->state.bad_blocks);
+        SCAN_ATOMIC_STORE(&ctx->publish->read_errors, ctx->state.read_errors);
+        SCAN_ATOMIC_STORE(&ctx->publish->bytes_read, ctx->bytes_total);
+        SCAN_ATOMIC_STORE(&ctx->publish->bad_sectors, ctx->state.bad_sectors);
+        SCAN_ATOMIC_STORE(&ctx->publish->bad_extents, ctx->state.bad_extents);
+        SCAN_ATOMIC_STORE(&ctx->publish->mismatch_blocks, ctx->state.mismatch_blocks);
+        SCAN_ATOMIC_STORE(&ctx->publish->mismatch_sectors, ctx->state.mismatch_sectors);
+        scan_latency_publish(&ctx->publish->latency, &ctx->state.latency);
+        SCAN_ATOMIC_STORE(&ctx->publish->cursor, ctx->cursor);
+        // Os setores ruins antes do cursor já estão no índice quando a sequência fecha.
+        SCAN_ATOMIC_STORE_RELEASE(&ctx->publish->sequence, sequence + 2);
+        ctx->last_update_ns = now;
+        return;
+    }
+
+    if (elapsed_ns > 0) {
+        ctx->state.current_speed_mbps = (ctx->bytes_since_update / (1024.0 * 1024.0)) / (elapsed_ns / 1e9);
+    }
+    scan_throttle_report(ctx->throttle, &ctx->state);
+    ctx->bytes_since_update = 0;
+    ctx->last_update_ns = now;
+    ctx->state.last_update_time = time(NULL);
+
+    if (ctx->callback) {
+        ctx->callback(&ctx->state, ctx->user_data);
+    }
+    scan_ctx_checkpoint(ctx, false);
+}
+
+// Leituras que cobrem [start, end); com a lista de faixas alocadas, só as faixas.
+static uint64_t scan_ctx_blocks_between(const scan_ctx_t* ctx, uint64_t start, uint64_t end) {
+    if (end <= start) return 0;
+    if (ctx->extents) return scan_extent_list_blocks_in(ctx->extents, start, end, ctx->block_size);
+    return (end - start + ctx->block_size - 1) / ctx->block_size;
+}
+
+void scan_ctx_checkpoint(scan_ctx_t* ctx, bool force) {
+    if (!ctx->journal || !ctx->opts->journal_path) return;
+
+    uint64_t now = scan_now_ns();
+    if (!force && now - ctx->last_checkpoint_ns < (uint64_t)SCAN_JOURNAL_INTERVAL_SECONDS * 1000000000ULL) {
+        return;
+    }
+    ctx->last_checkpoint_ns = now;
+
+    // Com uma única faixa o cursor é o do próprio contexto; no scan paralelo
+    // o coordenador já copiou os cursores publicados pelos workers.
+    scan_journal_t* journal = ctx->journal;
+    if (ctx->segment_count == 1) {
+        ctx->segments[0].cursor = ctx->cursor;
+    }
+    journal->segment_count = ctx->segment_count;
+    memcpy(journal->segments, ctx->segments, ctx->segment_count * sizeof(scan_segment_t));
+    journal->scanned_blocks = 0;
+    for (unsigned i = 0; i < ctx->segment_count; ++i) {
+        journal->scanned_blocks += scan_ctx_blocks_between(ctx, ctx->segments[i].start, ctx->segments[i].cursor);
+    }
+    // Os contadores só têm leituras antes dos cursores: o io_uring só contabiliza
+    // o que o cursor já passou e os workers publicam contadores e cursor juntos.
+    journal->bad_blocks = ctx->state.bad_blocks;
+    journal->read_errors = ctx->state.read_errors;
+    journal->mismatch_blocks = ctx->state.mismatch_blocks;
+    journal->latency = ctx->state.latency;
+    if (journal->classify) {
+        // Os workers somam no mapa sem lock.
+        for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+            for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+                journal->content.bytes[r][c] = SCAN_ATOMIC_LOAD(&ctx->content_map->bytes[r][c]);
             }
-            callback(&state, user_data);
         }
     }
+    journal->elapsed_seconds = difftime(time(NULL), ctx->state.start_time);
 
-    // A mensagem de status final é preparada, mas não impressa aqui
-    snprintf(result->status_message, sizeof(result->status_message), "Quick scan completed.");
+    scan_ctx_flush_latency_map(ctx);
+    if (ctx->bad_lock) scan_mutex_lock(ctx->bad_lock);
+    int rc = scan_journal_save(ctx->opts->journal_path, journal, ctx->bad_index, ctx->mismatch_index, ctx->latency_map);
+    if (ctx->bad_lock) scan_mutex_unlock(ctx->bad_lock);
+    ctx->checkpoint_saved = rc == 0;
+    if (rc != 0 && !ctx->checkpoint_warned) {
+        // Uma vez só: com o disco cheio a falha se repetiria a cada intervalo.
+        fprintf(stderr, "Warning: Could not write the scan checkpoint to %s; this scan cannot be resumed from there.\n", ctx->opts->journal_path);
+        ctx->checkpoint_warned = true;
+    }
+}
 
-    if (callback) {
-        state.current_speed_mbps = 0; // Final update with final numbers
-        callback(&state, user_data);
+// Engine síncrono: uma leitura de block_size por vez.
+static int surface_sync_scan(scan_ctx_t* ctx) {
+    uint8_t *buf = (uint8_t *)scan_buffer_alloc(ctx->block_size, ctx->alignment);
+    if (buf == NULL) {
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Memory allocation failed (sync).");
+        return 1;
     }
-    
-    // Copia o estado final para o ponteiro de saída, se fornecido
-    if (out_final_state) {
-        memcpy(out_final_state, &state, sizeof(scan_state_t));
+
+    uint64_t position = scan_ctx_next_offset(ctx, ctx->range_start);
+    ctx->cursor = position;
+    while (position < ctx->range_end && !scan_ctx_stop(ctx)) {
+        uint64_t offset = scan_ctx_read_offset(ctx, position);
+        uint32_t len = scan_ctx_read_len(ctx, offset);
+        scan_throttle_acquire(ctx, len);
+        if (scan_ctx_stop(ctx)) break;
+        uint64_t started_ns = scan_now_ns();
+        int64_t bytes_read = scan_dev_read(ctx->dev, buf, len, offset);
+        scan_ctx_record_read(ctx, offset, len, bytes_read, scan_now_ns() - started_ns);
+        if (bytes_read == (int64_t)len) scan_ctx_classify(ctx, offset, buf, len);
+        // Os buracos entre faixas alocadas contam como lidos.
+        position = scan_ctx_advance(ctx, position, len);
+        ctx->cursor = position;
+        scan_ctx_update_progress(ctx, false);
     }
 
-#ifdef _WIN32
-    if (buf) _aligned_free(buf);
-    CloseHandle(hFile);
-#else
-    if (buf) free(buf);
-    close(fd);
-#endif
+    scan_buffer_free(buf);
+    return 0;
+}
 
-#ifdef _WIN32
-    QueryPerformanceCounter(&end_time);
-    result->scan_time_seconds = (double)(end_time.QuadPart - start_time.QuadPart) / freq.QuadPart;
+int scan_ctx_run_engine(scan_ctx_t* ctx) {
+    int rc = -1;
+    scan_engine_t used = SCAN_ENGINE_SYNC;
+    // A prioridade de I/O é por thread: cada worker entra e sai da classe idle.
+    int previous_priority = ctx->idle_io ? scan_io_idle_begin() : -1;
+    if (ctx->opts->verify) {
+        // A verificação tem o seu próprio pipeline de leituras síncronas.
+        rc = surface_verify_scan(ctx);
+    }
+    else if (ctx->opts->engine == SCAN_ENGINE_MEDIA_VERIFY) {
+        rc = surface_media_scan(ctx);
+        if (rc >= 0) used = SCAN_ENGINE_MEDIA_VERIFY;
+        else if (ctx->publish == NULL) {
+            fprintf(stderr, "Warning: %s does not accept verify commands, falling back to reads.\n", ctx->device_path);
+        }
+    }
+#if defined(__linux__) && !defined(DISKORACLE_PAL_SIM)
+    else if (ctx->opts->engine == SCAN_ENGINE_URING || ctx->opts->engine == SCAN_ENGINE_AUTO) {
+        rc = surface_uring_scan(ctx);
+        if (rc >= 0) used = SCAN_ENGINE_URING;
+        else if (ctx->opts->engine == SCAN_ENGINE_URING && ctx->publish == NULL) {
+            fprintf(stderr, "Warning: io_uring is not available, falling back to synchronous reads.\n");
+        }
+    }
+#elif defined(DISKORACLE_PAL_SIM)
+    // O io_uring leria a imagem direto, sem a latência e as falhas simuladas.
+    else if (ctx->opts->engine == SCAN_ENGINE_URING && ctx->publish == NULL) {
+        fprintf(stderr, "Warning: io_uring is not used with simulated devices, falling back to synchronous reads.\n");
+    }
 #else
-    result->scan_time_seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    else if (ctx->opts->engine == SCAN_ENGINE_URING && ctx->publish == NULL) {
+        fprintf(stderr, "Warning: io_uring is only available on Linux, falling back to synchronous reads.\n");
+    }
 #endif
-    return 0;
+    if (rc < 0) {
+        rc = surface_sync_scan(ctx);
+    }
+    ctx->state.engine = used;
+    scan_ctx_flush_latency_map(ctx);
+    scan_buffer_free(ctx->retry_buf);
+    ctx->retry_buf = NULL;
+    scan_io_idle_end(previous_priority);
+    return rc;
 }
 
+scan_dev_t scan_ctx_reopen(const scan_ctx_t* ctx, const char* device) {
+    return scan_dev_open(device, ctx->direct_io);
+}
 
-static int surface_scan_deep(const char *device, SurfaceScanResult *result) {
-#ifdef _WIN32
-    LARGE_INTEGER freq, start_time, end_time;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start_time);
-#else
-    clock_t start_time = clock();
-#endif
-    result->scan_performed = true;
+void scan_ctx_close(scan_dev_t dev) {
+    scan_dev_close(dev);
+}
 
-    HANDLE hFile = INVALID_HANDLE_VALUE;
-#ifndef _WIN32
-    int fd = -1;
-#endif
+unsigned surface_scan_auto_threads(const char* device_path) {
+    int queues = 0;
+    if (pal_get_queue_count(device_path, &queues) != PAL_STATUS_SUCCESS || queues < 1) {
+        return 1;
+    }
+    unsigned threads = (unsigned)queues;
+    if (threads > SCAN_MAX_THREADS) threads = SCAN_MAX_THREADS;
+    return threads;
+}
 
-#ifdef _WIN32
-    hFile = CreateFileA(device, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
-    if (hFile == INVALID_HANDLE_VALUE) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not open device (deep). Error: %lu", GetLastError());
+static void scan_visit_bad_extent(const bad_extent_t* extent, void* user_data) {
+    const scan_ctx_t* ctx = (const scan_ctx_t*)user_data;
+    ctx->opts->on_bad_extent(extent, ctx->logical_sector_size, ctx->opts->bad_extent_user_data);
+}
+
+// Divide [start, end) em faixas contíguas alinhadas ao bloco; a última absorve o resto.
+static void scan_split_segments(uint64_t start, uint64_t end, uint32_t block_size, unsigned count, scan_segment_t* segments) {
+    uint64_t total_blocks = (end - start + block_size - 1) / block_size;
+    uint64_t blocks_per_segment = total_blocks / count;
+    uint64_t next_start = start;
+    for (unsigned i = 0; i < count; ++i) {
+        segments[i].start = next_start;
+        segments[i].end = (i == count - 1) ? end : next_start + blocks_per_segment * block_size;
+        segments[i].cursor = segments[i].start;
+        next_start = segments[i].end;
+    }
+}
+
+// Carrega o checkpoint e confere se ele pertence a este dispositivo.
+static int scan_resume_load(const char *device, const scan_options_t *opts, scan_journal_t *journal, bad_extent_index_t **index,
+                            bad_extent_index_t **mismatches, latency_map_t **map, SurfaceScanResult *result) {
+    if (!opts->journal_path || scan_journal_load(opts->journal_path, journal, index, mismatches, map) != 0) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: No valid scan checkpoint to resume from (%s).",
+                 opts->journal_path ? opts->journal_path : "no journal");
         return 1;
     }
-#else
-    fd = open(device, O_RDONLY);
-    if (fd < 0) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not open device (deep).");
+    // O caminho pode mudar entre boots (sdb -> sdc); o número de série não.
+    bool same_device;
+    if (journal->serial[0] != '\0' && opts->device_serial && opts->device_serial[0] != '\0') {
+        same_device = strcmp(journal->serial, opts->device_serial) == 0;
+    } else {
+        same_device = strcmp(journal->device_path, device) == 0;
+    }
+    if (!same_device) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: The checkpoint belongs to another device (%.120s, serial '%.63s').",
+                 journal->device_path, journal->serial);
+        bad_extent_index_destroy(*index);
+        bad_extent_index_destroy(*mismatches);
+        latency_map_destroy(*map);
+        *index = NULL;
+        *mismatches = NULL;
+        *map = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+// Scan rápido e profundo passam pelo mesmo núcleo: o rápido é só a ordem de
+// leitura SCAN_ORDER_SAMPLED, sem journal e sem a lista de faixas alocadas.
+static int surface_scan_run(const char *device, const scan_options_t *opts, bool quick, SurfaceScanResult *result, scan_callback_t callback, void* user_data, scan_state_t* out_final_state) {
+    uint64_t start_ns = scan_now_ns();
+    const char* kind = quick ? "quick" : "deep";
+    result->scan_performed = true;
+
+    // Num resume a configuração gravada no journal prevalece sobre a atual.
+    scan_options_t run_opts = *opts;
+    if (quick) {
+        run_opts.journal_path = NULL;
+        run_opts.resume = false;
+        run_opts.allocated_path = NULL;
+    }
+    scan_journal_t journal;
+    memset(&journal, 0, sizeof(journal));
+    bad_extent_index_t* resumed_index = NULL;
+    bad_extent_index_t* resumed_mismatches = NULL;
+    latency_map_t* resumed_map = NULL;
+    bool resuming = run_opts.resume;
+    if (resuming) {
+        if (scan_resume_load(device, opts, &journal, &resumed_index, &resumed_mismatches, &resumed_map, result) != 0) {
+            return 1;
+        }
+        run_opts.block_size = journal.block_size;
+        run_opts.queue_depth = journal.queue_depth;
+        run_opts.engine = (scan_engine_t)journal.engine;
+        run_opts.direct_io = journal.direct_io;
+        run_opts.order = (scan_order_kind_t)journal.order;
+        run_opts.stride = journal.stride;
+        run_opts.sample_seed = journal.order_seed;
+        // Os modos também: as faixas do journal só valem com a mesma lista de
+        // faixas alocadas, e a verificação continua comparando as leituras.
+        run_opts.verify = journal.verify;
+        run_opts.classify = journal.classify;
+        run_opts.allocated_path = journal.allocated_path[0] ? journal.allocated_path : NULL;
+    }
+    opts = &run_opts;
+
+    scan_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.opts = opts;
+    ctx.device_path = device;
+    ctx.result = result;
+    ctx.callback = callback;
+    ctx.user_data = user_data;
+    ctx.direct_io = opts->direct_io;
+
+    if (opts->block_size < 512 || opts->block_size % 512 != 0 || opts->block_size > SCAN_MAX_BLOCK_SIZE) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: Block size must be a multiple of 512 bytes, up to %u MiB (%s).", SCAN_MAX_BLOCK_SIZE / (1024 * 1024), kind);
+        bad_extent_index_destroy(resumed_index);
+        bad_extent_index_destroy(resumed_mismatches);
+        latency_map_destroy(resumed_map);
         return 1;
     }
+
+    // Leituras sem cache exigem offset, tamanho e endereço alinhados ao setor lógico.
+    uint32_t logical_size = 512, physical_size = 512;
+    if (pal_get_sector_sizes(device, &logical_size, &physical_size) != PAL_STATUS_SUCCESS || logical_size == 0) {
+        logical_size = 512;
+        physical_size = 512;
+    }
+    ctx.logical_sector_size = logical_size;
+    ctx.block_size = (opts->block_size + logical_size - 1) / logical_size * logical_size;
+    ctx.alignment = physical_size > BUFFER_ALIGNMENT ? physical_size : BUFFER_ALIGNMENT;
+    if (ctx.alignment < logical_size) ctx.alignment = logical_size;
+
+    ctx.dev = scan_dev_open(device, ctx.direct_io);
+#ifndef _WIN32
+    if (ctx.dev == SCAN_DEV_INVALID && ctx.direct_io && errno == EINVAL) {
+        fprintf(stderr, "Warning: %s does not support O_DIRECT, falling back to buffered reads.\n", device);
+        ctx.direct_io = false;
+        ctx.dev = scan_dev_open(device, false);
+    }
 #endif
+    if (ctx.dev == SCAN_DEV_INVALID) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not open device (%s).", kind);
+        bad_extent_index_destroy(resumed_index);
+        bad_extent_index_destroy(resumed_mismatches);
+        latency_map_destroy(resumed_map);
+        return 1;
+    }
 
     int64_t device_size = pal_get_device_size(device);
     if (device_size <= 0) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not get device size (deep).");
-#ifdef _WIN32
-        CloseHandle(hFile);
-#else
-        close(fd);
-#endif
+        snprintf(result->status_message, sizeof(result->status_message), "Error: Could not get device size (%s).", kind);
+        scan_dev_close(ctx.dev);
+        bad_extent_index_destroy(resumed_index);
+        bad_extent_index_destroy(resumed_mismatches);
+        latency_map_destroy(resumed_map);
+        return 1;
+    }
+    ctx.device_size = (uint64_t)device_size;
+    if (resuming && (journal.device_size != ctx.device_size || journal.sector_size != logical_size)) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: Device geometry changed since the checkpoint was written.");
+        scan_dev_close(ctx.dev);
+        bad_extent_index_destroy(resumed_index);
+        bad_extent_index_destroy(resumed_mismatches);
+        latency_map_destroy(resumed_map);
         return 1;
     }
 
-#ifdef _WIN32
-    uint8_t *buf = (uint8_t *)_aligned_malloc(BUFFER_SIZE, BUFFER_ALIGNMENT);
-#else
-    uint8_t *buf = (uint8_t *)malloc(BUFFER_SIZE);
-#endif
+    // O índice de setores ruins pode vir do chamador; senão é temporário.
+    if (opts->bad_index) {
+        ctx.bad_index = opts->bad_index;
+        if (bad_extent_index_sector_size(ctx.bad_index) == 0) {
+            bad_extent_index_set_sector_size(ctx.bad_index, logical_size);
+        }
+    } else {
+        ctx.bad_index = bad_extent_index_create(logical_size);
+        ctx.owns_bad_index = true;
+    }
+    if (resumed_index) {
+        if (ctx.bad_index) bad_extent_index_merge(ctx.bad_index, resumed_index);
+        bad_extent_index_destroy(resumed_index);
+        resumed_index = NULL;
+    }
 
-    if (buf == NULL) {
-        snprintf(result->status_message, sizeof(result->status_message), "Error: Memory allocation failed (deep).");
-#ifdef _WIN32
-        CloseHandle(hFile);
-#else
-        close(fd);
-#endif
+    // O mapa de latência também é do chamador; num resume recebe o do journal.
+    if (opts->latency_map && latency_map_set_geometry(opts->latency_map, ctx.device_size, logical_size) == 0) {
+        ctx.latency_map = opts->latency_map;
+        latency_cell_clear(&ctx.map_pending);
+        if (resumed_map) latency_map_merge(ctx.latency_map, resumed_map);
+    }
+    latency_map_destroy(resumed_map);
+    resumed_map = NULL;
+
+    // Setores inconsistentes da verificação: índice do chamador ou temporário.
+    if (opts->verify) {
+        if (opts->mismatch_index) {
+            ctx.mismatch_index = opts->mismatch_index;
+            if (bad_extent_index_sector_size(ctx.mismatch_index) == 0) {
+                bad_extent_index_set_sector_size(ctx.mismatch_index, logical_size);
+            }
+            ctx.state.mismatch_index = ctx.mismatch_index;
+        } else {
+            ctx.mismatch_index = bad_extent_index_create(logical_size);
+            ctx.owns_mismatch_index = true;
+        }
+        ctx.state.verify = true;
+        if (resumed_mismatches && ctx.mismatch_index) bad_extent_index_merge(ctx.mismatch_index, resumed_mismatches);
+    }
+    bad_extent_index_destroy(resumed_mismatches);
+    resumed_mismatches = NULL;
+
+    // Classificação do conteúdo: o mapa é do chamador e compartilhado pelos workers.
+    if (opts->content_map) {
+        scan_content_map_set_geometry(opts->content_map, ctx.device_size, logical_size);
+        ctx.content_map = opts->content_map;
+        ctx.state.content_map = ctx.content_map;
+        if (resuming && journal.classify) {
+            for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+                for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+                    ctx.content_map->bytes[r][c] += journal.content.bytes[r][c];
+                }
+            }
+        }
+    }
+
+    // Faixa pedida, com o início alinhado ao bloco e o fim limitado ao disco.
+    uint64_t range_start = opts->range_offset / ctx.block_size * ctx.block_size;
+    uint64_t range_end = ctx.device_size;
+    if (opts->range_length > 0 && opts->range_offset + opts->range_length < range_end) {
+        range_end = opts->range_offset + opts->range_length;
+        range_end = (range_end + ctx.block_size - 1) / ctx.block_size * ctx.block_size;
+        if (range_end > ctx.device_size) range_end = ctx.device_size;
+    }
+    if (range_start >= range_end) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: Scan range starts past the end of the device.");
+        scan_dev_close(ctx.dev);
+        scan_ctx_release(&ctx);
         return 1;
     }
 
-    int64_t total_sectors = device_size / BUFFER_SIZE;
-    int64_t offset = 0;
+    // As faixas alocadas são lidas na ordem do disco, agrupadas em leituras longas.
+    if (opts->allocated_path && opts->order != SCAN_ORDER_SEQUENTIAL) {
+        snprintf(result->status_message, sizeof(result->status_message), "Error: An allocated-space scan reads in sequential order only (not %s).", scan_order_name(opts->order));
+        scan_dev_close(ctx.dev);
+        scan_ctx_release(&ctx);
+        return 1;
+    }
 
-    printf("DiskOracle Deep Scan started on %s. Total sectors: %lld...\n", device, (long long)total_sectors);
-    fflush(stdout);
+    // Scan só do espaço alocado: faixas dos arquivos, ordenadas e agrupadas em
+    // leituras sequenciais longas. Num resume a lista é montada de novo.
+    if (opts->allocated_path) {
+        ctx.extents = (scan_extent_list_t*)malloc(sizeof(scan_extent_list_t));
+        int status = PAL_STATUS_NO_MEMORY;
+        if (ctx.extents) {
+            scan_extent_list_init(ctx.extents);
+            ctx.owns_extents = true;
+            status = scan_extent_list_collect_fs(ctx.extents, opts->allocated_path, device, logical_size, ctx.device_size);
+        }
+        if (status != PAL_STATUS_SUCCESS) {
+            if (status == PAL_STATUS_INVALID_PARAMETER) {
+                snprintf(result->status_message, sizeof(result->status_message), "Error: The filesystem at %.100s is not on %.100s.", opts->allocated_path, device);
+            } else if (status == PAL_STATUS_UNSUPPORTED) {
+                snprintf(result->status_message, sizeof(result->status_message), "Error: Cannot map the files of %.100s to disk blocks on this platform/filesystem.", opts->allocated_path);
+            } else {
+                snprintf(result->status_message, sizeof(result->status_message), "Error: Could not read the allocation of %.100s (%s).", opts->allocated_path, pal_get_error_string(status));
+            }
+            scan_dev_close(ctx.dev);
+            scan_ctx_release(&ctx);
+            return 1;
+        }
+    }
 
-    for (int64_t i = 0; i < total_sectors; ++i) {
-        ssize_t bytes_read = -1;
-#ifdef _WIN32
-            LARGE_INTEGER li_offset;
-            li_offset.QuadPart = offset;
-            DWORD win_bytes_read = 0;
-        if (SetFilePointerEx(hFile, li_offset, NULL, FILE_BEGIN) && ReadFile(hFile, buf, BUFFER_SIZE, &win_bytes_read, NULL)) {
-            bytes_read = win_bytes_read;
-        } else {
-            result->read_errors++;
+    if (resuming) {
+        range_start = journal.segments[0].start;
+        range_end = journal.segments[journal.segment_count - 1].end;
+    }
+
+    // Ordem de leitura. Fora da sequencial os workers dividem as posições da
+    // ordem: a faixa passa a ser [range_start, range_start + leituras * bloco).
+    if (quick) {
+        uint64_t samples = opts->samples ? opts->samples : scan_sampling_size(opts->confidence, opts->tolerance);
+        scan_order_init_sampled(&ctx.order, (range_end - range_start) / ctx.block_size, samples, opts->sample_seed);
+        ctx.state.population_blocks = ctx.order.blocks;
+        ctx.state.confidence = opts->confidence > 0.0 && opts->confidence < 1.0 ? opts->confidence : SCAN_SAMPLE_DEFAULT_CONFIDENCE;
+    } else {
+        scan_order_init(&ctx.order, opts->order, (range_end - range_start + ctx.block_size - 1) / ctx.block_size, opts->stride, opts->sample_seed);
+    }
+    ctx.order_base = range_start;
+    ctx.order_end = range_end;
+    ctx.state.order = ctx.order.kind;
+    if (ctx.order.kind != SCAN_ORDER_SEQUENTIAL && ctx.order.count * ctx.block_size < range_end - range_start) {
+        range_end = range_start + ctx.order.count * ctx.block_size;
+    }
+
+    // Uma faixa por worker; num resume as faixas e cursores vêm do journal.
+    scan_segment_t segments[SCAN_MAX_THREADS];
+    unsigned segment_count;
+    if (resuming) {
+        segment_count = journal.segment_count;
+        memcpy(segments, journal.segments, segment_count * sizeof(scan_segment_t));
+    } else {
+        uint64_t total_blocks = scan_ctx_blocks_between(&ctx, range_start, range_end);
+        segment_count = opts->threads;
+        if (segment_count == SCAN_THREADS_AUTO) {
+            segment_count = surface_scan_auto_threads(device);
         }
-#else
-        bytes_read = pread(fd, buf, BUFFER_SIZE, offset);
-        if (bytes_read < 0) result->read_errors++;
-#endif
-        result->total_sectors_scanned++;
+        if (segment_count > SCAN_MAX_THREADS) segment_count = SCAN_MAX_THREADS;
+        if ((uint64_t)segment_count > total_blocks) {
+            segment_count = total_blocks > 0 ? (unsigned)total_blocks : 1;
+        }
+        scan_split_segments(range_start, range_end, ctx.block_size, segment_count, segments);
+        if (ctx.extents) {
+            // Cada worker recebe a mesma quantidade de espaço alocado, não de disco.
+            uint64_t allocated = scan_extent_list_bytes_in(ctx.extents, range_start, range_end);
+            for (unsigned i = 1; i < segment_count; ++i) {
+                uint64_t share = allocated / segment_count * i;
+                segments[i].start = segments[i].cursor = segments[i - 1].end =
+                    scan_extent_list_offset_after(ctx.extents, range_start, range_end, share, logical_size);
+            }
+        }
+    }
+    ctx.segments = segments;
+    ctx.segment_count = segment_count;
+    if (ctx.extents) {
+        ctx.state.allocated_bytes = scan_extent_list_bytes_in(ctx.extents, range_start, range_end);
+    }
 
-        if (bytes_read > 0 && bytes_read < BUFFER_SIZE) {
-                result->bad_sectors_found++;
-        } else if (bytes_read < 0) {
-            result->bad_sectors_found++;
+    ctx.state.block_size = ctx.block_size;
+    // Por faixa: com a lista de alocação um worker pode começar no meio de uma extensão.
+    ctx.state.total_blocks = 0;
+    for (unsigned i = 0; i < segment_count; ++i) {
+        ctx.state.total_blocks += scan_ctx_blocks_between(&ctx, segments[i].start, segments[i].end);
+    }
+    ctx.state.latency_map = ctx.latency_map;
+    ctx.state.start_time = time(NULL);
+    if (resuming) {
+        ctx.state.start_time -= (time_t)journal.elapsed_seconds;
+        ctx.state.scanned_blocks = result->total_sectors_scanned = journal.scanned_blocks;
+        ctx.state.bad_blocks = journal.bad_blocks;
+        ctx.state.read_errors = result->read_errors = journal.read_errors;
+        ctx.state.mismatch_blocks = journal.mismatch_blocks;
+        ctx.state.bad_sectors = result->bad_sectors_found = bad_extent_index_sectors(ctx.bad_index);
+        ctx.state.bad_extents = bad_extent_index_extents(ctx.bad_index);
+        ctx.state.mismatch_sectors = bad_extent_index_sectors(ctx.mismatch_index);
+        ctx.state.mismatch_extents = bad_extent_index_extents(ctx.mismatch_index);
+        ctx.state.latency = journal.latency;
+    }
+    ctx.last_update_ns = scan_now_ns();
+    if (opts->time_budget_seconds > 0) {
+        ctx.deadline_ns = ctx.last_update_ns + (uint64_t)(opts->time_budget_seconds * 1e9);
+    }
+
+    if (opts->journal_path) {
+        snprintf(journal.device_path, sizeof(journal.device_path), "%s", device);
+        snprintf(journal.serial, sizeof(journal.serial), "%s", opts->device_serial ? opts->device_serial : "");
+        journal.device_size = ctx.device_size;
+        journal.sector_size = logical_size;
+        journal.block_size = ctx.block_size;
+        journal.queue_depth = opts->queue_depth;
+        journal.engine = (uint32_t)opts->engine;
+        journal.direct_io = ctx.direct_io;
+        journal.order = (uint32_t)ctx.order.kind;
+        journal.stride = ctx.order.stride;
+        journal.order_seed = ctx.order.seed;
+        journal.verify = opts->verify;
+        journal.classify = ctx.content_map != NULL;
+        if (opts->allocated_path != journal.allocated_path) {
+            snprintf(journal.allocated_path, sizeof(journal.allocated_path), "%s", opts->allocated_path ? opts->allocated_path : "");
         }
+        ctx.journal = &journal;
+        ctx.cursor = segments[0].cursor;
+        scan_ctx_checkpoint(&ctx, true);
+    }
 
-        offset += BUFFER_SIZE;
+    // Throttle compartilhado por todos os workers; os limites podem mudar durante o scan.
+    scan_throttle_t throttle;
+    if (opts->controls) {
+        scan_throttle_init(&throttle, opts->controls, device);
+        ctx.throttle = &throttle;
+        ctx.idle_io = opts->controls->idle_priority;
+        ctx.state.controls = opts->controls;
+    }
+
+    int rc;
+    if (segment_count > 1) {
+        rc = surface_parallel_scan(&ctx, device);
+    } else {
+        ctx.range_start = segments[0].cursor;
+        ctx.range_end = segments[0].end;
+        ctx.cursor = ctx.range_start;
+        rc = scan_ctx_run_engine(&ctx);
+        segments[0].cursor = ctx.cursor;
+    }
+    scan_dev_close(ctx.dev);
+    if (ctx.throttle) {
+        scan_throttle_destroy(ctx.throttle);
+        ctx.throttle = NULL;
+        scan_throttle_report(NULL, &ctx.state);
+    }
 
-        if (i > 0 && (total_sectors < 100 || i % (total_sectors / 100) == 0 || i == total_sectors - 1)) {
-            printf("DiskOracle Deep Scan progress: %.2f%%\r", (float)(i + 1) * 100.0f / total_sectors);
-            fflush(stdout);
+    // resume_offset: fim do trecho lido sem buracos a partir do início da faixa.
+    bool interrupted = false;
+    ctx.state.resume_offset = range_end;
+    for (unsigned i = 0; i < segment_count; ++i) {
+        if (segments[i].cursor < segments[i].end) {
+            if (!interrupted) ctx.state.resume_offset = segments[i].cursor;
+            interrupted = true;
         }
     }
+    // Parar por fim do orçamento de tempo é o resultado esperado, não uma interrupção.
+    bool budget_spent = interrupted && ctx.deadline_ns != 0 && !scan_stop_requested();
 
-    printf("\n"); // Newline after progress bar
-    snprintf(result->status_message, sizeof(result->status_message), "Deep scan completed. Sectors checked: %llu, Bad sectors: %llu.", result->total_sectors_scanned, result->bad_sectors_found);
+    if (rc != 0) {
+        // Um erro fatal também deixa o checkpoint, para continuar depois.
+        scan_ctx_checkpoint(&ctx, true);
+        scan_ctx_release(&ctx);
+        return rc;
+    }
 
-#ifdef _WIN32
-    if (buf) _aligned_free(buf);
-    CloseHandle(hFile);
-#else
-    if (buf) free(buf);
-    close(fd);
-#endif
+    scan_ctx_finish_bad_extents(&ctx);
+    ctx.state.current_speed_mbps = 0;
+    scan_ctx_update_progress(&ctx, true);
 
-#ifdef _WIN32
-    QueryPerformanceCounter(&end_time);
-    result->scan_time_seconds = (double)(end_time.QuadPart - start_time.QuadPart) / freq.QuadPart;
-#else
-    result->scan_time_seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
-#endif
+    if (out_final_state) {
+        memcpy(out_final_state, &ctx.state, sizeof(scan_state_t));
+    }
+
+    if (interrupted && !budget_spent) {
+        scan_ctx_checkpoint(&ctx, true);
+        scan_ctx_release(&ctx);
+        double done = ctx.state.total_blocks ? 100.0 * ctx.state.scanned_blocks / ctx.state.total_blocks : 0.0;
+        if (opts->journal_path && ctx.checkpoint_saved) {
+            snprintf(result->status_message, sizeof(result->status_message), "Deep scan interrupted at %.1f%%. Progress saved to %.180s; continue with --resume.", done, opts->journal_path);
+        } else if (opts->journal_path) {
+            snprintf(result->status_message, sizeof(result->status_message), "Deep scan interrupted at %.1f%%. The checkpoint could not be written to %.150s.", done, opts->journal_path);
+        } else {
+            snprintf(result->status_message, sizeof(result->status_message), "%s scan interrupted at %.1f%%.", quick ? "Quick" : "Deep", done);
+        }
+        return 1;
+    }
+    if (budget_spent) {
+        scan_ctx_checkpoint(&ctx, true);
+    } else if (opts->journal_path) {
+        scan_journal_remove(opts->journal_path);
+    }
+
+    if (opts->on_bad_extent) {
+        bad_extent_index_foreach(ctx.bad_index, scan_visit_bad_extent, &ctx);
+    }
+    scan_ctx_release(&ctx);
+
+    snprintf(result->status_message, sizeof(result->status_message), "%s scan %s. Blocks checked: %llu, Bad sectors: %llu in %llu extent(s).",
+             quick ? "Quick" : "Deep", budget_spent ? "stopped at the end of its time budget" : "completed",
+             (unsigned long long)result->total_sectors_scanned, (unsigned long long)result->bad_sectors_found,
+             (unsigned long long)result->bad_extents);
+    result->scan_time_seconds = (scan_now_ns() - start_ns) / 1e9;
     return 0;
 }
 
 
 // Função principal exportada, que chama as funções internas
 int surface_scan(const char *device_path, const char *scan_type, scan_callback_t callback, void* user_data, scan_state_t* out_final_state) {
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    if (scan_type != NULL && strlen(scan_type) > 0) {
+        opts.mode = scan_type;
+    }
+    return surface_scan_ex(device_path, &opts, callback, user_data, out_final_state);
+}
+
+int surface_scan_ex(const char *device_path, const scan_options_t *opts, scan_callback_t callback, void* user_data, scan_state_t* out_final_state) {
     SurfaceScanResult result = {0};
+    scan_options_t defaults;
 
     if (device_path == NULL) {
         fprintf(stderr, "Error: Device path is NULL.\n");
         return 1;
     }
+    if (opts == NULL) {
+        surface_scan_options_init(&defaults);
+        opts = &defaults;
+    }
 
-    const char *type_to_run = (scan_type == NULL || strlen(scan_type) == 0) ? "quick" : scan_type;
-
-    if (strcmp(type_to_run, "quick") == 0) {
-        return surface_scan_quick(device_path, &result, callback, user_data, out_final_state);
-    } else if (strcmp(type_to_run, "deep") == 0) {
-        return surface_scan_deep(device_path, &result);
-    } else {
+    const char *type_to_run = (opts->mode == NULL || strlen(opts->mode) == 0) ? "quick" : opts->mode;
+    if (strcmp(type_to_run, "quick") != 0 && strcmp(type_to_run, "deep") != 0) {
         fprintf(stderr, "Unknown scan type '%s'.\n", type_to_run);
         return 1;
     }
+
+#if defined(_MSC_VER)
+    if (InterlockedIncrement(&g_scans_running) == 1) g_scan_stop_requested = 0;
+#else
+    if (__atomic_add_fetch(&g_scans_running, 1, __ATOMIC_ACQ_REL) == 1) g_scan_stop_requested = 0;
+#endif
+
+    int rc = surface_scan_run(device_path, opts, strcmp(type_to_run, "quick") == 0, &result, callback, user_data, out_final_state);
+
+#if defined(_MSC_VER)
+    InterlockedDecrement(&g_scans_running);
+#else
+    __atomic_sub_fetch(&g_scans_running, 1, __ATOMIC_ACQ_REL);
+#endif
+
+    if (rc != 0) {
+        fprintf(stderr, "%s\n", result.status_message);
+    }
+    return rc;
 }
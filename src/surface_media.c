@@ -0,0 +1,119 @@
+#include "surface_engine.h"
+#include <stdio.h>
+#include <string.h>
+
+// Engine de verify na mídia: em vez de ler cada bloco, pede ao próprio disco
+// que o leia e confira (SCSI VERIFY(16), ATA READ VERIFY SECTORS EXT ou o
+// Verify do NVMe). Nada passa pelo barramento nem pela memória, então os
+// blocos podem ser grandes e o scan fica limitado só pela mídia. Um verify que
+// falha é refinado com outros verifies: o disco costuma informar o primeiro
+// LBA ilegível, e sem essa informação a faixa é dividida ao meio como na
+// bisseção das leituras.
+
+// Verifica [lba, lba + count) em comandos de até max_sectors e para no
+// primeiro que falhar, devolvendo em failed_at o início dele.
+static pal_status_t media_verify_range(pal_verifier_t* verifier, uint64_t lba, uint64_t count, uint64_t* failed_at, uint64_t* error_lba) {
+    *error_lba = UINT64_MAX;
+    while (count > 0) {
+        uint32_t chunk = count > verifier->max_sectors ? verifier->max_sectors : (uint32_t)count;
+        pal_status_t status = pal_verify_sectors(verifier, lba, chunk, error_lba);
+        if (status != PAL_STATUS_SUCCESS) {
+            *failed_at = lba;
+            return status;
+        }
+        lba += chunk;
+        count -= chunk;
+    }
+    return PAL_STATUS_SUCCESS;
+}
+
+// Setor que já falhou uma vez: ganha SCAN_SECTOR_RETRIES novas tentativas.
+static void media_check_sector(scan_ctx_t* ctx, pal_verifier_t* verifier, uint64_t lba) {
+    for (int i = 0; i < SCAN_SECTOR_RETRIES; ++i) {
+        if (pal_verify_sectors(verifier, lba, 1, NULL) == PAL_STATUS_SUCCESS) {
+            return;
+        }
+    }
+    scan_ctx_mark_bad(ctx, lba, 1);
+}
+
+// Localiza os setores ilegíveis de [lba, end), cujo verify acabou de falhar
+// (error_lba é o LBA informado pelo disco, ou UINT64_MAX). Setores antes do
+// LBA informado estão bons e a busca continua logo depois dele.
+static void media_localize(scan_ctx_t* ctx, pal_verifier_t* verifier, uint64_t lba, uint64_t end, uint64_t error_lba) {
+    while (lba < end) {
+        if (error_lba >= lba && error_lba < end) {
+            media_check_sector(ctx, verifier, error_lba);
+            lba = error_lba + 1;
+        } else if (end - lba == 1) {
+            media_check_sector(ctx, verifier, lba);
+            return;
+        } else {
+            uint64_t mid = lba + (end - lba) / 2;
+            uint64_t failed_at;
+            if (media_verify_range(verifier, lba, mid - lba, &failed_at, &error_lba) != PAL_STATUS_SUCCESS) {
+                media_localize(ctx, verifier, failed_at, mid, error_lba);
+            }
+            lba = mid;
+        }
+        if (lba >= end) return;
+        if (media_verify_range(verifier, lba, end - lba, &lba, &error_lba) == PAL_STATUS_SUCCESS) return;
+    }
+}
+
+int surface_media_scan(scan_ctx_t* ctx) {
+    pal_verifier_t verifier;
+    if (pal_verify_open(ctx->device_path, &verifier) != PAL_STATUS_SUCCESS) {
+        return -1;
+    }
+    if (verifier.sector_size != ctx->logical_sector_size) {
+        pal_verify_close(&verifier);
+        return -1;
+    }
+    uint32_t sector = ctx->logical_sector_size;
+    uint8_t* buf = NULL;    // só para os blocos em que o verify não funcionou
+
+    int rc = 0;
+    uint64_t position = scan_ctx_next_offset(ctx, ctx->range_start);
+    ctx->cursor = position;
+    while (position < ctx->range_end && !scan_ctx_stop(ctx)) {
+        uint64_t offset = scan_ctx_read_offset(ctx, position);
+        uint32_t len = scan_ctx_read_len(ctx, offset);
+        scan_throttle_acquire(ctx, len);
+        if (scan_ctx_stop(ctx)) break;
+
+        uint64_t lba = offset / sector;
+        uint64_t end = lba + len / sector;
+        uint64_t failed_at = lba, error_lba;
+        uint64_t started_ns = scan_now_ns();
+        pal_status_t status = media_verify_range(&verifier, lba, end - lba, &failed_at, &error_lba);
+        uint64_t latency_ns = scan_now_ns() - started_ns;
+
+        if (status == PAL_STATUS_SUCCESS || status == PAL_STATUS_DEVICE_ERROR) {
+            scan_ctx_record_verified(ctx, offset, len, status != PAL_STATUS_SUCCESS, latency_ns);
+            if (status != PAL_STATUS_SUCCESS) {
+                media_localize(ctx, &verifier, failed_at, end, error_lba);
+            }
+        } else {
+            // O comando falhou sem apontar a mídia (p.ex. abortado pelo HBA): o bloco é lido.
+            if (buf == NULL) {
+                buf = (uint8_t*)scan_buffer_alloc(ctx->block_size, ctx->alignment);
+                if (buf == NULL) {
+                    snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Memory allocation failed (media verify).");
+                    rc = 1;
+                    break;
+                }
+            }
+            started_ns = scan_now_ns();
+            int64_t bytes_read = scan_ctx_pread(ctx->dev, buf, len, offset);
+            scan_ctx_record_read(ctx, offset, len, bytes_read, scan_now_ns() - started_ns);
+        }
+        position = scan_ctx_advance(ctx, position, len);
+        ctx->cursor = position;
+        scan_ctx_update_progress(ctx, false);
+    }
+
+    scan_buffer_free(buf);
+    pal_verify_close(&verifier);
+    return rc;
+}
@@ -0,0 +1,238 @@
+#include "surface_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// Scan profundo paralelo: cada faixa (scan_segment_t) vai para um worker com
+// seu próprio contexto, handle e engine. Os contadores são publicados sem
+// lock em slots alinhados e somados pela thread chamadora, que é a única a
+// chamar o callback e a gravar checkpoints. O índice de setores ruins é
+// compartilhado sob um mutex que só é tomado quando um setor ruim aparece; o
+// mapa de latência é atualizado sem lock.
+
+typedef struct {
+    scan_ctx_t ctx;
+    SurfaceScanResult result;
+    bool owns_dev;
+    int rc;
+    volatile int done;
+} scan_worker_t;
+
+#ifdef _WIN32
+static unsigned __stdcall scan_worker_main(void* arg) {
+#else
+static void* scan_worker_main(void* arg) {
+#endif
+    scan_worker_t* worker = (scan_worker_t*)arg;
+    worker->rc = scan_ctx_run_engine(&worker->ctx);
+    scan_ctx_update_progress(&worker->ctx, true);
+#if defined(_MSC_VER)
+    InterlockedExchange((volatile LONG*)&worker->done, 1);
+#else
+    __atomic_store_n(&worker->done, 1, __ATOMIC_RELEASE);
+#endif
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static void scan_parallel_sleep_ms(unsigned ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = { 0, (long)ms * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Cópia coerente de um slot: refeita se o worker publicou no meio da leitura.
+static void scan_parallel_read_slot(scan_worker_slot_t* slot, scan_worker_slot_t* copy) {
+    for (;;) {
+        uint64_t before = SCAN_ATOMIC_LOAD_ACQUIRE(&slot->sequence);
+        if (before & 1) continue;
+        copy->scanned_blocks = SCAN_ATOMIC_LOAD(&slot->scanned_blocks);
+        copy->bad_blocks = SCAN_ATOMIC_LOAD(&slot->bad_blocks);
+        copy->read_errors = SCAN_ATOMIC_LOAD(&slot->read_errors);
+        copy->bytes_read = SCAN_ATOMIC_LOAD(&slot->bytes_read);
+        copy->bad_sectors = SCAN_ATOMIC_LOAD(&slot->bad_sectors);
+        copy->bad_extents = SCAN_ATOMIC_LOAD(&slot->bad_extents);
+        copy->mismatch_blocks = SCAN_ATOMIC_LOAD(&slot->mismatch_blocks);
+        copy->mismatch_sectors = SCAN_ATOMIC_LOAD(&slot->mismatch_sectors);
+        copy->cursor = SCAN_ATOMIC_LOAD(&slot->cursor);
+        scan_latency_snapshot(&copy->latency, &slot->latency);
+        SCAN_ATOMIC_FENCE_ACQUIRE();
+        if (SCAN_ATOMIC_LOAD(&slot->sequence) == before) return;
+    }
+}
+
+// Soma os slots publicados ao estado inicial (não zero quando o scan foi retomado).
+static void scan_parallel_aggregate(scan_ctx_t* ctx, const scan_state_t* base, scan_worker_slot_t* slots, unsigned threads, uint64_t* last_bytes) {
+    uint64_t scanned = base->scanned_blocks, bad = base->bad_blocks, errors = base->read_errors;
+    uint64_t bad_sectors = base->bad_sectors, bad_extents = base->bad_extents, bytes = 0;
+    uint64_t mismatch_blocks = base->mismatch_blocks, mismatch_sectors = base->mismatch_sectors;
+    ctx->state.latency = base->latency;
+    for (unsigned i = 0; i < threads; ++i) {
+        scan_worker_slot_t copy;
+        scan_parallel_read_slot(&slots[i], &copy);
+        if (copy.cursor > ctx->segments[i].cursor) ctx->segments[i].cursor = copy.cursor;
+        scanned += copy.scanned_blocks;
+        bad += copy.bad_blocks;
+        errors += copy.read_errors;
+        bytes += copy.bytes_read;
+        bad_sectors += copy.bad_sectors;
+        bad_extents += copy.bad_extents;
+        mismatch_blocks += copy.mismatch_blocks;
+        mismatch_sectors += copy.mismatch_sectors;
+        scan_latency_merge(&ctx->state.latency, &copy.latency);
+    }
+    ctx->state.scanned_blocks = scanned;
+    ctx->state.bad_blocks = bad;
+    ctx->state.read_errors = errors;
+    ctx->state.bad_sectors = bad_sectors;
+    ctx->state.bad_extents = bad_extents;
+    ctx->state.mismatch_blocks = mismatch_blocks;
+    ctx->state.mismatch_sectors = mismatch_sectors;
+    ctx->bytes_since_update += bytes - *last_bytes;
+    ctx->bytes_total = bytes;
+    *last_bytes = bytes;
+}
+
+int surface_parallel_scan(scan_ctx_t* ctx, const char* device_path) {
+    unsigned threads = ctx->segment_count;
+    scan_worker_t* workers = (scan_worker_t*)calloc(threads, sizeof(scan_worker_t));
+    scan_worker_slot_t* slots = (scan_worker_slot_t*)scan_buffer_alloc((size_t)threads * sizeof(scan_worker_slot_t), 64);
+#ifdef _WIN32
+    HANDLE* handles = (HANDLE*)calloc(threads, sizeof(HANDLE));
+#else
+    pthread_t* handles = (pthread_t*)calloc(threads, sizeof(pthread_t));
+#endif
+    if (workers == NULL || slots == NULL || handles == NULL) {
+        free(workers);
+        free(handles);
+        scan_buffer_free(slots);
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Memory allocation failed (parallel scan).");
+        return 1;
+    }
+    memset(slots, 0, (size_t)threads * sizeof(scan_worker_slot_t));
+
+    scan_mutex_t bad_lock;
+    scan_mutex_init(&bad_lock);
+    ctx->bad_lock = &bad_lock;
+    scan_state_t base = ctx->state;
+
+    unsigned started = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        scan_worker_t* worker = &workers[i];
+        worker->ctx = *ctx;
+        worker->ctx.result = &worker->result;
+        worker->ctx.callback = NULL;
+        worker->ctx.user_data = NULL;
+        worker->ctx.publish = &slots[i];
+        worker->ctx.bytes_since_update = 0;
+        worker->ctx.bytes_total = 0;
+        worker->ctx.retry_buf = NULL;
+        worker->ctx.owns_bad_index = false;
+        worker->ctx.last_bad_end = 0;
+        worker->ctx.owns_mismatch_index = false;
+        worker->ctx.owns_extents = false;
+        worker->ctx.extent_next = 0;
+        worker->ctx.last_mismatch_end = 0;
+        latency_cell_clear(&worker->ctx.map_pending);
+        worker->ctx.journal = NULL;
+        worker->ctx.segments = NULL;
+        worker->ctx.segment_count = 0;
+        memset(&worker->ctx.state, 0, sizeof(worker->ctx.state));
+        worker->ctx.state.block_size = ctx->block_size;
+
+        worker->ctx.range_start = ctx->segments[i].cursor;
+        worker->ctx.range_end = ctx->segments[i].end;
+        worker->ctx.cursor = worker->ctx.range_start;
+        slots[i].cursor = worker->ctx.cursor;
+
+        // Um handle por worker: no Windows um handle síncrono serializa as leituras.
+        worker->ctx.dev = scan_ctx_reopen(ctx, device_path);
+        worker->owns_dev = worker->ctx.dev != SCAN_DEV_INVALID;
+        if (!worker->owns_dev) {
+            worker->ctx.dev = ctx->dev;
+        }
+
+#ifdef _WIN32
+        handles[i] = (HANDLE)_beginthreadex(NULL, 0, scan_worker_main, worker, 0, NULL);
+        bool ok = handles[i] != 0;
+#else
+        bool ok = pthread_create(&handles[i], NULL, scan_worker_main, worker) == 0;
+#endif
+        if (!ok) {
+            if (worker->owns_dev) scan_ctx_close(worker->ctx.dev);
+            worker->owns_dev = false;
+            break;
+        }
+        started++;
+    }
+
+    int rc = 0;
+    if (started < threads) {
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Could not start scan worker threads.");
+        rc = 1;
+    }
+
+    // Coordenador: agrega os contadores e dirige o callback até todos terminarem.
+    uint64_t last_bytes = 0;
+    for (;;) {
+        unsigned finished = 0;
+        for (unsigned i = 0; i < started; ++i) {
+#if defined(_MSC_VER)
+            finished += InterlockedCompareExchange((volatile LONG*)&workers[i].done, 0, 0) ? 1 : 0;
+#else
+            finished += __atomic_load_n(&workers[i].done, __ATOMIC_ACQUIRE) ? 1 : 0;
+#endif
+        }
+        if (finished == started) break;
+
+        scan_parallel_sleep_ms(10);
+        scan_parallel_aggregate(ctx, &base, slots, threads, &last_bytes);
+        scan_ctx_update_progress(ctx, false);
+    }
+
+    for (unsigned i = 0; i < started; ++i) {
+#ifdef _WIN32
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+#else
+        pthread_join(handles[i], NULL);
+#endif
+        scan_worker_t* worker = &workers[i];
+        if (worker->owns_dev) {
+            scan_ctx_close(worker->ctx.dev);
+        }
+        if (worker->rc != 0 && rc == 0) {
+            rc = worker->rc;
+            memcpy(ctx->result->status_message, worker->result.status_message, sizeof(ctx->result->status_message));
+        }
+
+        ctx->result->total_sectors_scanned += worker->result.total_sectors_scanned;
+        ctx->result->bad_sectors_found += worker->result.bad_sectors_found;
+        ctx->result->read_errors += worker->result.read_errors;
+        // Se algum worker recuou para outra engine, o scan não rodou inteiro na escolhida.
+        if (i == 0 || worker->ctx.state.engine != SCAN_ENGINE_URING) ctx->state.engine = worker->ctx.state.engine;
+        scan_ctx_release(&worker->ctx);
+    }
+    scan_parallel_aggregate(ctx, &base, slots, threads, &last_bytes);
+
+    ctx->bad_lock = NULL;
+    scan_mutex_destroy(&bad_lock);
+
+    free(handles);
+    scan_buffer_free(slots);
+    free(workers);
+    return rc;
+}
@@ -0,0 +1,313 @@
+#include "surface_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// Engine de scan baseado em io_uring. Usa as syscalls diretamente para não
+// depender da liburing; só precisamos de IORING_OP_READ e de um anel simples.
+
+typedef struct {
+    int ring_fd;
+
+    void* sq_ptr;
+    size_t sq_len;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    size_t sqes_len;
+
+    void* cq_ptr;
+    size_t cq_len;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+} uring_t;
+
+// IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, 0), para o scan em segundo plano.
+#define URING_IOPRIO_IDLE (3u << 13)
+
+// Uma leitura em voo. O índice do slot vai em user_data do SQE.
+typedef struct {
+    uint8_t* buf;
+    uint64_t position;      // posição na ordem do scan, para o cursor
+    uint64_t offset;
+    uint32_t len;
+    uint64_t submitted_ns;  // início da medição de latência (0 = ainda não submetida)
+    bool busy;
+} uring_slot_t;
+
+// Leitura concluída à frente do cursor. Ela só é contabilizada quando o
+// cursor passa por ela: os contadores do checkpoint cobrem exatamente
+// [início, cursor), que é o que o resume não lê de novo.
+typedef struct {
+    uint64_t position;
+    uint64_t offset;
+    uint32_t len;
+    int32_t res;
+    uint64_t latency_ns;
+    int content;            // scan_content_class_t, ou -1 se o bloco não foi classificado
+} uring_done_t;
+
+typedef struct {
+    uring_done_t* items;
+    size_t count;
+    size_t capacity;
+} uring_ledger_t;
+
+static void uring_account(scan_ctx_t* ctx, const uring_done_t* done) {
+    scan_ctx_record_read(ctx, done->offset, done->len, done->res, done->latency_ns);
+    if (done->content >= 0) scan_ctx_add_content(ctx, done->offset, done->len, (scan_content_class_t)done->content);
+}
+
+// Guarda a conclusão até o cursor passar; sem memória ela conta na hora.
+static void uring_ledger_push(uring_ledger_t* ledger, scan_ctx_t* ctx, const uring_done_t* done) {
+    if (ledger->count == ledger->capacity) {
+        size_t capacity = ledger->capacity ? ledger->capacity * 2 : 64;
+        uring_done_t* items = (uring_done_t*)realloc(ledger->items, capacity * sizeof(uring_done_t));
+        if (items == NULL) {
+            uring_account(ctx, done);
+            return;
+        }
+        ledger->items = items;
+        ledger->capacity = capacity;
+    }
+    ledger->items[ledger->count++] = *done;
+}
+
+// Contabiliza as conclusões que ficaram para trás do cursor.
+static void uring_ledger_settle(uring_ledger_t* ledger, scan_ctx_t* ctx, uint64_t cursor) {
+    size_t kept = 0;
+    for (size_t i = 0; i < ledger->count; ++i) {
+        if (ledger->items[i].position < cursor) {
+            uring_account(ctx, &ledger->items[i]);
+        } else {
+            ledger->items[kept++] = ledger->items[i];
+        }
+    }
+    ledger->count = kept;
+}
+
+static int uring_setup(unsigned entries, struct io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void uring_destroy(uring_t* ring) {
+    if (ring->sqes && ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr && ring->cq_ptr != MAP_FAILED) munmap(ring->cq_ptr, ring->cq_len);
+    if (ring->sq_ptr && ring->sq_ptr != MAP_FAILED) munmap(ring->sq_ptr, ring->sq_len);
+    if (ring->ring_fd >= 0) close(ring->ring_fd);
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+}
+
+static int uring_init(uring_t* ring, unsigned entries) {
+    struct io_uring_params p;
+    memset(ring, 0, sizeof(*ring));
+    memset(&p, 0, sizeof(p));
+
+    ring->ring_fd = uring_setup(entries, &p);
+    if (ring->ring_fd < 0) {
+        ring->ring_fd = -1;
+        return -1;
+    }
+
+    ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+    ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        uring_destroy(ring);
+        return -1;
+    }
+
+    uint8_t* sq = (uint8_t*)ring->sq_ptr;
+    ring->sq_head = (unsigned*)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + p.sq_off.array);
+
+    uint8_t* cq = (uint8_t*)ring->cq_ptr;
+    ring->cq_head = (unsigned*)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+// Enfileira um READ no SQ. O kernel só enxerga o SQE após o store-release do tail.
+static void uring_queue_read(uring_t* ring, int fd, uring_slot_t* slot, unsigned slot_index, uint16_t ioprio) {
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)slot->buf;
+    sqe->len = slot->len;
+    sqe->off = slot->offset;
+    sqe->user_data = slot_index;
+    sqe->ioprio = ioprio;
+    slot->submitted_ns = 0;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Ocupa os slots livres até o limite de leituras em voo, que pode ser menor
+// que depth enquanto o scan idle-aware cede o disco. Devolve quantas enfileirou.
+static unsigned uring_top_up(uring_t* ring, scan_ctx_t* ctx, uring_slot_t* slots, unsigned depth, uint16_t ioprio,
+                             uint64_t* next_position, unsigned* in_flight) {
+    unsigned queued = 0;
+    for (unsigned i = 0; i < depth && *next_position < ctx->range_end; ++i) {
+        if (slots[i].busy) continue;
+        if (*in_flight >= scan_throttle_depth(ctx->throttle, depth)) break;
+        slots[i].position = *next_position;
+        slots[i].offset = scan_ctx_read_offset(ctx, *next_position);
+        slots[i].len = scan_ctx_read_len(ctx, slots[i].offset);
+        // Esperar pelo throttle com leituras em voo somaria a espera à latência
+        // delas (as conclusões ficariam no CQ sem ser colhidas): primeiro terminam.
+        if (*in_flight > 0 && !scan_throttle_ready(ctx->throttle, slots[i].len)) break;
+        scan_throttle_acquire(ctx, slots[i].len);
+        if (scan_ctx_stop(ctx)) break;
+        slots[i].busy = true;
+        uring_queue_read(ring, ctx->dev, &slots[i], i, ioprio);
+        *next_position = scan_ctx_advance(ctx, *next_position, slots[i].len);
+        (*in_flight)++;
+        queued++;
+    }
+    return queued;
+}
+
+// Espera, sem contabilizar, as leituras que o kernel já recebeu: os buffers
+// delas só podem ser liberados depois disso. Devolve quantas ficaram pendentes.
+static unsigned uring_drain(uring_t* ring, unsigned pending) {
+    while (pending > 0) {
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        unsigned reaped = tail - head;
+        pending -= reaped < pending ? reaped : pending;
+        __atomic_store_n(ring->cq_head, tail, __ATOMIC_RELEASE);
+        if (pending == 0) break;
+        if (uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) break;
+    }
+    return pending;
+}
+
+int surface_uring_scan(scan_ctx_t* ctx) {
+    unsigned depth = ctx->opts->queue_depth;
+    if (depth == 0) depth = 1;
+    if (depth > SCAN_MAX_QUEUE_DEPTH) depth = SCAN_MAX_QUEUE_DEPTH;
+    uint64_t range_blocks = (ctx->range_end - ctx->range_start + ctx->block_size - 1) / ctx->block_size;
+    if ((uint64_t)depth > range_blocks) depth = (unsigned)range_blocks;
+    if (depth == 0) return 0;
+
+    uring_t ring;
+    if (uring_init(&ring, depth) != 0) {
+        return -1;
+    }
+
+    uring_slot_t* slots = (uring_slot_t*)calloc(depth, sizeof(uring_slot_t));
+    uint8_t* pool = slots ? (uint8_t*)scan_buffer_alloc((size_t)depth * ctx->block_size, ctx->alignment) : NULL;
+    if (pool == NULL) {
+        free(slots);
+        uring_destroy(&ring);
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Memory allocation failed (io_uring).");
+        return 1;
+    }
+    for (unsigned i = 0; i < depth; ++i) {
+        slots[i].buf = pool + (size_t)i * ctx->block_size;
+    }
+
+    uint16_t ioprio = ctx->idle_io ? URING_IOPRIO_IDLE : 0;
+    uint64_t next_position = scan_ctx_next_offset(ctx, ctx->range_start);
+    ctx->cursor = next_position;
+    unsigned in_flight = 0;
+    unsigned to_submit = 0;
+    uring_ledger_t ledger;
+    memset(&ledger, 0, sizeof(ledger));
+    int rc = 0;
+
+    // Preenche a fila inicial.
+    to_submit = uring_top_up(&ring, ctx, slots, depth, ioprio, &next_position, &in_flight);
+
+    while (in_flight > 0) {
+        // A latência conta a partir da submissão, não de quando o SQE foi preparado.
+        if (to_submit > 0) {
+            uint64_t submitted_ns = scan_now_ns();
+            for (unsigned i = 0; i < depth; ++i) {
+                if (slots[i].busy && slots[i].submitted_ns == 0) slots[i].submitted_ns = submitted_ns;
+            }
+        }
+        int ret = uring_enter(ring.ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: io_uring_enter failed (%s).", strerror(errno));
+            rc = 1;
+            break;
+        }
+        to_submit -= (unsigned)ret < to_submit ? (unsigned)ret : to_submit;
+
+        // Colhe todas as conclusões disponíveis de uma vez e reabastece a fila.
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        uint64_t reaped_ns = scan_now_ns();
+        while (head != tail) {
+            struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+            unsigned slot_index = (unsigned)cqe->user_data;
+            uring_slot_t* slot = &slots[slot_index];
+
+            uring_done_t done = { slot->position, slot->offset, slot->len, cqe->res, reaped_ns - slot->submitted_ns, -1 };
+            // O buffer volta para a fila: a classificação é feita já.
+            if (ctx->content_map && cqe->res == (int32_t)slot->len) done.content = (int)scan_content_classify(slot->buf, slot->len);
+            uring_ledger_push(&ledger, ctx, &done);
+            slot->busy = false;
+            in_flight--;
+            head++;
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+        to_submit += uring_top_up(&ring, ctx, slots, depth, ioprio, &next_position, &in_flight);
+
+        // As conclusões chegam fora de ordem: o cursor é a leitura mais antiga ainda em voo.
+        uint64_t cursor = next_position;
+        for (unsigned i = 0; i < depth; ++i) {
+            if (slots[i].busy && slots[i].position < cursor) cursor = slots[i].position;
+        }
+        uring_ledger_settle(&ledger, ctx, cursor);
+        ctx->cursor = cursor;
+        scan_ctx_update_progress(ctx, false);
+    }
+    // Depois de um erro, o que ficou à frente do cursor é lido de novo no resume.
+    free(ledger.items);
+
+    // Depois de um erro do io_uring_enter ainda pode haver leituras escrevendo
+    // nos buffers; os SQEs nunca submetidos (to_submit) o kernel não viu.
+    unsigned pending = uring_drain(&ring, in_flight - to_submit);
+    uring_destroy(&ring);
+    if (pending > 0) {
+        // Sem como esperá-las, os buffers ficam alocados até o fim do processo.
+        return rc;
+    }
+    scan_buffer_free(pool);
+    free(slots);
+    return rc;
+}
+
+#endif // __linux__
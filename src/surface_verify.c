@@ -0,0 +1,190 @@
+#include "surface_engine.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#endif
+
+// Engine de verificação: cada bloco é lido duas vezes, a segunda por um handle
+// que não passa pelo cache do SO, e as duas cópias são comparadas. Uma thread
+// auxiliar só faz as leituras; a thread do scan dá as permissões do throttle,
+// contabiliza e compara. Com dois pares de buffers a comparação de um bloco
+// corre enquanto o próximo ainda está sendo lido.
+
+#define VERIFY_SLOTS 2
+
+typedef enum {
+    VERIFY_SLOT_FREE,
+    VERIFY_SLOT_QUEUED,     // esperando a thread de leitura
+    VERIFY_SLOT_READ        // as duas leituras terminaram
+} verify_slot_state_t;
+
+typedef struct {
+    uint8_t* first;
+    uint8_t* second;
+    uint64_t offset;
+    uint32_t len;
+    uint64_t next_position; // onde o scan segue depois deste bloco
+    int64_t first_read;
+    int64_t second_read;
+    uint64_t latency_ns;    // da segunda leitura, a que foi ao disco
+    verify_slot_state_t state;
+} verify_slot_t;
+
+typedef struct {
+    scan_ctx_t* ctx;
+    scan_dev_t uncached;
+    bool drop_cache;
+    verify_slot_t slots[VERIFY_SLOTS];
+    scan_mutex_t lock;
+    scan_cond_t changed;
+    bool quit;
+} verify_pipeline_t;
+
+#ifdef _WIN32
+static unsigned __stdcall verify_reader_main(void* arg) {
+#else
+static void* verify_reader_main(void* arg) {
+#endif
+    verify_pipeline_t* pipe = (verify_pipeline_t*)arg;
+    // A prioridade de I/O é por thread: esta também entra na classe idle.
+    int previous_priority = pipe->ctx->idle_io ? scan_io_idle_begin() : -1;
+    // Os slots são pedidos e devolvidos sempre na mesma ordem circular.
+    for (unsigned next = 0;; next = (next + 1) % VERIFY_SLOTS) {
+        verify_slot_t* slot = &pipe->slots[next];
+        scan_mutex_lock(&pipe->lock);
+        while (slot->state != VERIFY_SLOT_QUEUED && !pipe->quit) {
+            scan_cond_wait(&pipe->changed, &pipe->lock);
+        }
+        bool quit = slot->state != VERIFY_SLOT_QUEUED;
+        scan_mutex_unlock(&pipe->lock);
+        if (quit) break;
+
+        slot->first_read = scan_ctx_pread(pipe->ctx->dev, slot->first, slot->len, slot->offset);
+        if (pipe->drop_cache) scan_ctx_drop_cache(pipe->uncached, slot->offset, slot->len);
+        uint64_t started_ns = scan_now_ns();
+        slot->second_read = scan_ctx_pread(pipe->uncached, slot->second, slot->len, slot->offset);
+        slot->latency_ns = scan_now_ns() - started_ns;
+
+        scan_mutex_lock(&pipe->lock);
+        slot->state = VERIFY_SLOT_READ;
+        scan_cond_broadcast(&pipe->changed);
+        scan_mutex_unlock(&pipe->lock);
+    }
+    scan_io_idle_end(previous_priority);
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+// Contabiliza um par lido. Se só a leitura sem cache falhou, é ela que conta
+// como erro (e passa pela bisseção); só pares completos são comparados.
+static void verify_account(scan_ctx_t* ctx, const verify_slot_t* slot) {
+    int64_t outcome = slot->first_read == (int64_t)slot->len ? slot->second_read : slot->first_read;
+    scan_ctx_record_read(ctx, slot->offset, slot->len, outcome, slot->latency_ns);
+    if (outcome == (int64_t)slot->len) {
+        scan_ctx_record_mismatch(ctx, slot->offset, slot->first, slot->second, slot->len);
+        scan_ctx_classify(ctx, slot->offset, slot->second, slot->len);
+    }
+}
+
+int surface_verify_scan(scan_ctx_t* ctx) {
+    verify_pipeline_t pipe;
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.ctx = ctx;
+    pipe.uncached = scan_ctx_open_uncached(ctx, &pipe.drop_cache);
+    if (pipe.uncached == SCAN_DEV_INVALID) {
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Could not open the device for uncached verify reads.");
+        return 1;
+    }
+
+    uint8_t* pool = (uint8_t*)scan_buffer_alloc((size_t)VERIFY_SLOTS * 2 * ctx->block_size, ctx->alignment);
+    if (pool == NULL) {
+        scan_ctx_close(pipe.uncached);
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Memory allocation failed (verify).");
+        return 1;
+    }
+    for (unsigned i = 0; i < VERIFY_SLOTS; ++i) {
+        pipe.slots[i].first = pool + (size_t)(2 * i) * ctx->block_size;
+        pipe.slots[i].second = pool + (size_t)(2 * i + 1) * ctx->block_size;
+    }
+    scan_mutex_init(&pipe.lock);
+    scan_cond_init(&pipe.changed);
+
+#ifdef _WIN32
+    HANDLE reader = (HANDLE)_beginthreadex(NULL, 0, verify_reader_main, &pipe, 0, NULL);
+    bool started = reader != 0;
+#else
+    pthread_t reader;
+    bool started = pthread_create(&reader, NULL, verify_reader_main, &pipe) == 0;
+#endif
+    int rc = 0;
+    if (!started) {
+        snprintf(ctx->result->status_message, sizeof(ctx->result->status_message), "Error: Could not start the verify reader thread.");
+        rc = 1;
+    }
+
+    uint64_t next_position = scan_ctx_next_offset(ctx, ctx->range_start);
+    ctx->cursor = next_position;
+    unsigned issued = 0, completed = 0;
+    while (started) {
+        // Mantém os dois slots ocupados: o throttle é pago aqui, pelas duas leituras.
+        while (issued - completed < VERIFY_SLOTS && next_position < ctx->range_end && !scan_ctx_stop(ctx)) {
+            verify_slot_t* slot = &pipe.slots[issued % VERIFY_SLOTS];
+            uint64_t offset = scan_ctx_read_offset(ctx, next_position);
+            uint32_t len = scan_ctx_read_len(ctx, offset);
+            scan_throttle_acquire(ctx, 2 * len);
+            if (scan_ctx_stop(ctx)) break;
+            scan_mutex_lock(&pipe.lock);
+            slot->offset = offset;
+            slot->len = len;
+            slot->next_position = scan_ctx_advance(ctx, next_position, len);
+            slot->state = VERIFY_SLOT_QUEUED;
+            scan_cond_broadcast(&pipe.changed);
+            scan_mutex_unlock(&pipe.lock);
+            next_position = slot->next_position;
+            issued++;
+        }
+        if (completed == issued) break;
+
+        verify_slot_t* slot = &pipe.slots[completed % VERIFY_SLOTS];
+        scan_mutex_lock(&pipe.lock);
+        while (slot->state != VERIFY_SLOT_READ) {
+            scan_cond_wait(&pipe.changed, &pipe.lock);
+        }
+        scan_mutex_unlock(&pipe.lock);
+
+        // A thread de leitura já está no outro slot enquanto este é comparado.
+        verify_account(ctx, slot);
+        ctx->cursor = slot->next_position;
+
+        scan_mutex_lock(&pipe.lock);
+        slot->state = VERIFY_SLOT_FREE;
+        scan_mutex_unlock(&pipe.lock);
+        completed++;
+        scan_ctx_update_progress(ctx, false);
+    }
+
+    if (started) {
+        scan_mutex_lock(&pipe.lock);
+        pipe.quit = true;
+        scan_cond_broadcast(&pipe.changed);
+        scan_mutex_unlock(&pipe.lock);
+#ifdef _WIN32
+        WaitForSingleObject(reader, INFINITE);
+        CloseHandle(reader);
+#else
+        pthread_join(reader, NULL);
+#endif
+    }
+
+    scan_cond_destroy(&pipe.changed);
+    scan_mutex_destroy(&pipe.lock);
+    scan_buffer_free(pool);
+    scan_ctx_close(pipe.uncached);
+    return rc;
+}
@@ -2,10 +2,20 @@
 #include "style.h"
 #include "pal.h"
 #include "surface.h"
+#include "scan_patrol.h"
+#include "scan_profile.h"
+#include "scan_benchmark.h"
 #include <stdio.h>
 #include <time.h>
 #include <string.h>
 
+// Colunas do heatmap de latência (terminal e relatório).
+#define UI_HEATMAP_MAX_COLUMNS 256
+#define UI_HEATMAP_ROW 64
+
+// Linhas da curva de taxa de transferência (--profile).
+#define UI_CURVE_ROWS 12
+
 void ui_display_error_log_entry(const NVMeErrorLogEntry* log_entry, int entry_number) {
     if (!log_entry) {
         return;
@@ -55,6 +65,27 @@ void ui_cleanup(void) {
     fflush(stdout);
 }
 
+static const term_color_t ui_heat_colors[SCAN_TIER_COUNT] = {
+    COLOR_GREEN, COLOR_BRIGHT_GREEN, COLOR_YELLOW, COLOR_BRIGHT_YELLOW, COLOR_RED, COLOR_BRIGHT_RED, COLOR_MAGENTA
+};
+
+// Cor de uma célula do heatmap pela pior latência vista nela (estilo Victoria).
+static void ui_heat_cell(const latency_cell_t* cell) {
+    if (cell->count == 0 && cell->errors == 0) {
+        printf(" ");
+        return;
+    }
+    if (cell->errors > 0) {
+        style_set_bg(ui_heat_colors[SCAN_TIER_ERROR]);
+        printf("x");
+        style_reset();
+        return;
+    }
+    style_set_bg(ui_heat_colors[scan_latency_tier_of(cell->max_us)]);
+    printf(" ");
+    style_reset();
+}
+
 void ui_draw_scan_progress(const scan_state_t* state, const BasicDriveInfo* drive_info) {
     int term_width, term_height;
     if (pal_get_terminal_size(&term_width, &term_height) != PAL_STATUS_SUCCESS) {
@@ -117,6 +148,41 @@ void ui_draw_scan_progress(const scan_state_t* state, const BasicDriveInfo* driv
     printf("%llu\n", state->bad_blocks);
     style_reset();
 
+    // Scan em segundo plano: limite efetivo (o do usuário ou o do alvo de latência).
+    if (state->controls) {
+        printf(" Limit: ");
+        style_set_bold();
+        if (state->throttle_bytes_per_sec > 0) {
+            printf("%6.1f MB/s", state->throttle_bytes_per_sec / (1024.0 * 1024.0));
+        } else {
+            printf("none");
+        }
+        style_reset();
+        uint64_t max_iops = state->controls->max_iops;
+        if (max_iops > 0) printf(" | IOPS: %llu", (unsigned long long)max_iops);
+        if (state->controls->idle_priority) printf(" | idle I/O");
+        if (state->paused) {
+            style_set_fg(COLOR_BRIGHT_YELLOW);
+            printf(" | paused: foreground I/O");
+            style_reset();
+        } else if (state->depth_limit > 0) {
+            printf(" | yielding: QD %u", state->depth_limit);
+        }
+        printf("   (SIGUSR1 slower, SIGUSR2 faster)   \n");
+    }
+
+    // Heatmap do disco inteiro, montado do nível do mapa que cabe na largura.
+    if (state->latency_map) {
+        latency_cell_t cells[UI_HEATMAP_MAX_COLUMNS];
+        unsigned columns = (unsigned)(bar_width > 0 ? bar_width : 1);
+        if (columns > UI_HEATMAP_MAX_COLUMNS) columns = UI_HEATMAP_MAX_COLUMNS;
+        if (latency_map_render(state->latency_map, 0, UINT64_MAX, cells, columns) == 0) {
+            printf("\n[");
+            for (unsigned i = 0; i < columns; ++i) ui_heat_cell(&cells[i]);
+            printf("] latency\n");
+        }
+    }
+
     fflush(stdout);
 }
 
@@ -147,6 +213,59 @@ void display_drive_list(const DriveInfo* drives, int count) {
     printf("\n");
 }
 
+// Setores inconsistentes mostrados no relatório do terminal; o JSON tem a lista toda.
+#define UI_MISMATCH_SHOWN 16
+
+static void ui_print_mismatch(const bad_extent_t* extent, void* user_data) {
+    uint64_t* shown = (uint64_t*)user_data;
+    if (*shown >= UI_MISMATCH_SHOWN) return;
+    (*shown)++;
+    style_set_fg(COLOR_RED);
+    if (extent->count == 1) {
+        printf("|     LBA %llu\n", (unsigned long long)extent->lba);
+    } else {
+        printf("|     LBA %llu-%llu (%llu sectors)\n", (unsigned long long)extent->lba,
+               (unsigned long long)(extent->lba + extent->count - 1), (unsigned long long)extent->count);
+    }
+    style_reset();
+}
+
+// Classe predominante de cada região: '0' zerada, 'F' 0xFF, 'p' padrão, '#' dados, ' ' não lida.
+static void ui_display_content_map(const scan_content_map_t* map) {
+    uint64_t totals[SCAN_CONTENT_CLASSES];
+    scan_content_totals(map, totals);
+    uint64_t classified = 0;
+    for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) classified += totals[c];
+    if (classified == 0) return;
+
+    printf("| ");
+    style_set_bold();
+    printf("What the Blocks Hold:\n");
+    style_reset();
+    printf("|   ");
+    for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+        printf("%s%s %.1f%%", c ? ", " : "", scan_content_class_name((scan_content_class_t)c), totals[c] * 100.0 / classified);
+    }
+    printf(" of %.1f MiB read\n", classified / (1024.0 * 1024.0));
+
+    static const char cell[SCAN_CONTENT_CLASSES] = { '0', 'F', 'p', '#' };
+    printf("|   [");
+    for (unsigned r = 0; r < SCAN_CONTENT_REGIONS; ++r) {
+        unsigned best = SCAN_CONTENT_CLASSES;
+        uint64_t best_bytes = 0;
+        for (unsigned c = 0; c < SCAN_CONTENT_CLASSES; ++c) {
+            if (map->bytes[r][c] > best_bytes) {
+                best_bytes = map->bytes[r][c];
+                best = c;
+            }
+        }
+        putchar(best < SCAN_CONTENT_CLASSES ? cell[best] : ' ');
+    }
+    printf("]\n");
+    printf("|   '0' zeroed, 'F' all 0xFF, 'p' repeating pattern, '#' data, ' ' not read.\n");
+    printf("|\n");
+}
+
 void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* drive_info) {
     if (!state || !drive_info) return;
 
@@ -177,6 +296,10 @@ void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* dri
     printf("| ");
     style_set_fg(COLOR_CYAN);
     printf("The Oracle peered at %llu sectors of the digital ether.\n", state->scanned_blocks);
+    if (state->allocated_bytes > 0) {
+        printf("| ");
+        printf("Only the %.1f MiB held by files were read; free space was left in peace.\n", state->allocated_bytes / (1024.0 * 1024.0));
+    }
     style_reset();
     printf("|\n");
     
@@ -186,7 +309,11 @@ void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* dri
     style_reset();
 
     printf("|   ");
-    if (state->bad_blocks > 0) {
+    if (state->bad_sectors > 0) {
+        style_set_fg(COLOR_BRIGHT_RED);
+        printf("> %llu sectors in %llu region(s) have succumbed to the creeping decay.\n",
+               (unsigned long long)state->bad_sectors, (unsigned long long)state->bad_extents);
+    } else if (state->bad_blocks > 0) {
         style_set_fg(COLOR_BRIGHT_RED);
         printf("> %llu sectors have succumbed to the creeping decay.\n", state->bad_blocks);
     } else {
@@ -194,15 +321,79 @@ void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* dri
         printf("> 0 sectors were found to be lost to the void.\n");
     }
     style_reset();
+    if (state->index_incomplete) {
+        printf("|   ");
+        style_set_fg(COLOR_BRIGHT_YELLOW);
+        printf("> Memory ran out: the saved sector lists are incomplete; the counts above are not.\n");
+        style_reset();
+    }
     printf("|\n");
 
+    // Scan por amostragem: extrapola a taxa de blocos ruins para o disco inteiro.
+    if (state->population_blocks > 0 && state->scanned_blocks > 0) {
+        double low, high;
+        double rate = (double)state->bad_blocks / state->scanned_blocks;
+        scan_sampling_interval(state->bad_blocks, state->scanned_blocks, state->confidence, &low, &high);
+        printf("|   ");
+        style_set_fg(state->bad_blocks > 0 ? COLOR_BRIGHT_YELLOW : COLOR_CYAN);
+        printf("> %llu of %llu blocks sampled: est. bad-block rate %.4f%% (%.4g%% CI %.4f%% - %.4f%%)\n",
+               (unsigned long long)state->scanned_blocks, (unsigned long long)state->population_blocks,
+               rate * 100.0, state->confidence * 100.0, low * 100.0, high * 100.0);
+        printf("|   ");
+        printf("  i.e. at most ~%.0f unreadable blocks of %u bytes on the whole device.\n",
+               high * (double)state->population_blocks, state->block_size);
+        style_reset();
+        printf("|\n");
+    }
+
+    // Verificação: setores que devolveram dados diferentes nas duas leituras.
+    if (state->verify) {
+        printf("|   ");
+        if (state->mismatch_sectors > 0) {
+            style_set_fg(COLOR_BRIGHT_RED);
+            printf("> %llu sectors in %llu region(s) spoke two different truths when read twice.\n",
+                   (unsigned long long)state->mismatch_sectors, (unsigned long long)state->mismatch_extents);
+            style_reset();
+            uint64_t shown = 0;
+            bad_extent_index_foreach(state->mismatch_index, ui_print_mismatch, &shown);
+            if (state->mismatch_extents > shown) {
+                printf("|     ... and %llu more region(s).\n", (unsigned long long)(state->mismatch_extents - shown));
+            }
+        } else {
+            style_set_fg(COLOR_BRIGHT_GREEN);
+            printf("> Every block read twice gave the same answer.\n");
+        }
+        style_reset();
+        printf("|\n");
+    }
+
+    if (state->content_map) {
+        ui_display_content_map(state->content_map);
+    }
+
+    ui_display_scan_latency(&state->latency);
+
+    uint64_t mapped_bytes = latency_map_device_size(state->latency_map);
+    uint32_t map_sector = latency_map_sector_size(state->latency_map);
+    if (mapped_bytes > 0 && map_sector > 0) {
+        latency_cell_t cells[UI_HEATMAP_MAX_COLUMNS];
+        if (latency_map_render(state->latency_map, 0, mapped_bytes, cells, UI_HEATMAP_MAX_COLUMNS) == 0) {
+            printf("| ");
+            style_set_bold();
+            printf("Map of the Surface (worst read latency, by starting LBA):\n");
+            style_reset();
+            uint64_t lbas = mapped_bytes / map_sector;
+            ui_display_latency_heatmap(cells, UI_HEATMAP_MAX_COLUMNS, 0, (lbas + UI_HEATMAP_MAX_COLUMNS - 1) / UI_HEATMAP_MAX_COLUMNS);
+        }
+    }
+
     printf("| ");
     style_set_bold();
     printf("Final Verdict:\n");
     style_reset();
 
     printf("|   ");
-    if (state->bad_blocks > 0) {
+    if (state->bad_blocks > 0 || state->mismatch_blocks > 0) {
         style_set_fg(COLOR_BRIGHT_YELLOW);
         printf("A shadow looms over this disk-spirit. Heed this warning.\n");
     } else {
@@ -218,6 +409,422 @@ void ui_display_scan_report(const scan_state_t* state, const BasicDriveInfo* dri
     // O menu que chama esta função (run_surface_scan_interactive) agora é responsável pela pausa.
 }
 
+// Formata uma latência em µs com a unidade mais legível.
+static void ui_format_latency(uint64_t us, char* out, size_t out_size) {
+    if (us >= 1000000) {
+        snprintf(out, out_size, "%.2f s", us / 1e6);
+    } else if (us >= 1000) {
+        snprintf(out, out_size, "%.1f ms", us / 1e3);
+    } else {
+        snprintf(out, out_size, "%llu us", (unsigned long long)us);
+    }
+}
+
+void ui_display_scan_latency(const scan_latency_t* latency) {
+    uint64_t total = 0;
+    for (int i = 0; i < SCAN_TIER_COUNT; ++i) total += latency->tiers[i];
+    if (total == 0) return;
+
+    printf("| ");
+    style_set_bold();
+    printf("Whispers of Latency (per block read):\n");
+    style_reset();
+
+    for (int tier = 0; tier < SCAN_TIER_COUNT; ++tier) {
+        uint64_t count = latency->tiers[tier];
+        // Barra em escala logarítmica: uma leitura lenta entre milhões ainda aparece.
+        int bar = 0;
+        for (uint64_t v = count; v > 0; v /= 10) bar += 3;
+
+        printf("|   %-8s %12llu  ", scan_latency_tier_label((scan_latency_tier_t)tier), (unsigned long long)count);
+        if (tier <= SCAN_TIER_20MS) style_set_fg(COLOR_GREEN);
+        else if (tier <= SCAN_TIER_150MS) style_set_fg(COLOR_YELLOW);
+        else style_set_fg(COLOR_BRIGHT_RED);
+        for (int i = 0; i < bar; ++i) printf("#");
+        style_reset();
+        printf("\n");
+    }
+
+    if (latency->count > 0) {
+        char p50[16], p99[16], p999[16], max[16];
+        ui_format_latency(scan_latency_percentile_us(latency, 50.0), p50, sizeof(p50));
+        ui_format_latency(scan_latency_percentile_us(latency, 99.0), p99, sizeof(p99));
+        ui_format_latency(scan_latency_percentile_us(latency, 99.9), p999, sizeof(p999));
+        ui_format_latency(latency->max_us, max, sizeof(max));
+        printf("|   p50 %s | p99 %s | p99.9 %s | max %s\n", p50, p99, p999, max);
+    }
+
+    uint64_t slow = latency->tiers[SCAN_TIER_500MS] + latency->tiers[SCAN_TIER_SLOW];
+    if (slow > 0) {
+        printf("|   ");
+        style_set_fg(COLOR_BRIGHT_YELLOW);
+        printf("> %llu block(s) answered only after 150 ms: the surface is weakening there.\n", (unsigned long long)slow);
+        style_reset();
+    }
+    printf("|\n");
+}
+
+void ui_display_latency_heatmap(const latency_cell_t* cells, unsigned count, uint64_t first_lba, uint64_t lbas_per_cell) {
+    if (!cells || count == 0) return;
+    for (unsigned row = 0; row < count; row += UI_HEATMAP_ROW) {
+        printf("|   %14llu ", (unsigned long long)(first_lba + row * lbas_per_cell));
+        for (unsigned i = row; i < count && i < row + UI_HEATMAP_ROW; ++i) ui_heat_cell(&cells[i]);
+        printf("\n");
+    }
+    printf("|   ");
+    for (int tier = 0; tier < SCAN_TIER_COUNT; ++tier) {
+        style_set_bg(ui_heat_colors[tier]);
+        printf(" ");
+        style_reset();
+        printf(" %s  ", scan_latency_tier_label((scan_latency_tier_t)tier));
+    }
+    printf("\n|\n");
+}
+
+void ui_display_bad_extents(const bad_extent_t* extents, size_t shown, uint64_t total, uint32_t sector_size) {
+    if (!extents || total == 0) return;
+
+    printf("\n");
+    style_set_bold();
+    printf("Unreadable sectors (LBA, %u-byte sectors):\n", sector_size);
+    style_reset();
+
+    for (size_t i = 0; i < shown; ++i) {
+        style_set_fg(COLOR_RED);
+        if (extents[i].count == 1) {
+            printf("  %llu\n", (unsigned long long)extents[i].lba);
+        } else {
+            printf("  %llu-%llu (%llu sectors)\n", (unsigned long long)extents[i].lba,
+                   (unsigned long long)(extents[i].lba + extents[i].count - 1), (unsigned long long)extents[i].count);
+        }
+        style_reset();
+    }
+    if (total > shown) {
+        printf("  ... and %llu more region(s).\n", (unsigned long long)(total - shown));
+    }
+}
+
+// Trechos listados no terminal; o relatório JSON traz até SCAN_FILEMAP_MAX_HITS.
+#define UI_MAX_FILE_HITS 16
+
+void ui_display_file_damage(const scan_file_damage_t* damage) {
+    if (!damage) return;
+
+    printf("\n");
+    style_set_bold();
+    printf("Files on the damaged sectors (%s):\n", damage->fs_path);
+    style_reset();
+    if (damage->status != PAL_STATUS_SUCCESS) {
+        style_set_fg(COLOR_MAGENTA);
+        printf("  Could not map the files: %s\n", pal_get_error_string(damage->status));
+        style_reset();
+        return;
+    }
+    if (damage->total_hits == 0) {
+        printf("  No file is stored on them.\n");
+    }
+
+    size_t shown = damage->hit_count < UI_MAX_FILE_HITS ? damage->hit_count : UI_MAX_FILE_HITS;
+    for (size_t i = 0; i < shown; ++i) {
+        const scan_file_hit_t* hit = &damage->hits[i];
+        style_set_fg(hit->kind == SCAN_DAMAGE_UNREADABLE ? COLOR_RED : COLOR_BRIGHT_YELLOW);
+        printf("  LBA %llu", (unsigned long long)hit->lba);
+        if (hit->sectors > 1) printf("-%llu", (unsigned long long)(hit->lba + hit->sectors - 1));
+        printf(" %s: %s at byte %llu\n", scan_damage_kind_name(hit->kind), scan_file_damage_path(damage, hit),
+               (unsigned long long)hit->file_offset);
+        style_reset();
+    }
+    if (damage->total_hits > shown) {
+        printf("  ... and %llu more (see the JSON report).\n", (unsigned long long)(damage->total_hits - shown));
+    }
+    if (damage->total_hits > 0) {
+        printf("  %llu file(s), %.1f KiB of file data affected.\n", (unsigned long long)damage->files, damage->bytes / 1024.0);
+    }
+    if (damage->unmapped_sectors > 0) {
+        printf("  %llu sector(s) outside any file (free space or filesystem metadata).\n", (unsigned long long)damage->unmapped_sectors);
+    }
+}
+
+// Uma linha por dispositivo: barra curta, velocidade, erros e estado do job.
+void ui_draw_scan_dashboard(const scan_job_t* jobs, size_t count) {
+    size_t running = 0, finished = 0;
+    double total_speed = 0.0;
+    uint64_t total_bad = 0;
+
+    printf("\x1b[H");
+    style_set_bold();
+    printf("DiskOracle v1.0 - Surface Scan (%zu devices)\x1b[K\n", count);
+    style_reset();
+    printf("\x1b[K\n");
+
+    for (size_t i = 0; i < count; ++i) {
+        scan_state_t state;
+        scan_job_status_t status;
+        scan_job_snapshot(&jobs[i], &state, &status);
+
+        double fraction = state.total_blocks > 0 ? (double)state.scanned_blocks / state.total_blocks : 0.0;
+        if (status == SCAN_JOB_DONE) fraction = 1.0;
+        int filled = (int)(fraction * 24);
+
+        printf("%-18.18s %-20.20s [", jobs[i].device_path, jobs[i].drive_info.model);
+        style_set_bg(status == SCAN_JOB_FAILED ? COLOR_RED : COLOR_GREEN);
+        for (int c = 0; c < filled; ++c) printf(" ");
+        style_reset();
+        for (int c = filled; c < 24; ++c) printf(" ");
+        printf("] %5.1f%% ", fraction * 100.0);
+
+        if (status == SCAN_JOB_RUNNING) {
+            printf("%7.1f MB/s ", state.current_speed_mbps);
+            total_speed += state.current_speed_mbps;
+            running++;
+        } else {
+            printf("%12s ", "");
+        }
+        if (status == SCAN_JOB_DONE || status == SCAN_JOB_FAILED) finished++;
+
+        if (state.bad_blocks > 0) style_set_fg(COLOR_RED);
+        printf("%6llu bad ", (unsigned long long)state.bad_blocks);
+        style_reset();
+        total_bad += state.bad_blocks;
+
+        if (status == SCAN_JOB_FAILED) style_set_fg(COLOR_BRIGHT_RED);
+        else if (status == SCAN_JOB_PENDING) style_set_fg(COLOR_DIM);
+        printf("%s", scan_job_status_name(status));
+        style_reset();
+        printf("\x1b[K\n");
+    }
+
+    printf("\x1b[K\n");
+    printf(" Running: ");
+    style_set_bold();
+    printf("%zu", running);
+    style_reset();
+    printf(" | Finished: ");
+    style_set_bold();
+    printf("%zu/%zu", finished, count);
+    style_reset();
+    printf(" | Total: ");
+    style_set_bold();
+    printf("%.1f MB/s", total_speed);
+    style_reset();
+    printf(" | Bad blocks: ");
+    style_set_bold();
+    if (total_bad > 0) style_set_fg(COLOR_RED);
+    printf("%llu", (unsigned long long)total_bad);
+    style_reset();
+    printf("\x1b[K\n");
+    fflush(stdout);
+}
+
+void ui_display_scan_summary(const scan_job_t* jobs, size_t count) {
+    printf("\n");
+    style_set_fg(COLOR_MAGENTA);
+    printf("+-----------------------------------------------------------------------------+\n");
+    printf("|                    The Oracle's Divination, Drive by Drive                  |\n");
+    printf("+-----------------------------------------------------------------------------+\n");
+    style_reset();
+
+    style_set_bold();
+    printf("%-18s %-20s %-8s %12s %10s %10s  %s\n", "Device", "Model", "Status", "Blocks read", "Bad", "p99", "Verdict");
+    style_reset();
+
+    size_t healthy = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const scan_job_t* job = &jobs[i];
+        const scan_state_t* state = &job->state;
+        char p99[32];
+        ui_format_latency(scan_latency_percentile_us(&state->latency, 99.0), p99, sizeof(p99));
+
+        printf("%-18.18s %-20.20s %-8s %12llu ", job->device_path, job->drive_info.model,
+               scan_job_status_name(job->status), (unsigned long long)state->scanned_blocks);
+        if (state->bad_blocks > 0) style_set_fg(COLOR_RED);
+        printf("%10llu ", (unsigned long long)state->bad_blocks);
+        style_reset();
+        printf("%10s  ", state->latency.count > 0 ? p99 : "-");
+
+        if (job->status != SCAN_JOB_DONE) {
+            style_set_fg(COLOR_BRIGHT_YELLOW);
+            printf("incomplete\n");
+        } else if (state->bad_blocks > 0 || state->latency.tiers[SCAN_TIER_SLOW] > 0) {
+            style_set_fg(COLOR_BRIGHT_RED);
+            printf("shadowed\n");
+        } else {
+            style_set_fg(COLOR_BRIGHT_GREEN);
+            printf("vigorous\n");
+            healthy++;
+        }
+        style_reset();
+    }
+
+    printf("\n%zu of %zu disk-spirits appear vigorous and untainted.\n", healthy, count);
+}
+
+// Idade da cobertura em dias: um dígito até 9, '+' acima disso.
+static void ui_patrol_cell(int64_t age) {
+    if (age < 0) {
+        printf(".");
+        return;
+    }
+    int64_t days = age / 86400;
+    if (days < 2) style_set_fg(COLOR_BRIGHT_GREEN);
+    else if (days < 7) style_set_fg(COLOR_BRIGHT_YELLOW);
+    else style_set_fg(COLOR_BRIGHT_RED);
+    if (days > 9) printf("+");
+    else printf("%d", (int)days);
+    style_reset();
+}
+
+void ui_display_patrol_coverage(const scan_patrol_t* patrol, int64_t now) {
+    if (!patrol || patrol->device_size == 0) return;
+
+    printf("\n");
+    style_set_bold();
+    printf("Patrol coverage (days since each 1/%d of the disk was read):\n", SCAN_PATROL_REGIONS);
+    style_reset();
+
+    unsigned cursor_region = SCAN_PATROL_REGIONS;
+    for (unsigned r = 0; r < SCAN_PATROL_REGIONS; ++r) {
+        if (patrol->cursor < scan_patrol_region_start(patrol, r + 1)) {
+            cursor_region = r;
+            break;
+        }
+    }
+
+    printf("  [");
+    for (unsigned r = 0; r < SCAN_PATROL_REGIONS; ++r) {
+        ui_patrol_cell(scan_patrol_region_age(patrol, r, now));
+    }
+    printf("]\n   ");
+    for (unsigned r = 0; r < cursor_region && r < SCAN_PATROL_REGIONS; ++r) printf(" ");
+    printf("^ next run starts here\n");
+    printf("  0-9 days, '+' older, '.' not read yet. Full passes: %llu\n", (unsigned long long)patrol->passes);
+}
+
+void ui_draw_transfer_curve(const scan_profile_t* profile, const scan_profile_t* baseline) {
+    if (!profile || profile->zone_count == 0) return;
+    if (baseline && baseline->measured == 0) baseline = NULL;
+
+    int term_width, term_height;
+    if (pal_get_terminal_size(&term_width, &term_height) != PAL_STATUS_SUCCESS) {
+        term_width = 80;
+    }
+    // Até três colunas por zona quando cabem, para a curva não ficar espremida.
+    int cell = (term_width - 12) / (int)profile->zone_count;
+    if (cell > 3) cell = 3;
+    if (cell < 1) cell = 1;
+
+    double expected[SCAN_PROFILE_MAX_ZONES];
+    double top = 0.0;
+    for (unsigned z = 0; z < profile->zone_count; ++z) {
+        expected[z] = baseline ? scan_profile_rate_at(baseline, scan_profile_zone_position(profile, z)) : 0.0;
+        if (expected[z] > top) top = expected[z];
+        if (z < profile->measured && profile->zones[z].mbps > top) top = profile->zones[z].mbps;
+    }
+    if (top <= 0.0) top = 1.0;
+    top *= 1.05;
+
+    printf("\n");
+    style_set_bold();
+    printf("Transfer rate by zone (MB/s, outer to inner tracks):\n");
+    style_reset();
+
+    // Uma linha por faixa de taxa, de cima para baixo; a zona preenche as faixas abaixo da sua taxa.
+    for (int row = UI_CURVE_ROWS - 1; row >= 0; --row) {
+        double low = top * row / UI_CURVE_ROWS;
+        double high = top * (row + 1) / UI_CURVE_ROWS;
+        printf("%7.0f |", high);
+        for (unsigned z = 0; z < profile->zone_count; ++z) {
+            bool measured = z < profile->measured;
+            double rate = measured ? profile->zones[z].mbps : 0.0;
+            bool marker = baseline && expected[z] >= low && expected[z] < high;
+            if (measured && rate > low) {
+                bool slow = baseline && expected[z] > 0.0 && rate < expected[z] * (1.0 - SCAN_PROFILE_SLOW_PERCENT / 100.0);
+                if (profile->zones[z].bad_sectors > 0) style_set_fg(COLOR_BRIGHT_RED);
+                else style_set_fg(slow ? COLOR_BRIGHT_YELLOW : COLOR_GREEN);
+                for (int c = 0; c < cell; ++c) printf(marker ? "=" : "#");
+                style_reset();
+            } else if (marker) {
+                style_set_fg(COLOR_BRIGHT_BLACK);
+                for (int c = 0; c < cell; ++c) printf("-");
+                style_reset();
+            } else {
+                printf("%*s", cell, "");
+            }
+        }
+        printf("\n");
+    }
+    printf("        +");
+    for (unsigned z = 0; z < profile->zone_count * (unsigned)cell; ++z) printf("-");
+    printf("\n         0%%%*s\n", (int)(profile->zone_count * (unsigned)cell) - 2, "100%");
+    if (baseline) {
+        printf("  '-' baseline (%s), yellow: more than %.0f%% below it, red: zone with bad sectors\n",
+               baseline->model[0] ? baseline->model : "same model", SCAN_PROFILE_SLOW_PERCENT);
+    }
+}
+
+// Tamanho de bloco curto para as tabelas: 4K, 64K, 1M.
+static void ui_format_block_size(uint32_t bytes, char* out, size_t out_size) {
+    if (bytes >= 1024 * 1024 && bytes % (1024 * 1024) == 0) snprintf(out, out_size, "%uM", bytes / (1024 * 1024));
+    else if (bytes >= 1024 && bytes % 1024 == 0) snprintf(out, out_size, "%uK", bytes / 1024);
+    else snprintf(out, out_size, "%u", bytes);
+}
+
+void ui_display_benchmark(const scan_bench_result_t* results, size_t count) {
+    printf("\n");
+    style_set_bold();
+    printf("%-10s %6s %5s %11s %10s %10s %10s %10s %8s\n", "Pattern", "Block", "QD", "IOPS", "MB/s", "p50", "p99", "p99.9", "Errors");
+    style_reset();
+
+    for (size_t i = 0; i < count; ++i) {
+        const scan_bench_result_t* r = &results[i];
+        char block[16], p50[32], p99[32], p999[32];
+        ui_format_block_size(r->config.block_size, block, sizeof(block));
+        ui_format_latency(r->p50_us, p50, sizeof(p50));
+        ui_format_latency(r->p99_us, p99, sizeof(p99));
+        ui_format_latency(r->p999_us, p999, sizeof(p999));
+        printf("%-10s %6s %5u %11.0f %10.1f %10s %10s %10s ", scan_bench_pattern_name(r->config.pattern), block,
+               r->config.queue_depth, r->iops, r->mbps, p50, p99, p999);
+        if (r->errors > 0) style_set_fg(COLOR_RED);
+        printf("%8llu", (unsigned long long)r->errors);
+        style_reset();
+        // Sem io_uring a fila vem de workers síncronos, até o limite deles.
+        if (r->threads > 1) printf("  (%u threads)", r->threads);
+        printf("\n");
+    }
+}
+
+void ui_display_tune_result(const scan_tune_result_t* result) {
+    if (!result) return;
+    const pal_queue_limits_t* limits = &result->limits;
+    char max_transfer[16] = "unknown", mdts[16];
+    if (limits->max_transfer_bytes > 0) ui_format_block_size(limits->max_transfer_bytes, max_transfer, sizeof(max_transfer));
+    printf("Queue limits: max transfer %s, sectors %u/%u, nr_requests ", max_transfer,
+           limits->logical_block_size, limits->physical_block_size);
+    if (limits->nr_requests > 0) printf("%u", limits->nr_requests);
+    else printf("unknown");
+    printf(", %s", limits->rotational == 1 ? "rotational" : limits->rotational == 0 ? "non-rotational" : "rotation unknown");
+    if (limits->nvme_mdts_bytes > 0) {
+        ui_format_block_size(limits->nvme_mdts_bytes, mdts, sizeof(mdts));
+        printf(", NVMe MDTS %s", mdts);
+    }
+    printf("\n\n");
+
+    style_set_bold();
+    printf("%6s %5s %11s %10s\n", "Block", "QD", "IOPS", "MB/s");
+    style_reset();
+    for (unsigned i = 0; i < result->probe_count; ++i) {
+        const scan_tune_probe_t* p = &result->probes[i];
+        char block[16];
+        ui_format_block_size(p->block_size, block, sizeof(block));
+        bool chosen = i == result->chosen;
+        if (chosen) style_set_fg(COLOR_GREEN);
+        printf("%6s %5u %11.0f %10.1f%s\n", block, p->queue_depth, p->iops, p->mbps, chosen ? "  <- chosen" : "");
+        if (chosen) style_reset();
+    }
+    // Sem io_uring as leituras saem uma a uma por worker e a fila não muda nada.
+    if (!result->async) printf("Queue depth not tuned: reads are synchronous on this engine.\n");
+}
+
 /**
  * @brief Imprime uma mensagem de uso curta para comandos inválidos.
  */
@@ -0,0 +1,415 @@
+// Benchmark do scan de superfície: roda surface_scan_ex() numa matriz de
+// tamanhos de bloco, padrões de acesso e modos de cache sobre um arquivo
+// (servido pelo backend simulado, sem latência nem falhas) e escreve um
+// resultado por combinação em JSON ou CSV, para comparar versões.
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // O_DIRECT
+#endif
+
+#include "surface.h"
+#include "pal.h"
+#include "pal_sim.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#define BENCH_MAX_BLOCK_SIZES 16
+#define BENCH_MAX_RUNS 64
+#define BENCH_DEFAULT_SIZE (256ull * 1024 * 1024)
+#define BENCH_DEFAULT_SAMPLES 8192
+#define BENCH_DEFAULT_THREADS 4
+
+typedef enum {
+    BENCH_SEQUENTIAL,   // scan profundo, um worker
+    BENCH_PARALLEL,     // scan profundo dividido entre threads workers
+    BENCH_RANDOM,       // scan rápido: blocos sorteados por estrato
+    BENCH_PATTERN_COUNT
+} bench_pattern_t;
+
+static const char* const bench_pattern_names[BENCH_PATTERN_COUNT] = { "sequential", "parallel", "random" };
+
+typedef struct {
+    const char* image;
+    char generated[512];
+    const char* dir;
+    uint64_t size;
+    uint32_t block_sizes[BENCH_MAX_BLOCK_SIZES];
+    int block_size_count;
+    bool patterns[BENCH_PATTERN_COUNT];
+    bool buffered;
+    bool direct;
+    bool warm;
+    unsigned threads;
+    uint64_t samples;
+    int runs;
+    bool csv;
+    const char* output;
+} bench_config_t;
+
+typedef struct {
+    double seconds;
+    double cpu_seconds;
+    uint64_t bytes;
+    uint64_t reads;
+    double mbps;
+    double iops;
+    double cpu_per_gb;
+    uint64_t p50_us, p90_us, p99_us, p999_us, max_us;
+    double mean_us;
+} bench_result_t;
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double bench_cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+}
+
+static bool bench_parse_size(const char* text, uint64_t* out) {
+    char* end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || errno != 0) return false;
+    switch (*end) {
+        case '\0': break;
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: return false;
+    }
+    if (*end != '\0' || value == 0) return false;
+    *out = value;
+    return true;
+}
+
+static bool bench_parse_list(char* list, bench_config_t* config, bool block_sizes) {
+    char* save = NULL;
+    for (char* item = strtok_r(list, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (block_sizes) {
+            uint64_t size = 0;
+            if (!bench_parse_size(item, &size) || size % 512 != 0 || size > SCAN_MAX_BLOCK_SIZE ||
+                config->block_size_count >= BENCH_MAX_BLOCK_SIZES) {
+                return false;
+            }
+            config->block_sizes[config->block_size_count++] = (uint32_t)size;
+            continue;
+        }
+        int found = -1;
+        for (int p = 0; p < BENCH_PATTERN_COUNT; p++) {
+            if (strcasecmp(item, bench_pattern_names[p]) == 0) found = p;
+        }
+        if (found < 0) return false;
+        config->patterns[found] = true;
+    }
+    return true;
+}
+
+static void bench_usage(void) {
+    fprintf(stderr,
+            "Usage: diskoracle_bench [--image FILE | --dir DIR --size N] [--block-sizes 4K,64K,1M]\n"
+            "                        [--patterns sequential,parallel,random] [--cache buffered,direct]\n"
+            "                        [--threads N] [--samples N] [--runs N] [--warm] [--format json|csv] [--output FILE]\n");
+}
+
+// Arquivo de teste com dados pseudoaleatórios: zeros seriam comprimidos ou
+// deduplicados por alguns sistemas de arquivos e distorceriam a medida.
+static int bench_create_image(bench_config_t* config) {
+    snprintf(config->generated, sizeof(config->generated), "%s/diskoracle_bench_XXXXXX", config->dir);
+    int fd = mkstemp(config->generated);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not create the test image in %s: %s\n", config->dir, strerror(errno));
+        return 1;
+    }
+    enum { CHUNK = 1024 * 1024 };
+    uint64_t* chunk = malloc(CHUNK);
+    if (!chunk) {
+        close(fd);
+        return 1;
+    }
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t written = 0; written < config->size; ) {
+        for (size_t i = 0; i < CHUNK / sizeof(uint64_t); i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            chunk[i] = x;
+        }
+        size_t len = config->size - written < CHUNK ? (size_t)(config->size - written) : CHUNK;
+        if (write(fd, chunk, len) != (ssize_t)len) {
+            fprintf(stderr, "Error: Could not write the test image: %s\n", strerror(errno));
+            free(chunk);
+            close(fd);
+            unlink(config->generated);
+            return 1;
+        }
+        written += len;
+    }
+    free(chunk);
+    fsync(fd);
+    close(fd);
+    config->image = config->generated;
+    return 0;
+}
+
+// Tira a imagem do page cache, para toda rodada começar fria.
+static void bench_evict(const char* image) {
+    int fd = open(image, O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+static bool bench_direct_supported(const char* image) {
+#ifdef O_DIRECT
+    int fd = open(image, O_RDONLY | O_DIRECT);
+    if (fd >= 0) {
+        close(fd);
+        return true;
+    }
+#endif
+    return false;
+}
+
+static int bench_run(const bench_config_t* config, bench_pattern_t pattern, uint32_t block_size, bool direct, bench_result_t* out) {
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    opts.engine = SCAN_ENGINE_SYNC;
+    opts.direct_io = direct;
+    opts.block_size = block_size;
+    if (pattern == BENCH_RANDOM) {
+        opts.mode = "quick";
+        opts.samples = config->samples;
+        opts.sample_seed = 1;   // mesma amostra em toda rodada
+    } else {
+        opts.mode = "deep";
+        opts.threads = pattern == BENCH_PARALLEL ? config->threads : 1;
+    }
+
+    if (!config->warm) bench_evict(config->image);
+    scan_state_t state;
+    memset(&state, 0, sizeof(state));
+    double cpu0 = bench_cpu_seconds();
+    double t0 = bench_now();
+    int rc = surface_scan_ex(config->image, &opts, NULL, NULL, &state);
+    double seconds = bench_now() - t0;
+    double cpu = bench_cpu_seconds() - cpu0;
+    if (rc != 0 || state.bad_sectors != 0 || state.read_errors != 0) {
+        fprintf(stderr, "Error: %s scan of %s failed.\n", bench_pattern_names[pattern], config->image);
+        return 1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->seconds = seconds;
+    out->cpu_seconds = cpu;
+    out->reads = state.latency.count;
+    out->bytes = state.scanned_blocks * (uint64_t)state.block_size;
+    if (out->bytes > config->size) out->bytes = config->size;
+    if (seconds > 0) {
+        out->mbps = (double)out->bytes / (1024.0 * 1024.0) / seconds;
+        out->iops = (double)out->reads / seconds;
+    }
+    if (out->bytes > 0) {
+        out->cpu_per_gb = cpu / ((double)out->bytes / (1024.0 * 1024.0 * 1024.0));
+    }
+    out->p50_us = scan_latency_percentile_us(&state.latency, 50.0);
+    out->p90_us = scan_latency_percentile_us(&state.latency, 90.0);
+    out->p99_us = scan_latency_percentile_us(&state.latency, 99.0);
+    out->p999_us = scan_latency_percentile_us(&state.latency, 99.9);
+    out->max_us = state.latency.max_us;
+    out->mean_us = state.latency.count ? (double)state.latency.sum_us / (double)state.latency.count : 0.0;
+    return 0;
+}
+
+static int bench_compare_mbps(const void* a, const void* b) {
+    double x = ((const bench_result_t*)a)->mbps, y = ((const bench_result_t*)b)->mbps;
+    return (x > y) - (x < y);
+}
+
+static void bench_write_header(FILE* out, const bench_config_t* config) {
+    if (config->csv) {
+        fprintf(out, "pattern,cache,block_size,runs,bytes,reads,seconds,mbps,iops,cpu_s_per_gb,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us\n");
+        return;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"tool\": \"diskoracle_bench\",\n");
+    fprintf(out, "  \"version\": \"%s\",\n", PROJECT_VERSION);
+    fprintf(out, "  \"timestamp\": %lld,\n", (long long)time(NULL));
+    fprintf(out, "  \"image\": \"%s\",\n", config->image);
+    fprintf(out, "  \"sizeBytes\": %llu,\n", (unsigned long long)config->size);
+    fprintf(out, "  \"threads\": %u,\n", config->threads);
+    fprintf(out, "  \"coldCache\": %s,\n", config->warm ? "false" : "true");
+    fprintf(out, "  \"results\": [");
+}
+
+// Uma linha por combinação, com a rodada mediana (por MB/s).
+static void bench_write_result(FILE* out, const bench_config_t* config, bool first, bench_pattern_t pattern, bool direct,
+                               uint32_t block_size, int runs, const bench_result_t* r) {
+    const char* cache = direct ? "direct" : "buffered";
+    if (config->csv) {
+        fprintf(out, "%s,%s,%u,%d,%llu,%llu,%.6f,%.2f,%.1f,%.4f,%.1f,%llu,%llu,%llu,%llu,%llu\n",
+                bench_pattern_names[pattern], cache, block_size, runs, (unsigned long long)r->bytes, (unsigned long long)r->reads,
+                r->seconds, r->mbps, r->iops, r->cpu_per_gb, r->mean_us, (unsigned long long)r->p50_us, (unsigned long long)r->p90_us,
+                (unsigned long long)r->p99_us, (unsigned long long)r->p999_us, (unsigned long long)r->max_us);
+        return;
+    }
+    fprintf(out, "%s\n    {\"pattern\": \"%s\", \"cache\": \"%s\", \"blockSize\": %u, \"runs\": %d, \"bytes\": %llu, \"reads\": %llu, "
+                 "\"seconds\": %.6f, \"mbps\": %.2f, \"iops\": %.1f, \"cpuSecondsPerGB\": %.4f, "
+                 "\"latencyUs\": {\"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}}",
+            first ? "" : ",", bench_pattern_names[pattern], cache, block_size, runs, (unsigned long long)r->bytes, (unsigned long long)r->reads,
+            r->seconds, r->mbps, r->iops, r->cpu_per_gb, r->mean_us, (unsigned long long)r->p50_us, (unsigned long long)r->p90_us,
+            (unsigned long long)r->p99_us, (unsigned long long)r->p999_us, (unsigned long long)r->max_us);
+}
+
+int main(int argc, char* argv[]) {
+    bench_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.dir = "/var/tmp";    // /tmp costuma ser tmpfs, que não aceita O_DIRECT
+    config.size = BENCH_DEFAULT_SIZE;
+    config.threads = BENCH_DEFAULT_THREADS;
+    config.samples = BENCH_DEFAULT_SAMPLES;
+    config.runs = 3;
+    config.buffered = config.direct = true;
+    char cache_list[64] = "";
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = true;
+        if (strcmp(arg, "--warm") == 0) {
+            config.warm = true;
+            continue;
+        }
+        if (!value) {
+            ok = false;
+        } else if (strcmp(arg, "--image") == 0) {
+            config.image = value;
+        } else if (strcmp(arg, "--dir") == 0) {
+            config.dir = value;
+        } else if (strcmp(arg, "--size") == 0) {
+            ok = bench_parse_size(value, &config.size);
+        } else if (strcmp(arg, "--block-sizes") == 0) {
+            ok = bench_parse_list(argv[i + 1], &config, true);
+        } else if (strcmp(arg, "--patterns") == 0) {
+            ok = bench_parse_list(argv[i + 1], &config, false);
+        } else if (strcmp(arg, "--cache") == 0) {
+            snprintf(cache_list, sizeof(cache_list), "%s", value);
+        } else if (strcmp(arg, "--threads") == 0) {
+            config.threads = (unsigned)strtoul(value, NULL, 10);
+            ok = config.threads >= 1 && config.threads <= SCAN_MAX_THREADS;
+        } else if (strcmp(arg, "--samples") == 0) {
+            ok = bench_parse_size(value, &config.samples);
+        } else if (strcmp(arg, "--runs") == 0) {
+            config.runs = atoi(value);
+            ok = config.runs >= 1 && config.runs <= BENCH_MAX_RUNS;
+        } else if (strcmp(arg, "--format") == 0) {
+            config.csv = strcmp(value, "csv") == 0;
+            ok = config.csv || strcmp(value, "json") == 0;
+        } else if (strcmp(arg, "--output") == 0) {
+            config.output = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: Invalid argument '%s'.\n", arg);
+            bench_usage();
+            return 1;
+        }
+        i++;
+    }
+    if (cache_list[0] != '\0') {
+        config.buffered = strstr(cache_list, "buffered") != NULL;
+        config.direct = strstr(cache_list, "direct") != NULL;
+        if (!config.buffered && !config.direct) {
+            fprintf(stderr, "Error: --cache takes buffered, direct or both.\n");
+            return 1;
+        }
+    }
+    if (config.block_size_count == 0) {
+        static const uint32_t defaults[] = { 4096, 65536, 1024 * 1024 };
+        for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) config.block_sizes[config.block_size_count++] = defaults[i];
+    }
+    bool any_pattern = false;
+    for (int p = 0; p < BENCH_PATTERN_COUNT; p++) any_pattern |= config.patterns[p];
+    if (!any_pattern) {
+        for (int p = 0; p < BENCH_PATTERN_COUNT; p++) config.patterns[p] = true;
+    }
+
+    if (config.image) {
+        struct stat st;
+        if (stat(config.image, &st) != 0 || !S_ISREG(st.st_mode)) {
+            fprintf(stderr, "Error: %s is not a regular file.\n", config.image);
+            return 1;
+        }
+        config.size = (uint64_t)st.st_size;
+    } else if (bench_create_image(&config) != 0) {
+        return 1;
+    }
+
+    // O arquivo vira um dispositivo simulado sem latência nem falhas: a PAL
+    // responde tamanho, setores e filas, e cada leitura vai direto ao arquivo.
+    pal_sim_config_t device;
+    pal_sim_config_init(&device);
+    snprintf(device.image, sizeof(device.image), "%s", config.image);
+    device.queues = (int)config.threads;
+    int rc = 1;
+    if (pal_sim_register(config.image, &device) != PAL_STATUS_SUCCESS) {
+        fprintf(stderr, "Error: %s is too small to benchmark.\n", config.image);
+        goto cleanup;
+    }
+    if (config.direct && !bench_direct_supported(config.image)) {
+        fprintf(stderr, "Warning: the filesystem of %s does not support O_DIRECT; skipping direct runs.\n", config.image);
+        config.direct = false;
+        if (!config.buffered) goto cleanup;
+    }
+
+    FILE* out = config.output ? fopen(config.output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Could not open %s: %s\n", config.output, strerror(errno));
+        goto cleanup;
+    }
+    bench_write_header(out, &config);
+
+    rc = 0;
+    bool first = true;
+    for (int p = 0; p < BENCH_PATTERN_COUNT && rc == 0; p++) {
+        if (!config.patterns[p]) continue;
+        for (int c = 0; c < 2 && rc == 0; c++) {
+            bool direct = c == 1;
+            if ((direct && !config.direct) || (!direct && !config.buffered)) continue;
+            for (int b = 0; b < config.block_size_count && rc == 0; b++) {
+                uint32_t block_size = config.block_sizes[b];
+                bench_result_t runs[BENCH_MAX_RUNS];
+                for (int r = 0; r < config.runs && rc == 0; r++) {
+                    rc = bench_run(&config, (bench_pattern_t)p, block_size, direct, &runs[r]);
+                }
+                if (rc != 0) break;
+                qsort(runs, (size_t)config.runs, sizeof(runs[0]), bench_compare_mbps);
+                bench_write_result(out, &config, first, (bench_pattern_t)p, direct, block_size, config.runs, &runs[config.runs / 2]);
+                fflush(out);
+                first = false;
+            }
+        }
+    }
+    if (!config.csv) fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+
+cleanup:
+    pal_sim_reset();
+    if (config.generated[0] != '\0') unlink(config.generated);
+    return rc;
+}
@@ -1,14 +1,26 @@
 #include "../include/report.h"
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 int main() {
-    int r = report_generate("/dev/null", "json");
-    assert(r == 0);
-    r = report_generate("/dev/null", "xml");
+    struct smart_data data;
+    memset(&data, 0, sizeof(data));
+    data.drive_type = DRIVE_TYPE_ATA;
+    data.attr_count = 1;
+    data.data.attrs[0].id = 5;
+    data.data.attrs[0].value = 100;
+    data.data.attrs[0].worst = 100;
+    data.data.attrs[0].threshold = 10;
+
+    int r = report_generate("/dev/null", &data, "json", "test_report.json");
     assert(r == 0);
-    r = report_generate("/dev/null", "csv");
+    r = report_generate("/dev/null", &data, "txt", "test_report.txt");
     assert(r == 0);
+
+    // Sem dados S.M.A.R.T. o relatório é recusado.
+    r = report_generate("/dev/null", NULL, "json", "test_report_empty.json");
+    assert(r != 0);
     printf("test_report OK\n");
     return 0;
 }
@@ -0,0 +1,422 @@
+// Regressão do núcleo do scan sobre o backend simulado: falhas injetadas
+// (EIO, FLAKY e FLIP) têm de aparecer nos mesmos setores em toda ordem de
+// leitura, engine e número de threads; também confere a retomada de um scan
+// interrompido, as respostas de S.M.A.R.T. simuladas, a ida e volta dos
+// arquivos DOBX e DOSJ e as peças puras do scan (amostragem, ordens, mapa de
+// latência e mapeamento para arquivos).
+#include "surface.h"
+#include "pal.h"
+#include "pal_sim.h"
+#include "scan_journal.h"
+#include "scan_sampling.h"
+#include "latency_map.h"
+#include "scan_filemap.h"
+#include "smart.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_DEVICE "sim-test0"
+#define SIM_SIZE (256ull * 1024 * 1024)     // 524288 setores de 512 bytes
+
+static const pal_sim_fault_t faults[] = {
+    { 1000, 3, PAL_SIM_FAULT_EIO },
+    { 50000, 1, PAL_SIM_FAULT_FLAKY },      // a nova tentativa passa: não é setor ruim
+    { 65535, 2, PAL_SIM_FAULT_EIO },        // atravessa a fronteira entre blocos
+    { 300000, 1, PAL_SIM_FAULT_FLIP },      // só --verify percebe
+    { 524287, 1, PAL_SIM_FAULT_EIO },       // último setor do disco
+};
+#define EXPECTED_BAD_SECTORS 6
+#define EXPECTED_BAD_EXTENTS 3
+
+// Registra o disco de novo antes de cada scan: as falhas alternadas recomeçam.
+// read_latency_us > 0 faz as leituras do último quarto do disco demorarem: o
+// orçamento de tempo para o scan ali, depois do FLIP e antes do último setor ruim.
+static void register_device(pal_sim_bus_t bus, uint32_t read_latency_us) {
+    pal_sim_config_t config;
+    pal_sim_config_init(&config);
+    config.bus = bus;
+    config.size = SIM_SIZE;
+    config.oncs = 0x80;
+    memcpy(config.faults, faults, sizeof(faults));
+    config.fault_count = sizeof(faults) / sizeof(faults[0]);
+    if (read_latency_us > 0) {
+        config.regions[0] = (pal_sim_region_t){ SIM_SIZE / 4 * 3, SIM_SIZE, read_latency_us, 0.0 };
+        config.region_count = 1;
+    }
+    assert(pal_sim_register(SIM_DEVICE, &config) == PAL_STATUS_SUCCESS);
+}
+
+static void check_bad_index(const bad_extent_index_t* index) {
+    assert(bad_extent_index_sectors(index) == EXPECTED_BAD_SECTORS);
+    assert(bad_extent_index_extents(index) == EXPECTED_BAD_EXTENTS);
+    assert(bad_extent_index_contains(index, 1000) && bad_extent_index_contains(index, 1002));
+    assert(!bad_extent_index_contains(index, 999) && !bad_extent_index_contains(index, 1003));
+    assert(bad_extent_index_contains(index, 65535) && bad_extent_index_contains(index, 65536));
+    assert(bad_extent_index_contains(index, 524287));
+    assert(!bad_extent_index_contains(index, 50000) && !bad_extent_index_contains(index, 300000));
+}
+
+static void run_scan(scan_engine_t engine, scan_order_kind_t order, unsigned threads, uint32_t block_size, bool verify) {
+    register_device(PAL_SIM_BUS_ATA, 0);
+    bad_extent_index_t* index = bad_extent_index_create(512);
+    bad_extent_index_t* mismatches = bad_extent_index_create(512);
+    assert(index && mismatches);
+
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    opts.mode = "deep";
+    opts.engine = engine;
+    opts.order = order;
+    opts.threads = threads;
+    opts.block_size = block_size;
+    opts.verify = verify;
+    opts.bad_index = index;
+    opts.mismatch_index = mismatches;
+
+    scan_state_t state;
+    int rc = surface_scan_ex(SIM_DEVICE, &opts, NULL, NULL, &state);
+    printf("  %-12s %-10s threads=%u block=%u%s: bad_sectors=%llu mismatch_sectors=%llu\n",
+           surface_scan_engine_name(engine), scan_order_name(order), threads, block_size, verify ? " verify" : "",
+           (unsigned long long)state.bad_sectors, (unsigned long long)state.mismatch_sectors);
+    assert(rc == 0);
+    assert(state.scanned_blocks == SIM_SIZE / block_size);
+    assert(state.bad_sectors == EXPECTED_BAD_SECTORS);
+    check_bad_index(index);
+    if (verify) {
+        assert(state.mismatch_sectors == 1 && state.mismatch_blocks == 1);
+        assert(bad_extent_index_contains(mismatches, 300000));
+    } else {
+        assert(state.mismatch_sectors == 0);
+    }
+    bad_extent_index_destroy(mismatches);
+    bad_extent_index_destroy(index);
+}
+
+static void test_fault_localization(void) {
+    static const scan_order_kind_t orders[] = {
+        SCAN_ORDER_SEQUENTIAL, SCAN_ORDER_REVERSE, SCAN_ORDER_STRIDED, SCAN_ORDER_RANDOM, SCAN_ORDER_BUTTERFLY
+    };
+    static const unsigned thread_counts[] = { 1, 4 };
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); ++o) {
+        for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t) {
+            run_scan(SCAN_ENGINE_SYNC, orders[o], thread_counts[t], 1024 * 1024, false);
+            run_scan(SCAN_ENGINE_MEDIA_VERIFY, orders[o], thread_counts[t], 8 * 1024 * 1024, false);
+        }
+    }
+    run_scan(SCAN_ENGINE_SYNC, SCAN_ORDER_SEQUENTIAL, 1, 64 * 1024, true);
+    run_scan(SCAN_ENGINE_SYNC, SCAN_ORDER_RANDOM, 4, 64 * 1024, true);
+}
+
+// Um scan com --verify parado pelo orçamento de tempo e retomado pelo journal
+// tem de terminar com os mesmos totais de um scan inteiro, sem contar de novo
+// o que já tinha sido lido, e a retomada herda o --verify do journal.
+static void test_resume(void) {
+    const char* path = "test_scan_sim.resume";
+    const uint32_t block_size = 1024 * 1024;
+    scan_journal_remove(path);
+
+    scan_options_t opts;
+    surface_scan_options_init(&opts);
+    opts.mode = "deep";
+    opts.engine = SCAN_ENGINE_SYNC;
+    opts.block_size = block_size;
+    opts.verify = true;
+
+    // Referência: o mesmo scan sem interrupção.
+    register_device(PAL_SIM_BUS_ATA, 0);
+    scan_state_t full;
+    assert(surface_scan_ex(SIM_DEVICE, &opts, NULL, NULL, &full) == 0);
+    assert(full.scanned_blocks == SIM_SIZE / block_size && full.bad_sectors == EXPECTED_BAD_SECTORS);
+
+    register_device(PAL_SIM_BUS_ATA, 1000);
+    bad_extent_index_t* index = bad_extent_index_create(512);
+    bad_extent_index_t* mismatches = bad_extent_index_create(512);
+    assert(index && mismatches);
+    opts.bad_index = index;
+    opts.mismatch_index = mismatches;
+    opts.journal_path = path;
+    opts.time_budget_seconds = 0.15;
+    scan_state_t state;
+    assert(surface_scan_ex(SIM_DEVICE, &opts, NULL, NULL, &state) == 0);
+    uint64_t first_pass = state.scanned_blocks;
+    assert(first_pass > 0 && first_pass < SIM_SIZE / block_size);
+    assert(state.bad_sectors < EXPECTED_BAD_SECTORS);
+    assert(scan_journal_exists(path));
+
+    // O índice do chamador é descartado: a retomada recarrega o do journal.
+    bad_extent_index_destroy(mismatches);
+    bad_extent_index_destroy(index);
+    index = bad_extent_index_create(512);
+    mismatches = bad_extent_index_create(512);
+    assert(index && mismatches);
+    opts.verify = false;
+    opts.bad_index = index;
+    opts.mismatch_index = mismatches;
+    opts.time_budget_seconds = 0.0;
+    opts.resume = true;
+    assert(surface_scan_ex(SIM_DEVICE, &opts, NULL, NULL, &state) == 0);
+    printf("  resume: %llu + %llu blocks, bad_sectors=%llu mismatch_sectors=%llu\n",
+           (unsigned long long)first_pass, (unsigned long long)(state.scanned_blocks - first_pass),
+           (unsigned long long)state.bad_sectors, (unsigned long long)state.mismatch_sectors);
+    assert(state.scanned_blocks == SIM_SIZE / block_size);
+    assert(state.verify);
+    assert(state.bad_sectors == EXPECTED_BAD_SECTORS && state.bad_extents == EXPECTED_BAD_EXTENTS);
+    assert(state.bad_blocks == full.bad_blocks && state.read_errors == full.read_errors);
+    check_bad_index(index);
+    assert(state.mismatch_sectors == 1 && state.mismatch_blocks == 1);
+    assert(bad_extent_index_sectors(mismatches) == 1 && bad_extent_index_contains(mismatches, 300000));
+    assert(!scan_journal_exists(path));
+
+    bad_extent_index_destroy(mismatches);
+    bad_extent_index_destroy(index);
+    scan_journal_remove(path);
+}
+
+// Contadores little-endian dos atributos ATA (6 bytes) e do log NVMe.
+static uint64_t le_value(const uint8_t* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = count - 1; i >= 0; --i) value = (value << 8) | bytes[i];
+    return value;
+}
+
+static void test_smart_responses(void) {
+    struct smart_data data;
+    register_device(PAL_SIM_BUS_ATA, 0);
+    assert(pal_get_smart_data(SIM_DEVICE, &data) == PAL_STATUS_SUCCESS);
+    assert(!data.is_nvme && data.drive_type == DRIVE_TYPE_ATA);
+    assert(data.attr_count == 6);
+    assert(data.data.attrs[0].id == 5 && data.data.attrs[0].value == 100 && data.data.attrs[0].threshold == 10);
+    assert(le_value(data.data.attrs[1].raw, 6) == 1200);     // horas ligado
+
+    register_device(PAL_SIM_BUS_NVME, 0);
+    assert(pal_get_smart_data(SIM_DEVICE, &data) == PAL_STATUS_SUCCESS);
+    assert(data.is_nvme && data.drive_type == DRIVE_TYPE_NVME);
+    const NVME_HEALTH_INFO_LOG* log = &data.data.nvme.raw_health_log;
+    assert((log->Temperature[0] | (log->Temperature[1] << 8)) == 308);
+    assert(log->AvailableSpare == 100 && log->AvailableSpareThreshold == 10);
+    assert(le_value(log->PowerOnHours, 8) == 1200);
+
+    assert(pal_get_smart_data("sim-test-missing", &data) != PAL_STATUS_SUCCESS);
+}
+
+static void test_bad_index_round_trip(void) {
+    const char* path = "test_scan_sim.dobx";
+    bad_extent_index_t* index = bad_extent_index_create(512);
+    assert(index);
+    for (size_t i = 0; i < sizeof(faults) / sizeof(faults[0]); ++i) {
+        if (faults[i].kind == PAL_SIM_FAULT_EIO) {
+            assert(bad_extent_index_add(index, faults[i].lba, faults[i].count, NULL) == 0);
+        }
+    }
+    assert(bad_extent_index_save(index, path) == 0);
+    bad_extent_index_t* loaded = bad_extent_index_load(path);
+    assert(loaded);
+    assert(bad_extent_index_sector_size(loaded) == 512);
+    check_bad_index(loaded);
+    bad_extent_index_destroy(loaded);
+    bad_extent_index_destroy(index);
+    remove(path);
+}
+
+static void test_journal_round_trip(void) {
+    const char* path = "test_scan_sim.journal";
+    scan_journal_t journal;
+    memset(&journal, 0, sizeof(journal));
+    snprintf(journal.device_path, sizeof(journal.device_path), "%s", SIM_DEVICE);
+    snprintf(journal.serial, sizeof(journal.serial), "SIM00000001");
+    journal.device_size = SIM_SIZE;
+    journal.sector_size = 512;
+    journal.block_size = 1024 * 1024;
+    journal.queue_depth = 32;
+    journal.order = SCAN_ORDER_RANDOM;
+    journal.order_seed = 0x1234abcdULL;
+    journal.scanned_blocks = 100;
+    journal.bad_blocks = 2;
+    journal.read_errors = 2;
+    journal.segment_count = 2;
+    journal.segments[0] = (scan_segment_t){ 0, SIM_SIZE / 2, 64ull * 1024 * 1024 };
+    journal.segments[1] = (scan_segment_t){ SIM_SIZE / 2, SIM_SIZE, SIM_SIZE / 2 + 36ull * 1024 * 1024 };
+
+    bad_extent_index_t* index = bad_extent_index_create(512);
+    assert(index && bad_extent_index_add(index, 1000, 3, NULL) == 0);
+    assert(scan_journal_save(path, &journal, index, NULL, NULL) == 0);
+
+    scan_journal_t loaded;
+    bad_extent_index_t* loaded_index = NULL;
+    latency_map_t* loaded_map = NULL;
+    assert(scan_journal_load(path, &loaded, &loaded_index, NULL, &loaded_map) == 0);
+    assert(strcmp(loaded.device_path, SIM_DEVICE) == 0 && strcmp(loaded.serial, "SIM00000001") == 0);
+    assert(loaded.device_size == SIM_SIZE && loaded.sector_size == 512 && loaded.block_size == journal.block_size);
+    assert(loaded.order == SCAN_ORDER_RANDOM && loaded.order_seed == journal.order_seed);
+    assert(loaded.scanned_blocks == 100 && loaded.bad_blocks == 2 && loaded.read_errors == 2);
+    assert(loaded.segment_count == 2);
+    assert(memcmp(loaded.segments, journal.segments, 2 * sizeof(scan_segment_t)) == 0);
+    assert(loaded_index && bad_extent_index_sectors(loaded_index) == 3 && bad_extent_index_contains(loaded_index, 1002));
+    assert(loaded_map == NULL);
+
+    bad_extent_index_destroy(loaded_index);
+    bad_extent_index_destroy(index);
+    scan_journal_remove(path);
+}
+
+static void test_sampling(void) {
+    // Com zero falhas em n amostras o limite superior do intervalo fica na
+    // tolerância; com uma amostra a menos, ainda acima dela.
+    uint64_t n = scan_sampling_size(0.95, 0.001);
+    double low, high;
+    scan_sampling_interval(0, n, 0.95, &low, &high);
+    assert(low == 0.0 && high <= 0.001 + 1e-12);
+    scan_sampling_interval(0, n - 1, 0.95, &low, &high);
+    assert(high > 0.001);
+    assert(scan_sampling_size(0.99, 0.001) > n && scan_sampling_size(0.95, 0.01) < n);
+
+    scan_sampling_interval(10, 1000, 0.95, &low, &high);
+    assert(low > 0.0 && low < 0.01 && high > 0.01 && high < 0.02);
+    scan_sampling_interval(0, 0, 0.95, &low, &high);
+    assert(low == 0.0 && high == 0.0);
+
+    // Cada estrato dá exatamente um bloco, dentro dele.
+    const uint64_t population = 100003, count = 997;
+    scan_sampler_t sampler;
+    scan_sampler_init(&sampler, population, count, 42);
+    assert(sampler.count == count);
+    bool* seen = (bool*)calloc(count, sizeof(bool));
+    assert(seen);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t block = scan_sampler_block(&sampler, i);
+        assert(block < population);
+        uint64_t stratum = 0;
+        while (scan_split_point(population, count, stratum + 1) <= block) stratum++;
+        assert(!seen[stratum]);
+        seen[stratum] = true;
+    }
+    free(seen);
+    assert(scan_split_point(population, count, 0) == 0 && scan_split_point(population, count, count) == population);
+    assert(scan_split_point(UINT64_MAX, 3, 2) == UINT64_MAX / 3 * 2 + (UINT64_MAX % 3) * 2 / 3);
+}
+
+// Toda ordem tem de ser uma permutação: cada bloco lido uma vez só.
+static void test_order_permutations(void) {
+    static const scan_order_kind_t kinds[] = {
+        SCAN_ORDER_SEQUENTIAL, SCAN_ORDER_REVERSE, SCAN_ORDER_STRIDED, SCAN_ORDER_RANDOM, SCAN_ORDER_BUTTERFLY
+    };
+    static const uint64_t sizes[] = { 1, 2, 7, 64, 1000, 4099 };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); ++k) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            uint64_t blocks = sizes[s];
+            scan_order_t order;
+            scan_order_init(&order, kinds[k], blocks, 0, 7);
+            bool* seen = (bool*)calloc(blocks, sizeof(bool));
+            assert(seen);
+            for (uint64_t p = 0; p < blocks; ++p) {
+                uint64_t block = scan_order_block(&order, p);
+                assert(block < blocks && !seen[block]);
+                seen[block] = true;
+            }
+            free(seen);
+        }
+    }
+    // A mesma semente reproduz a mesma permutação (é o que o journal guarda).
+    scan_order_t a, b;
+    scan_order_init(&a, SCAN_ORDER_RANDOM, 1000, 0, 99);
+    scan_order_init(&b, SCAN_ORDER_RANDOM, 1000, 0, 99);
+    for (uint64_t p = 0; p < 1000; ++p) assert(scan_order_block(&a, p) == scan_order_block(&b, p));
+}
+
+static void test_latency_map_queries(void) {
+    const char* path = "test_scan_sim.latmap";
+    const uint64_t device_size = 1024 * 1024;
+    latency_map_t* map = latency_map_create(64);
+    assert(map && latency_map_set_geometry(map, device_size, 512) == 0);
+    uint64_t bucket = latency_map_bucket_bytes(map);
+    assert(bucket == device_size / 64);
+
+    latency_map_record(map, 0, 100, true);
+    latency_map_record(map, bucket, 300, true);
+    latency_map_record(map, bucket + 512, 500, true);
+    latency_map_record(map, device_size / 2, 0, false);
+
+    latency_cell_t cells[4];
+    assert(latency_map_render(map, 0, 2 * bucket, cells, 2) == 0);
+    assert(cells[0].count == 1 && cells[0].min_us == 100 && cells[0].max_us == 100);
+    assert(cells[1].count == 2 && cells[1].sum_us == 800 && cells[1].min_us == 300 && cells[1].max_us == 500);
+
+    // Uma coluna para o disco inteiro vem dos níveis de cima.
+    assert(latency_map_render(map, 0, device_size, cells, 1) == 0);
+    assert(cells[0].count == 3 && cells[0].errors == 1 && cells[0].min_us == 100 && cells[0].max_us == 500);
+
+    // Metade de cima: só o erro; o último quarto: vazio.
+    assert(latency_map_render(map, device_size / 2, UINT64_MAX, cells, 2) == 0);
+    assert(cells[0].count == 0 && cells[0].errors == 1);
+    assert(cells[1].count == 0 && cells[1].errors == 0 && cells[1].min_us == UINT32_MAX);
+
+    // O arquivo responde às mesmas consultas sem carregar o mapa.
+    assert(latency_map_save(map, path) == 0);
+    uint64_t saved_size = 0;
+    uint32_t saved_sector = 0;
+    assert(latency_map_file_query(path, 0, 2 * bucket, cells, 2, &saved_size, &saved_sector) == 0);
+    assert(saved_size == device_size && saved_sector == 512);
+    assert(cells[0].count == 1 && cells[1].count == 2 && cells[1].sum_us == 800);
+
+    latency_map_destroy(map);
+    remove(path);
+}
+
+// /a tem dois trechos; /b compartilha parte do primeiro (reflink).
+static void test_file_damage(void) {
+    scan_file_index_t files;
+    scan_file_index_init(&files);
+    assert(scan_file_index_add(&files, "/a", 4096, 1000 * 512, 2 * 512) == 0);
+    assert(scan_file_index_add(&files, "/a", 0, 2000 * 512, 10 * 512) == 0);
+    assert(scan_file_index_add(&files, "/b", 0, 1001 * 512, 4 * 512) == 0);
+    assert(scan_file_index_sort(&files) == 0);
+
+    bad_extent_index_t* bad = bad_extent_index_create(512);
+    bad_extent_index_t* mismatch = bad_extent_index_create(512);
+    assert(bad && mismatch);
+    assert(bad_extent_index_add(bad, 1000, 3, NULL) == 0);
+    assert(bad_extent_index_add(bad, 3000, 2, NULL) == 0);     // fora de qualquer arquivo
+    assert(bad_extent_index_add(mismatch, 2005, 1, NULL) == 0);
+
+    scan_file_damage_t damage;
+    scan_file_damage_init(&damage);
+    assert(scan_file_damage_resolve(&damage, &files, bad, SCAN_DAMAGE_UNREADABLE) == 0);
+    assert(damage.total_hits == 2 && damage.hit_count == 2 && damage.files == 2);
+    assert(damage.bytes == 4 * 512 && damage.unmapped_sectors == 2);
+    for (size_t i = 0; i < damage.hit_count; ++i) {
+        const scan_file_hit_t* hit = &damage.hits[i];
+        const char* file = scan_file_damage_path(&damage, hit);
+        assert(hit->kind == SCAN_DAMAGE_UNREADABLE && hit->sectors == 2);
+        if (strcmp(file, "/a") == 0) assert(hit->lba == 1000 && hit->file_offset == 4096);
+        else assert(strcmp(file, "/b") == 0 && hit->lba == 1001 && hit->file_offset == 0);
+    }
+
+    // O mesmo arquivo atingido de novo não conta como outro arquivo.
+    assert(scan_file_damage_resolve(&damage, &files, mismatch, SCAN_DAMAGE_MISMATCH) == 0);
+    assert(damage.total_hits == 3 && damage.files == 2 && damage.unmapped_sectors == 2);
+    const scan_file_hit_t* hit = &damage.hits[2];
+    assert(hit->kind == SCAN_DAMAGE_MISMATCH && hit->lba == 2005 && hit->sectors == 1 && hit->file_offset == 5 * 512);
+    assert(strcmp(scan_file_damage_path(&damage, hit), "/a") == 0);
+
+    scan_file_damage_free(&damage);
+    bad_extent_index_destroy(mismatch);
+    bad_extent_index_destroy(bad);
+    scan_file_index_free(&files);
+}
+
+int main(void) {
+    test_fault_localization();
+    test_resume();
+    test_smart_responses();
+    test_bad_index_round_trip();
+    test_journal_round_trip();
+    test_sampling();
+    test_order_permutations();
+    test_latency_map_queries();
+    test_file_damage();
+    pal_sim_reset();
+    printf("test_scan_sim OK\n");
+    return 0;
+}